@@ -112,4 +112,9 @@ struct replica_info
     7:string                            app_type;
     8:string                            disk_tag;
     9:optional manual_compaction_status manual_compact_status;
+    // The load of the replica, used by the meta server to balance the cluster by the cost of
+    // the replicas.
+    10:optional i64                     storage_mb;
+    11:optional i64                     read_qps;
+    12:optional i64                     write_bytes_per_sec;
 }
@@ -62,6 +62,14 @@ enum cas_check_type
     CT_VALUE_INT_GREATER              // int compare: value > operand
 }
 
+enum pushdown_predicate_type
+{
+    PPT_VALUE_PREFIX,     // value starts with operand
+    PPT_VALUE_RANGE,      // bytes compare: operand <= value < operand_end, unset operand_end means no upper bound
+    PPT_TTL_RANGE,        // min_ttl_seconds <= ttl <= max_ttl_seconds, the record without ttl never matches an upper bound
+    PPT_SORT_KEY_REGEX    // sort key fully matches the RE2 regex operand
+}
+
 enum mutate_operation
 {
     MO_PUT,
@@ -145,6 +153,25 @@ struct multi_remove_response
     6:string        server;
 }
 
+struct pushdown_predicate
+{
+    1:pushdown_predicate_type type;
+    2:dsn.blob          operand;
+    3:optional dsn.blob operand_end;
+    4:optional i32      min_ttl_seconds;
+    5:optional i32      max_ttl_seconds;
+}
+
+// Evaluated on the server side to avoid transferring the records which are dropped by the
+// client: only the records matching all of the predicates are returned, and only the slice
+// [value_offset, value_offset + value_length) of each value is returned if projected.
+struct read_pushdown
+{
+    1:list<pushdown_predicate> predicates;
+    2:optional i32      value_offset;
+    3:optional i32      value_length; // < 0 means to the end of the value
+}
+
 struct multi_get_request
 {
     1:dsn.blob      hash_key;
@@ -159,6 +186,7 @@ struct multi_get_request
     10:filter_type  sort_key_filter_type;
     11:dsn.blob     sort_key_filter_pattern;
     12:bool         reverse; // if search in reverse direction
+    13:optional read_pushdown pushdown;
 }
 
 struct multi_get_response
@@ -287,11 +315,21 @@ struct get_scanner_request
     12:optional bool    return_expire_ts;
     13:optional bool full_scan; // true means client want to build 'full scan' context with the server side, false otherwise
     14:optional bool only_return_count = false;
+    // > 0 means the client works in streaming mode, the server may prefetch at most this count
+    // of batches ahead into the scan context while the client is consuming the current one.
+    15:optional i32  prefetch_credits = 0;
+    16:optional read_pushdown pushdown;
+    // > 1 means the server may split the key range of a full scan into at most this count of
+    // sub-ranges and iterate them in parallel. The records in a batch are ordered within each
+    // sub-range, but not across sub-ranges, so it's only allowed when full_scan is true.
+    17:optional i32  sub_scan_count = 0;
 }
 
 struct scan_request
 {
     1:i64           context_id;
+    // refresh the prefetch credits of the scan context, see get_scanner_request.prefetch_credits.
+    2:optional i32  prefetch_credits;
 }
 
 struct scan_response
@@ -28,13 +28,15 @@
 
 // IWYU pragma: no_include <string>
 
+#include "aio/aio_task.h"
 #include "disk_engine.h"
 
 namespace dsn {
-class aio_task;
 
 aio_provider::aio_provider(disk_engine *disk) : _engine(disk) {}
 
+void aio_provider::collapse_write_buffers(aio_task *aio) { aio->collapse(); }
+
 void aio_provider::complete_io(aio_task *aio, error_code err, uint64_t bytes)
 {
     _engine->complete_io(aio, err, bytes);
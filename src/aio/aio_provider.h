@@ -82,6 +82,10 @@ public:
 
     virtual aio_context *prepare_aio_context(aio_task *) = 0;
 
+    // Merges the buffers of a vectored write into a single one before it's submitted.
+    // The provider may merge them into its own buffers, e.g. the ones registered to the kernel.
+    virtual void collapse_write_buffers(aio_task *aio);
+
     void complete_io(aio_task *aio, error_code err, uint64_t bytes);
 
 private:
@@ -33,6 +33,7 @@
 
 #include "aio/aio_provider.h"
 #include "aio/aio_task.h"
+#include "io_uring_aio_provider.h"
 #include "native_linux_aio_provider.h"
 #include "runtime/task/task.h"
 #include "runtime/task/task_code.h"
@@ -40,16 +41,25 @@
 #include "runtime/tool_api.h"
 #include "utils/error_code.h"
 #include "utils/factory_store.h"
+#include "utils/flags.h"
 #include "utils/fmt_logging.h"
 #include "utils/join_point.h"
 #include "utils/link.h"
 #include "utils/threadpool_code.h"
 
+DSN_DEFINE_string(core,
+                  aio_factory_name,
+                  "dsn::tools::native_aio_provider",
+                  "The implementation class of disk AIO service, could be "
+                  "'dsn::tools::native_aio_provider' or 'dsn::tools::io_uring_aio_provider'");
+
 namespace dsn {
 DEFINE_TASK_CODE_AIO(LPC_AIO_BATCH_WRITE, TASK_PRIORITY_COMMON, THREAD_POOL_DEFAULT)
 
 const char *native_aio_provider = "dsn::tools::native_aio_provider";
 DSN_REGISTER_COMPONENT_PROVIDER(native_linux_aio_provider, native_aio_provider);
+const char *uring_aio_provider = "dsn::tools::io_uring_aio_provider";
+DSN_REGISTER_COMPONENT_PROVIDER(io_uring_aio_provider, uring_aio_provider);
 
 struct disk_engine_initializer
 {
@@ -161,11 +171,24 @@ aio_task *disk_file::on_write_completed(aio_task *wk, void *ctx, error_code err,
 }
 
 //----------------- disk_engine ------------------------
-disk_engine::disk_engine()
+aio_provider &disk_engine::provider()
 {
-    aio_provider *provider = utils::factory_store<aio_provider>::create(
-        native_aio_provider, dsn::PROVIDER_TYPE_MAIN, this);
-    _provider.reset(provider);
+    // The provider is created on the first use rather than in the constructor, since the
+    // singleton is constructed during the static initialization, before the config is loaded.
+    auto &engine = instance();
+    std::call_once(engine._provider_once, [&engine]() {
+        aio_provider *provider = utils::factory_store<aio_provider>::create(
+            FLAGS_aio_factory_name, dsn::PROVIDER_TYPE_MAIN, &engine);
+        if (provider == nullptr) {
+            LOG_ERROR("aio provider '{}' not found, fall back to '{}'",
+                      FLAGS_aio_factory_name,
+                      native_aio_provider);
+            provider = utils::factory_store<aio_provider>::create(
+                native_aio_provider, dsn::PROVIDER_TYPE_MAIN, &engine);
+        }
+        engine._provider.reset(provider);
+    });
+    return *engine._provider;
 }
 
 class batch_write_io_task : public aio_task
@@ -213,8 +236,8 @@ void disk_engine::process_write(aio_task *aio, uint64_t sz)
 
     // no batching
     if (dio->buffer_size == sz) {
-        aio->collapse();
-        _provider->submit_aio_task(aio);
+        provider().collapse_write_buffers(aio);
+        provider().submit_aio_task(aio);
     }
 
     // batching
@@ -270,7 +293,7 @@ void disk_engine::complete_io(aio_task *aio, error_code err, uint64_t bytes)
         if (aio->get_aio_context()->type == AIO_Read) {
             auto wk = dfile->on_read_completed(aio, err, (size_t)bytes);
             if (wk) {
-                _provider->submit_aio_task(wk);
+                provider().submit_aio_task(wk);
             }
         }
 
@@ -0,0 +1,870 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "io_uring_aio_provider.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "aio/aio_task.h"
+#include "aio/disk_engine.h"
+#include "rocksdb/env.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "runtime/service_engine.h"
+#include "utils/flags.h"
+#include "utils/fmt_logging.h"
+#include "utils/latency_tracer.h"
+#include "utils/safe_strerror_posix.h"
+#include "utils/synchronize.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define DSN_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+DSN_DECLARE_bool(encrypt_data_at_rest);
+
+DSN_DEFINE_uint32(core,
+                  io_uring_queue_depth,
+                  256,
+                  "The count of entries of the io_uring submission queue");
+DSN_DEFINE_uint32(core,
+                  io_uring_registered_buffer_count,
+                  16,
+                  "The count of buffers registered to io_uring for the vectored writes, 0 means "
+                  "the registered buffers are not used");
+DSN_DEFINE_uint32(core,
+                  io_uring_registered_buffer_size_kb,
+                  1024,
+                  "The size of each buffer registered to io_uring, the vectored write larger "
+                  "than it is merged into a temporary buffer instead");
+
+namespace dsn {
+
+namespace {
+
+// Return 0 if all the 'size' bytes are written, otherwise the errno.
+int pwrite_fully(int fd, const char *buf, size_t size, uint64_t offset)
+{
+    while (size > 0) {
+        ssize_t n = ::pwrite(fd, buf, size, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        buf += n;
+        size -= n;
+        offset += n;
+    }
+    return 0;
+}
+
+// Return 0 if the read succeeds, the read bytes is less than 'size' only if EOF is reached.
+int pread_fully(int fd, char *buf, size_t size, uint64_t offset, size_t *read_bytes)
+{
+    *read_bytes = 0;
+    while (*read_bytes < size) {
+        ssize_t n = ::pread(fd, buf + *read_bytes, size - *read_bytes, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        if (n == 0) {
+            break;
+        }
+        *read_bytes += n;
+        offset += n;
+    }
+    return 0;
+}
+
+rocksdb::Status io_error(const std::string &fname, int err)
+{
+    return rocksdb::Status::IOError(fname, utils::safe_strerror(err));
+}
+
+// The files opened by io_uring_aio_provider expose their fds, so that they could be accessed by
+// the ring. The synchronous interfaces are implemented by the plain system calls.
+class io_uring_rw_file : public rocksdb::RandomRWFile
+{
+public:
+    io_uring_rw_file(std::string fname, int fd) : _fname(std::move(fname)), _fd(fd) {}
+    ~io_uring_rw_file() override { Close(); }
+
+    rocksdb::Status Write(uint64_t offset, const rocksdb::Slice &data) override
+    {
+        int err = pwrite_fully(_fd, data.data(), data.size(), offset);
+        return err == 0 ? rocksdb::Status::OK() : io_error(_fname, err);
+    }
+
+    rocksdb::Status
+    Read(uint64_t offset, size_t n, rocksdb::Slice *result, char *scratch) const override
+    {
+        size_t read_bytes = 0;
+        int err = pread_fully(_fd, scratch, n, offset, &read_bytes);
+        if (err != 0) {
+            return io_error(_fname, err);
+        }
+        *result = rocksdb::Slice(scratch, read_bytes);
+        return rocksdb::Status::OK();
+    }
+
+    rocksdb::Status Flush() override { return rocksdb::Status::OK(); }
+
+    rocksdb::Status Sync() override
+    {
+        return ::fdatasync(_fd) == 0 ? rocksdb::Status::OK() : io_error(_fname, errno);
+    }
+
+    rocksdb::Status Fsync() override
+    {
+        return ::fsync(_fd) == 0 ? rocksdb::Status::OK() : io_error(_fname, errno);
+    }
+
+    rocksdb::Status Close() override
+    {
+        if (_fd < 0) {
+            return rocksdb::Status::OK();
+        }
+        int ret = ::close(_fd);
+        _fd = -1;
+        return ret == 0 ? rocksdb::Status::OK() : io_error(_fname, errno);
+    }
+
+    int fd() const { return _fd; }
+
+private:
+    const std::string _fname;
+    int _fd;
+};
+
+class io_uring_read_file : public rocksdb::RandomAccessFile
+{
+public:
+    io_uring_read_file(std::string fname, int fd) : _fname(std::move(fname)), _fd(fd) {}
+    ~io_uring_read_file() override { ::close(_fd); }
+
+    rocksdb::Status
+    Read(uint64_t offset, size_t n, rocksdb::Slice *result, char *scratch) const override
+    {
+        size_t read_bytes = 0;
+        int err = pread_fully(_fd, scratch, n, offset, &read_bytes);
+        if (err != 0) {
+            return io_error(_fname, err);
+        }
+        *result = rocksdb::Slice(scratch, read_bytes);
+        return rocksdb::Status::OK();
+    }
+
+    int fd() const { return _fd; }
+
+private:
+    const std::string _fname;
+    const int _fd;
+};
+
+} // anonymous namespace
+
+// The context of a request submitted to the ring, it's passed as the user data of the entries.
+struct io_uring_request
+{
+    // The aio task to be completed, nullptr for the synchronous requests.
+    aio_task *aio = nullptr;
+    int fd = -1;
+    struct iovec iov;
+    // The index of the registered buffer used by the write, -1 if not used.
+    int buffer_index = -1;
+    // The sequence number of the write among the writes of the file.
+    uint64_t write_seq = 0;
+
+    // The synchronous requests (e.g. fsync) are waited by the submitter.
+    utils::notify_event *done = nullptr;
+    int result = 0;
+};
+
+struct io_uring_sqe_args
+{
+    uint8_t opcode;
+    int fd;
+    const void *addr;
+    uint32_t len;
+    uint64_t offset;
+    int buf_index;
+    uint64_t user_data;
+    // IOSQE_* flags of the entry.
+    uint8_t flags;
+};
+
+#ifdef DSN_HAS_IO_URING
+
+// A minimal io_uring implemented by the raw system calls, thus no extra library is required.
+class io_uring_ring
+{
+public:
+    // Return nullptr if io_uring is not supported.
+    static std::unique_ptr<io_uring_ring>
+    create(uint32_t entries, uint32_t buffer_count, size_t buffer_size)
+    {
+        std::unique_ptr<io_uring_ring> ring(new io_uring_ring());
+        if (!ring->setup(entries)) {
+            return nullptr;
+        }
+        ring->register_buffers(buffer_count, buffer_size);
+        return ring;
+    }
+
+    ~io_uring_ring()
+    {
+        if (_sq_ring != MAP_FAILED) {
+            ::munmap(_sq_ring, _sq_ring_size);
+        }
+        if (_cq_ring != MAP_FAILED && _cq_ring != _sq_ring) {
+            ::munmap(_cq_ring, _cq_ring_size);
+        }
+        if (_sqes != MAP_FAILED) {
+            ::munmap(_sqes, _params.sq_entries * sizeof(struct io_uring_sqe));
+        }
+        if (_ring_fd >= 0) {
+            ::close(_ring_fd);
+        }
+        ::free(_buffers);
+    }
+
+    // Submit an entry. The submissions of the concurrent callers are batched: once a caller is
+    // submitting, the others only append their entries to the queue, which will be submitted by
+    // the former in the following io_uring_enter() call.
+    void submit(const io_uring_sqe_args &args)
+    {
+        std::unique_lock<std::mutex> l(_sq_mutex);
+        while (pending_submissions() >= _params.sq_entries) {
+            // The kernel refuses to consume the entries only if the completion queue overflows,
+            // wait for the reaping thread.
+            l.unlock();
+            std::this_thread::yield();
+            flush_submissions();
+            l.lock();
+        }
+
+        const unsigned tail = *_sq_tail;
+        const unsigned index = tail & *_sq_mask;
+        struct io_uring_sqe *sqe = &_sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = args.opcode;
+        sqe->flags = args.flags;
+        sqe->fd = args.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(args.addr);
+        sqe->len = args.len;
+        sqe->off = args.offset;
+        if (args.buf_index >= 0) {
+            sqe->buf_index = static_cast<uint16_t>(args.buf_index);
+        }
+        sqe->user_data = args.user_data;
+        _sq_array[index] = index;
+        __atomic_store_n(_sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+        if (!_submitting) {
+            submit_pending(l);
+        }
+    }
+
+    // Submit the entries left by the failed io_uring_enter() calls.
+    void flush_submissions()
+    {
+        std::unique_lock<std::mutex> l(_sq_mutex);
+        if (!_submitting) {
+            submit_pending(l);
+        }
+    }
+
+    // Wait until there is at least one completion, and take all of them as pairs of
+    // <user_data, result>. Return 0 if succeed, otherwise the errno of the failed wait, which is
+    // left to the caller to retry. It should be called by only one thread.
+    int wait_completions(std::vector<std::pair<uint64_t, int>> &completions)
+    {
+        unsigned head = *_cq_head;
+        unsigned tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+        while (head == tail) {
+            int ret = enter(0, 1, IORING_ENTER_GETEVENTS);
+            if (ret < 0 && errno != EINTR) {
+                return errno;
+            }
+            tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+        }
+
+        for (; head != tail; ++head) {
+            const struct io_uring_cqe &cqe = _cqes[head & *_cq_mask];
+            completions.emplace_back(cqe.user_data, cqe.res);
+        }
+        __atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+        return 0;
+    }
+
+    // Acquire a registered buffer for the write of 'size' bytes, nullptr if none is available.
+    char *acquire_buffer(size_t size)
+    {
+        if (size > _buffer_size) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> l(_buffer_mutex);
+        if (_free_buffers.empty()) {
+            return nullptr;
+        }
+        int index = _free_buffers.back();
+        _free_buffers.pop_back();
+        return _buffers + static_cast<size_t>(index) * _buffer_size;
+    }
+
+    // Return the index of the registered buffer, or -1 if 'buffer' is not registered.
+    int buffer_index(const void *buffer) const
+    {
+        const char *p = static_cast<const char *>(buffer);
+        if (_buffers == nullptr || p < _buffers || p >= _buffers + _buffer_count * _buffer_size) {
+            return -1;
+        }
+        return static_cast<int>((p - _buffers) / _buffer_size);
+    }
+
+    void release_buffer(int index)
+    {
+        std::lock_guard<std::mutex> l(_buffer_mutex);
+        _free_buffers.push_back(index);
+    }
+
+private:
+    io_uring_ring() = default;
+
+    bool setup(uint32_t entries)
+    {
+        memset(&_params, 0, sizeof(_params));
+        _ring_fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &_params));
+        if (_ring_fd < 0) {
+            LOG_WARNING("io_uring is not supported, err = {}", utils::safe_strerror(errno));
+            return false;
+        }
+
+        _sq_ring_size = _params.sq_off.array + _params.sq_entries * sizeof(unsigned);
+        _cq_ring_size = _params.cq_off.cqes + _params.cq_entries * sizeof(struct io_uring_cqe);
+        const bool single_mmap = (_params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            _sq_ring_size = std::max(_sq_ring_size, _cq_ring_size);
+            _cq_ring_size = _sq_ring_size;
+        }
+
+        _sq_ring = ::mmap(nullptr,
+                          _sq_ring_size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE,
+                          _ring_fd,
+                          IORING_OFF_SQ_RING);
+        if (_sq_ring == MAP_FAILED) {
+            LOG_WARNING("mmap io_uring submission queue failed, err = {}",
+                        utils::safe_strerror(errno));
+            return false;
+        }
+        _cq_ring = single_mmap ? _sq_ring
+                               : ::mmap(nullptr,
+                                        _cq_ring_size,
+                                        PROT_READ | PROT_WRITE,
+                                        MAP_SHARED | MAP_POPULATE,
+                                        _ring_fd,
+                                        IORING_OFF_CQ_RING);
+        if (_cq_ring == MAP_FAILED) {
+            LOG_WARNING("mmap io_uring completion queue failed, err = {}",
+                        utils::safe_strerror(errno));
+            return false;
+        }
+        _sqes = static_cast<struct io_uring_sqe *>(
+            ::mmap(nullptr,
+                   _params.sq_entries * sizeof(struct io_uring_sqe),
+                   PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE,
+                   _ring_fd,
+                   IORING_OFF_SQES));
+        if (_sqes == MAP_FAILED) {
+            LOG_WARNING("mmap io_uring submission entries failed, err = {}",
+                        utils::safe_strerror(errno));
+            return false;
+        }
+
+        char *sq = static_cast<char *>(_sq_ring);
+        _sq_head = reinterpret_cast<unsigned *>(sq + _params.sq_off.head);
+        _sq_tail = reinterpret_cast<unsigned *>(sq + _params.sq_off.tail);
+        _sq_mask = reinterpret_cast<unsigned *>(sq + _params.sq_off.ring_mask);
+        _sq_array = reinterpret_cast<unsigned *>(sq + _params.sq_off.array);
+        char *cq = static_cast<char *>(_cq_ring);
+        _cq_head = reinterpret_cast<unsigned *>(cq + _params.cq_off.head);
+        _cq_tail = reinterpret_cast<unsigned *>(cq + _params.cq_off.tail);
+        _cq_mask = reinterpret_cast<unsigned *>(cq + _params.cq_off.ring_mask);
+        _cqes = reinterpret_cast<struct io_uring_cqe *>(cq + _params.cq_off.cqes);
+
+        LOG_INFO("io_uring is set up, sq_entries = {}, cq_entries = {}",
+                 _params.sq_entries,
+                 _params.cq_entries);
+        return true;
+    }
+
+    void register_buffers(uint32_t count, size_t size)
+    {
+        if (count == 0 || size == 0) {
+            return;
+        }
+
+        void *buffers = nullptr;
+        if (::posix_memalign(&buffers, 4096, count * size) != 0) {
+            LOG_WARNING("allocate {} io_uring buffers of {} bytes failed", count, size);
+            return;
+        }
+        std::vector<struct iovec> iovs(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            iovs[i].iov_base = static_cast<char *>(buffers) + i * size;
+            iovs[i].iov_len = size;
+        }
+        // It may fail if the buffers exceed RLIMIT_MEMLOCK, the writes are still submitted to
+        // the ring, just without the registered buffers.
+        int ret = static_cast<int>(::syscall(
+            __NR_io_uring_register, _ring_fd, IORING_REGISTER_BUFFERS, iovs.data(), count));
+        if (ret < 0) {
+            LOG_WARNING("register {} io_uring buffers of {} bytes failed, err = {}",
+                        count,
+                        size,
+                        utils::safe_strerror(errno));
+            ::free(buffers);
+            return;
+        }
+
+        _buffers = static_cast<char *>(buffers);
+        _buffer_count = count;
+        _buffer_size = size;
+        for (uint32_t i = 0; i < count; ++i) {
+            _free_buffers.push_back(static_cast<int>(i));
+        }
+    }
+
+    int enter(unsigned to_submit, unsigned min_complete, unsigned flags)
+    {
+        return static_cast<int>(::syscall(
+            __NR_io_uring_enter, _ring_fd, to_submit, min_complete, flags, nullptr, 0));
+    }
+
+    // The count of the entries which haven't been consumed by the kernel.
+    unsigned pending_submissions() const
+    {
+        return *_sq_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+    }
+
+    // Preconditions:
+    // - 'l' holds _sq_mutex
+    // - _submitting == false
+    void submit_pending(std::unique_lock<std::mutex> &l)
+    {
+        _submitting = true;
+        unsigned to_submit;
+        while ((to_submit = pending_submissions()) > 0) {
+            // Release the lock during the system call, the entries appended in the meantime will
+            // be submitted by the next round.
+            l.unlock();
+            int ret = enter(to_submit, 0, 0);
+            int err = errno;
+            l.lock();
+            if (ret < 0 && err != EINTR) {
+                // EAGAIN or EBUSY, the left entries will be submitted after some completions
+                // are reaped.
+                if (err != EAGAIN && err != EBUSY) {
+                    LOG_ERROR("submit to io_uring failed, err = {}", utils::safe_strerror(err));
+                }
+                break;
+            }
+        }
+        _submitting = false;
+    }
+
+    int _ring_fd = -1;
+    struct io_uring_params _params;
+
+    void *_sq_ring = MAP_FAILED;
+    size_t _sq_ring_size = 0;
+    unsigned *_sq_head = nullptr;
+    unsigned *_sq_tail = nullptr;
+    unsigned *_sq_mask = nullptr;
+    unsigned *_sq_array = nullptr;
+    struct io_uring_sqe *_sqes = static_cast<struct io_uring_sqe *>(MAP_FAILED);
+    std::mutex _sq_mutex;
+    bool _submitting = false;
+
+    void *_cq_ring = MAP_FAILED;
+    size_t _cq_ring_size = 0;
+    unsigned *_cq_head = nullptr;
+    unsigned *_cq_tail = nullptr;
+    unsigned *_cq_mask = nullptr;
+    struct io_uring_cqe *_cqes = nullptr;
+
+    char *_buffers = nullptr;
+    size_t _buffer_count = 0;
+    size_t _buffer_size = 0;
+    std::mutex _buffer_mutex;
+    std::vector<int> _free_buffers;
+};
+
+namespace {
+const uint8_t kOpNop = IORING_OP_NOP;
+const uint8_t kOpReadv = IORING_OP_READV;
+const uint8_t kOpWritev = IORING_OP_WRITEV;
+const uint8_t kOpWriteFixed = IORING_OP_WRITE_FIXED;
+const uint8_t kOpFsync = IORING_OP_FSYNC;
+} // anonymous namespace
+
+#else // DSN_HAS_IO_URING
+
+// io_uring is not supported on this platform, the provider always falls back.
+class io_uring_ring
+{
+public:
+    static std::unique_ptr<io_uring_ring> create(uint32_t, uint32_t, size_t)
+    {
+        LOG_WARNING("io_uring is not supported on this platform");
+        return nullptr;
+    }
+    void submit(const io_uring_sqe_args &) {}
+    void flush_submissions() {}
+    int wait_completions(std::vector<std::pair<uint64_t, int>> &) { return 0; }
+    char *acquire_buffer(size_t) { return nullptr; }
+    int buffer_index(const void *) const { return -1; }
+    void release_buffer(int) {}
+};
+
+namespace {
+const uint8_t kOpNop = 0;
+const uint8_t kOpReadv = 0;
+const uint8_t kOpWritev = 0;
+const uint8_t kOpWriteFixed = 0;
+const uint8_t kOpFsync = 0;
+} // anonymous namespace
+
+#endif // DSN_HAS_IO_URING
+
+io_uring_aio_provider::io_uring_aio_provider(disk_engine *disk) : native_linux_aio_provider(disk)
+{
+    if (FLAGS_encrypt_data_at_rest) {
+        LOG_WARNING("io_uring is disabled since the data is encrypted at rest");
+        return;
+    }
+
+    _ring = io_uring_ring::create(FLAGS_io_uring_queue_depth,
+                                  FLAGS_io_uring_registered_buffer_count,
+                                  static_cast<size_t>(FLAGS_io_uring_registered_buffer_size_kb) *
+                                      1024);
+    if (_ring) {
+        _reaper = std::thread([this]() { reap_completions(); });
+    }
+}
+
+io_uring_aio_provider::~io_uring_aio_provider()
+{
+    if (_reaper.joinable()) {
+        // The completion of the entry with user data 0 stops the reaping thread, once all the
+        // requests in flight have been completed.
+        _stopping.store(true);
+        _ring->submit({kOpNop, -1, nullptr, 0, 0, -1, 0, 0});
+        _reaper.join();
+    }
+}
+
+std::unique_ptr<rocksdb::RandomAccessFile>
+io_uring_aio_provider::open_read_file(const std::string &fname)
+{
+    if (!_ring) {
+        return native_linux_aio_provider::open_read_file(fname);
+    }
+
+    int fd = ::open(fname.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("open read file '{}' failed, err = {}", fname, utils::safe_strerror(errno));
+        return nullptr;
+    }
+    return std::make_unique<io_uring_read_file>(fname, fd);
+}
+
+std::unique_ptr<rocksdb::RandomRWFile>
+io_uring_aio_provider::open_write_file(const std::string &fname)
+{
+    if (!_ring) {
+        return native_linux_aio_provider::open_write_file(fname);
+    }
+
+    int fd = ::open(fname.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR("open write file '{}' failed, err = {}", fname, utils::safe_strerror(errno));
+        return nullptr;
+    }
+    return std::make_unique<io_uring_rw_file>(fname, fd);
+}
+
+error_code io_uring_aio_provider::flush(rocksdb::RandomRWFile *wf)
+{
+    auto *file = dynamic_cast<io_uring_rw_file *>(wf);
+    if (!_ring || file == nullptr) {
+        return native_linux_aio_provider::flush(wf);
+    }
+
+    utils::notify_event done;
+    io_uring_request req;
+    req.fd = file->fd();
+    req.done = &done;
+    // The entries in the ring may be executed in any order, while fsync only persists the writes
+    // completed before it starts. Wait for the writes of this file submitted before it, rather
+    // than draining the ring with IOSQE_IO_DRAIN, which would stall the requests of all the other
+    // files behind the fsync.
+    wait_writes_submitted_before(req.fd);
+    _inflight_requests.fetch_add(1);
+    _ring->submit({kOpFsync, req.fd, nullptr, 0, 0, -1, reinterpret_cast<uint64_t>(&req), 0});
+    done.wait();
+
+    if (req.result < 0) {
+        LOG_ERROR("flush file failed, err = {}", utils::safe_strerror(-req.result));
+        return ERR_FILE_OPERATION_FAILED;
+    }
+    return ERR_OK;
+}
+
+int io_uring_aio_provider::get_fd(aio_task *aio) const
+{
+    aio_context *ctx = aio->get_aio_context();
+    if (ctx->type == AIO_Read) {
+        auto *file = dynamic_cast<io_uring_read_file *>(ctx->dfile->rfile());
+        return file == nullptr ? -1 : file->fd();
+    }
+    auto *file = dynamic_cast<io_uring_rw_file *>(ctx->dfile->wfile());
+    return file == nullptr ? -1 : file->fd();
+}
+
+void io_uring_aio_provider::collapse_write_buffers(aio_task *aio)
+{
+    aio_context *ctx = aio->get_aio_context();
+    char *buffer = nullptr;
+    if (_ring && !aio->_unmerged_write_buffers.empty() &&
+        !service_engine::instance().is_simulator() && get_fd(aio) >= 0) {
+        buffer = _ring->acquire_buffer(ctx->buffer_size);
+    }
+    if (buffer == nullptr) {
+        aio->collapse();
+        return;
+    }
+
+    // The registered buffer is released once the write is completed, see on_completed().
+    char *dest = buffer;
+    for (const dsn_file_buffer_t &b : aio->_unmerged_write_buffers) {
+        ::memcpy(dest, b.buffer, b.size);
+        dest += b.size;
+    }
+    CHECK_EQ(dest - buffer, ctx->buffer_size);
+    ctx->buffer = buffer;
+}
+
+void io_uring_aio_provider::submit_aio_task(aio_task *aio)
+{
+    int fd = -1;
+    if (_ring && !service_engine::instance().is_simulator()) {
+        fd = get_fd(aio);
+    }
+    if (fd < 0) {
+        native_linux_aio_provider::submit_aio_task(aio);
+        return;
+    }
+
+    ADD_POINT(aio->_tracer);
+    aio_context *ctx = aio->get_aio_context();
+    auto *req = new io_uring_request();
+    req->aio = aio;
+    req->fd = fd;
+    req->iov.iov_base = ctx->buffer;
+    req->iov.iov_len = ctx->buffer_size;
+
+    io_uring_sqe_args args{kOpReadv,
+                           fd,
+                           &req->iov,
+                           1,
+                           ctx->file_offset,
+                           -1,
+                           reinterpret_cast<uint64_t>(req),
+                           0};
+    if (ctx->type == AIO_Write) {
+        req->buffer_index = _ring->buffer_index(ctx->buffer);
+        if (req->buffer_index >= 0) {
+            args.opcode = kOpWriteFixed;
+            args.addr = ctx->buffer;
+            args.len = static_cast<uint32_t>(ctx->buffer_size);
+            args.buf_index = req->buffer_index;
+        } else {
+            args.opcode = kOpWritev;
+        }
+        req->write_seq = on_write_submitted(fd);
+    }
+    _inflight_requests.fetch_add(1);
+    _ring->submit(args);
+}
+
+void io_uring_aio_provider::reap_completions()
+{
+    static const int kMaxBackoffMs = 1000;
+
+    std::vector<std::pair<uint64_t, int>> completions;
+    bool stopped = false;
+    uint64_t failures = 0;
+    int backoff_ms = 1;
+    while (!stopped || _inflight_requests.load() > 0) {
+        completions.clear();
+        int err = _ring->wait_completions(completions);
+        if (err != 0) {
+            // The failure is hardly transient, back off rather than spinning on it. It's logged
+            // at the first time and then about once a minute.
+            ++failures;
+            LOG_ERROR_IF(failures == 1 || failures % 60 == 0,
+                         "wait for io_uring completions failed for {} times, err = {}",
+                         failures,
+                         utils::safe_strerror(err));
+            if (stopped || _stopping.load()) {
+                LOG_ERROR("give up {} io_uring requests in flight", _inflight_requests.load());
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
+            backoff_ms = std::min(backoff_ms * 2, kMaxBackoffMs);
+            continue;
+        }
+        failures = 0;
+        backoff_ms = 1;
+
+        for (const auto &completion : completions) {
+            if (completion.first == 0) {
+                stopped = true;
+                continue;
+            }
+            on_completed(reinterpret_cast<io_uring_request *>(completion.first),
+                         completion.second);
+        }
+        // Some entries may be left in the submission queue if the completion queue was full.
+        _ring->flush_submissions();
+    }
+}
+
+void io_uring_aio_provider::on_completed(io_uring_request *req, int result)
+{
+    if (req->done != nullptr) {
+        // The synchronous request is owned by the waiter.
+        req->result = result;
+        _inflight_requests.fetch_sub(1);
+        req->done->notify();
+        return;
+    }
+
+    std::unique_ptr<io_uring_request> holder(req);
+    aio_task *aio = req->aio;
+    aio_context *ctx = aio->get_aio_context();
+    const bool is_write = ctx->type == AIO_Write;
+    error_code err = ERR_OK;
+    uint64_t processed_bytes = 0;
+    if (result < 0) {
+        LOG_ERROR("{} file failed, err = {}",
+                  ctx->type == AIO_Read ? "read" : "write",
+                  utils::safe_strerror(-result));
+        err = ERR_FILE_OPERATION_FAILED;
+    } else if (ctx->type == AIO_Read) {
+        if (result == 0) {
+            err = ERR_HANDLE_EOF;
+        }
+        processed_bytes = static_cast<uint64_t>(result);
+    } else {
+        processed_bytes = static_cast<uint64_t>(result);
+        if (processed_bytes < ctx->buffer_size) {
+            // A short write is rare on the regular files, write the rest synchronously.
+            int write_err = pwrite_fully(req->fd,
+                                         static_cast<const char *>(ctx->buffer) + processed_bytes,
+                                         ctx->buffer_size - processed_bytes,
+                                         ctx->file_offset + processed_bytes);
+            if (write_err != 0) {
+                LOG_ERROR("write file failed, err = {}", utils::safe_strerror(write_err));
+                err = ERR_FILE_OPERATION_FAILED;
+            } else {
+                processed_bytes = ctx->buffer_size;
+            }
+        }
+    }
+
+    if (req->buffer_index >= 0) {
+        ctx->buffer = nullptr;
+        _ring->release_buffer(req->buffer_index);
+    }
+
+    ADD_CUSTOM_POINT(aio->_tracer, "completed");
+    complete_io(aio, err, processed_bytes);
+
+    // The aio task may have been released once completed.
+    if (is_write) {
+        on_write_completed(req->fd, req->write_seq);
+    }
+    _inflight_requests.fetch_sub(1);
+}
+
+uint64_t io_uring_aio_provider::on_write_submitted(int fd)
+{
+    std::lock_guard<std::mutex> l(_writes_mutex);
+    file_writes &writes = _writes[fd];
+    uint64_t seq = writes.next_seq++;
+    writes.inflight.insert(seq);
+    return seq;
+}
+
+void io_uring_aio_provider::on_write_completed(int fd, uint64_t seq)
+{
+    {
+        std::lock_guard<std::mutex> l(_writes_mutex);
+        _writes[fd].inflight.erase(seq);
+    }
+    _writes_cv.notify_all();
+}
+
+void io_uring_aio_provider::wait_writes_submitted_before(int fd)
+{
+    std::unique_lock<std::mutex> l(_writes_mutex);
+    // The references to the elements of std::unordered_map are never invalidated by rehashing.
+    const file_writes &writes = _writes[fd];
+    const uint64_t end_seq = writes.next_seq;
+    _writes_cv.wait(l, [&writes, end_seq]() {
+        return writes.inflight.empty() || *writes.inflight.begin() >= end_seq;
+    });
+}
+
+} // namespace dsn
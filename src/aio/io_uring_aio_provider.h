@@ -0,0 +1,110 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "aio/native_linux_aio_provider.h"
+#include "utils/error_code.h"
+
+namespace rocksdb {
+class RandomAccessFile;
+class RandomRWFile;
+} // namespace rocksdb
+
+namespace dsn {
+class aio_task;
+class disk_engine;
+class io_uring_ring;
+struct io_uring_request;
+
+// The aio provider based on io_uring:
+// - The reads, writes and fsyncs are submitted to the ring without blocking any worker thread,
+//   and the submissions of the concurrent tasks are batched into one io_uring_enter() call.
+// - The completions are reaped by a dedicated thread, which completes the aio tasks.
+// - The vectored writes, e.g. the log blocks of the private log, are merged into the buffers
+//   registered to the kernel, which saves pinning the pages of each write.
+//
+// It falls back to native_linux_aio_provider if io_uring is not supported by the kernel, or the
+// files are encrypted at rest, which have to be accessed through the encrypted Env.
+class io_uring_aio_provider : public native_linux_aio_provider
+{
+public:
+    explicit io_uring_aio_provider(disk_engine *disk);
+    ~io_uring_aio_provider() override;
+
+    std::unique_ptr<rocksdb::RandomAccessFile> open_read_file(const std::string &fname) override;
+
+    std::unique_ptr<rocksdb::RandomRWFile> open_write_file(const std::string &fname) override;
+    error_code flush(rocksdb::RandomRWFile *wf) override;
+
+    void submit_aio_task(aio_task *aio) override;
+    void collapse_write_buffers(aio_task *aio) override;
+
+    // Whether the ring has been set up, otherwise all the operations fall back to
+    // native_linux_aio_provider.
+    bool ring_enabled() const { return _ring != nullptr; }
+
+private:
+    // Return the fd of the file to be accessed by 'aio', or -1 if it's not opened by this
+    // provider.
+    int get_fd(aio_task *aio) const;
+
+    void reap_completions();
+    void on_completed(io_uring_request *req, int result);
+
+    // Track the writes in flight of each file, so that the fsync of a file waits for only the
+    // writes of its own rather than draining the whole ring.
+    uint64_t on_write_submitted(int fd);
+    void on_write_completed(int fd, uint64_t seq);
+    void wait_writes_submitted_before(int fd);
+
+    struct file_writes
+    {
+        // The sequence number of the next write submitted to the file.
+        uint64_t next_seq = 0;
+        // The sequence numbers of the writes in flight.
+        std::set<uint64_t> inflight;
+    };
+
+    std::unique_ptr<io_uring_ring> _ring;
+    std::thread _reaper;
+    // The count of the requests submitted to the ring but not completed yet, the reaping thread
+    // doesn't stop until all of them have been completed.
+    std::atomic<uint64_t> _inflight_requests{0};
+    // Set once the provider is being destroyed, so that the reaping thread gives up the requests
+    // in flight rather than waiting for them forever if the ring is broken.
+    std::atomic<bool> _stopping{false};
+
+    std::mutex _writes_mutex;
+    std::condition_variable _writes_cv;
+    // fd => the writes of the file
+    std::unordered_map<int, file_writes> _writes;
+};
+
+} // namespace dsn
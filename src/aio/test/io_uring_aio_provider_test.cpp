@@ -0,0 +1,244 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <rocksdb/env.h>
+#include <rocksdb/slice.h>
+#include <rocksdb/status.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "aio/aio_task.h"
+#include "aio/disk_engine.h"
+#include "aio/file_io.h"
+#include "aio/io_uring_aio_provider.h"
+#include "gtest/gtest.h"
+#include "runtime/task/task_code.h"
+#include "test_util/test_util.h"
+#include "utils/error_code.h"
+#include "utils/filesystem.h"
+#include "utils/flags.h"
+#include "utils/fmt_logging.h"
+#include "utils/threadpool_code.h"
+
+DSN_DECLARE_bool(encrypt_data_at_rest);
+
+namespace dsn {
+
+DEFINE_TASK_CODE_AIO(LPC_IO_URING_AIO_TEST, TASK_PRIORITY_COMMON, THREAD_POOL_DEFAULT)
+
+class io_uring_aio_provider_test : public testing::Test
+{
+public:
+    void SetUp() override { utils::filesystem::remove_path(kTestFileName); }
+    void TearDown() override { utils::filesystem::remove_path(kTestFileName); }
+
+    // Submit the read to 'provider' in the way of disk_engine, whose completion is still
+    // handled by disk_engine.
+    static aio_task_ptr submit_read(io_uring_aio_provider &provider,
+                                    disk_file *dfile,
+                                    char *buffer,
+                                    size_t size,
+                                    uint64_t offset)
+    {
+        auto tsk = create_test_task(dfile, AIO_Read, size, offset);
+        tsk->get_aio_context()->buffer = buffer;
+        auto *wk = dfile->read(tsk);
+        CHECK(tsk.get() == wk, "the task should be submitted at once");
+        provider.submit_aio_task(wk);
+        return tsk;
+    }
+
+    // Similar to the above, but the buffers are merged before being written, like the vectored
+    // writes.
+    static aio_task_ptr submit_write(io_uring_aio_provider &provider,
+                                     disk_file *dfile,
+                                     const std::vector<std::string> &buffers,
+                                     uint64_t offset)
+    {
+        size_t size = 0;
+        for (const auto &buffer : buffers) {
+            size += buffer.size();
+        }
+        auto tsk = create_test_task(dfile, AIO_Write, size, offset);
+        for (const auto &buffer : buffers) {
+            tsk->_unmerged_write_buffers.push_back(
+                {const_cast<char *>(buffer.data()), static_cast<int>(buffer.size())});
+        }
+
+        uint64_t sz = 0;
+        auto *wk = dfile->write(tsk, &sz);
+        CHECK(tsk.get() == wk, "the task should be submitted at once");
+        CHECK_EQ(size, sz);
+        provider.collapse_write_buffers(wk);
+        provider.submit_aio_task(wk);
+        return tsk;
+    }
+
+    const std::string kTestFileName = "io_uring_aio_provider_test.txt";
+
+private:
+    static aio_task_ptr
+    create_test_task(disk_file *dfile, aio_type type, size_t size, uint64_t offset)
+    {
+        auto tsk = file::create_aio_task(LPC_IO_URING_AIO_TEST, nullptr, [](error_code, size_t) {});
+        auto *ctx = tsk->get_aio_context();
+        ctx->buffer_size = size;
+        ctx->file_offset = offset;
+        ctx->type = type;
+        ctx->engine = &disk_engine::instance();
+        ctx->dfile = dfile;
+        return tsk;
+    }
+};
+
+TEST_F(io_uring_aio_provider_test, encrypted_fallback)
+{
+    PRESERVE_FLAG(encrypt_data_at_rest);
+    FLAGS_encrypt_data_at_rest = true;
+    io_uring_aio_provider provider(&disk_engine::instance());
+    ASSERT_FALSE(provider.ring_enabled());
+}
+
+TEST_F(io_uring_aio_provider_test, file_operations)
+{
+    PRESERVE_FLAG(encrypt_data_at_rest);
+    FLAGS_encrypt_data_at_rest = false;
+    io_uring_aio_provider provider(&disk_engine::instance());
+    if (!provider.ring_enabled()) {
+        GTEST_SKIP() << "io_uring is not supported";
+    }
+
+    const std::string data("hello io_uring");
+    auto wf = provider.open_write_file(kTestFileName);
+    ASSERT_NE(nullptr, wf);
+    auto s = wf->Write(0, rocksdb::Slice(data.data(), data.length()));
+    ASSERT_TRUE(s.ok()) << s.ToString();
+    // The fsync is submitted to the ring and waited for its completion.
+    ASSERT_EQ(ERR_OK, provider.flush(wf.get()));
+    ASSERT_EQ(ERR_OK, provider.close(wf.get()));
+
+    auto rf = provider.open_read_file(kTestFileName);
+    ASSERT_NE(nullptr, rf);
+    char scratch[64];
+    rocksdb::Slice result;
+    s = rf->Read(0, sizeof(scratch), &result, scratch);
+    ASSERT_TRUE(s.ok()) << s.ToString();
+    ASSERT_EQ(data, result.ToString());
+
+    ASSERT_EQ(nullptr, provider.open_read_file(kTestFileName + ".not_exist"));
+}
+
+TEST_F(io_uring_aio_provider_test, async_operations)
+{
+    PRESERVE_FLAG(encrypt_data_at_rest);
+    FLAGS_encrypt_data_at_rest = false;
+    io_uring_aio_provider provider(&disk_engine::instance());
+    if (!provider.ring_enabled()) {
+        GTEST_SKIP() << "io_uring is not supported";
+    }
+
+    // Write the blocks concurrently, each through a separate file handle.
+    const size_t kBlockSize = 4096;
+    const int kBlockCount = 8;
+    std::vector<std::unique_ptr<disk_file>> wfiles;
+    std::vector<std::string> blocks;
+    std::vector<aio_task_ptr> tasks;
+    for (int i = 0; i < kBlockCount; ++i) {
+        auto wf = provider.open_write_file(kTestFileName);
+        ASSERT_NE(nullptr, wf);
+        wfiles.emplace_back(new disk_file(std::move(wf)));
+
+        blocks.emplace_back(kBlockSize, static_cast<char>('a' + i));
+        // Split each block into several buffers, which are merged before being written.
+        const std::vector<std::string> buffers = {blocks.back().substr(0, 100),
+                                                  blocks.back().substr(100, 1000),
+                                                  blocks.back().substr(1100)};
+        tasks.push_back(submit_write(provider, wfiles.back().get(), buffers, i * kBlockSize));
+    }
+
+    // The fsync of a file is not started until all the writes of the file submitted before it
+    // have been completed, thus the write has been completed once it returns.
+    for (int i = 0; i < kBlockCount; ++i) {
+        ASSERT_EQ(ERR_OK, provider.flush(wfiles[i]->wfile()));
+        ASSERT_EQ(kBlockSize, tasks[i]->get_transferred_size());
+    }
+
+    for (const auto &tsk : tasks) {
+        tsk->wait();
+        ASSERT_EQ(ERR_OK, tsk->error());
+    }
+    for (const auto &wfile : wfiles) {
+        ASSERT_EQ(ERR_OK, provider.close(wfile->wfile()));
+    }
+
+    // Read the blocks back.
+    auto rf = provider.open_read_file(kTestFileName);
+    ASSERT_NE(nullptr, rf);
+    std::unique_ptr<disk_file> rfile(new disk_file(std::move(rf)));
+    std::string buffer(kBlockSize, '\0');
+    for (int i = 0; i < kBlockCount; ++i) {
+        auto tsk = submit_read(provider, rfile.get(), &buffer[0], kBlockSize, i * kBlockSize);
+        tsk->wait();
+        ASSERT_EQ(ERR_OK, tsk->error());
+        ASSERT_EQ(kBlockSize, tsk->get_transferred_size());
+        ASSERT_EQ(blocks[i], buffer);
+    }
+
+    // Read beyond the end of the file.
+    auto tsk = submit_read(provider, rfile.get(), &buffer[0], kBlockSize, kBlockCount * kBlockSize);
+    tsk->wait();
+    ASSERT_EQ(ERR_HANDLE_EOF, tsk->error());
+}
+
+TEST_F(io_uring_aio_provider_test, destroy_with_inflight_requests)
+{
+    PRESERVE_FLAG(encrypt_data_at_rest);
+    FLAGS_encrypt_data_at_rest = false;
+    std::vector<std::unique_ptr<disk_file>> wfiles;
+    std::vector<aio_task_ptr> tasks;
+    {
+        io_uring_aio_provider provider(&disk_engine::instance());
+        if (!provider.ring_enabled()) {
+            GTEST_SKIP() << "io_uring is not supported";
+        }
+
+        // Each write is submitted through a separate file handle, like 'async_operations'.
+        const std::string block(4096, 'a');
+        for (int i = 0; i < 8; ++i) {
+            auto wf = provider.open_write_file(kTestFileName);
+            ASSERT_NE(nullptr, wf);
+            wfiles.emplace_back(new disk_file(std::move(wf)));
+            tasks.push_back(submit_write(provider, wfiles.back().get(), {block}, i * block.size()));
+        }
+        // The provider is destroyed with the writes in flight.
+    }
+
+    // All the writes are still completed rather than leaked.
+    for (const auto &tsk : tasks) {
+        tsk->wait();
+        ASSERT_EQ(ERR_OK, tsk->error());
+        ASSERT_EQ(4096, tsk->get_transferred_size());
+    }
+}
+
+} // namespace dsn
@@ -52,13 +52,84 @@ inline uint64_t extract_timestamp_from_timetag(uint64_t timetag)
     return static_cast<uint64_t>((timetag >> 8u) & 0xFFFFFFFFFFFFFFLu);
 }
 
+/// A view over a rocksdb value of the schema `Version`, which decodes the fields in place
+/// without any allocation or copy. The offsets of the fields are resolved at compile time.
+///
+/// The view refers to the memory of the raw value, which must be alive while the view is.
+/// The value schema must be in v0 or v1.
+template <uint32_t Version>
+class pegasus_value_view
+{
+public:
+    static_assert(Version <= PEGASUS_DATA_VERSION_MAX, "unsupported value schema version");
+
+    // The size of [expire_ts] for v0, or [expire_ts] [timetag] for v1.
+    static constexpr size_t kHeaderSize =
+        Version == 0 ? sizeof(uint32_t) : sizeof(uint32_t) + sizeof(uint64_t);
+
+    explicit pegasus_value_view(absl::string_view raw_value) : _raw_value(raw_value) {}
+
+    /// \return expire_ts in host endian
+    uint32_t expire_ts() const { return read<uint32_t>(0); }
+
+    /// \return timetag in host endian
+    uint64_t timetag() const
+    {
+        static_assert(Version == 1, "only v1 value has timetag");
+        return read<uint64_t>(sizeof(uint32_t));
+    }
+
+    absl::string_view user_data() const
+    {
+        CHECK_GE(_raw_value.size(), kHeaderSize);
+        return {_raw_value.data() + kHeaderSize, _raw_value.size() - kHeaderSize};
+    }
+
+private:
+    template <typename T>
+    T read(size_t offset) const
+    {
+        CHECK_GE(_raw_value.size(), offset + sizeof(T));
+        T val;
+        memcpy(&val, _raw_value.data() + offset, sizeof(T));
+        return dsn::endian::ntoh(val);
+    }
+
+    absl::string_view _raw_value;
+};
+
+/// Calls `func` with the pegasus_value_view of `raw_value` in the schema `version`, thus the
+/// version is dispatched only once for all the fields decoded by `func`, e.g.
+///
+///   visit_value_view(version, raw_value, [](auto view) { return view.expire_ts(); });
+///
+/// The value schema must be in v0 or v1.
+template <typename Func>
+inline auto visit_value_view(uint32_t version, absl::string_view raw_value, Func &&func)
+{
+    if (version == 1) {
+        return func(pegasus_value_view<1>(raw_value));
+    }
+    CHECK_EQ(version, 0);
+    return func(pegasus_value_view<0>(raw_value));
+}
+
 /// Extracts expire_ts from rocksdb value with given version.
 /// The value schema must be in v0 or v1.
 /// \return expire_ts in host endian
 inline uint32_t pegasus_extract_expire_ts(uint32_t version, absl::string_view value)
 {
     CHECK_LE(version, PEGASUS_DATA_VERSION_MAX);
-    return dsn::data_input(value).read_u32();
+    // expire_ts is the heading field of both v0 and v1.
+    return pegasus_value_view<0>(value).expire_ts();
+}
+
+/// Extracts user value from a raw rocksdb value without copy.
+/// The result refers to the memory of `raw_value`.
+inline absl::string_view pegasus_extract_user_data_view(uint32_t version,
+                                                        absl::string_view raw_value)
+{
+    return visit_value_view(version, raw_value, [](auto view) { return view.user_data(); });
 }
 
 /// Extracts user value from a raw rocksdb value.
@@ -68,18 +139,12 @@ inline uint32_t pegasus_extract_expire_ts(uint32_t version, absl::string_view va
 inline void
 pegasus_extract_user_data(uint32_t version, std::string &&raw_value, ::dsn::blob &user_data)
 {
-    CHECK_LE(version, PEGASUS_DATA_VERSION_MAX);
-
-    auto *s = new std::string(std::move(raw_value));
-    dsn::data_input input(*s);
-    input.skip(sizeof(uint32_t));
-    if (version == 1) {
-        input.skip(sizeof(uint64_t));
-    }
-    absl::string_view view = input.read_str();
+    auto s = std::make_shared<std::string>(std::move(raw_value));
+    const auto view = pegasus_extract_user_data_view(version, *s);
 
-    // tricky code to avoid memory copy
-    std::shared_ptr<char> buf(const_cast<char *>(view.data()), [s](char *) { delete s; });
+    // The buffer shares the ownership of `s`, which saves the allocation of another control
+    // block besides the one of `s`.
+    std::shared_ptr<char> buf(s, const_cast<char *>(view.data()));
     user_data.assign(std::move(buf), 0, static_cast<unsigned int>(view.length()));
 }
 
@@ -87,11 +152,7 @@ pegasus_extract_user_data(uint32_t version, std::string &&raw_value, ::dsn::blob
 inline uint64_t pegasus_extract_timetag(int version, absl::string_view value)
 {
     CHECK_EQ(version, 1);
-
-    dsn::data_input input(value);
-    input.skip(sizeof(uint32_t));
-
-    return input.read_u64();
+    return pegasus_value_view<1>(value).timetag();
 }
 
 /// Update expire_ts in rocksdb value with given version.
@@ -0,0 +1,151 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <fmt/core.h>
+#include <stdio.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+#include "base/pegasus_value_schema.h"
+#include "base/value_field.h"
+#include "base/value_schema_manager.h"
+#include "runtime/api_layer1.h"
+#include "utils/blob.h"
+#include "utils/string_conv.h"
+
+void print_usage(const char *cmd)
+{
+    fmt::print("USAGE: {} <num_operations> <user_data_size> [data_version]\n", cmd);
+    fmt::print("Run a simple benchmark that compares the decoding of rocksdb values by\n"
+               "value_schema, which allocates for each field, with pegasus_value_view.\n\n");
+
+    fmt::print("    <num_operations>       the number of operations.\n");
+    fmt::print("    <user_data_size>       the size of user data in each value.\n");
+    fmt::print("    [data_version]         the value schema version, 0 or 1, default 1.\n");
+}
+
+void run_case(const std::string &name, uint64_t num_operations, std::function<uint64_t()> exec)
+{
+    uint64_t checksum = 0;
+    auto start = dsn_now_ns();
+    for (uint64_t i = 0; i < num_operations; ++i) {
+        checksum += exec();
+    }
+    auto end = dsn_now_ns();
+
+    std::chrono::nanoseconds nano(end - start);
+    auto duration_s = std::chrono::duration_cast<std::chrono::duration<double>>(nano).count();
+    fmt::print("Running {} operations of {} took {} seconds, {} ns/op (checksum = {}).\n",
+               num_operations,
+               name,
+               duration_s,
+               static_cast<double>(end - start) / num_operations,
+               checksum);
+}
+
+void run_bench(uint64_t num_operations, uint64_t user_data_size, uint32_t data_version)
+{
+    const std::string user_data(user_data_size, 'v');
+    pegasus::pegasus_value_generator generator;
+    const auto parts = generator.generate_value(data_version, user_data, 1000, 10001);
+    std::string raw_value;
+    for (int i = 0; i < parts.num_parts; ++i) {
+        raw_value.append(parts.parts[i].data(), parts.parts[i].size());
+    }
+
+    auto *schema = pegasus::value_schema_manager::instance().get_value_schema(data_version);
+
+    // Decode the expire_ts, which is what scan filtering and the ttl compaction filter do for
+    // each key.
+    run_case("value_schema::extract_field(EXPIRE_TIMESTAMP)", num_operations, [&]() {
+        auto field =
+            schema->extract_field(raw_value, pegasus::value_field_type::EXPIRE_TIMESTAMP);
+        return static_cast<pegasus::expire_timestamp_field *>(field.get())->expire_ts;
+    });
+    run_case("pegasus_value_view::expire_ts", num_operations, [&]() {
+        return pegasus::visit_value_view(
+            data_version, raw_value, [](auto view) { return view.expire_ts(); });
+    });
+
+    // Decode the expire_ts and user data together, which is what the read pushdown does.
+    run_case("value_schema::extract_field(EXPIRE_TIMESTAMP)+extract_user_data",
+             num_operations,
+             [&]() {
+                 auto field = schema->extract_field(raw_value,
+                                                    pegasus::value_field_type::EXPIRE_TIMESTAMP);
+                 auto data = schema->extract_user_data(std::string(raw_value));
+                 return static_cast<pegasus::expire_timestamp_field *>(field.get())->expire_ts +
+                        data.length();
+             });
+    run_case("pegasus_value_view::expire_ts+user_data", num_operations, [&]() {
+        return pegasus::visit_value_view(data_version, raw_value, [](auto view) {
+            return view.expire_ts() + view.user_data().length();
+        });
+    });
+
+    // Extract the user data into a blob which owns it, which is what the read responses do.
+    run_case("value_schema::extract_user_data", num_operations, [&]() {
+        return schema->extract_user_data(std::string(raw_value)).length();
+    });
+    run_case("pegasus_extract_user_data", num_operations, [&]() {
+        dsn::blob data;
+        pegasus::pegasus_extract_user_data(data_version, std::string(raw_value), data);
+        return data.length();
+    });
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    uint64_t num_operations;
+    if (!dsn::buf2uint64(argv[1], num_operations) || num_operations == 0) {
+        fmt::print(stderr, "Invalid num_operations: {}\n\n", argv[1]);
+
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    uint64_t user_data_size;
+    if (!dsn::buf2uint64(argv[2], user_data_size)) {
+        fmt::print(stderr, "Invalid user_data_size: {}\n\n", argv[2]);
+
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    uint32_t data_version = pegasus::PEGASUS_DATA_VERSION_MAX;
+    if (argc >= 4) {
+        if (!dsn::buf2uint32(argv[3], data_version) ||
+            data_version > static_cast<uint32_t>(pegasus::PEGASUS_DATA_VERSION_MAX)) {
+            fmt::print(stderr, "Invalid data_version: {}\n\n", argv[3]);
+
+            print_usage(argv[0]);
+            ::exit(-1);
+        }
+    }
+
+    run_bench(num_operations, user_data_size, data_version);
+
+    return 0;
+}
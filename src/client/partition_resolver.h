@@ -95,6 +95,9 @@ public:
 
     dsn::host_port get_meta_server() const { return _meta_server; }
 
+    // The partition count of the app, or -1 if it has not been resolved yet.
+    virtual int get_partition_count() const = 0;
+
     const char *log_prefix() const { return _app_name.c_str(); }
 
 protected:
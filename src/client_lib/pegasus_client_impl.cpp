@@ -461,6 +461,9 @@ void pegasus_client_impl::async_multi_get(const std::string &hash_key,
     req.sort_key_filter_type = (dsn::apps::filter_type::type)options.sort_key_filter_type;
     req.sort_key_filter_pattern = ::dsn::blob(
         options.sort_key_filter_pattern.data(), 0, options.sort_key_filter_pattern.size());
+    if (fill_read_pushdown(options.pushdown, req.pushdown)) {
+        req.__isset.pushdown = true;
+    }
     ::dsn::blob tmp_key;
     pegasus_generate_key(tmp_key, req.hash_key, ::dsn::blob());
     auto partition_hash = pegasus_key_hash(tmp_key);
@@ -1325,6 +1328,38 @@ const char *pegasus_client_impl::get_error_string(int error_code) const
     }
 }
 
+/*static*/ bool pegasus_client_impl::fill_read_pushdown(const read_pushdown_options &options,
+                                                       ::dsn::apps::read_pushdown &pushdown)
+{
+    if (options.empty()) {
+        return false;
+    }
+
+    pushdown.predicates.clear();
+    pushdown.predicates.reserve(options.predicates.size());
+    for (const auto &p : options.predicates) {
+        ::dsn::apps::pushdown_predicate pred;
+        pred.type = static_cast<::dsn::apps::pushdown_predicate_type::type>(p.type);
+        pred.operand = ::dsn::blob::create_from_bytes(p.operand.data(), p.operand.size());
+        if (p.has_operand_end) {
+            pred.__set_operand_end(
+                ::dsn::blob::create_from_bytes(p.operand_end.data(), p.operand_end.size()));
+        }
+        if (p.min_ttl_seconds >= 0) {
+            pred.__set_min_ttl_seconds(p.min_ttl_seconds);
+        }
+        if (p.max_ttl_seconds >= 0) {
+            pred.__set_max_ttl_seconds(p.max_ttl_seconds);
+        }
+        pushdown.predicates.emplace_back(std::move(pred));
+    }
+    if (options.value_offset > 0 || options.value_length >= 0) {
+        pushdown.__set_value_offset(std::max(options.value_offset, 0));
+        pushdown.__set_value_length(options.value_length);
+    }
+    return true;
+}
+
 /*static*/ int pegasus_client_impl::get_client_error(int server_error)
 {
     auto it = _server_error_to_client.find(server_error);
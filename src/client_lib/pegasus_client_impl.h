@@ -320,6 +320,8 @@ public:
         volatile bool _rpc_started;
         bool _validate_partition_hash;
         bool _full_scan;
+        // true if the current partition is scanned in parallel sub-ranges.
+        bool _sub_scan_started;
         async_scan_type _type;
 
         void _async_next_internal();
@@ -337,6 +339,11 @@ public:
     static int get_client_error(int server_error);
     static int get_rocksdb_server_error(int rocskdb_error);
 
+    // Fill 'pushdown' of the request by 'options', return false if there is nothing to be pushed
+    // down and the field should be left unset.
+    static bool fill_read_pushdown(const read_pushdown_options &options,
+                                   ::dsn::apps::read_pushdown &pushdown);
+
 private:
     class pegasus_scanner_impl_wrapper : public abstract_pegasus_scanner
     {
@@ -88,6 +88,7 @@ pegasus_client_impl::pegasus_scanner_impl::pegasus_scanner_impl(::dsn::apps::rrd
       _rpc_started(false),
       _validate_partition_hash(validate_partition_hash),
       _full_scan(full_scan),
+      _sub_scan_started(false),
       _type(async_scan_type::NORMAL)
 {
 }
@@ -263,6 +264,9 @@ void pegasus_client_impl::pegasus_scanner_impl::_next_batch()
 {
     ::dsn::apps::scan_request req;
     req.context_id = _context;
+    if (_options.prefetch_batches > 0) {
+        req.__set_prefetch_credits(_options.prefetch_batches);
+    }
 
     CHECK(!_rpc_started, "");
     _rpc_started = true;
@@ -298,6 +302,16 @@ void pegasus_client_impl::pegasus_scanner_impl::_start_scan()
     req.__set_return_expire_ts(_options.return_expire_ts);
     req.__set_full_scan(_full_scan);
     req.__set_only_return_count(_options.only_return_count);
+    if (_options.prefetch_batches > 0) {
+        req.__set_prefetch_credits(_options.prefetch_batches);
+    }
+    if (fill_read_pushdown(_options.pushdown, req.pushdown)) {
+        req.__isset.pushdown = true;
+    }
+    if (_full_scan && _kvs.empty() && _options.sub_scan_count > 1) {
+        req.__set_sub_scan_count(_options.sub_scan_count);
+        _sub_scan_started = true;
+    }
 
     CHECK(!_rpc_started, "");
     _rpc_started = true;
@@ -338,7 +352,10 @@ void pegasus_client_impl::pegasus_scanner_impl::_on_scan_response(::dsn::error_c
             }
             _async_next_internal();
             return;
-        } else if (get_rocksdb_server_error(response.error) == PERR_NOT_FOUND) {
+        } else if (get_rocksdb_server_error(response.error) == PERR_NOT_FOUND &&
+                   !_sub_scan_started) {
+            // The scan is resumed from the last received key, which is impossible for the
+            // parallel sub-range scan since its records are not ordered.
             _lock.lock();
             _context = SCAN_CONTEXT_ID_NOT_EXIST;
             _async_next_internal();
@@ -373,6 +390,7 @@ void pegasus_client_impl::pegasus_scanner_impl::_split_reset()
     _kvs.clear();
     _p = -1;
     _context = SCAN_CONTEXT_ID_NOT_EXIST;
+    _sub_scan_started = false;
 }
 
 pegasus_client_impl::pegasus_scanner_impl::~pegasus_scanner_impl()
@@ -23,6 +23,12 @@ namespace cpp dsn.apps
 struct duplicate_request
 {
     1: list<duplicate_entry> entries
+
+    // The duplicate_request holding the entries, serialized and compressed by zstd as a whole
+    // frame, which is set instead of `entries` if [pegasus.server]dup_compress_frames is
+    // enabled. Such requests are sent by RPC_RRDB_RRDB_DUPLICATE_COMPRESSED, thus would be
+    // rejected by the remote cluster unable to decompress them.
+    2: optional dsn.blob compressed_entries
 }
 
 struct duplicate_entry
@@ -102,6 +102,10 @@ const std::string replica_envs::UPDATE_MAX_REPLICA_COUNT("max_replica_count.upda
 const std::string replica_envs::ROCKSDB_WRITE_BUFFER_SIZE("rocksdb.write_buffer_size");
 const std::string replica_envs::ROCKSDB_NUM_LEVELS("rocksdb.num_levels");
 
+/// true means incr is done by rocksdb merge without read before write, and the new value is
+/// not responded, otherwise false
+const std::string replica_envs::INCR_BY_MERGE("replica.incr_by_merge");
+
 const std::set<std::string> replica_envs::ROCKSDB_DYNAMIC_OPTIONS = {
     replica_envs::ROCKSDB_WRITE_BUFFER_SIZE,
 };
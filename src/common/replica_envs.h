@@ -71,6 +71,7 @@ public:
     static const std::string UPDATE_MAX_REPLICA_COUNT;
     static const std::string ROCKSDB_WRITE_BUFFER_SIZE;
     static const std::string ROCKSDB_NUM_LEVELS;
+    static const std::string INCR_BY_MERGE;
 
     static const std::set<std::string> ROCKSDB_DYNAMIC_OPTIONS;
     static const std::set<std::string> ROCKSDB_STATIC_OPTIONS;
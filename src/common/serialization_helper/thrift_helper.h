@@ -67,7 +67,8 @@ private:
     binary_reader &_reader;
 };
 
-class binary_writer_transport : public TVirtualTransport<binary_writer_transport>
+class binary_writer_transport : public TVirtualTransport<binary_writer_transport>,
+                                public zero_copy_transport
 {
 public:
     binary_writer_transport(binary_writer &writer) : _writer(writer) {}
@@ -83,6 +84,8 @@ public:
         _writer.write((const char *)buf, static_cast<int>(len));
     }
 
+    bool write_zero_copy(const blob &bb) override { return _writer.write_zero_copy(bb); }
+
 private:
     binary_writer &_writer;
 };
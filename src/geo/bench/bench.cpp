@@ -45,7 +45,7 @@ int main(int argc, char **argv)
 {
     if (argc < 7) {
         std::cerr << "USAGE: " << argv[0] << " <cluster_name> <app_name> <geo_app_name> <radius> "
-                                             "<test_count> <max_level> [gen_data]"
+                                             "<test_count> <max_level> [gen_data] [count]"
                   << std::endl;
         return -1;
     }
@@ -75,6 +75,14 @@ int main(int argc, char **argv)
             return -1;
         }
     }
+    // search the nearest `count` data if it's positive, otherwise all the data in random order
+    int count = -1;
+    if (argc >= 9) {
+        if (!dsn::buf2int32(argv[8], count)) {
+            std::cerr << "count is invalid: " << argv[8] << std::endl;
+            return -1;
+        }
+    }
 
     // TODO(yingchun): the benchmark can not exit normally, we need to fix it later.
     pegasus::geo::geo_client my_geo(
@@ -112,7 +120,8 @@ int main(int argc, char **argv)
     auto statistics = rocksdb::CreateDBStatistics();
     rocksdb::Env *env = dsn::utils::PegasusEnv(dsn::utils::FileDataType::kSensitive);
     uint64_t start = env->NowNanos();
-    std::atomic<uint64_t> count(test_count);
+    uint64_t start_scanned_count = my_geo.scanned_count();
+    std::atomic<uint64_t> left_count(test_count);
     dsn::utils::notify_event get_completed;
 
     // test search_radial by lat & lng
@@ -124,15 +133,16 @@ int main(int argc, char **argv)
             latlng.lat().degrees(),
             latlng.lng().degrees(),
             radius,
-            -1,
-            pegasus::geo::geo_client::SortType::random,
+            count,
+            count > 0 ? pegasus::geo::geo_client::SortType::asc
+                      : pegasus::geo::geo_client::SortType::random,
             500,
             [&, start_nanos](int error_code, std::list<pegasus::geo::SearchResult> &&results) {
                 statistics->measureTime(static_cast<uint32_t>(histogram_type::LATENCY),
                                         env->NowNanos() - start_nanos);
                 statistics->measureTime(static_cast<uint32_t>(histogram_type::RESULT_COUNT),
                                         results.size());
-                uint64_t left = count.fetch_sub(1);
+                uint64_t left = left_count.fetch_sub(1);
                 if (left == 1) {
                     get_completed.notify();
                 }
@@ -144,6 +154,9 @@ int main(int argc, char **argv)
 
     std::cout << "start time: " << start << ", end time: " << end
               << ", QPS: " << test_count / ((end - start) / 1e9) << std::endl;
+    std::cout << "scanned count per search: "
+              << static_cast<double>(my_geo.scanned_count() - start_scanned_count) / test_count
+              << std::endl;
     std::cout << "latency_histogram: " << std::endl;
     std::cout << statistics->getHistogramString(static_cast<uint32_t>(histogram_type::LATENCY))
               << std::endl;
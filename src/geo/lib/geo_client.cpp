@@ -23,6 +23,7 @@
 #include <math.h>
 #include <pegasus/error.h>
 #include <s2/s1angle.h>
+#include <s2/s1chord_angle.h>
 #include <s2/s2cap.h>
 #include <s2/s2cell.h>
 #include <s2/s2cell_id.h>
@@ -32,8 +33,10 @@
 #include <s2/s2region_coverer.h>
 #include <s2/util/units/length-units.h>
 #include <stddef.h>
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
+#include <iterator>
 #include <limits>
 #include <mutex>
 #include <type_traits>
@@ -43,6 +46,7 @@
 #include "base/pegasus_utils.h"
 #include "geo/lib/latlng_codec.h"
 #include "pegasus/client.h"
+#include "runtime/api_layer1.h"
 #include "utils/blob.h"
 #include "utils/error_code.h"
 #include "utils/errors.h"
@@ -76,6 +80,19 @@ DSN_DEFINE_group_validator(min_max_level, [](std::string &message) -> bool {
 });
 DSN_DEFINE_uint32(geo_client.lib, latitude_index, 5, "latitude index in value");
 DSN_DEFINE_uint32(geo_client.lib, longitude_index, 4, "longitude index in value");
+DSN_DEFINE_bool(geo_client.lib,
+                adaptive_nearest_search,
+                true,
+                "Whether to search the nearest data (i.e. SortType::asc with a positive count) "
+                "by scanning the cells from the nearer ones to the farther ones, which are refined "
+                "by the observed data density, and stop once the nearest ones are found");
+DSN_TAG_VARIABLE(adaptive_nearest_search, FT_MUTABLE);
+DSN_DEFINE_uint32(geo_client.lib,
+                  max_concurrent_scans,
+                  8,
+                  "The max count of the concurrent scans in a nearest search");
+DSN_TAG_VARIABLE(max_concurrent_scans, FT_MUTABLE);
+DSN_DEFINE_validator(max_concurrent_scans, [](uint32_t value) -> bool { return value > 0; });
 
 namespace pegasus {
 namespace geo {
@@ -556,6 +573,11 @@ void geo_client::async_search_radial(const S2LatLng &latlng,
     std::shared_ptr<S2Cap> cap_ptr = std::make_shared<S2Cap>();
     gen_search_cap(latlng, radius_m, *cap_ptr);
 
+    if (FLAGS_adaptive_nearest_search && sort_type == SortType::asc && count > 0) {
+        async_search_nearest(cap_ptr, count, timeout_ms, std::move(callback));
+        return;
+    }
+
     // generate cell ids
     S2CellUnion cids;
     gen_cells_covered_by_cap(*cap_ptr, cids);
@@ -604,8 +626,9 @@ void geo_client::async_get_result_from_cells(const S2CellUnion &cids,
         std::make_shared<std::list<std::list<SearchResult>>>();
     std::shared_ptr<std::atomic<bool>> send_finish = std::make_shared<std::atomic<bool>>(false);
     std::shared_ptr<std::atomic<int>> scan_count = std::make_shared<std::atomic<int>>(0);
+    // the data of the failed scans are left out
     auto single_scan_finish_callback =
-        [ send_finish, scan_count, results, cb = std::move(callback) ]()
+        [ send_finish, scan_count, results, cb = std::move(callback) ](int)
     {
         // NOTE: make sure fetch_sub is at first of the if expression to make it always execute
         if (scan_count->fetch_sub(1) == 1 && send_finish->load()) {
@@ -692,7 +715,219 @@ void geo_client::async_get_result_from_cells(const S2CellUnion &cids,
     // called, so we add 2 lines tricky code as follows
     scan_count->fetch_add(1);
     send_finish->store(true);
-    single_scan_finish_callback();
+    single_scan_finish_callback(PERR_OK);
+}
+
+struct geo_client::nearest_search_context
+{
+    std::shared_ptr<S2Cap> cap_ptr;
+    size_t count;
+    uint64_t deadline_ms;
+    geo_search_callback_t callback;
+    // in the ascending order of min distance
+    std::vector<scan_unit> units;
+
+    std::mutex lock;
+    size_t next_unit = 0;
+    uint32_t scanning_count = 0;
+    // the first error of the scans, or PERR_TIMEOUT if some units are left unscanned
+    int error_code = PERR_OK;
+    // the nearest data found by now, as a max heap of distance
+    std::vector<SearchResult> nearest;
+};
+
+void geo_client::async_search_nearest(std::shared_ptr<S2Cap> cap_ptr,
+                                      int count,
+                                      int timeout_ms,
+                                      geo_search_callback_t &&callback)
+{
+    auto context = std::make_shared<nearest_search_context>();
+    context->cap_ptr = std::move(cap_ptr);
+    context->count = static_cast<size_t>(count);
+    context->deadline_ms = dsn_now_ms() + timeout_ms;
+    context->callback = std::move(callback);
+    gen_scan_units(*context->cap_ptr, gen_refined_level(count), context->units);
+    continue_nearest_search(context, nullptr, PERR_OK);
+}
+
+void geo_client::continue_nearest_search(const std::shared_ptr<nearest_search_context> &context,
+                                         std::list<SearchResult> *results,
+                                         int error_code)
+{
+    std::vector<size_t> units_to_scan;
+    bool finished = false;
+    {
+        std::lock_guard<std::mutex> l(context->lock);
+        auto &nearest = context->nearest;
+        if (error_code != PERR_OK && context->error_code == PERR_OK) {
+            context->error_code = error_code;
+        }
+        if (results != nullptr) {
+            --context->scanning_count;
+            for (auto &r : *results) {
+                if (nearest.size() < context->count) {
+                    nearest.emplace_back(std::move(r));
+                    std::push_heap(nearest.begin(), nearest.end(), SearchResultNearer());
+                } else if (r.distance < nearest.front().distance) {
+                    std::pop_heap(nearest.begin(), nearest.end(), SearchResultNearer());
+                    nearest.back() = std::move(r);
+                    std::push_heap(nearest.begin(), nearest.end(), SearchResultNearer());
+                }
+            }
+        }
+
+        const uint64_t now_ms = dsn_now_ms();
+        while (context->next_unit < context->units.size() &&
+               context->scanning_count < FLAGS_max_concurrent_scans) {
+            // the units left are all farther than the nearest data found, since the units are
+            // in the ascending order of min distance
+            if (nearest.size() >= context->count &&
+                nearest.front().distance <= context->units[context->next_unit].min_distance_m) {
+                break;
+            }
+            // the units left may hold nearer data, but there is no time to scan them
+            if (now_ms >= context->deadline_ms) {
+                if (context->error_code == PERR_OK) {
+                    context->error_code = PERR_TIMEOUT;
+                }
+                break;
+            }
+            units_to_scan.push_back(context->next_unit++);
+            ++context->scanning_count;
+        }
+        finished = (context->scanning_count == 0);
+    }
+
+    if (finished) {
+        auto &nearest = context->nearest;
+        std::sort_heap(nearest.begin(), nearest.end(), SearchResultNearer());
+        std::list<SearchResult> result(std::make_move_iterator(nearest.begin()),
+                                       std::make_move_iterator(nearest.end()));
+        context->callback(context->error_code, std::move(result));
+        return;
+    }
+
+    for (size_t index : units_to_scan) {
+        const scan_unit &unit = context->units[index];
+        auto unit_results = std::make_shared<std::list<SearchResult>>();
+        const uint64_t now_ms = dsn_now_ms();
+        const int timeout_ms =
+            now_ms < context->deadline_ms ? static_cast<int>(context->deadline_ms - now_ms) : 1;
+        start_scan(unit.hash_key,
+                   std::string(unit.start_sort_key),
+                   std::string(unit.stop_sort_key),
+                   context->cap_ptr,
+                   -1,
+                   timeout_ms,
+                   [this, context, index, unit_results](int error_code) {
+                       // the data count of a failed scan tells nothing about the density
+                       if (error_code == PERR_OK) {
+                           update_density(context->units[index], unit_results->size());
+                       }
+                       continue_nearest_search(context, unit_results.get(), error_code);
+                   },
+                   *unit_results);
+    }
+}
+
+void geo_client::gen_scan_units(const S2Cap &cap, int level, std::vector<scan_unit> &units)
+{
+    auto min_distance_m = [&cap](const S2Cell &cell) {
+        return S2Earth::ToMeters(cell.GetDistance(cap.center()).ToAngle());
+    };
+
+    S2CellUnion cids;
+    gen_cells_covered_by_cap(cap, cids);
+    for (const auto &cid : cids) {
+        std::string hash_key = cid.ToString();
+        for (S2CellId cur = cid.child_begin(level); cur != cid.child_end(level); cur = cur.next()) {
+            S2Cell cell(cur);
+            if (cap.Contains(cell)) {
+                // for the full contained cell, scan all data in it
+                if (cur.level() == FLAGS_min_level) {
+                    units.push_back({hash_key, "", "", min_distance_m(cell), cur.level()});
+                } else {
+                    units.push_back({hash_key,
+                                     gen_start_sort_key(cur, hash_key),
+                                     gen_stop_sort_key(cur, hash_key),
+                                     min_distance_m(cell),
+                                     cur.level()});
+                }
+                continue;
+            }
+
+            if (!cap.MayIntersect(cell)) {
+                continue;
+            }
+
+            // for the partial contained cell, scan the consecutive sub cells on FLAGS_max_level
+            // along the Hilbert curve which may be intersected by the cap
+            S2CellId start;
+            S2CellId pre;
+            double distance_m = std::numeric_limits<double>::max();
+            for (S2CellId sub = cur.child_begin(FLAGS_max_level);
+                 sub != cur.child_end(FLAGS_max_level);
+                 sub = sub.next()) {
+                S2Cell sub_cell(sub);
+                if (!cap.MayIntersect(sub_cell)) {
+                    continue;
+                }
+                if (pre.is_valid() && pre.next() != sub) {
+                    units.push_back({hash_key,
+                                     gen_start_sort_key(start, hash_key),
+                                     gen_stop_sort_key(pre, hash_key),
+                                     distance_m,
+                                     -1});
+                    start = S2CellId();
+                    distance_m = std::numeric_limits<double>::max();
+                }
+                if (!start.is_valid()) {
+                    start = sub;
+                }
+                distance_m = std::min(distance_m, min_distance_m(sub_cell));
+                pre = sub;
+            }
+            if (start.is_valid()) {
+                units.push_back({hash_key,
+                                 gen_start_sort_key(start, hash_key),
+                                 gen_stop_sort_key(pre, hash_key),
+                                 distance_m,
+                                 -1});
+            }
+        }
+    }
+
+    std::stable_sort(units.begin(), units.end(), [](const scan_unit &l, const scan_unit &r) {
+        return l.min_distance_m < r.min_distance_m;
+    });
+}
+
+int geo_client::gen_refined_level(int count) const
+{
+    // each level down divides a cell into 4 sub cells
+    uint64_t count_per_cell = _count_per_cell.load(std::memory_order_relaxed);
+    int level = FLAGS_min_level;
+    while (level < FLAGS_max_level && count_per_cell > static_cast<uint64_t>(count)) {
+        count_per_cell /= 4;
+        ++level;
+    }
+    return level;
+}
+
+void geo_client::update_density(const scan_unit &unit, size_t count)
+{
+    // only the full contained cells tell the density
+    if (unit.contained_level < 0) {
+        return;
+    }
+
+    uint64_t count_per_cell = static_cast<uint64_t>(count)
+                              << (2 * (unit.contained_level - FLAGS_min_level));
+    uint64_t old_count_per_cell = _count_per_cell.load(std::memory_order_relaxed);
+    if (old_count_per_cell != 0) {
+        count_per_cell = (old_count_per_cell * 7 + count_per_cell) / 8;
+    }
+    _count_per_cell.store(count_per_cell, std::memory_order_relaxed);
 }
 
 void geo_client::normalize_result(std::list<std::list<SearchResult>> &&results,
@@ -878,7 +1113,7 @@ void geo_client::start_scan(const std::string &hash_key,
             if (error_code == PERR_OK) {
                 do_scan(hash_scanner->get_smart_wrapper(), cap_ptr, count, std::move(cb), result);
             } else {
-                cb();
+                cb(error_code);
             }
         });
 }
@@ -899,20 +1134,21 @@ void geo_client::do_scan(pegasus_client::pegasus_scanner_wrapper scanner_wrapper
             uint32_t expire_ts_seconds,
             int32_t kv_count) mutable {
             if (ret == PERR_SCAN_COMPLETE) {
-                cb();
+                cb(PERR_OK);
                 return;
             }
 
             if (ret != PERR_OK) {
                 LOG_ERROR("async_next failed. error={}", get_error_string(ret));
-                cb();
+                cb(ret);
                 return;
             }
+            _scanned_count.fetch_add(1, std::memory_order_relaxed);
 
             S2LatLng latlng;
             if (!_codec.decode_from_value(value, latlng)) {
                 LOG_ERROR("decode_from_value failed. value={}", value);
-                cb();
+                cb(PERR_GEO_DECODE_VALUE_ERROR);
                 return;
             }
 
@@ -922,7 +1158,7 @@ void geo_client::do_scan(pegasus_client::pegasus_scanner_wrapper scanner_wrapper
                 if (!restore_origin_keys(geo_sort_key, origin_hash_key, origin_sort_key)) {
                     LOG_ERROR("restore_origin_keys failed. geo_sort_key={}",
                               utils::redact_sensitive_string(geo_sort_key));
-                    cb();
+                    cb(PERR_CORRUPTION);
                     return;
                 }
 
@@ -935,7 +1171,7 @@ void geo_client::do_scan(pegasus_client::pegasus_scanner_wrapper scanner_wrapper
             }
 
             if (count != -1 && result.size() >= count) {
-                cb();
+                cb(PERR_OK);
                 return;
             }
 
@@ -20,12 +20,15 @@
 #pragma once
 
 #include <pegasus/client.h>
+#include <stdint.h>
+#include <atomic>
 #include <functional>
 #include <list>
 #include <memory>
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "latlng_codec.h"
 #include "runtime/task/task_tracker.h"
@@ -376,6 +379,9 @@ public:
     // For test.
     const latlng_codec &get_codec() const { return _codec; }
 
+    // For benchmark, the count of the data scanned from app/table `geo_app_name`.
+    uint64_t scanned_count() const { return _scanned_count.load(std::memory_order_relaxed); }
+
 private:
     friend class geo_client_test;
 
@@ -389,7 +395,21 @@ private:
         int error_code, pegasus_client::internal_info &&info, DataType data_type)>;
     using scan_all_area_callback_t =
         std::function<void(std::list<std::list<SearchResult>> &&results)>;
-    using scan_one_area_callback_t = std::function<void()>;
+    using scan_one_area_callback_t = std::function<void(int error_code)>;
+
+    // a range of sort keys under a geo hash_key, which is scanned by a scanner
+    struct scan_unit
+    {
+        std::string hash_key;
+        std::string start_sort_key;
+        std::string stop_sort_key;
+        // the min distance from the center of the cap to the range, in meter
+        double min_distance_m;
+        // the level of the cell whose data are all in the range and contained by the cap, or -1
+        // if the range is only a part of the cell
+        int contained_level;
+    };
+    struct nearest_search_context;
 
     // generate hash_key and sort_key in geo database from hash_key and sort_key in common data
     // database
@@ -452,6 +472,31 @@ private:
                                      int timeout_ms,
                                      scan_all_area_callback_t &&callback);
 
+    // search the `count` nearest data covered by `cap_ptr`, by scanning the cells from the nearer
+    // ones to the farther ones, and stop once the nearest ones are found
+    void async_search_nearest(std::shared_ptr<S2Cap> cap_ptr,
+                              int count,
+                              int timeout_ms,
+                              geo_search_callback_t &&callback);
+
+    // merge `results` of a finished scan (or nullptr when the search starts), then start the next
+    // scans, or finish the search. The search fails with the first `error_code` of the scans, or
+    // PERR_TIMEOUT if some units are left unscanned by the deadline, but still calls back with
+    // the nearest data found.
+    void continue_nearest_search(const std::shared_ptr<nearest_search_context> &context,
+                                 std::list<SearchResult> *results,
+                                 int error_code);
+
+    // generate the scan units covering the cap, with the cells refined to `level`, in the
+    // ascending order of their min distance
+    void gen_scan_units(const S2Cap &cap, int level, std::vector<scan_unit> &units);
+
+    // the level whose cells are expected to hold about `count` data, by the observed density
+    int gen_refined_level(int count) const;
+
+    // update the observed density by the data count of a unit scanned successfully
+    void update_density(const scan_unit &unit, size_t count);
+
     // normalize the result by count, sort type, ...
     void normalize_result(std::list<std::list<SearchResult>> &&results,
                           int count,
@@ -484,6 +529,9 @@ private:
     dsn::task_tracker _tracker;
 
     latlng_codec _codec;
+    // the moving average of the data count in a cell on FLAGS_min_level
+    std::atomic<uint64_t> _count_per_cell{0};
+    std::atomic<uint64_t> _scanned_count{0};
     pegasus_client *_common_data_client = nullptr;
     pegasus_client *_geo_data_client = nullptr;
 };
@@ -46,7 +46,10 @@
 #include "utils/flags.h"
 #include "utils/fmt_logging.h"
 #include "utils/string_conv.h"
+#include "utils/test_macros.h"
 
+DSN_DECLARE_bool(adaptive_nearest_search);
+DSN_DECLARE_int32(max_level);
 DSN_DECLARE_int32(min_level);
 
 namespace pegasus {
@@ -104,6 +107,46 @@ public:
         _geo_client->gen_search_cap(latlng, radius_m, cap);
     }
 
+    uint64_t count_per_cell() const { return _geo_client->_count_per_cell.load(); }
+
+    // check that the units are in the ascending order of min distance, and the data contained by
+    // the cap are all covered by the units
+    void check_scan_units(const S2Cap &cap, int level)
+    {
+        std::vector<geo_client::scan_unit> units;
+        _geo_client->gen_scan_units(cap, level, units);
+        ASSERT_FALSE(units.empty());
+        for (size_t i = 1; i < units.size(); ++i) {
+            ASSERT_LE(units[i - 1].min_distance_m, units[i].min_distance_m);
+        }
+        for (const auto &unit : units) {
+            if (unit.contained_level >= 0) {
+                ASSERT_EQ(level, unit.contained_level);
+                ASSERT_LE(unit.min_distance_m, S2Earth::ToMeters(cap.radius()));
+            }
+        }
+
+        for (int i = 0; i < 1000; ++i) {
+            S2LatLng latlng(S2Testing::SamplePoint(cap));
+            std::string geo_hash_key;
+            std::string geo_sort_key;
+            ASSERT_TRUE(generate_geo_keys(std::to_string(i),
+                                          "",
+                                          gen_value(latlng.lat().degrees(), latlng.lng().degrees()),
+                                          geo_hash_key,
+                                          geo_sort_key));
+            bool covered = false;
+            for (const auto &unit : units) {
+                if (unit.hash_key == geo_hash_key && unit.start_sort_key <= geo_sort_key &&
+                    (unit.stop_sort_key.empty() || geo_sort_key <= unit.stop_sort_key)) {
+                    covered = true;
+                    break;
+                }
+            }
+            ASSERT_TRUE(covered) << latlng.ToStringInDegrees();
+        }
+    }
+
     std::string gen_value(double lat_degrees, double lng_degrees)
     {
         return "00:00:00:00:01:5e|2018-04-26|2018-04-28|ezp8xchrr|" + std::to_string(lng_degrees) +
@@ -536,6 +579,79 @@ TEST_F(geo_client_test, normalize_result_distance_order)
     }
 }
 
+TEST_F(geo_client_test, gen_scan_units)
+{
+    S2Cap cap;
+    gen_search_cap(S2LatLng::FromDegrees(31.23, 121.47), 3000, cap);
+    for (int level = FLAGS_min_level; level <= FLAGS_max_level; ++level) {
+        NO_FATALS(check_scan_units(cap, level));
+    }
+}
+
+TEST_F(geo_client_test, nearest_search)
+{
+    // far from the data of the other cases
+    double lat_degrees = 31.23;
+    double lng_degrees = 121.47;
+    double radius_m = 2000;
+    int test_data_count = 1000;
+
+    S2Cap cap;
+    gen_search_cap(S2LatLng::FromDegrees(lat_degrees, lng_degrees), radius_m, cap);
+    for (int i = 0; i < test_data_count; ++i) {
+        S2LatLng latlng(S2Testing::SamplePoint(cap));
+        int ret = _geo_client->set("nearest_" + std::to_string(i),
+                                   "",
+                                   gen_value(latlng.lat().degrees(), latlng.lng().degrees()),
+                                   5000);
+        ASSERT_EQ(ret, pegasus::PERR_OK);
+    }
+
+    const bool old_adaptive_nearest_search = FLAGS_adaptive_nearest_search;
+    FLAGS_adaptive_nearest_search = false;
+    std::list<geo::SearchResult> expected_result;
+    int ret = _geo_client->search_radial(lat_degrees,
+                                         lng_degrees,
+                                         radius_m,
+                                         -1,
+                                         geo::geo_client::SortType::asc,
+                                         5000,
+                                         expected_result);
+    ASSERT_EQ(ret, pegasus::PERR_OK);
+    ASSERT_GE(expected_result.size(), test_data_count);
+
+    // the nearest data are the same as the ones by the full search, while the data density
+    // observed by the former searches refines the cells of the latter ones
+    FLAGS_adaptive_nearest_search = true;
+    for (int count : {1, 10, 100, 10, 1}) {
+        std::list<geo::SearchResult> result;
+        ret = _geo_client->search_radial(lat_degrees,
+                                         lng_degrees,
+                                         radius_m,
+                                         count,
+                                         geo::geo_client::SortType::asc,
+                                         5000,
+                                         result);
+        ASSERT_EQ(ret, pegasus::PERR_OK);
+        ASSERT_EQ(count, result.size());
+        auto expected = expected_result.begin();
+        for (const auto &r : result) {
+            ASSERT_DOUBLE_EQ(expected->distance, r.distance);
+            ++expected;
+        }
+    }
+
+    // the search times out before any unit is scanned, which leaves the density unchanged
+    const uint64_t old_count_per_cell = count_per_cell();
+    std::list<geo::SearchResult> result;
+    ret = _geo_client->search_radial(
+        lat_degrees, lng_degrees, radius_m, 10, geo::geo_client::SortType::asc, 0, result);
+    ASSERT_EQ(ret, pegasus::PERR_TIMEOUT);
+    ASSERT_TRUE(result.empty());
+    ASSERT_EQ(old_count_per_cell, count_per_cell());
+    FLAGS_adaptive_nearest_search = old_adaptive_nearest_search;
+}
+
 TEST_F(geo_client_test, distance)
 {
     {
@@ -90,6 +90,47 @@ public:
         FT_MATCH_EXACT = 4
     };
 
+    // Same as pushdown_predicate_type in idl/rrdb.thrift.
+    enum pushdown_predicate_type
+    {
+        PPT_VALUE_PREFIX = 0,  // value starts with operand
+        PPT_VALUE_RANGE = 1,   // bytes compare: operand <= value < operand_end
+        PPT_TTL_RANGE = 2,     // min_ttl_seconds <= ttl <= max_ttl_seconds
+        PPT_SORT_KEY_REGEX = 3 // sort key fully matches the RE2 regex operand
+    };
+
+    struct pushdown_predicate
+    {
+        pushdown_predicate_type type;
+        std::string operand;
+        // only used by PPT_VALUE_RANGE, false means no upper bound
+        bool has_operand_end;
+        std::string operand_end;
+        // only used by PPT_TTL_RANGE, < 0 means no bound, the record without ttl never matches
+        // an upper bound
+        int min_ttl_seconds;
+        int max_ttl_seconds;
+        pushdown_predicate()
+            : type(PPT_VALUE_PREFIX),
+              has_operand_end(false),
+              min_ttl_seconds(-1),
+              max_ttl_seconds(-1)
+        {
+        }
+    };
+
+    // Evaluated on the server side to avoid transferring the records which are dropped by the
+    // client: only the records matching all of the predicates are returned, and only the slice
+    // [value_offset, value_offset + value_length) of each value is returned if projected.
+    struct read_pushdown_options
+    {
+        std::vector<pushdown_predicate> predicates;
+        int value_offset; // <= 0 and value_length < 0 means no projection
+        int value_length; // < 0 means to the end of the value
+        read_pushdown_options() : value_offset(0), value_length(-1) {}
+        bool empty() const { return predicates.empty() && value_offset <= 0 && value_length < 0; }
+    };
+
     struct multi_get_options
     {
         bool start_inclusive;
@@ -98,6 +139,7 @@ public:
         std::string sort_key_filter_pattern;
         bool no_value; // only fetch hash_key and sort_key, but not fetch value
         bool reverse;  // if search in reverse direction
+        read_pushdown_options pushdown;
         multi_get_options()
             : start_inclusive(true),
               stop_inclusive(false),
@@ -112,7 +154,8 @@ public:
               sort_key_filter_type(o.sort_key_filter_type),
               sort_key_filter_pattern(o.sort_key_filter_pattern),
               no_value(o.no_value),
-              reverse(o.reverse)
+              reverse(o.reverse),
+              pushdown(o.pushdown)
         {
         }
     };
@@ -256,6 +299,14 @@ public:
         bool no_value; // only fetch hash_key and sort_key, but not fetch value
         bool return_expire_ts;
         bool only_return_count;
+        // > 0 means streaming scan: the server may prefetch at most this count of batches
+        // ahead while the client is consuming the current one.
+        int prefetch_batches;
+        // > 1 means the server may scan each partition in at most this count of sub-ranges in
+        // parallel, only used by get_unordered_scanners(). The records of a partition are not
+        // ordered any more, and the scan can't be resumed once the context on the server is lost.
+        int sub_scan_count;
+        read_pushdown_options pushdown;
         scan_options()
             : timeout_ms(5000),
               batch_size(100),
@@ -265,7 +316,9 @@ public:
               sort_key_filter_type(FT_NO_FILTER),
               no_value(false),
               return_expire_ts(false),
-              only_return_count(false)
+              only_return_count(false),
+              prefetch_batches(0),
+              sub_scan_count(0)
         {
         }
         scan_options(const scan_options &o)
@@ -279,7 +332,10 @@ public:
               sort_key_filter_pattern(o.sort_key_filter_pattern),
               no_value(o.no_value),
               return_expire_ts(o.return_expire_ts),
-              only_return_count(o.only_return_count)
+              only_return_count(o.only_return_count),
+              prefetch_batches(o.prefetch_batches),
+              sub_scan_count(o.sub_scan_count),
+              pushdown(o.pushdown)
         {
         }
     };
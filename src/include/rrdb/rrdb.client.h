@@ -47,6 +47,9 @@ public:
     }
     ~rrdb_client() { _tracker.cancel_outstanding_tasks(); }
 
+    // The partition count of the app, or -1 if it has not been resolved yet.
+    int get_partition_count() const { return _resolver->get_partition_count(); }
+
     // ---------- call RPC_RRDB_RRDB_PUT ------------
     // - synchronous
     std::pair<::dsn::error_code, update_response>
@@ -31,6 +31,7 @@ DEFINE_STORAGE_WRITE_RPC_CODE(RPC_RRDB_RRDB_INCR, NOT_ALLOW_BATCH, NOT_IDEMPOTEN
 DEFINE_STORAGE_WRITE_RPC_CODE(RPC_RRDB_RRDB_CHECK_AND_SET, NOT_ALLOW_BATCH, NOT_IDEMPOTENT)
 DEFINE_STORAGE_WRITE_RPC_CODE(RPC_RRDB_RRDB_CHECK_AND_MUTATE, NOT_ALLOW_BATCH, NOT_IDEMPOTENT)
 DEFINE_STORAGE_WRITE_RPC_CODE(RPC_RRDB_RRDB_DUPLICATE, NOT_ALLOW_BATCH, IS_IDEMPOTENT)
+DEFINE_STORAGE_WRITE_RPC_CODE(RPC_RRDB_RRDB_DUPLICATE_COMPRESSED, NOT_ALLOW_BATCH, IS_IDEMPOTENT)
 DEFINE_STORAGE_READ_RPC_CODE(RPC_RRDB_RRDB_GET)
 DEFINE_STORAGE_READ_RPC_CODE(RPC_RRDB_RRDB_TTL)
 DEFINE_STORAGE_SCAN_RPC_CODE(RPC_RRDB_RRDB_SORTKEY_COUNT)
@@ -254,6 +254,8 @@ void app_env_validator::register_all_validators()
          std::bind(&check_rocksdb_write_buffer_size, std::placeholders::_1, std::placeholders::_2)},
         {replica_envs::ROCKSDB_NUM_LEVELS,
          std::bind(&check_rocksdb_num_levels, std::placeholders::_1, std::placeholders::_2)},
+        {replica_envs::INCR_BY_MERGE,
+         std::bind(&check_bool_value, std::placeholders::_1, std::placeholders::_2)},
         // TODO(zhaoliwei): not implemented
         {replica_envs::BUSINESS_INFO, nullptr},
         {replica_envs::TABLE_LEVEL_DEFAULT_TTL, nullptr},
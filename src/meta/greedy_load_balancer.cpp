@@ -35,6 +35,7 @@
 #include "app_balance_policy.h"
 #include "cluster_balance_policy.h"
 #include "greedy_load_balancer.h"
+#include "load_cost_balance_policy.h"
 #include "meta/load_balance_policy.h"
 #include "meta/meta_service.h"
 #include "meta/server_load_balancer.h"
@@ -51,6 +52,13 @@
 
 DSN_DEFINE_bool(meta_server, balance_cluster, false, "whether to enable cluster balancer");
 DSN_TAG_VARIABLE(balance_cluster, FT_MUTABLE);
+DSN_DEFINE_bool(meta_server,
+                balance_by_load_cost,
+                false,
+                "whether to balance the cluster by the load cost of the nodes, which is calculated "
+                "from the storage, read qps and write bytes reported by the replicas, rather than "
+                "by the replica counts");
+DSN_TAG_VARIABLE(balance_by_load_cost, FT_MUTABLE);
 
 DSN_DECLARE_uint64(min_live_node_count_for_unfreeze);
 
@@ -63,6 +71,8 @@ greedy_load_balancer::greedy_load_balancer(meta_service *_svc) : server_load_bal
 {
     _app_balance_policy = std::make_unique<app_balance_policy>(_svc);
     _cluster_balance_policy = std::make_unique<cluster_balance_policy>(_svc);
+    _load_cost_balance_policy = std::make_unique<load_cost_balance_policy>(_svc);
+    _load_cost_balance_checker = std::make_unique<load_cost_balance_policy>(_svc);
     _all_replca_infos_collected = false;
 
     ::memset(t_operation_counters, 0, sizeof(t_operation_counters));
@@ -170,7 +180,10 @@ void greedy_load_balancer::greedy_balancer(const bool balance_checker)
     }
 
     load_balance_policy *balance_policy = nullptr;
-    if (!FLAGS_balance_cluster) {
+    if (FLAGS_balance_by_load_cost) {
+        balance_policy = balance_checker ? _load_cost_balance_checker.get()
+                                         : _load_cost_balance_policy.get();
+    } else if (!FLAGS_balance_cluster) {
         balance_policy = _app_balance_policy.get();
     } else if (!balance_checker) {
         balance_policy = _cluster_balance_policy.get();
@@ -180,6 +193,14 @@ void greedy_load_balancer::greedy_balancer(const bool balance_checker)
     }
 }
 
+void greedy_load_balancer::on_node_load_changed(const host_port &node)
+{
+    // The loads are tracked even if the load cost balancer is disabled, so that it's ready
+    // once enabled at runtime.
+    _load_cost_balance_policy->mark_node_dirty(node);
+    _load_cost_balance_checker->mark_node_dirty(node);
+}
+
 bool greedy_load_balancer::balance(meta_view view, migration_list &list)
 {
     LOG_INFO("balancer round");
@@ -42,6 +42,7 @@ class rpc_address;
 
 namespace replication {
 class load_balance_policy;
+class load_cost_balance_policy;
 class meta_service;
 
 // A greedy load balancer based on Dijkstra & Ford-Fulkerson.
@@ -59,6 +60,8 @@ public:
 
     std::string get_balance_operation_count(const std::vector<std::string> &args) override;
 
+    void on_node_load_changed(const host_port &node) override;
+
 private:
     enum operation_counters
     {
@@ -78,6 +81,10 @@ private:
 
     std::unique_ptr<load_balance_policy> _app_balance_policy;
     std::unique_ptr<load_balance_policy> _cluster_balance_policy;
+    std::unique_ptr<load_cost_balance_policy> _load_cost_balance_policy;
+    // The balance checker keeps its own cached loads and dirty nodes, otherwise the nodes marked
+    // dirty would be consumed by the checker rounds and missed by the balancer rounds.
+    std::unique_ptr<load_cost_balance_policy> _load_cost_balance_checker;
 
     std::unique_ptr<command_deregister> _get_balance_operation_count;
 
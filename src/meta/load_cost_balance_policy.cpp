@@ -0,0 +1,405 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "load_cost_balance_policy.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "dsn.layer2_types.h"
+#include "meta_admin_types.h"
+#include "metadata_types.h"
+#include "runtime/rpc/dns_resolver.h"
+#include "utils/flags.h"
+#include "utils/fmt_logging.h"
+
+DSN_DEFINE_double(meta_server,
+                  load_cost_storage_weight,
+                  1.0,
+                  "The weight of the storage of the replicas in the cost of a node, used by the "
+                  "load cost balancer");
+DSN_TAG_VARIABLE(load_cost_storage_weight, FT_MUTABLE);
+DSN_DEFINE_double(meta_server,
+                  load_cost_read_qps_weight,
+                  1.0,
+                  "The weight of the read qps of the replicas in the cost of a node, used by the "
+                  "load cost balancer");
+DSN_TAG_VARIABLE(load_cost_read_qps_weight, FT_MUTABLE);
+DSN_DEFINE_double(meta_server,
+                  load_cost_write_bytes_weight,
+                  1.0,
+                  "The weight of the write bytes per second of the replicas in the cost of a "
+                  "node, used by the load cost balancer");
+DSN_TAG_VARIABLE(load_cost_write_bytes_weight, FT_MUTABLE);
+DSN_DEFINE_double(meta_server,
+                  load_cost_learning_weight,
+                  1.0,
+                  "The weight of the data to be learned by a copy, relative to the average "
+                  "storage of the replicas. The higher it is, the more the load cost balancer "
+                  "prefers to move the primaries or to copy the small replicas");
+DSN_TAG_VARIABLE(load_cost_learning_weight, FT_MUTABLE);
+DSN_DEFINE_double(meta_server,
+                  load_cost_skew_threshold,
+                  0.1,
+                  "The load cost balancer stops once the difference between the costs of the "
+                  "hottest and the coldest node is less than this ratio of the average cost");
+DSN_TAG_VARIABLE(load_cost_skew_threshold, FT_MUTABLE);
+DSN_DEFINE_uint32(meta_server,
+                  load_cost_max_moves_per_round,
+                  8,
+                  "The max count of the moves proposed by the load cost balancer in a round");
+DSN_TAG_VARIABLE(load_cost_max_moves_per_round, FT_MUTABLE);
+DSN_DEFINE_uint32(meta_server,
+                  load_cost_candidate_target_count,
+                  3,
+                  "The count of the coldest nodes which are considered as the targets of the "
+                  "copies in each step of the load cost balancer");
+DSN_TAG_VARIABLE(load_cost_candidate_target_count, FT_MUTABLE);
+DSN_DEFINE_validator(load_cost_candidate_target_count,
+                     [](uint32_t value) -> bool { return value > 0; });
+
+namespace dsn {
+namespace replication {
+
+replica_load &replica_load::operator+=(const replica_load &other)
+{
+    storage_mb += other.storage_mb;
+    read_qps += other.read_qps;
+    write_bytes_per_sec += other.write_bytes_per_sec;
+    return *this;
+}
+
+replica_load &replica_load::operator-=(const replica_load &other)
+{
+    storage_mb -= other.storage_mb;
+    read_qps -= other.read_qps;
+    write_bytes_per_sec -= other.write_bytes_per_sec;
+    return *this;
+}
+
+replica_load get_replica_load(const app_mapper &apps, const gpid &pid, const host_port &node)
+{
+    replica_load load;
+    const auto *pc = get_config(apps, pid);
+    const auto *cc = get_config_context(apps, pid);
+    if (pc == nullptr || cc == nullptr) {
+        return load;
+    }
+
+    auto iter = cc->find_from_serving(node);
+    if (iter != cc->serving.end()) {
+        load.storage_mb = iter->storage_mb;
+    }
+
+    if (!pc->hp_primary) {
+        return load;
+    }
+    auto primary = cc->find_from_serving(pc->hp_primary);
+    if (primary != cc->serving.end()) {
+        if (pc->hp_primary == node) {
+            load.read_qps = primary->read_qps;
+        }
+        load.write_bytes_per_sec = primary->write_bytes_per_sec;
+    }
+    return load;
+}
+
+load_cost_balance_policy::load_cost_balance_policy(meta_service *svc) : load_balance_policy(svc)
+{
+}
+
+void load_cost_balance_policy::balance(bool checker,
+                                       const meta_view *global_view,
+                                       migration_list *list)
+{
+    init(global_view, list);
+    update_node_loads();
+    load_cost_balance(*_migration_result);
+}
+
+void load_cost_balance_policy::mark_node_dirty(const host_port &node)
+{
+    zauto_lock l(_dirty_nodes_lock);
+    _dirty_nodes.insert(node);
+}
+
+void load_cost_balance_policy::update_node_loads()
+{
+    std::unordered_set<host_port> dirty_nodes;
+    {
+        zauto_lock l(_dirty_nodes_lock);
+        dirty_nodes.swap(_dirty_nodes);
+    }
+
+    const auto &apps = *_global_view->apps;
+    const auto &nodes = *_global_view->nodes;
+    for (auto iter = _node_loads.begin(); iter != _node_loads.end();) {
+        if (nodes.find(iter->first) == nodes.end()) {
+            iter = _node_loads.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+
+    // The writes reported by a primary are also applied by its secondaries.
+    std::unordered_set<host_port> affected_nodes(dirty_nodes);
+    for (const auto &node : dirty_nodes) {
+        auto iter = nodes.find(node);
+        if (iter == nodes.end()) {
+            continue;
+        }
+        iter->second.for_each_partition([&](const gpid &pid) {
+            const auto *pc = get_config(apps, pid);
+            if (pc != nullptr && pc->hp_primary == node) {
+                affected_nodes.insert(pc->hp_secondaries.begin(), pc->hp_secondaries.end());
+            }
+            return true;
+        });
+    }
+
+    int updated_count = 0;
+    for (const auto &kv : nodes) {
+        if (_node_loads.find(kv.first) == _node_loads.end() ||
+            affected_nodes.find(kv.first) != affected_nodes.end()) {
+            _node_loads[kv.first] = calc_node_load(kv.first, kv.second);
+            ++updated_count;
+        }
+    }
+    LOG_DEBUG("updated the loads of {} nodes, {} nodes in total", updated_count, nodes.size());
+}
+
+replica_load load_cost_balance_policy::calc_node_load(const host_port &node,
+                                                      const node_state &ns) const
+{
+    replica_load load;
+    ns.for_each_partition([&](const gpid &pid) {
+        load += get_replica_load(*_global_view->apps, pid, node);
+        return true;
+    });
+    return load;
+}
+
+double load_cost_balance_policy::calc_cost(const replica_load &load,
+                                           const replica_load &total,
+                                           size_t node_count)
+{
+    double cost = 0;
+    const auto add_cost = [&cost, node_count](int64_t value, int64_t total_value, double weight) {
+        if (total_value > 0) {
+            cost += weight * value * node_count / total_value;
+        }
+    };
+    add_cost(load.storage_mb, total.storage_mb, FLAGS_load_cost_storage_weight);
+    add_cost(load.read_qps, total.read_qps, FLAGS_load_cost_read_qps_weight);
+    add_cost(
+        load.write_bytes_per_sec, total.write_bytes_per_sec, FLAGS_load_cost_write_bytes_weight);
+    return cost;
+}
+
+bool load_cost_balance_policy::can_move(const gpid &pid, const migration_list &list)
+{
+    if (list.find(pid) != list.end()) {
+        return false;
+    }
+
+    const auto &apps = *_global_view->apps;
+    auto iter = apps.find(pid.get_app_id());
+    if (iter == apps.end()) {
+        return false;
+    }
+    const auto &app = iter->second;
+    if (!app->is_stateful || app->status != app_status::AS_AVAILABLE || app->is_bulk_loading ||
+        app->splitting() || is_ignored_app(app->app_id)) {
+        return false;
+    }
+
+    // Only the healthy partitions are moved.
+    const auto &pc = app->partitions[pid.get_partition_index()];
+    return pc.hp_primary &&
+           static_cast<int>(pc.hp_secondaries.size()) + 1 >= pc.max_replica_count;
+}
+
+bool load_cost_balance_policy::get_next_move(
+    const host_port &source,
+    const std::vector<host_port> &targets,
+    const std::unordered_map<host_port, replica_load> &loads,
+    const replica_load &total,
+    int64_t average_replica_storage_mb,
+    const migration_list &list,
+    /*out*/ move_info &next_move)
+{
+    const auto &apps = *_global_view->apps;
+    const size_t node_count = loads.size();
+    const double source_cost = calc_cost(loads.at(source), total, node_count);
+    bool found = false;
+
+    const auto try_move = [&](const gpid &pid,
+                              const host_port &target,
+                              balance_type type,
+                              const replica_load &moved_load) {
+        auto iter = loads.find(target);
+        if (iter == loads.end()) {
+            // The target is not alive.
+            return;
+        }
+        const double gap = source_cost - calc_cost(iter->second, total, node_count);
+        const double delta = calc_cost(moved_load, total, node_count);
+        // The move should not make the target hotter than the source.
+        if (delta <= 0 || delta >= gap) {
+            return;
+        }
+
+        // The reduction of the sum of the squared costs of the source and the target.
+        double score = 2 * delta * (gap - delta);
+        if (type != balance_type::MOVE_PRIMARY && average_replica_storage_mb > 0) {
+            score /= 1 + FLAGS_load_cost_learning_weight * moved_load.storage_mb /
+                             average_replica_storage_mb;
+        }
+        if (score > next_move.score) {
+            next_move.pid = pid;
+            next_move.type = type;
+            next_move.source = source;
+            next_move.target = target;
+            next_move.moved_load = moved_load;
+            next_move.score = score;
+            found = true;
+        }
+    };
+
+    const node_state &ns = _global_view->nodes->at(source);
+    ns.for_each_partition([&](const gpid &pid) {
+        if (!can_move(pid, list)) {
+            return true;
+        }
+
+        const auto &pc = *get_config(apps, pid);
+        const bool is_primary = pc.hp_primary == source;
+        const auto load = get_replica_load(apps, pid, source);
+        if (is_primary) {
+            // Only the reads are moved along with the primary.
+            replica_load moved_load;
+            moved_load.read_qps = load.read_qps;
+            for (const auto &secondary : pc.hp_secondaries) {
+                try_move(pid, secondary, balance_type::MOVE_PRIMARY, moved_load);
+            }
+        }
+
+        for (const auto &target : targets) {
+            if (target == pc.hp_primary ||
+                std::find(pc.hp_secondaries.begin(), pc.hp_secondaries.end(), target) !=
+                    pc.hp_secondaries.end()) {
+                continue;
+            }
+            try_move(pid,
+                     target,
+                     is_primary ? balance_type::COPY_PRIMARY : balance_type::COPY_SECONDARY,
+                     load);
+        }
+        return true;
+    });
+    return found;
+}
+
+void load_cost_balance_policy::load_cost_balance(/*out*/ migration_list &list)
+{
+    const auto &apps = *_global_view->apps;
+    std::unordered_map<host_port, replica_load> loads;
+    replica_load total;
+    int64_t total_replica_count = 0;
+    for (const auto &kv : *_global_view->nodes) {
+        if (!kv.second.alive()) {
+            continue;
+        }
+        const auto &load = _node_loads[kv.first];
+        loads.emplace(kv.first, load);
+        total += load;
+        total_replica_count += kv.second.partition_count();
+    }
+    if (loads.size() < 2) {
+        return;
+    }
+
+    const size_t node_count = loads.size();
+    const double average_cost = calc_cost(total, total, node_count) / node_count;
+    if (average_cost <= 0) {
+        LOG_INFO("no load is reported, skip the load cost balance");
+        return;
+    }
+    const int64_t average_replica_storage_mb =
+        total_replica_count > 0 ? total.storage_mb / total_replica_count : 0;
+
+    std::vector<std::pair<double, host_port>> costs;
+    costs.reserve(node_count);
+    for (uint32_t i = 0; i < FLAGS_load_cost_max_moves_per_round; ++i) {
+        costs.clear();
+        for (const auto &kv : loads) {
+            costs.emplace_back(calc_cost(kv.second, total, node_count), kv.first);
+        }
+        std::sort(costs.begin(), costs.end());
+
+        const double skew = (costs.back().first - costs.front().first) / average_cost;
+        if (skew < FLAGS_load_cost_skew_threshold) {
+            LOG_INFO("the load costs of the nodes are balanced, skew = {:.3f}", skew);
+            break;
+        }
+
+        std::vector<host_port> targets;
+        for (size_t j = 0; j < costs.size() - 1 && j < FLAGS_load_cost_candidate_target_count;
+             ++j) {
+            targets.push_back(costs[j].second);
+        }
+
+        // Move from the hottest node, fall back to the less hot ones if it has nothing to move.
+        move_info next_move;
+        bool found = false;
+        for (auto iter = costs.rbegin(); iter != costs.rend() && iter->first > average_cost;
+             ++iter) {
+            found = get_next_move(iter->second,
+                                  targets,
+                                  loads,
+                                  total,
+                                  average_replica_storage_mb,
+                                  list,
+                                  next_move);
+            if (found) {
+                break;
+            }
+        }
+        if (!found) {
+            LOG_INFO("no more move could reduce the skew({:.3f}) of the load costs", skew);
+            break;
+        }
+
+        const auto &pc = *get_config(apps, next_move.pid);
+        list.emplace(next_move.pid,
+                     generate_balancer_request(
+                         apps,
+                         pc,
+                         next_move.type,
+                         dsn::dns_resolver::instance().resolve_address(next_move.source),
+                         dsn::dns_resolver::instance().resolve_address(next_move.target),
+                         next_move.source,
+                         next_move.target));
+        loads[next_move.source] -= next_move.moved_load;
+        loads[next_move.target] += next_move.moved_load;
+    }
+}
+
+} // namespace replication
+} // namespace dsn
@@ -0,0 +1,118 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <gtest/gtest_prod.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/gpid.h"
+#include "load_balance_policy.h"
+#include "meta/meta_data.h"
+#include "runtime/rpc/rpc_host_port.h"
+#include "utils/zlocks.h"
+
+namespace dsn {
+namespace replication {
+class meta_service;
+
+// The load of a replica, or the sum of the loads of the replicas on a node.
+struct replica_load
+{
+    int64_t storage_mb = 0;
+    int64_t read_qps = 0;
+    int64_t write_bytes_per_sec = 0;
+
+    replica_load &operator+=(const replica_load &other);
+    replica_load &operator-=(const replica_load &other);
+};
+
+// Get the load of the replica of `pid` on `node` from the reports collected by config sync:
+// - the storage is reported by the replica itself;
+// - the reads are only served by the primary;
+// - the writes reported by the primary are applied by all the replicas.
+replica_load get_replica_load(const app_mapper &apps, const gpid &pid, const host_port &node);
+
+// A load balance policy which balances the cost of the nodes rather than the replica counts.
+//
+// The cost of a node is the weighted sum of its storage, read qps and write bytes, each of which
+// is normalized by the average of the alive nodes, so a perfectly balanced node costs the sum of
+// the weights. In each round the moves are picked greedily from the hottest nodes to the coldest
+// ones by their score, which is the reduction of the skew of the costs discounted by the data to
+// be learned, until the skew is under the threshold or the count of the moves reaches the limit.
+//
+// The loads of the nodes are cached and only the nodes marked dirty, i.e. whose replicas reported
+// different loads or whose partitions changed since the last round, are recalculated. The cache
+// and the dirty nodes are owned by the instance, thus the balance checker uses its own one.
+class load_cost_balance_policy : public load_balance_policy
+{
+public:
+    load_cost_balance_policy(meta_service *svc);
+    ~load_cost_balance_policy() = default;
+
+    void balance(bool checker, const meta_view *global_view, migration_list *list) override;
+
+    // Thread-safe.
+    void mark_node_dirty(const host_port &node);
+
+private:
+    struct move_info
+    {
+        gpid pid;
+        balance_type type = balance_type::INVALID;
+        host_port source;
+        host_port target;
+        replica_load moved_load;
+        double score = 0;
+    };
+
+    // Recalculate the loads of the dirty nodes, and drop the nodes which no longer exist.
+    void update_node_loads();
+    replica_load calc_node_load(const host_port &node, const node_state &ns) const;
+
+    // Normalize the load by the average of the `node_count` nodes whose total load is `total`.
+    static double
+    calc_cost(const replica_load &load, const replica_load &total, size_t node_count);
+    bool can_move(const gpid &pid, const migration_list &list);
+    // Find the move with the highest score from `source`, either the primary is moved to a
+    // secondary or the replica is copied to one of the `targets`.
+    bool get_next_move(const host_port &source,
+                       const std::vector<host_port> &targets,
+                       const std::unordered_map<host_port, replica_load> &loads,
+                       const replica_load &total,
+                       int64_t average_replica_storage_mb,
+                       const migration_list &list,
+                       /*out*/ move_info &next_move);
+    void load_cost_balance(/*out*/ migration_list &list);
+
+    // The cached loads of the nodes, only accessed by balance().
+    std::unordered_map<host_port, replica_load> _node_loads;
+
+    zlock _dirty_nodes_lock; // {
+    std::unordered_set<host_port> _dirty_nodes;
+    // }
+
+    FRIEND_TEST(load_cost_balance_policy_test, calc_cost);
+    FRIEND_TEST(load_cost_balance_policy_test, incremental_node_loads);
+};
+
+} // namespace replication
+} // namespace dsn
@@ -154,7 +154,10 @@ bool construct_replica(meta_view view, const gpid &pid, int max_replica_count)
     return true;
 }
 
-bool collect_replica(meta_view view, const host_port &node, const replica_info &info)
+bool collect_replica(meta_view view,
+                     const host_port &node,
+                     const replica_info &info,
+                     /*out*/ bool *load_changed)
 {
     partition_configuration &pc = *get_config(*view.apps, info.pid);
     // current partition is during partition split
@@ -162,7 +165,10 @@ bool collect_replica(meta_view view, const host_port &node, const replica_info &
         return false;
     config_context &cc = *get_config_context(*view.apps, info.pid);
     if (is_member(pc, node)) {
-        cc.collect_serving_replica(node, info);
+        const bool changed = cc.collect_serving_replica(node, info);
+        if (load_changed != nullptr) {
+            *load_changed = changed;
+        }
         return true;
     }
 
@@ -435,18 +441,31 @@ bool config_context::remove_from_serving(const host_port &node)
     return false;
 }
 
-void config_context::collect_serving_replica(const host_port &node, const replica_info &info)
+bool config_context::collect_serving_replica(const host_port &node, const replica_info &info)
 {
     auto iter = find_from_serving(node);
     auto compact_status = info.__isset.manual_compact_status ? info.manual_compact_status
                                                              : manual_compaction_status::IDLE;
-    if (iter != serving.end()) {
-        iter->disk_tag = info.disk_tag;
-        iter->storage_mb = 0;
-        iter->compact_status = compact_status;
-    } else {
-        serving.emplace_back(serving_replica{node, 0, info.disk_tag, compact_status});
+    bool load_changed = false;
+    if (iter == serving.end()) {
+        iter = serving.emplace(serving.end(), serving_replica{node});
+        load_changed = true;
+    }
+    iter->disk_tag = info.disk_tag;
+    iter->compact_status = compact_status;
+    // The old replica servers don't report the load.
+    const int64_t storage_mb = info.__isset.storage_mb ? info.storage_mb : 0;
+    const int64_t read_qps = info.__isset.read_qps ? info.read_qps : 0;
+    const int64_t write_bytes_per_sec =
+        info.__isset.write_bytes_per_sec ? info.write_bytes_per_sec : 0;
+    if (iter->storage_mb != storage_mb || iter->read_qps != read_qps ||
+        iter->write_bytes_per_sec != write_bytes_per_sec) {
+        iter->storage_mb = storage_mb;
+        iter->read_qps = read_qps;
+        iter->write_bytes_per_sec = write_bytes_per_sec;
+        load_changed = true;
     }
+    return load_changed;
 }
 
 void config_context::adjust_proposal(const host_port &node, const replica_info &info)
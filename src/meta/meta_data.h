@@ -186,10 +186,12 @@ inline int dropped_cmp(const dropped_replica &d1, const dropped_replica &d2)
 struct serving_replica
 {
     dsn::host_port node;
-    // TODO: report the storage size of replica
-    int64_t storage_mb;
+    int64_t storage_mb = 0;
     std::string disk_tag;
     manual_compaction_status::type compact_status;
+    // The load reported by the replica, only the primary serves the reads and the writes.
+    int64_t read_qps = 0;
+    int64_t write_bytes_per_sec = 0;
 };
 
 class config_context
@@ -249,7 +251,9 @@ public:
     // return true if remove ok, false if node doesn't in serving
     bool remove_from_serving(const dsn::host_port &node);
 
-    void collect_serving_replica(const dsn::host_port &node, const replica_info &info);
+    // return true if the replica is newly serving, or its load differs from the one collected
+    // before
+    bool collect_serving_replica(const dsn::host_port &node, const replica_info &info);
 
     void adjust_proposal(const dsn::host_port &node, const replica_info &info);
 
@@ -582,10 +586,14 @@ bool construct_replica(meta_view view, const gpid &pid, int max_replica_count);
 // params:
 //   node: the owner of the replica info
 //   info: the replica info on node
+//   load_changed: set to true if the replica is serving and its load changed, could be nullptr
 // ret:
 //   return true if the replica is accepted as an useful replica. Or-else false.
 //   WARNING: if false is returned, the replica on node may be garbage-collected
-bool collect_replica(meta_view view, const host_port &node, const replica_info &info);
+bool collect_replica(meta_view view,
+                     const host_port &node,
+                     const replica_info &info,
+                     /*out*/ bool *load_changed = nullptr);
 
 inline bool has_seconds_expired(uint64_t second_ts) { return second_ts * 1000 < dsn_now_ms(); }
 
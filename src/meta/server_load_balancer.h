@@ -164,6 +164,14 @@ public:
     //
     virtual std::string get_balance_operation_count(const std::vector<std::string> &args) = 0;
 
+    //
+    // Notify that the load of the node may have changed, i.e. the replicas on the node reported
+    // their load by config sync, or the partitions served by the node changed
+    // params:
+    //   node: the node whose load may have changed
+    //
+    virtual void on_node_load_changed(const host_port &node) {}
+
 public:
     typedef std::function<bool(const host_port &addr1, const host_port &addr2)> node_comparator;
     static node_comparator primary_comparator(const node_mapper &nodes)
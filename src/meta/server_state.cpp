@@ -870,6 +870,7 @@ void server_state::on_config_sync(configuration_query_by_node_rpc rpc)
                 ns->set_replicas_collect_flag(true);
             const std::vector<replica_info> &replicas = request.stored_replicas;
             meta_function_level::type level = _meta_svc->get_function_level();
+            bool load_changed = false;
             // if the node serve the replica on the meta server, then we ignore it
             // if the dropped servers on the meta servers are enough, we need to gc it
             // there are not enough dropped servers, we need to add it to dropped
@@ -931,7 +932,10 @@ void server_state::on_config_sync(configuration_query_by_node_rpc rpc)
                         }
                     }
                 } else if (app->status == app_status::AS_AVAILABLE) {
-                    bool is_useful_replica = collect_replica({&_all_apps, &_nodes}, hp_node, rep);
+                    bool replica_load_changed = false;
+                    bool is_useful_replica = collect_replica(
+                        {&_all_apps, &_nodes}, hp_node, rep, &replica_load_changed);
+                    load_changed = load_changed || replica_load_changed;
                     if (!is_useful_replica) {
                         if (level <= meta_function_level::fl_steady) {
                             LOG_INFO("gpid({}) on node({}({})) is useless, but current function "
@@ -950,6 +954,12 @@ void server_state::on_config_sync(configuration_query_by_node_rpc rpc)
                     }
                 }
             }
+            // Only the nodes whose replicas reported a different load are recalculated by the
+            // balancer, the partitions moved in or out are tracked by
+            // update_configuration_locally.
+            if (load_changed) {
+                _meta_svc->get_balancer()->on_node_load_changed(hp_node);
+            }
 
             if (!response.gc_replicas.empty()) {
                 response.__isset.gc_replicas = true;
@@ -1593,6 +1603,11 @@ void server_state::update_configuration_locally(
 #ifndef NDEBUG
         request_check(old_cfg, *config_request);
 #endif
+        // The partitions on the nodes changed, and so does their load.
+        auto *balancer = _meta_svc->get_balancer();
+        if (ns != nullptr) {
+            balancer->on_node_load_changed(hp_node);
+        }
         switch (config_request->type) {
         case config_type::CT_ASSIGN_PRIMARY:
         case config_type::CT_UPGRADE_TO_PRIMARY:
@@ -1618,8 +1633,10 @@ void server_state::update_configuration_locally(
         case config_type::CT_DROP_PARTITION:
             for (const auto &node : new_cfg.hp_last_drops) {
                 ns = get_node_state(_nodes, node, false);
-                if (ns != nullptr)
+                if (ns != nullptr) {
                     ns->remove_partition(gpid, false);
+                    balancer->on_node_load_changed(node);
+                }
             }
             break;
 
@@ -1633,12 +1650,14 @@ void server_state::update_configuration_locally(
                 for (const auto &secondary : config_request->config.hp_secondaries) {
                     auto secondary_node = get_node_state(_nodes, secondary, false);
                     secondary_node->put_partition(gpid, false);
+                    balancer->on_node_load_changed(secondary);
                 }
             } else {
                 for (const auto &secondary : config_request->config.secondaries) {
-                    auto secondary_node =
-                        get_node_state(_nodes, host_port::from_address(secondary), false);
+                    const auto hp_secondary = host_port::from_address(secondary);
+                    auto secondary_node = get_node_state(_nodes, hp_secondary, false);
                     secondary_node->put_partition(gpid, false);
+                    balancer->on_node_load_changed(hp_secondary);
                 }
             }
             break;
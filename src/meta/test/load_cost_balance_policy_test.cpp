@@ -0,0 +1,260 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "common/gpid.h"
+#include "dsn.layer2_types.h"
+#include "gtest/gtest.h"
+#include "meta/load_balance_policy.h"
+#include "meta/load_cost_balance_policy.h"
+#include "meta/meta_data.h"
+#include "meta/meta_service.h"
+#include "meta_admin_types.h"
+#include "metadata_types.h"
+#include "runtime/rpc/rpc_host_port.h"
+#include "test_util/test_util.h"
+#include "utils/flags.h"
+
+DSN_DECLARE_uint32(load_cost_max_moves_per_round);
+
+namespace dsn {
+namespace replication {
+
+class load_cost_balance_policy_test : public testing::Test
+{
+public:
+    // All the replicas are of the same size and write load, while all the primaries, which serve
+    // the reads, are on the first node.
+    void SetUp() override
+    {
+        dsn::app_info info;
+        info.app_id = kAppId;
+        info.partition_count = kPartitionCount;
+        info.max_replica_count = 3;
+        info.is_stateful = true;
+        info.status = app_status::AS_AVAILABLE;
+        _app = app_state::create(info);
+        _apps[kAppId] = _app;
+
+        for (const auto &hp : _hps) {
+            _nodes[hp].set_hp(hp);
+            _nodes[hp].set_alive(true);
+        }
+        for (int i = 0; i < kPartitionCount; ++i) {
+            auto &pc = _app->partitions[i];
+            pc.hp_primary = _hps[0];
+            pc.hp_secondaries = {_hps[1], _hps[2]};
+
+            auto &cc = _app->helpers->contexts[i];
+            for (const auto &hp : _hps) {
+                serving_replica sr;
+                sr.node = hp;
+                sr.storage_mb = 100;
+                sr.disk_tag = "disk1";
+                sr.read_qps = hp == pc.hp_primary ? 100 : 0;
+                sr.write_bytes_per_sec = hp == pc.hp_primary ? 1000 : 0;
+                cc.serving.emplace_back(sr);
+                _nodes[hp].put_partition(gpid(kAppId, i), hp == pc.hp_primary);
+            }
+        }
+
+        _view.apps = &_apps;
+        _view.nodes = &_nodes;
+    }
+
+    const int32_t kAppId = 1;
+    const int kPartitionCount = 4;
+    const std::vector<host_port> _hps = {
+        host_port("localhost", 1), host_port("localhost", 2), host_port("localhost", 3)};
+
+    std::shared_ptr<app_state> _app;
+    app_mapper _apps;
+    node_mapper _nodes;
+    meta_view _view;
+    meta_service _svc;
+};
+
+TEST_F(load_cost_balance_policy_test, get_replica_load)
+{
+    auto load = get_replica_load(_apps, gpid(kAppId, 0), _hps[0]);
+    ASSERT_EQ(100, load.storage_mb);
+    ASSERT_EQ(100, load.read_qps);
+    ASSERT_EQ(1000, load.write_bytes_per_sec);
+
+    // The secondary applies the writes of the primary, but serves no read.
+    load = get_replica_load(_apps, gpid(kAppId, 0), _hps[1]);
+    ASSERT_EQ(100, load.storage_mb);
+    ASSERT_EQ(0, load.read_qps);
+    ASSERT_EQ(1000, load.write_bytes_per_sec);
+
+    load = get_replica_load(_apps, gpid(kAppId + 1, 0), _hps[0]);
+    ASSERT_EQ(0, load.storage_mb);
+    ASSERT_EQ(0, load.read_qps);
+    ASSERT_EQ(0, load.write_bytes_per_sec);
+}
+
+TEST_F(load_cost_balance_policy_test, calc_cost)
+{
+    replica_load total;
+    total.storage_mb = 300;
+    total.read_qps = 30;
+    total.write_bytes_per_sec = 0;
+
+    replica_load load;
+    load.storage_mb = 100;
+    load.read_qps = 20;
+    load.write_bytes_per_sec = 0;
+    // The write term is ignored since there is no write at all.
+    ASSERT_DOUBLE_EQ(1.0 + 2.0, load_cost_balance_policy::calc_cost(load, total, 3));
+    ASSERT_DOUBLE_EQ(3.0 + 3.0, load_cost_balance_policy::calc_cost(total, total, 3));
+}
+
+TEST_F(load_cost_balance_policy_test, collect_load_changes)
+{
+    auto &cc = _app->helpers->contexts[0];
+    replica_info info;
+    info.pid = gpid(kAppId, 0);
+    info.disk_tag = "disk1";
+    info.__set_storage_mb(100);
+    info.__set_read_qps(0);
+    info.__set_write_bytes_per_sec(0);
+
+    // The node is not marked dirty by a config sync reporting the same load.
+    bool load_changed = true;
+    ASSERT_TRUE(collect_replica(_view, _hps[1], info, &load_changed));
+    ASSERT_FALSE(load_changed);
+
+    info.__set_storage_mb(200);
+    ASSERT_TRUE(collect_replica(_view, _hps[1], info, &load_changed));
+    ASSERT_TRUE(load_changed);
+    ASSERT_EQ(200, cc.find_from_serving(_hps[1])->storage_mb);
+
+    // A newly serving replica changes the load of its node.
+    ASSERT_TRUE(cc.remove_from_serving(_hps[2]));
+    ASSERT_TRUE(cc.collect_serving_replica(_hps[2], info));
+    ASSERT_FALSE(cc.collect_serving_replica(_hps[2], info));
+}
+
+TEST_F(load_cost_balance_policy_test, incremental_node_loads)
+{
+    load_cost_balance_policy policy(&_svc);
+    migration_list list;
+    policy.init(&_view, &list);
+    policy.update_node_loads();
+    ASSERT_EQ(3, policy._node_loads.size());
+    ASSERT_EQ(400, policy._node_loads[_hps[0]].read_qps);
+    ASSERT_EQ(0, policy._node_loads[_hps[1]].read_qps);
+    ASSERT_EQ(4000, policy._node_loads[_hps[1]].write_bytes_per_sec);
+
+    auto &cc = _app->helpers->contexts[0];
+    cc.find_from_serving(_hps[0])->write_bytes_per_sec = 5000;
+    cc.find_from_serving(_hps[2])->storage_mb = 500;
+
+    // The cached loads are kept until the nodes are marked dirty.
+    policy.update_node_loads();
+    ASSERT_EQ(4000, policy._node_loads[_hps[0]].write_bytes_per_sec);
+    ASSERT_EQ(400, policy._node_loads[_hps[2]].storage_mb);
+
+    // The secondaries are also updated along with the primary for the writes.
+    policy.mark_node_dirty(_hps[0]);
+    policy.update_node_loads();
+    ASSERT_EQ(8000, policy._node_loads[_hps[0]].write_bytes_per_sec);
+    ASSERT_EQ(8000, policy._node_loads[_hps[1]].write_bytes_per_sec);
+    ASSERT_EQ(8000, policy._node_loads[_hps[2]].write_bytes_per_sec);
+    ASSERT_EQ(800, policy._node_loads[_hps[2]].storage_mb);
+
+    // The removed nodes are dropped.
+    _nodes.erase(_hps[2]);
+    policy.update_node_loads();
+    ASSERT_EQ(2, policy._node_loads.size());
+}
+
+TEST_F(load_cost_balance_policy_test, move_primary)
+{
+    load_cost_balance_policy policy(&_svc);
+    migration_list list;
+    policy.balance(false, &_view, &list);
+
+    // The primaries are spread as 2:1:1 without any copy, since all the nodes serve all the
+    // partitions.
+    ASSERT_EQ(2, list.size());
+    std::set<host_port> targets;
+    for (const auto &kv : list) {
+        ASSERT_EQ(balancer_request_type::move_primary, kv.second->balance_type);
+        ASSERT_EQ(_hps[0], kv.second->action_list[0].hp_node);
+        targets.insert(kv.second->action_list[1].hp_node);
+    }
+    ASSERT_EQ(std::set<host_port>({_hps[1], _hps[2]}), targets);
+}
+
+TEST_F(load_cost_balance_policy_test, max_moves_per_round)
+{
+    PRESERVE_FLAG(load_cost_max_moves_per_round);
+    FLAGS_load_cost_max_moves_per_round = 1;
+
+    load_cost_balance_policy policy(&_svc);
+    migration_list list;
+    policy.balance(false, &_view, &list);
+    ASSERT_EQ(1, list.size());
+}
+
+TEST_F(load_cost_balance_policy_test, copy_secondary)
+{
+    // A new node joins without any replica, the secondaries are copied to it.
+    const auto hp4 = host_port("localhost", 4);
+    _nodes[hp4].set_hp(hp4);
+    _nodes[hp4].set_alive(true);
+    for (auto &pc : _app->partitions) {
+        pc.hp_primary = _hps[pc.pid.get_partition_index() % 3];
+        pc.hp_secondaries.clear();
+        for (const auto &hp : _hps) {
+            if (hp != pc.hp_primary) {
+                pc.hp_secondaries.push_back(hp);
+            }
+        }
+    }
+    for (auto &cc : _app->helpers->contexts) {
+        for (auto &sr : cc.serving) {
+            sr.read_qps = 0;
+            sr.write_bytes_per_sec = 0;
+        }
+    }
+
+    load_cost_balance_policy policy(&_svc);
+    migration_list list;
+    policy.balance(false, &_view, &list);
+    ASSERT_FALSE(list.empty());
+    for (const auto &kv : list) {
+        ASSERT_EQ(hp4, kv.second->action_list[0].hp_node);
+    }
+}
+
+TEST_F(load_cost_balance_policy_test, skip_unavailable_app)
+{
+    _app->status = app_status::AS_DROPPING;
+    load_cost_balance_policy policy(&_svc);
+    migration_list list;
+    policy.balance(false, &_view, &list);
+    ASSERT_TRUE(list.empty());
+}
+
+} // namespace replication
+} // namespace dsn
@@ -41,6 +41,8 @@ struct copy_request
     9: optional string         source_disk_tag;
     10: optional dsn.gpid      pid;
     11: optional dsn.host_port hp_source;
+    // Whether to return the crc32 of the file content.
+    12: optional bool           need_checksum;
 }
 
 struct copy_response
@@ -49,6 +51,8 @@ struct copy_response
     2: dsn.blob file_content;
     3: i64 offset;
     4: i32 size;
+    // The crc32 of the file content computed by the server, set if need_checksum is true.
+    5: optional i32 checksum;
 }
 
 struct get_file_size_request
@@ -69,4 +73,7 @@ struct get_file_size_response
     1: i32 error;
     2: list<string> file_list;
     3: list<i64> size_list;
+    // The last modified time in seconds of each file, which identifies the version of the file
+    // when resuming an interrupted copy.
+    4: optional list<i64> mtime_list;
 }
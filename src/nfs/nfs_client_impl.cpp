@@ -27,6 +27,11 @@
 #include "nfs_client_impl.h"
 
 // IWYU pragma: no_include <ext/alloc_traits.h>
+#include <rocksdb/env.h>
+#include <rocksdb/options.h>
+#include <rocksdb/slice.h>
+#include <rocksdb/status.h>
+#include <algorithm>
 #include <mutex>
 
 #include "absl/strings/string_view.h"
@@ -37,9 +42,12 @@
 #include "runtime/rpc/rpc_host_port.h"
 #include "utils/blob.h"
 #include "utils/command_manager.h"
+#include "utils/crc.h"
+#include "utils/env.h"
 #include "utils/filesystem.h"
 #include "utils/flags.h"
 #include "utils/fmt_logging.h"
+#include "utils/load_dump_object.h"
 #include "utils/token_buckets.h"
 
 DSN_DEFINE_uint32(nfs,
@@ -64,7 +72,10 @@ DSN_DEFINE_int32(nfs,
                  max_concurrent_remote_copy_requests,
                  50,
                  "max concurrent remote copy to the same server on nfs client");
-DSN_DEFINE_int32(nfs, max_concurrent_local_writes, 50, "max local file writes on nfs client");
+DSN_DEFINE_int32(nfs,
+                 max_concurrent_local_writes,
+                 50,
+                 "max concurrent local file writes per disk on nfs client");
 DSN_DEFINE_int32(nfs, max_buffered_local_writes, 500, "max buffered file writes on nfs client");
 DSN_DEFINE_int32(nfs,
                  high_priority_speed_rate,
@@ -83,7 +94,27 @@ DSN_DEFINE_int32(nfs,
                  2,
                  "maximum concurrent remote copy requests for the same file on nfs client"
                  "to limit each file copy speed");
+DSN_DEFINE_int32(nfs,
+                 max_concurrent_copy_files_per_request,
+                 4,
+                 "The maximum number of files of the same copy request which are copied in "
+                 "parallel on nfs client, while the chunks of each file are still requested in "
+                 "order");
+DSN_DEFINE_validator(max_concurrent_copy_files_per_request,
+                     [](int32_t value) -> bool { return value > 0; });
 DSN_DEFINE_int32(nfs, max_retry_count_per_copy_request, 2, "maximum retry count when copy failed");
+DSN_DEFINE_bool(nfs,
+                resume_partially_copied_files,
+                true,
+                "Whether to resume the files partially copied by the last interrupted copy from "
+                "the last written chunk on nfs client, rather than copying them from scratch");
+DSN_TAG_VARIABLE(resume_partially_copied_files, FT_MUTABLE);
+DSN_DEFINE_uint32(nfs,
+                  copy_progress_persist_interval_mb,
+                  64,
+                  "The progress of a file being copied is persisted on nfs client every time "
+                  "this size of data is written, for resuming the copy after an interruption");
+DSN_TAG_VARIABLE(copy_progress_persist_interval_mb, FT_MUTABLE);
 DSN_DEFINE_int32(nfs,
                  rpc_timeout_ms,
                  1e5, // 100s
@@ -100,6 +131,18 @@ METRIC_DEFINE_counter(server,
                       dsn::metric_unit::kRequests,
                       "The number of failed nfs copy requests (requested by client)");
 
+METRIC_DEFINE_counter(server,
+                      nfs_client_checksum_mismatched_chunks,
+                      dsn::metric_unit::kRequests,
+                      "The number of chunks whose checksum mismatched during nfs copy, which are "
+                      "requested again by client");
+
+METRIC_DEFINE_counter(server,
+                      nfs_client_resumed_bytes,
+                      dsn::metric_unit::kBytes,
+                      "The accumulated data size in bytes that are not requested by client since "
+                      "they have been copied by the last interrupted nfs copy");
+
 METRIC_DEFINE_counter(
     server,
     nfs_client_write_bytes,
@@ -115,14 +158,18 @@ namespace dsn {
 namespace service {
 static uint32_t current_max_copy_rate_megabytes = 0;
 
+const std::string file_copy_progress::kSuffix(".nfs_progress");
+
 nfs_client_impl::nfs_client_impl()
     : _concurrent_copy_request_count(0),
-      _concurrent_local_write_count(0),
       _buffered_local_write_count(0),
-      _copy_requests_low(FLAGS_max_file_copy_request_count_per_file),
+      _copy_requests_low(FLAGS_max_file_copy_request_count_per_file *
+                         FLAGS_max_concurrent_copy_files_per_request),
       _high_priority_remaining_time(FLAGS_high_priority_speed_rate),
       METRIC_VAR_INIT_server(nfs_client_copy_bytes),
       METRIC_VAR_INIT_server(nfs_client_copy_failed_requests),
+      METRIC_VAR_INIT_server(nfs_client_checksum_mismatched_chunks),
+      METRIC_VAR_INIT_server(nfs_client_resumed_bytes),
       METRIC_VAR_INIT_server(nfs_client_write_bytes),
       METRIC_VAR_INIT_server(nfs_client_failed_writes)
 {
@@ -184,46 +231,86 @@ void nfs_client_impl::end_get_file_size(::dsn::error_code err,
         return;
     }
 
-    std::deque<copy_request_ex_ptr> copy_requests;
+    // Resuming the files needs to read the local files, which should not block the rpc thread.
+    tasking::enqueue(
+        LPC_NFS_COPY_FILE, &_tracker, [this, resp, ureq]() { prepare_copy_requests(resp, ureq); });
+}
+
+void nfs_client_impl::prepare_copy_requests(const ::dsn::service::get_file_size_response &resp,
+                                            const user_request_ptr &ureq)
+{
+    const uint64_t block_bytes = FLAGS_nfs_copy_block_bytes;
+    const bool has_mtime =
+        resp.__isset.mtime_list && resp.mtime_list.size() == resp.size_list.size();
+    std::vector<std::deque<copy_request_ex_ptr>> file_requests(resp.size_list.size());
+    int resumed_files = 0;
     ureq->file_contexts.resize(resp.size_list.size());
     for (size_t i = 0; i < resp.size_list.size(); i++) // file list
     {
         file_context_ptr filec(new file_context(ureq, resp.file_list[i], resp.size_list[i]));
+        filec->progress.source_mtime = has_mtime ? resp.mtime_list[i] : 0;
         ureq->file_contexts[i] = filec;
 
-        // init copy requests
-        uint64_t size = resp.size_list[i];
-        uint64_t req_offset = 0;
-        uint32_t req_size = size > FLAGS_nfs_copy_block_bytes ? FLAGS_nfs_copy_block_bytes
-                                                              : static_cast<uint32_t>(size);
+        // init copy requests, an empty file is also copied by a request of size 0
+        const uint64_t size = resp.size_list[i];
+        const uint64_t chunk_count = std::max<uint64_t>((size + block_bytes - 1) / block_bytes, 1);
+        const uint64_t resumed_chunks = resume_file_copy(filec, chunk_count);
+        if (resumed_chunks == chunk_count) {
+            ++resumed_files;
+            continue;
+        }
 
-        filec->copy_requests.reserve(size / FLAGS_nfs_copy_block_bytes + 1);
-        int idx = 0;
-        for (;;) // send one file with multi-round rpc
-        {
-            copy_request_ex_ptr req(
-                new copy_request_ex(filec, idx++, FLAGS_max_retry_count_per_copy_request));
-            req->offset = req_offset;
-            req->size = req_size;
-            req->is_last = (size <= req_size);
+        filec->copy_requests.reserve(chunk_count - resumed_chunks);
+        for (uint64_t chunk = resumed_chunks; chunk < chunk_count; ++chunk) {
+            copy_request_ex_ptr req(new copy_request_ex(filec,
+                                                        static_cast<int>(chunk - resumed_chunks),
+                                                        FLAGS_max_retry_count_per_copy_request));
+            req->offset = chunk * block_bytes;
+            req->size = static_cast<uint32_t>(std::min(block_bytes, size - req->offset));
+            req->is_last = (chunk + 1 == chunk_count);
 
             filec->copy_requests.push_back(req);
-            copy_requests.push_back(req);
+            file_requests[i].push_back(req);
+        }
+    }
 
-            req_offset += req_size;
-            size -= req_size;
-            if (size <= 0) {
-                CHECK_EQ_MSG(
-                    size, 0, "last request must read exactly the remaing size of the file");
-                break;
+    ureq->finished_files = resumed_files;
+    if (resumed_files == static_cast<int>(ureq->file_contexts.size())) {
+        handle_completion(ureq, ERR_OK);
+        return;
+    }
+
+    // Interleave the chunks of at most 'max_concurrent_copy_files_per_request' files, so that
+    // these files are streamed in parallel, while the chunks of each file are still in order to
+    // keep the local writes sequential.
+    std::deque<copy_request_ex_ptr> copy_requests;
+    std::list<std::deque<copy_request_ex_ptr> *> copying_files;
+    size_t next_file = 0;
+    while (true) {
+        while (copying_files.size() <
+                   static_cast<size_t>(FLAGS_max_concurrent_copy_files_per_request) &&
+               next_file < file_requests.size()) {
+            if (!file_requests[next_file].empty()) {
+                copying_files.push_back(&file_requests[next_file]);
             }
+            ++next_file;
+        }
+        if (copying_files.empty()) {
+            break;
+        }
 
-            req_size = size > FLAGS_nfs_copy_block_bytes ? FLAGS_nfs_copy_block_bytes
-                                                         : static_cast<uint32_t>(size);
+        for (auto it = copying_files.begin(); it != copying_files.end();) {
+            copy_requests.push_back((*it)->front());
+            (*it)->pop_front();
+            if ((*it)->empty()) {
+                it = copying_files.erase(it);
+            } else {
+                ++it;
+            }
         }
     }
 
-    if (!copy_requests.empty()) {
+    {
         zauto_lock l(_copy_requests_lock);
         if (ureq->high_priority)
             _copy_requests_high.insert(
@@ -232,7 +319,72 @@ void nfs_client_impl::end_get_file_size(::dsn::error_code err,
             _copy_requests_low.push(std::move(copy_requests));
     }
 
-    tasking::enqueue(LPC_NFS_COPY_FILE, nullptr, [this]() { continue_copy(); }, 0);
+    continue_copy();
+}
+
+uint64_t nfs_client_impl::resume_file_copy(const file_context_ptr &fc, uint64_t chunk_count)
+{
+    const auto &file_size_req = fc->user_req->file_size_req;
+    auto &progress = fc->progress;
+    progress.source = file_size_req.hp_source.to_string();
+    progress.source_path = utils::filesystem::path_combine(file_size_req.source_dir, fc->file_name);
+    progress.file_size = static_cast<int64_t>(fc->file_size);
+    progress.block_bytes = FLAGS_nfs_copy_block_bytes;
+
+    const auto file_path = utils::filesystem::path_combine(file_size_req.dst_dir, fc->file_name);
+    const auto progress_path = file_copy_progress::path_of(file_path);
+    file_copy_progress last_progress;
+    uint64_t resumed_chunks = 0;
+    // The remote file is identified by its path, size and last modified time, and the content of
+    // the local chunks is verified again since they may not be synced to the disk.
+    if (FLAGS_resume_partially_copied_files && progress.source_mtime != 0 &&
+        utils::filesystem::file_exists(progress_path) &&
+        utils::load_rjobj_from_file(progress_path, &last_progress) == ERR_OK &&
+        last_progress.source == progress.source &&
+        last_progress.source_path == progress.source_path &&
+        last_progress.source_mtime == progress.source_mtime &&
+        last_progress.file_size == progress.file_size &&
+        last_progress.block_bytes == progress.block_bytes &&
+        last_progress.checksums.size() <= chunk_count) {
+        std::unique_ptr<rocksdb::RandomAccessFile> rfile;
+        auto s = utils::PegasusEnv(utils::FileDataType::kSensitive)
+                     ->NewRandomAccessFile(file_path, &rfile, rocksdb::EnvOptions());
+        if (s.ok()) {
+            std::unique_ptr<char[]> scratch(new char[progress.block_bytes]);
+            for (; resumed_chunks < last_progress.checksums.size(); ++resumed_chunks) {
+                const uint64_t offset = resumed_chunks * progress.block_bytes;
+                const size_t size =
+                    std::min<uint64_t>(progress.block_bytes, fc->file_size - offset);
+                rocksdb::Slice result;
+                s = rfile->Read(offset, size, &result, scratch.get());
+                if (!s.ok() || result.size() != size ||
+                    utils::crc32_calc(result.data(), result.size(), 0) !=
+                        last_progress.checksums[resumed_chunks]) {
+                    break;
+                }
+            }
+        }
+    }
+
+    if (resumed_chunks == 0) {
+        // Copy from scratch, the stale content is removed in case that it's longer than the file.
+        utils::filesystem::remove_path(file_path);
+        utils::filesystem::remove_path(progress_path);
+        return 0;
+    }
+
+    progress.checksums.assign(last_progress.checksums.begin(),
+                              last_progress.checksums.begin() + resumed_chunks);
+    const uint64_t resumed_bytes =
+        std::min<uint64_t>(resumed_chunks * progress.block_bytes, fc->file_size);
+    METRIC_VAR_INCREMENT_BY(nfs_client_resumed_bytes, resumed_bytes);
+    LOG_INFO("[nfs_service] resume copying file {} from {}({}), resumed_size = {}, file_size = {}",
+             file_path,
+             file_size_req.hp_source,
+             progress.source_path,
+             resumed_bytes,
+             fc->file_size);
+    return resumed_chunks;
 }
 
 void nfs_client_impl::continue_copy()
@@ -308,6 +460,7 @@ void nfs_client_impl::continue_copy()
                 copy_req.__set_source_disk_tag(ureq->file_size_req.source_disk_tag);
                 copy_req.__set_pid(ureq->file_size_req.pid);
                 copy_req.__set_hp_source(ureq->file_size_req.hp_source);
+                copy_req.__set_need_checksum(true);
                 req->remote_copy_task =
                     async_nfs_copy(copy_req,
                                    [=](error_code err, copy_response &&resp) {
@@ -351,6 +504,10 @@ void nfs_client_impl::end_copy(::dsn::error_code err,
         err = resp.error;
     }
 
+    if (err == ERR_OK) {
+        err = verify_chunk(resp, reqc);
+    }
+
     if (err != ::dsn::ERR_OK) {
         METRIC_VAR_INCREMENT(nfs_client_copy_failed_requests);
 
@@ -413,10 +570,11 @@ void nfs_client_impl::end_copy(::dsn::error_code err,
             }
         }
 
-        // put write requests into queue
+        // put write requests into the pipeline of the disk
         if (!new_writes.empty()) {
             zauto_lock l(_local_writes_lock);
-            _local_writes.insert(_local_writes.end(), new_writes.begin(), new_writes.end());
+            auto &writes = _local_writes[fc->user_req->file_size_req.dest_disk_tag].writes;
+            writes.insert(writes.end(), new_writes.begin(), new_writes.end());
             _buffered_local_write_count += new_writes.size();
         }
     }
@@ -425,47 +583,100 @@ void nfs_client_impl::end_copy(::dsn::error_code err,
     continue_write();
 }
 
+error_code nfs_client_impl::verify_chunk(const copy_response &resp,
+                                         const copy_request_ex_ptr &reqc)
+{
+    const file_context_ptr &fc = reqc->file_ctx;
+    if (static_cast<uint64_t>(resp.offset) != reqc->offset ||
+        static_cast<uint32_t>(resp.size) != reqc->size ||
+        resp.file_content.length() < reqc->size) {
+        LOG_ERROR("[nfs_service] remote copy returns an unexpected chunk, source = {}({}), "
+                  "file = {}, expected = [{}, +{}], actual = [{}, +{}, length = {}]",
+                  fc->user_req->file_size_req.hp_source,
+                  fc->user_req->file_size_req.source,
+                  fc->file_name,
+                  reqc->offset,
+                  reqc->size,
+                  resp.offset,
+                  resp.size,
+                  resp.file_content.length());
+        return ERR_INVALID_DATA;
+    }
+
+    reqc->checksum = utils::crc32_calc(resp.file_content.data(), reqc->size, 0);
+    // The checksum is not returned by the old servers.
+    if (resp.__isset.checksum && static_cast<uint32_t>(resp.checksum) != reqc->checksum) {
+        METRIC_VAR_INCREMENT(nfs_client_checksum_mismatched_chunks);
+        LOG_ERROR("[nfs_service] checksum of the chunk mismatched, source = {}({}), file = {}, "
+                  "chunk = [{}, +{}], remote_checksum = {:#010x}, local_checksum = {:#010x}",
+                  fc->user_req->file_size_req.hp_source,
+                  fc->user_req->file_size_req.source,
+                  fc->file_name,
+                  reqc->offset,
+                  reqc->size,
+                  static_cast<uint32_t>(resp.checksum),
+                  reqc->checksum);
+        return ERR_CORRUPTION;
+    }
+    return ERR_OK;
+}
+
 void nfs_client_impl::continue_write()
 {
-    // check write quota
-    if (++_concurrent_local_write_count > FLAGS_max_concurrent_local_writes) {
-        // exceed max_concurrent_local_writes limit, pause.
-        // the copy task will be triggered by continue_write() invoked in
-        // local_write_callback().
-        --_concurrent_local_write_count;
-        return;
+    // Keep the pipelines of all the disks full.
+    while (true) {
+        copy_request_ex_ptr reqc = pop_local_write();
+        if (reqc == nullptr) {
+            return;
+        }
+        write_chunk(reqc);
     }
+}
 
-    // get write data
-    copy_request_ex_ptr reqc;
+nfs_client_impl::copy_request_ex_ptr nfs_client_impl::pop_local_write()
+{
     while (true) {
+        copy_request_ex_ptr reqc;
         {
             zauto_lock l(_local_writes_lock);
-            if (!_local_writes.empty()) {
-                reqc = _local_writes.front();
-                _local_writes.pop_front();
-                --_buffered_local_write_count;
-            } else {
-                // no write data
-                reqc = nullptr;
-                break;
+            for (auto &disk_writes : _local_writes) {
+                auto &pipeline = disk_writes.second;
+                // check write quota of the disk
+                if (!pipeline.writes.empty() &&
+                    pipeline.concurrent_write_count < FLAGS_max_concurrent_local_writes) {
+                    reqc = pipeline.writes.front();
+                    pipeline.writes.pop_front();
+                    ++pipeline.concurrent_write_count;
+                    --_buffered_local_write_count;
+                    break;
+                }
             }
         }
 
+        if (nullptr == reqc) {
+            // no write data, or all the disks with write data are busy
+            return nullptr;
+        }
+
         {
             // only process valid request, and discard invalid request
             zauto_lock l(reqc->lock);
             if (reqc->is_valid) {
-                break;
+                return reqc;
             }
         }
+        release_local_write(reqc);
     }
+}
 
-    if (nullptr == reqc) {
-        --_concurrent_local_write_count;
-        return;
-    }
+void nfs_client_impl::release_local_write(const copy_request_ex_ptr &reqc)
+{
+    zauto_lock l(_local_writes_lock);
+    --_local_writes[reqc->file_ctx->user_req->file_size_req.dest_disk_tag].concurrent_write_count;
+}
 
+void nfs_client_impl::write_chunk(const copy_request_ex_ptr &reqc)
+{
     // real write
     const file_context_ptr &fc = reqc->file_ctx;
     std::string file_path =
@@ -482,7 +693,7 @@ void nfs_client_impl::continue_write()
     }
 
     if (!fc->file_holder->file_handle) {
-        --_concurrent_local_write_count;
+        release_local_write(reqc);
         LOG_ERROR("open file {} failed", file_path);
         handle_completion(fc->user_req, ERR_FILE_OPERATION_FAILED);
     } else {
@@ -510,14 +721,14 @@ void nfs_client_impl::continue_write()
                                                      }
                                                  });
         } else {
-            --_concurrent_local_write_count;
+            release_local_write(reqc);
         }
     }
 }
 
 void nfs_client_impl::end_write(error_code err, size_t sz, const copy_request_ex_ptr &reqc)
 {
-    --_concurrent_local_write_count;
+    release_local_write(reqc);
 
     // clear content to release memory quickly
     reqc->response.file_content = blob();
@@ -538,6 +749,10 @@ void nfs_client_impl::end_write(error_code err, size_t sz, const copy_request_ex
 
         file_wrapper_ptr temp_holder;
         zauto_lock l(fc->user_req->user_req_lock);
+        if (!fc->user_req->is_finished) {
+            reqc->is_written = true;
+            update_copy_progress(fc);
+        }
         if (!fc->user_req->is_finished &&
             ++fc->finished_segments == (int)fc->copy_requests.size()) {
             // release file to make it closed immediately after write done.
@@ -571,7 +786,11 @@ void nfs_client_impl::handle_completion(const user_request_ptr &req, error_code
     size_t total_size = 0;
     for (file_context_ptr &fc : req->file_contexts) {
         total_size += fc->file_size;
-        if (err != ERR_OK) {
+        if (err == ERR_OK) {
+            // The progress is useless once all the files are copied.
+            utils::filesystem::remove_path(file_copy_progress::path_of(
+                utils::filesystem::path_combine(req->file_size_req.dst_dir, fc->file_name)));
+        } else {
             // mark all copy_requests to be invalid
             for (const copy_request_ex_ptr &rc : fc->copy_requests) {
                 zauto_lock l(rc->lock);
@@ -589,6 +808,38 @@ void nfs_client_impl::handle_completion(const user_request_ptr &req, error_code
     req->nfs_task->enqueue(err, err == ERR_OK ? total_size : 0);
 }
 
+void nfs_client_impl::update_copy_progress(const file_context_ptr &fc)
+{
+    const int old_written_segments = fc->written_segments;
+    while (fc->written_segments < static_cast<int>(fc->copy_requests.size()) &&
+           fc->copy_requests[fc->written_segments]->is_written) {
+        fc->progress.checksums.push_back(fc->copy_requests[fc->written_segments]->checksum);
+        ++fc->written_segments;
+    }
+    // The progress could not be resumed without the last modified time of the remote file.
+    if (fc->written_segments == old_written_segments || !FLAGS_resume_partially_copied_files ||
+        fc->progress.source_mtime == 0) {
+        return;
+    }
+
+    const uint64_t unpersisted_bytes =
+        static_cast<uint64_t>(fc->written_segments - fc->persisted_segments) *
+        FLAGS_nfs_copy_block_bytes;
+    const uint64_t persist_interval_bytes =
+        static_cast<uint64_t>(FLAGS_copy_progress_persist_interval_mb) << 20;
+    if (fc->written_segments < static_cast<int>(fc->copy_requests.size()) &&
+        unpersisted_bytes < persist_interval_bytes) {
+        return;
+    }
+
+    // It's fine to fail to persist the progress, which just makes less chunks resumable.
+    const auto progress_path = file_copy_progress::path_of(
+        utils::filesystem::path_combine(fc->user_req->file_size_req.dst_dir, fc->file_name));
+    if (utils::dump_rjobj_to_file(fc->progress, progress_path) == ERR_OK) {
+        fc->persisted_segments = fc->written_segments;
+    }
+}
+
 // todo(jiashuo1) just for compatibility with scripts, such as
 // https://github.com/apache/incubator-pegasus/blob/v2.3/scripts/pegasus_offline_node_list.sh
 void nfs_client_impl::register_cli_commands()
@@ -32,6 +32,7 @@
 #include <chrono>
 #include <deque>
 #include <list>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
@@ -39,6 +40,7 @@
 
 #include "aio/aio_task.h"
 #include "aio/file_io.h"
+#include "nfs/nfs_copy_progress.h"
 #include "nfs_code_definition.h"
 #include "nfs_types.h"
 #include "runtime/rpc/rpc_address.h"
@@ -123,9 +125,11 @@ public:
         uint32_t size;
         bool is_last;
         copy_response response;
+        uint32_t checksum; // crc32 of the response content, verified against the server's
         ::dsn::task_ptr remote_copy_task;
         ::dsn::task_ptr local_write_task;
         bool is_ready_for_write;
+        bool is_written;
         bool is_valid;
         int retry_count;
         zlock lock; // to protect is_valid
@@ -137,7 +141,9 @@ public:
             offset = 0;
             size = 0;
             is_last = false;
+            checksum = 0;
             is_ready_for_write = false;
+            is_written = false;
             is_valid = true;
             retry_count = try_count;
         }
@@ -155,6 +161,12 @@ public:
         int finished_segments;
         std::vector<copy_request_ex_ptr> copy_requests;
 
+        // The progress of the file, the checksums of the chunks resumed from the last copy are
+        // followed by the ones of the written prefix of 'copy_requests'.
+        file_copy_progress progress;
+        int written_segments;   // the count of the written prefix of 'copy_requests'
+        int persisted_segments; // 'written_segments' when the progress was persisted last time
+
         file_context(const user_request_ptr &req, const std::string &file_nm, uint64_t sz)
         {
             user_req = req;
@@ -163,6 +175,8 @@ public:
             file_holder = new file_wrapper();
             current_write_index = -1;
             finished_segments = 0;
+            written_segments = 0;
+            persisted_segments = 0;
         }
     };
 
@@ -267,6 +281,14 @@ public:
         bool empty() { return total_count == 0; }
     };
 
+    // The local writes to the same disk, whose concurrency is limited separately from the other
+    // disks, so that a slow disk would not stall the writes to the others.
+    struct local_write_pipeline
+    {
+        std::deque<copy_request_ex_ptr> writes;
+        int concurrent_write_count = 0;
+    };
+
 public:
     nfs_client_impl();
     virtual ~nfs_client_impl();
@@ -279,15 +301,40 @@ private:
                            const ::dsn::service::get_file_size_response &resp,
                            const user_request_ptr &ureq);
 
+    // Split the files into chunks and put the copy requests of the chunks into the queue. The
+    // chunks copied by the last interrupted copy are skipped if they are still valid.
+    void prepare_copy_requests(const ::dsn::service::get_file_size_response &resp,
+                               const user_request_ptr &ureq);
+
+    // Load the progress of the last copy of the file, and return the count of the leading chunks
+    // whose local content is still consistent with the progress. The local file and its progress
+    // are removed if nothing could be resumed.
+    uint64_t resume_file_copy(const file_context_ptr &fc, uint64_t chunk_count);
+
     void continue_copy();
 
     void
     end_copy(::dsn::error_code err, const copy_response &resp, const copy_request_ex_ptr &reqc);
 
+    // Check the chunk received from the server, the checksum of the chunk is saved into 'reqc'.
+    error_code verify_chunk(const copy_response &resp, const copy_request_ex_ptr &reqc);
+
     void continue_write();
 
+    // Pop a valid local write from the pipeline of a disk whose concurrency is not exhausted,
+    // return nullptr if there is none.
+    copy_request_ex_ptr pop_local_write();
+
+    void write_chunk(const copy_request_ex_ptr &reqc);
+
     void end_write(error_code err, size_t sz, const copy_request_ex_ptr &reqc);
 
+    void release_local_write(const copy_request_ex_ptr &reqc);
+
+    // Persist the progress of the file if enough chunks are written since the last time.
+    // Preconditions: the user_req_lock of the user request is held.
+    void update_copy_progress(const file_context_ptr &fc);
+
     void handle_completion(const user_request_ptr &req, error_code err);
 
     void register_cli_commands();
@@ -298,8 +345,6 @@ private:
 
     std::atomic<int> _concurrent_copy_request_count; // record concurrent request count, limited
                                                      // by max_concurrent_remote_copy_requests.
-    std::atomic<int> _concurrent_local_write_count;  // record concurrent write count, limited
-                                                     // by max_concurrent_local_writes.
     std::atomic<int> _buffered_local_write_count;    // record current buffered write count, limited
                                                      // by max_buffered_local_writes.
 
@@ -309,10 +354,14 @@ private:
     int _high_priority_remaining_time;
 
     zlock _local_writes_lock;
-    std::deque<copy_request_ex_ptr> _local_writes;
+    // dest_disk_tag -> the pipeline of the disk, the concurrent write count of each pipeline is
+    // limited by max_concurrent_local_writes.
+    std::map<std::string, local_write_pipeline> _local_writes;
 
     METRIC_VAR_DECLARE_counter(nfs_client_copy_bytes);
     METRIC_VAR_DECLARE_counter(nfs_client_copy_failed_requests);
+    METRIC_VAR_DECLARE_counter(nfs_client_checksum_mismatched_chunks);
+    METRIC_VAR_DECLARE_counter(nfs_client_resumed_bytes);
     METRIC_VAR_DECLARE_counter(nfs_client_write_bytes);
     METRIC_VAR_DECLARE_counter(nfs_client_failed_writes);
 
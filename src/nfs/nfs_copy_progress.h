@@ -0,0 +1,50 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "common/json_helper.h"
+
+namespace dsn {
+namespace service {
+
+// The progress of copying a remote file, which is persisted beside the local file while copying,
+// so that the copy could be resumed from the last copied chunk after an interruption. It's removed
+// once all the files of the copy request are copied successfully.
+struct file_copy_progress
+{
+    // The identity of the remote file.
+    std::string source;
+    std::string source_path;
+    int64_t source_mtime = 0;
+    int64_t file_size = 0;
+    uint32_t block_bytes = 0;
+    // The crc32 of each copied chunk, in the order of the offset.
+    std::vector<uint32_t> checksums;
+    DEFINE_JSON_SERIALIZATION(source, source_path, source_mtime, file_size, block_bytes, checksums)
+
+    static std::string path_of(const std::string &file_path) { return file_path + kSuffix; }
+
+    static const std::string kSuffix;
+};
+
+} // namespace service
+} // namespace dsn
@@ -25,12 +25,18 @@
  */
 
 #include <algorithm>
+#include <unordered_set>
 #include <utility>
 
 #include "aio/file_io.h"
+#include "nfs/nfs_copy_progress.h"
 #include "nfs/nfs_node.h"
 #include "nfs_node_simple.h"
 #include "utils/autoref_ptr.h"
+#include "utils/filesystem.h"
+#include "utils/flags.h"
+
+DSN_DECLARE_bool(resume_partially_copied_files);
 
 namespace dsn {
 class task_tracker;
@@ -109,4 +115,39 @@ aio_task_ptr nfs_node::copy_remote_files(std::shared_ptr<remote_copy_request> &r
     call(request, cb);
     return cb;
 }
+
+void nfs_node::clean_dir_for_resuming_copy(const std::string &dest_dir,
+                                           const std::vector<std::string> &files)
+{
+    std::unordered_set<std::string> resumable_files;
+    if (FLAGS_resume_partially_copied_files) {
+        for (const auto &file : files) {
+            const auto file_path = utils::filesystem::path_combine(dest_dir, file);
+            const auto progress_path = service::file_copy_progress::path_of(file_path);
+            if (utils::filesystem::file_exists(progress_path)) {
+                std::string npath;
+                utils::filesystem::get_normalized_path(file_path, npath);
+                resumable_files.insert(npath);
+                utils::filesystem::get_normalized_path(progress_path, npath);
+                resumable_files.insert(npath);
+            }
+        }
+    }
+
+    std::vector<std::string> sub_files;
+    if (resumable_files.empty() ||
+        !utils::filesystem::get_subfiles(dest_dir, sub_files, /* recursive */ true)) {
+        utils::filesystem::remove_path(dest_dir);
+        return;
+    }
+
+    // Whether the resumable files are still valid is checked by the next copy.
+    for (const auto &sub_file : sub_files) {
+        std::string npath;
+        utils::filesystem::get_normalized_path(sub_file, npath);
+        if (resumable_files.count(npath) == 0) {
+            utils::filesystem::remove_path(sub_file);
+        }
+    }
+}
 }
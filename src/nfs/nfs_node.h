@@ -99,6 +99,12 @@ public:
                                    aio_handler &&callback,
                                    int hash = 0);
 
+    // Prepare 'dest_dir' for copying 'files' (relative to 'dest_dir') into it: everything in it is
+    // removed except the files partially copied by the last interrupted copy, which could be
+    // resumed by the next copy_remote_files() with the same source.
+    static void clean_dir_for_resuming_copy(const std::string &dest_dir,
+                                            const std::vector<std::string> &files);
+
     nfs_node() {}
     virtual ~nfs_node() {}
     virtual error_code start() = 0;
@@ -29,6 +29,7 @@
 // IWYU pragma: no_include <ext/alloc_traits.h>
 #include <chrono>
 #include <cstdint>
+#include <ctime>
 #include <mutex>
 #include <type_traits>
 #include <vector>
@@ -39,6 +40,7 @@
 #include "runtime/task/async_calls.h"
 #include "utils/TokenBucket.h"
 #include "utils/autoref_ptr.h"
+#include "utils/crc.h"
 #include "utils/env.h"
 #include "utils/filesystem.h"
 #include "utils/flags.h"
@@ -127,6 +129,7 @@ void nfs_service_impl::on_copy(const ::dsn::service::copy_request &request,
     cp->file_path = std::move(file_path);
     cp->offset = request.offset;
     cp->size = request.size;
+    cp->need_checksum = request.__isset.need_checksum && request.need_checksum;
 
     auto buffer_save = cp->bb.buffer().get();
 
@@ -170,6 +173,12 @@ void nfs_service_impl::internal_read_callback(error_code err, size_t sz, callbac
     resp.file_content = std::move(cp.bb);
     resp.offset = cp.offset;
     resp.size = cp.size;
+    if (err == ERR_OK && cp.need_checksum) {
+        // Only the bytes actually read are checksummed, thus a short read would be detected by
+        // the client.
+        resp.__set_checksum(
+            static_cast<int32_t>(utils::crc32_calc(resp.file_content.data(), sz, 0)));
+    }
 
     cp.replier(resp);
 }
@@ -182,6 +191,16 @@ void nfs_service_impl::on_get_file_size(
     get_file_size_response resp;
     error_code err = ERR_OK;
     std::string folder = request.source_dir;
+    std::vector<int64_t> mtime_list;
+    bool has_mtime = true;
+    const auto add_mtime = [&mtime_list, &has_mtime](const std::string &file_path) {
+        time_t mtime;
+        if (has_mtime && dsn::utils::filesystem::last_write_time(file_path, mtime)) {
+            mtime_list.push_back(mtime);
+        } else {
+            has_mtime = false;
+        }
+    };
     // TODO(yingchun): refactor the following code!
     if (request.file_list.size() == 0) // return all file size in the destination file folder
     {
@@ -208,6 +227,7 @@ void nfs_service_impl::on_get_file_size(
                     resp.size_list.push_back(sz);
                     resp.file_list.push_back(
                         fpath.substr(request.source_dir.length(), fpath.length() - 1));
+                    add_mtime(fpath);
                 }
             }
         }
@@ -228,9 +248,13 @@ void nfs_service_impl::on_get_file_size(
             resp.file_list.push_back(
                 (folder + file_name)
                     .substr(request.source_dir.length(), (folder + file_name).length() - 1));
+            add_mtime(file_path);
         }
     }
 
+    if (err == ERR_OK && has_mtime) {
+        resp.__set_mtime_list(std::move(mtime_list));
+    }
     resp.error = err;
     reply(resp);
 }
@@ -88,15 +88,20 @@ private:
         blob bb;
         uint64_t offset;
         uint32_t size;
+        bool need_checksum;
         rpc_replier<copy_response> replier;
 
-        callback_para(rpc_replier<copy_response> &&r) : offset(0), size(0), replier(std::move(r)) {}
+        callback_para(rpc_replier<copy_response> &&r)
+            : offset(0), size(0), need_checksum(false), replier(std::move(r))
+        {
+        }
         callback_para(callback_para &&r)
             : file_path(std::move(r.file_path)),
               dst_dir(std::move(r.dst_dir)),
               bb(std::move(r.bb)),
               offset(r.offset),
               size(r.size),
+              need_checksum(r.need_checksum),
               replier(std::move(r.replier))
         {
             r.offset = 0;
@@ -24,10 +24,12 @@
  * THE SOFTWARE.
  */
 
+#include <rocksdb/env.h>
 #include <rocksdb/status.h>
 #include <stddef.h>
 #include <algorithm>
 #include <cstdint>
+#include <ctime>
 #include <memory>
 #include <string>
 #include <utility>
@@ -36,6 +38,8 @@
 #include "aio/aio_task.h"
 #include "common/gpid.h"
 #include "gtest/gtest.h"
+#include "nfs/nfs_client_impl.h"
+#include "nfs/nfs_copy_progress.h"
 #include "nfs/nfs_node.h"
 #include "runtime/app_model.h"
 #include "runtime/rpc/rpc_host_port.h"
@@ -43,13 +47,16 @@
 #include "runtime/tool_api.h"
 #include "test_util/test_util.h"
 #include "utils/autoref_ptr.h"
+#include "utils/crc.h"
 #include "utils/env.h"
 #include "utils/error_code.h"
 #include "utils/filesystem.h"
 #include "utils/flags.h"
+#include "utils/load_dump_object.h"
 #include "utils/threadpool_code.h"
 
 DSN_DECLARE_bool(encrypt_data_at_rest);
+DSN_DECLARE_uint32(nfs_copy_block_bytes);
 
 using namespace dsn;
 
@@ -248,6 +255,100 @@ TEST_P(nfs_test, basic)
     nfs->stop();
 }
 
+TEST_P(nfs_test, resume_partially_copied_files)
+{
+    auto nfs = dsn::nfs_node::create();
+    nfs->start();
+    nfs->register_async_rpc_handler_for_test();
+
+    const std::string kDstDir = "nfs_test_resume_dir";
+    const dsn::host_port kSource("localhost", 20101);
+    ASSERT_TRUE(utils::filesystem::remove_path(kDstDir));
+    ASSERT_TRUE(utils::filesystem::create_directory(kDstDir));
+
+    std::vector<std::string> src_filenames({"nfs_test_file1", "nfs_test_file2"});
+    if (FLAGS_encrypt_data_at_rest) {
+        for (auto &src_filename : src_filenames) {
+            auto s = dsn::utils::encrypt_file(src_filename, src_filename + ".encrypted");
+            ASSERT_TRUE(s.ok()) << s.ToString();
+            src_filename += ".encrypted";
+        }
+    }
+
+    // Prepare the files partially copied by the last copy, whose content is different from the
+    // source files, but consistent with their progress.
+    std::vector<std::string> src_contents;
+    std::vector<std::string> stale_contents;
+    for (size_t i = 0; i < src_filenames.size(); i++) {
+        const auto &src_filename = src_filenames[i];
+        std::string content;
+        auto s = rocksdb::ReadFileToString(
+            dsn::utils::PegasusEnv(dsn::utils::FileDataType::kSensitive), src_filename, &content);
+        ASSERT_TRUE(s.ok()) << s.ToString();
+        src_contents.push_back(content);
+        std::reverse(content.begin(), content.end());
+        ASSERT_NE(src_contents.back(), content);
+        stale_contents.push_back(content);
+
+        const auto dst_filename = utils::filesystem::path_combine(kDstDir, src_filename);
+        s = rocksdb::WriteStringToFile(
+            dsn::utils::PegasusEnv(dsn::utils::FileDataType::kSensitive), content, dst_filename);
+        ASSERT_TRUE(s.ok()) << s.ToString();
+
+        time_t mtime;
+        ASSERT_TRUE(utils::filesystem::last_write_time(src_filename, mtime));
+        dsn::service::file_copy_progress progress;
+        progress.source = kSource.to_string();
+        progress.source_path = utils::filesystem::path_combine(".", src_filename);
+        // The 2nd file has been modified since the last copy, thus it could not be resumed.
+        progress.source_mtime = (i == 0 ? mtime : mtime - 1);
+        progress.file_size = static_cast<int64_t>(content.size());
+        progress.block_bytes = FLAGS_nfs_copy_block_bytes;
+        progress.checksums.push_back(utils::crc32_calc(content.data(), content.size(), 0));
+        ASSERT_EQ(ERR_OK,
+                  utils::dump_rjobj_to_file(
+                      progress, dsn::service::file_copy_progress::path_of(dst_filename)));
+    }
+
+    aio_result r;
+    auto t = nfs->copy_remote_files(kSource,
+                                    "default",
+                                    ".",
+                                    src_filenames,
+                                    "default",
+                                    kDstDir,
+                                    gpid(1, 0),
+                                    true,
+                                    false,
+                                    LPC_AIO_TEST_NFS,
+                                    nullptr,
+                                    [&r](dsn::error_code err, size_t sz) {
+                                        r.err = err;
+                                        r.sz = sz;
+                                    },
+                                    0);
+    ASSERT_NE(nullptr, t);
+    ASSERT_TRUE(t->wait(20000));
+    ASSERT_EQ(ERR_OK, r.err);
+
+    // The 1st file is resumed without being requested, while the 2nd one is copied again.
+    for (size_t i = 0; i < src_filenames.size(); i++) {
+        const auto dst_filename = utils::filesystem::path_combine(kDstDir, src_filenames[i]);
+        std::string content;
+        auto s = rocksdb::ReadFileToString(
+            dsn::utils::PegasusEnv(dsn::utils::FileDataType::kSensitive), dst_filename, &content);
+        ASSERT_TRUE(s.ok()) << s.ToString();
+        ASSERT_EQ(i == 0 ? stale_contents[i] : src_contents[i], content);
+    }
+
+    // The progress files are removed after all the files are copied.
+    std::vector<std::string> dst_filenames;
+    ASSERT_TRUE(utils::filesystem::get_subfiles(kDstDir, dst_filenames, true));
+    ASSERT_EQ(src_filenames.size(), dst_filenames.size());
+
+    nfs->stop();
+}
+
 int g_test_ret = 0;
 GTEST_API_ int main(int argc, char **argv)
 {
@@ -31,8 +31,11 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdint>
+#include <iterator>
+#include <map>
 
 #include "absl/strings/string_view.h"
+#include "client/partition_resolver.h"
 #include "common/common.h"
 #include "common/replication_other_types.h"
 #include "pegasus/client.h"
@@ -43,15 +46,51 @@
 #include "utils/api_utilities.h"
 #include "utils/binary_writer.h"
 #include "utils/error_code.h"
+#include "utils/flags.h"
 #include "utils/fmt_logging.h"
 #include "utils/ports.h"
 #include "utils/string_conv.h"
 #include "utils/strings.h"
 #include "utils/utils.h"
 
+DSN_DEFINE_uint32(pegasus.proxy,
+                  max_batch_get_keys,
+                  100,
+                  "The max count of the keys read by a batch_get RPC, into which the reads of the "
+                  "pipelined GET/MGET/HGET/HMGET commands in the same partition are coalesced");
+DSN_TAG_VARIABLE(max_batch_get_keys, FT_MUTABLE);
+DSN_DEFINE_validator(max_batch_get_keys, [](uint32_t value) -> bool { return value > 0; });
+DSN_DEFINE_bool(pegasus.proxy,
+                route_by_key_hash,
+                false,
+                "Whether to send the requests on a key to the partition of its hash like the "
+                "native clients, otherwise to partition 0 like the proxy of the older versions. "
+                "The data written with it disabled is unreachable once it's enabled, see "
+                "config.ini of the proxy for the migration");
+DSN_DEFINE_int32(pegasus.proxy,
+                 proxy_rpc_timeout_ms,
+                 2000,
+                 "The timeout in milliseconds of the RPCs sent to the Pegasus cluster for the "
+                 "Redis commands");
+DSN_TAG_VARIABLE(proxy_rpc_timeout_ms, FT_MUTABLE);
+DSN_DEFINE_validator(proxy_rpc_timeout_ms, [](int32_t value) -> bool { return value > 0; });
+
 namespace pegasus {
 namespace proxy {
 
+namespace {
+std::chrono::milliseconds rpc_timeout()
+{
+    return std::chrono::milliseconds(FLAGS_proxy_rpc_timeout_ms);
+}
+
+// The partition hash of the requests on a key, whose hash is 'key_hash'.
+uint64_t request_partition_hash(uint64_t key_hash)
+{
+    return FLAGS_route_by_key_hash ? key_hash : 0;
+}
+} // anonymous namespace
+
 std::atomic_llong redis_parser::s_next_seqid(0);
 const char redis_parser::CR = '\015';
 const char redis_parser::LF = '\012';
@@ -72,6 +111,14 @@ std::unordered_map<std::string, redis_parser::redis_call_handler> redis_parser::
     {"INCRBY", redis_parser::g_incr_by},
     {"DECR", redis_parser::g_decr},
     {"DECRBY", redis_parser::g_decr_by},
+    {"MGET", redis_parser::g_mget},
+    {"MSET", redis_parser::g_mset},
+    {"MDEL", redis_parser::g_del},
+    {"HGET", redis_parser::g_hget},
+    {"HMGET", redis_parser::g_hmget},
+    {"HSET", redis_parser::g_hset},
+    {"HMSET", redis_parser::g_hset},
+    {"HDEL", redis_parser::g_hdel},
 };
 
 redis_parser::redis_call_handler redis_parser::get_handler(const char *command, unsigned int length)
@@ -332,7 +379,11 @@ bool redis_parser::parse_stream()
 bool redis_parser::parse(dsn::message_ex *msg)
 {
     append_message(msg);
-    if (parse_stream()) {
+    bool ok = parse_stream();
+    // the responses of the parsed commands have been queued in order, thus their reads could be
+    // sent in any order
+    send_pending_reads();
+    if (ok) {
         return true;
     } else {
         // when parse a new message failed, we only reset the parser.
@@ -388,6 +439,238 @@ void redis_parser::reply_all_ready()
     }
 }
 
+void redis_parser::add_pending_read(const std::shared_ptr<multi_key_command> &command,
+                                    size_t index,
+                                    const ::dsn::blob &hash_key,
+                                    const ::dsn::blob &sort_key)
+{
+    pending_read read;
+    read.command = command;
+    read.index = index;
+    read.hash_key = hash_key;
+    read.sort_key = sort_key;
+    ::dsn::blob key;
+    pegasus_generate_key(key, hash_key, sort_key);
+    read.partition_hash = request_partition_hash(pegasus_key_hash(key));
+    _pending_reads.emplace_back(std::move(read));
+}
+
+void redis_parser::send_pending_reads()
+{
+    if (_pending_reads.empty()) {
+        return;
+    }
+
+    std::vector<pending_read> reads;
+    reads.swap(_pending_reads);
+
+    // Before the partition count is resolved, the reads are grouped by the partition hash, which
+    // still coalesces the reads on the same hash key.
+    const int partition_count = client->get_partition_count();
+    std::unordered_map<uint64_t, std::vector<pending_read>> partition_reads;
+    for (auto &read : reads) {
+        uint64_t partition = read.partition_hash;
+        if (partition_count > 0) {
+            partition = dsn::replication::partition_resolver::get_partition_index(
+                partition_count, read.partition_hash);
+        }
+        partition_reads[partition].emplace_back(std::move(read));
+    }
+
+    const size_t max_batch_keys = FLAGS_max_batch_get_keys;
+    for (auto &kv : partition_reads) {
+        auto &group = kv.second;
+        for (size_t begin = 0; begin < group.size(); begin += max_batch_keys) {
+            const size_t end = std::min(group.size(), begin + max_batch_keys);
+            if (end - begin == 1) {
+                send_get(std::move(group[begin]));
+            } else {
+                send_batch_get(std::vector<pending_read>(
+                    std::make_move_iterator(group.begin() + begin),
+                    std::make_move_iterator(group.begin() + end)));
+            }
+        }
+    }
+}
+
+void redis_parser::send_get(pending_read &&read)
+{
+    LOG_DEBUG_PREFIX("send GET for command seqid({})", read.command->entry.sequence_id);
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    auto on_get_reply = [ ref_this, this, command = read.command, index = read.index ](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response)
+    {
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            LOG_INFO_PREFIX("GET for command seqid({}) got reply, but session has reset",
+                            command->entry.sequence_id);
+            return;
+        }
+
+        auto &result = command->results[index];
+        if (::dsn::ERR_OK != ec) {
+            LOG_INFO_PREFIX("GET for command seqid({}) got reply with error = {}",
+                            command->entry.sequence_id,
+                            ec);
+            result.error = ec.to_string();
+        } else {
+            ::dsn::apps::read_response rrdb_response;
+            ::dsn::unmarshall(response, rrdb_response);
+            if (rrdb_response.error == 0) {
+                result.value = std::make_shared<redis_bulk_string>(rrdb_response.value);
+            } else if (rrdb_response.error == rocksdb::Status::kNotFound) {
+                result.value = std::make_shared<redis_bulk_string>();
+            } else {
+                result.error = "internal error " + std::to_string(rrdb_response.error);
+            }
+        }
+        on_key_done(command);
+    };
+
+    ::dsn::blob req;
+    pegasus_generate_key(req, read.hash_key, read.sort_key);
+    client->get(req, on_get_reply, rpc_timeout(), read.partition_hash);
+}
+
+void redis_parser::send_batch_get(std::vector<pending_read> &&reads)
+{
+    LOG_DEBUG_PREFIX("send BATCH_GET for {} keys", reads.size());
+    ::dsn::apps::batch_get_request req;
+    req.keys.reserve(reads.size());
+    for (const auto &read : reads) {
+        ::dsn::apps::full_key key;
+        key.hash_key = read.hash_key;
+        key.sort_key = read.sort_key;
+        req.keys.emplace_back(std::move(key));
+    }
+    // all the keys are in the same partition
+    const uint64_t partition_hash = reads.front().partition_hash;
+
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    auto on_batch_get_reply = [ ref_this, this, reads = std::move(reads) ](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response)
+    {
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            LOG_INFO_PREFIX("BATCH_GET for {} keys got reply, but session has reset",
+                            reads.size());
+            return;
+        }
+
+        std::string error;
+        ::dsn::apps::batch_get_response rrdb_response;
+        if (::dsn::ERR_OK != ec) {
+            LOG_INFO_PREFIX("BATCH_GET for {} keys got reply with error = {}", reads.size(), ec);
+            error = ec.to_string();
+        } else {
+            ::dsn::unmarshall(response, rrdb_response);
+            if (rrdb_response.error != 0) {
+                error = "internal error " + std::to_string(rrdb_response.error);
+            }
+        }
+
+        // the keys not found are absent from the response
+        std::map<std::pair<absl::string_view, absl::string_view>, const ::dsn::blob *> values;
+        for (const auto &data : rrdb_response.data) {
+            values.emplace(
+                std::make_pair(data.hash_key.to_string_view(), data.sort_key.to_string_view()),
+                &data.value);
+        }
+        for (const auto &read : reads) {
+            auto &result = read.command->results[read.index];
+            if (!error.empty()) {
+                result.error = error;
+            } else {
+                auto iter = values.find(
+                    std::make_pair(read.hash_key.to_string_view(), read.sort_key.to_string_view()));
+                result.value = iter == values.end()
+                                   ? std::make_shared<redis_bulk_string>()
+                                   : std::make_shared<redis_bulk_string>(*iter->second);
+            }
+            on_key_done(read.command);
+        }
+    };
+
+    client->batch_get(req, on_batch_get_reply, rpc_timeout(), partition_hash);
+}
+
+void redis_parser::on_update_reply(const std::shared_ptr<multi_key_command> &command,
+                                   size_t index,
+                                   ::dsn::error_code ec,
+                                   dsn::message_ex *response)
+{
+    if (_is_session_reset.load(std::memory_order_acquire)) {
+        LOG_INFO_PREFIX("command seqid({}) got reply, but session has reset",
+                        command->entry.sequence_id);
+        return;
+    }
+
+    auto &result = command->results[index];
+    if (::dsn::ERR_OK != ec) {
+        LOG_INFO_PREFIX(
+            "command seqid({}) got reply with error = {}", command->entry.sequence_id, ec);
+        result.error = ec.to_string();
+    } else {
+        ::dsn::apps::update_response rrdb_response;
+        ::dsn::unmarshall(response, rrdb_response);
+        if (rrdb_response.error != 0) {
+            result.error = "internal error " + std::to_string(rrdb_response.error);
+        }
+    }
+    on_key_done(command);
+}
+
+void redis_parser::on_key_done(const std::shared_ptr<multi_key_command> &command)
+{
+    // the last key done replies the command
+    if (command->pending_keys.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    message_entry &entry = command->entry;
+    if (command->type == multi_key_command::reply_type::kKeyCount) {
+        // Reply the count of the keys done successfully, unless all of them failed.
+        int64_t done_keys = 0;
+        for (const auto &result : command->results) {
+            if (result.error.empty()) {
+                ++done_keys;
+            }
+        }
+        if (done_keys == 0 && !command->results.empty()) {
+            simple_error_reply(entry, command->results.front().error);
+        } else {
+            simple_integer_reply(entry, done_keys);
+        }
+        return;
+    }
+
+    for (const auto &result : command->results) {
+        if (!result.error.empty()) {
+            simple_error_reply(entry, result.error);
+            return;
+        }
+    }
+
+    switch (command->type) {
+    case multi_key_command::reply_type::kValue:
+        reply_message(entry, *command->results.front().value);
+        break;
+    case multi_key_command::reply_type::kArray: {
+        redis_array result;
+        result.resize(command->results.size());
+        for (size_t i = 0; i < command->results.size(); ++i) {
+            result.array[i] = std::move(command->results[i].value);
+        }
+        reply_message(entry, result);
+        break;
+    }
+    case multi_key_command::reply_type::kOk:
+        simple_ok_reply(entry);
+        break;
+    case multi_key_command::reply_type::kKeyCount:
+        // replied above
+        break;
+    }
+}
+
 std::shared_ptr<redis_parser::redis_bulk_string> redis_parser::construct_bulk_string(double data)
 {
     std::string data_str(std::to_string(data));
@@ -486,9 +769,8 @@ void redis_parser::set_internal(redis_parser::message_entry &entry)
             req.expire_ts_seconds = 0;
         else
             req.expire_ts_seconds = ttl_seconds + utils::epoch_now();
-        auto partition_hash = pegasus_key_hash(req.key);
-        // TODO: set the timeout
-        client->put(req, on_set_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+        auto partition_hash = request_partition_hash(pegasus_key_hash(req.key));
+        client->put(req, on_set_reply, rpc_timeout(), partition_hash);
     }
 }
 
@@ -526,7 +808,7 @@ void redis_parser::set_geo_internal(message_entry &entry)
                                std::string(),                                  // ""  => sort_key
                                redis_request.sub_requests[2].data.to_string(), // value
                                set_callback,
-                               2000, // TODO: set the timeout
+                               FLAGS_proxy_rpc_timeout_ms,
                                ttl_seconds);
     }
 }
@@ -583,10 +865,9 @@ void redis_parser::setex(message_entry &entry)
         req.value = redis_req.sub_requests[3].data;
         req.expire_ts_seconds = pegasus::utils::epoch_now() + ttl_seconds;
 
-        auto partition_hash = pegasus_key_hash(req.key);
+        auto partition_hash = request_partition_hash(pegasus_key_hash(req.key));
 
-        // TODO: set the timeout
-        client->put(req, on_setex_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+        client->put(req, on_setex_reply, rpc_timeout(), partition_hash);
     }
 }
 
@@ -597,44 +878,220 @@ void redis_parser::get(message_entry &entry)
         LOG_INFO_PREFIX("GET command seqid({}) with invalid arguments", entry.sequence_id);
         simple_error_reply(entry, "wrong number of arguments for 'get' command");
     } else {
-        LOG_DEBUG_PREFIX("send GET command seqid({})", entry.sequence_id);
-        std::shared_ptr<proxy_session> ref_this = shared_from_this();
-        auto on_get_reply = [ref_this, this, &entry](
-            ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
-            if (_is_session_reset.load(std::memory_order_acquire)) {
-                LOG_INFO_PREFIX("GET command({}) got reply, but session has reset",
-                                entry.sequence_id);
-                return;
-            }
+        LOG_DEBUG_PREFIX("add GET command seqid({})", entry.sequence_id);
+        auto command = std::make_shared<multi_key_command>(
+            entry, multi_key_command::reply_type::kValue, 1);
+        add_pending_read(command, 0, redis_req.sub_requests[1].data, ::dsn::blob());
+    }
+}
 
-            if (::dsn::ERR_OK != ec) {
-                LOG_INFO_PREFIX(
-                    "GET command seqid({}) got reply with error = {}", entry.sequence_id, ec);
-                simple_error_reply(entry, ec.to_string());
-            } else {
-                ::dsn::apps::read_response rrdb_response;
-                ::dsn::unmarshall(response, rrdb_response);
-                if (rrdb_response.error != 0) {
-                    if (rrdb_response.error == rocksdb::Status::kNotFound) {
-                        reply_message(entry, redis_bulk_string());
-                    } else {
-                        simple_error_reply(entry,
-                                           "internal error " + std::to_string(rrdb_response.error));
-                    }
-                } else {
-                    reply_message(entry, redis_bulk_string(rrdb_response.value));
-                }
-            }
+// MGET key [key ...]
+void redis_parser::mget(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    if (redis_req.sub_requests.size() < 2) {
+        LOG_INFO_PREFIX("MGET command seqid({}) with invalid arguments", entry.sequence_id);
+        simple_error_reply(entry, "wrong number of arguments for 'mget' command");
+    } else {
+        LOG_DEBUG_PREFIX("add MGET command seqid({})", entry.sequence_id);
+        const size_t key_count = redis_req.sub_requests.size() - 1;
+        auto command = std::make_shared<multi_key_command>(
+            entry, multi_key_command::reply_type::kArray, key_count);
+        for (size_t i = 0; i < key_count; ++i) {
+            add_pending_read(command, i, redis_req.sub_requests[i + 1].data, ::dsn::blob());
+        }
+    }
+}
+
+// MSET key value [key value ...]
+void redis_parser::mset(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    if (redis_req.sub_requests.size() < 3 || redis_req.sub_requests.size() % 2 == 0) {
+        LOG_INFO_PREFIX("MSET command seqid({}) with invalid arguments", entry.sequence_id);
+        simple_error_reply(entry, "wrong number of arguments for 'mset' command");
+        return;
+    }
+    if (_geo_client != nullptr) {
+        simple_error_reply(entry, "'mset' command is not supported on GEO mode");
+        return;
+    }
+
+    LOG_DEBUG_PREFIX("send MSET command seqid({})", entry.sequence_id);
+    const size_t key_count = (redis_req.sub_requests.size() - 1) / 2;
+    auto command =
+        std::make_shared<multi_key_command>(entry, multi_key_command::reply_type::kOk, key_count);
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    // The keys are in different hash keys, which could not be written by a single RPC. Thus the
+    // keys are put concurrently, and the command is replied once all of them are done.
+    for (size_t i = 0; i < key_count; ++i) {
+        auto on_put_reply = [ref_this, this, command, i](
+            ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+            on_update_reply(command, i, ec, response);
         };
-        ::dsn::blob req;
-        ::dsn::blob null_blob;
-        pegasus_generate_key(req, redis_req.sub_requests[1].data, null_blob);
-        auto partition_hash = pegasus_key_hash(req);
-        // TODO: set the timeout
-        client->get(req, on_get_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+
+        ::dsn::apps::update_request req;
+        pegasus_generate_key(req.key, redis_req.sub_requests[2 * i + 1].data, ::dsn::blob());
+        req.value = redis_req.sub_requests[2 * i + 2].data;
+        req.expire_ts_seconds = 0;
+        client->put(
+            req, on_put_reply, rpc_timeout(), request_partition_hash(pegasus_key_hash(req.key)));
+    }
+}
+
+// HGET key field
+void redis_parser::hget(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    if (redis_req.sub_requests.size() != 3) {
+        LOG_INFO_PREFIX("HGET command seqid({}) with invalid arguments", entry.sequence_id);
+        simple_error_reply(entry, "wrong number of arguments for 'hget' command");
+    } else {
+        LOG_DEBUG_PREFIX("add HGET command seqid({})", entry.sequence_id);
+        auto command = std::make_shared<multi_key_command>(
+            entry, multi_key_command::reply_type::kValue, 1);
+        add_pending_read(
+            command, 0, redis_req.sub_requests[1].data, redis_req.sub_requests[2].data);
+    }
+}
+
+// HMGET key field [field ...]
+void redis_parser::hmget(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    if (redis_req.sub_requests.size() < 3) {
+        LOG_INFO_PREFIX("HMGET command seqid({}) with invalid arguments", entry.sequence_id);
+        simple_error_reply(entry, "wrong number of arguments for 'hmget' command");
+    } else {
+        LOG_DEBUG_PREFIX("add HMGET command seqid({})", entry.sequence_id);
+        const size_t field_count = redis_req.sub_requests.size() - 2;
+        auto command = std::make_shared<multi_key_command>(
+            entry, multi_key_command::reply_type::kArray, field_count);
+        for (size_t i = 0; i < field_count; ++i) {
+            add_pending_read(
+                command, i, redis_req.sub_requests[1].data, redis_req.sub_requests[i + 2].data);
+        }
     }
 }
 
+// process 'hset' and 'hmset':
+// HSET key field value [field value ...]
+// the field is stored as the sort key of the key.
+void redis_parser::hset(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    bool is_hmset = (toupper(redis_req.sub_requests[0].data.data()[1]) == 'M');
+    if (redis_req.sub_requests.size() < 4 || redis_req.sub_requests.size() % 2 != 0) {
+        LOG_INFO_PREFIX("HSET/HMSET command seqid({}) with invalid arguments", entry.sequence_id);
+        simple_error_reply(entry,
+                           fmt::format("wrong number of arguments for '{}' command",
+                                       is_hmset ? "hmset" : "hset"));
+        return;
+    }
+    if (_geo_client != nullptr) {
+        simple_error_reply(entry, "'hset' command is not supported on GEO mode");
+        return;
+    }
+
+    LOG_DEBUG_PREFIX("send HSET/HMSET command seqid({})", entry.sequence_id);
+    ::dsn::apps::multi_put_request req;
+    req.hash_key = redis_req.sub_requests[1].data;
+    req.expire_ts_seconds = 0;
+    req.kvs.reserve((redis_req.sub_requests.size() - 2) / 2);
+    for (size_t i = 2; i < redis_req.sub_requests.size(); i += 2) {
+        ::dsn::apps::key_value kv;
+        kv.key = redis_req.sub_requests[i].data;
+        kv.value = redis_req.sub_requests[i + 1].data;
+        req.kvs.emplace_back(std::move(kv));
+    }
+    const int64_t field_count = req.kvs.size();
+
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    auto on_hset_reply = [ref_this, this, &entry, is_hmset, field_count](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            LOG_INFO_PREFIX("HSET/HMSET command seqid({}) got reply, but session has reset",
+                            entry.sequence_id);
+            return;
+        }
+
+        if (::dsn::ERR_OK != ec) {
+            LOG_INFO_PREFIX(
+                "HSET/HMSET command seqid({}) got reply with error = {}", entry.sequence_id, ec);
+            simple_error_reply(entry, ec.to_string());
+            return;
+        }
+
+        ::dsn::apps::update_response rrdb_response;
+        ::dsn::unmarshall(response, rrdb_response);
+        if (rrdb_response.error != 0) {
+            simple_error_reply(entry, "internal error " + std::to_string(rrdb_response.error));
+        } else if (is_hmset) {
+            simple_ok_reply(entry);
+        } else {
+            // NOTE: Standard Redis returns the count of the new fields, while Pegasus returns the
+            // count of all the fields since it does not check the existence, like 'del' command.
+            simple_integer_reply(entry, field_count);
+        }
+    };
+    client->multi_put(req,
+                      on_hset_reply,
+                      rpc_timeout(),
+                      request_partition_hash(pegasus_hash_key_hash(req.hash_key)));
+}
+
+// HDEL key field [field ...]
+void redis_parser::hdel(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    if (redis_req.sub_requests.size() < 3) {
+        LOG_INFO_PREFIX("HDEL command seqid({}) with invalid arguments", entry.sequence_id);
+        simple_error_reply(entry, "wrong number of arguments for 'hdel' command");
+        return;
+    }
+    if (_geo_client != nullptr) {
+        simple_error_reply(entry, "'hdel' command is not supported on GEO mode");
+        return;
+    }
+
+    LOG_DEBUG_PREFIX("send HDEL command seqid({})", entry.sequence_id);
+    ::dsn::apps::multi_remove_request req;
+    req.hash_key = redis_req.sub_requests[1].data;
+    req.sort_keys.reserve(redis_req.sub_requests.size() - 2);
+    for (size_t i = 2; i < redis_req.sub_requests.size(); ++i) {
+        req.sort_keys.emplace_back(redis_req.sub_requests[i].data);
+    }
+
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    auto on_hdel_reply = [ref_this, this, &entry](
+        ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+        if (_is_session_reset.load(std::memory_order_acquire)) {
+            LOG_INFO_PREFIX("HDEL command seqid({}) got reply, but session has reset",
+                            entry.sequence_id);
+            return;
+        }
+
+        if (::dsn::ERR_OK != ec) {
+            LOG_INFO_PREFIX(
+                "HDEL command seqid({}) got reply with error = {}", entry.sequence_id, ec);
+            simple_error_reply(entry, ec.to_string());
+            return;
+        }
+
+        ::dsn::apps::multi_remove_response rrdb_response;
+        ::dsn::unmarshall(response, rrdb_response);
+        if (rrdb_response.error != 0) {
+            simple_error_reply(entry, "internal error " + std::to_string(rrdb_response.error));
+        } else {
+            simple_integer_reply(entry, rrdb_response.count);
+        }
+    };
+    client->multi_remove(req,
+                         on_hdel_reply,
+                         rpc_timeout(),
+                         request_partition_hash(pegasus_hash_key_hash(req.hash_key)));
+}
+
 void redis_parser::del(message_entry &entry)
 {
     if (_geo_client == nullptr) {
@@ -647,7 +1104,9 @@ void redis_parser::del(message_entry &entry)
 void redis_parser::del_internal(message_entry &entry)
 {
     redis_request &redis_req = entry.request;
-    if (redis_req.sub_requests.size() != 2) {
+    if (redis_req.sub_requests.size() > 2) {
+        del_multi_internal(entry);
+    } else if (redis_req.sub_requests.size() != 2) {
         LOG_INFO_PREFIX("DEL command seqid({}) with invalid arguments", entry.sequence_id);
         simple_error_reply(entry, "wrong number of arguments for 'del' command");
     } else {
@@ -685,9 +1144,31 @@ void redis_parser::del_internal(message_entry &entry)
         ::dsn::blob req;
         ::dsn::blob null_blob;
         pegasus_generate_key(req, redis_req.sub_requests[1].data, null_blob);
-        auto partition_hash = pegasus_key_hash(req);
-        // TODO: set the timeout
-        client->remove(req, on_del_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+        auto partition_hash = request_partition_hash(pegasus_key_hash(req));
+        client->remove(req, on_del_reply, rpc_timeout(), partition_hash);
+    }
+}
+
+// DEL key [key ...]
+void redis_parser::del_multi_internal(message_entry &entry)
+{
+    redis_request &redis_req = entry.request;
+    LOG_DEBUG_PREFIX("send DEL command seqid({}) with multiple keys", entry.sequence_id);
+    const size_t key_count = redis_req.sub_requests.size() - 1;
+    auto command = std::make_shared<multi_key_command>(
+        entry, multi_key_command::reply_type::kKeyCount, key_count);
+    std::shared_ptr<proxy_session> ref_this = shared_from_this();
+    // Like 'mset' command, the keys are removed concurrently.
+    for (size_t i = 0; i < key_count; ++i) {
+        auto on_del_reply = [ref_this, this, command, i](
+            ::dsn::error_code ec, dsn::message_ex *, dsn::message_ex *response) {
+            on_update_reply(command, i, ec, response);
+        };
+
+        ::dsn::blob req;
+        pegasus_generate_key(req, redis_req.sub_requests[i + 1].data, ::dsn::blob());
+        client->remove(
+            req, on_del_reply, rpc_timeout(), request_partition_hash(pegasus_key_hash(req)));
     }
 }
 
@@ -722,7 +1203,7 @@ void redis_parser::del_geo_internal(message_entry &entry)
                                std::string(),                                  // ""  => sort_key
                                false,
                                del_callback,
-                               2000); // TODO: set the timeout
+                               FLAGS_proxy_rpc_timeout_ms);
     }
 }
 
@@ -771,9 +1252,8 @@ void redis_parser::ttl(message_entry &entry)
         ::dsn::blob req;
         ::dsn::blob null_blob;
         pegasus_generate_key(req, redis_req.sub_requests[1].data, null_blob);
-        auto partition_hash = pegasus_key_hash(req);
-        // TODO: set the timeout
-        client->ttl(req, on_ttl_reply, std::chrono::milliseconds(2000), 0, partition_hash);
+        auto partition_hash = request_partition_hash(pegasus_key_hash(req));
+        client->ttl(req, on_ttl_reply, rpc_timeout(), partition_hash);
     }
 }
 
@@ -837,8 +1317,13 @@ void redis_parser::geo_radius(message_entry &entry)
             entry, unit, WITHCOORD, WITHDIST, WITHHASH, ec, std::move(results));
     };
 
-    _geo_client->async_search_radial(
-        lat_degrees, lng_degrees, radius_m, count, sort_type, 2000, search_callback);
+    _geo_client->async_search_radial(lat_degrees,
+                                     lng_degrees,
+                                     radius_m,
+                                     count,
+                                     sort_type,
+                                     FLAGS_proxy_rpc_timeout_ms,
+                                     search_callback);
 }
 
 // command format:
@@ -892,7 +1377,7 @@ void redis_parser::geo_radius_by_member(message_entry &entry)
     };
 
     _geo_client->async_search_radial(
-        hash_key, "", radius_m, count, sort_type, 2000, search_callback);
+        hash_key, "", radius_m, count, sort_type, FLAGS_proxy_rpc_timeout_ms, search_callback);
 }
 
 void redis_parser::incr(message_entry &entry) { counter_internal(entry); }
@@ -970,7 +1455,8 @@ void redis_parser::counter_internal(message_entry &entry)
     dsn::apps::incr_request req;
     pegasus_generate_key(req.key, entry.request.sub_requests[1].data, dsn::blob());
     req.increment = increment;
-    client->incr(req, on_incr_reply, std::chrono::milliseconds(2000), 0, pegasus_key_hash(req.key));
+    client->incr(
+        req, on_incr_reply, rpc_timeout(), request_partition_hash(pegasus_key_hash(req.key)));
 }
 
 void redis_parser::parse_set_parameters(const std::vector<redis_bulk_string> &opts,
@@ -1171,7 +1657,12 @@ void redis_parser::geo_add(message_entry &entry)
             dsn::buf2double(redis_request.sub_requests[2 + i * 3 + 1].data.to_string_view(),
                             lat_degree)) {
             const std::string &hashkey = redis_request.sub_requests[2 + i * 3 + 2].data.to_string();
-            _geo_client->async_set(hashkey, "", lat_degree, lng_degree, set_latlng_callback, 2000);
+            _geo_client->async_set(hashkey,
+                                   "",
+                                   lat_degree,
+                                   lng_degree,
+                                   set_latlng_callback,
+                                   FLAGS_proxy_rpc_timeout_ms);
         } else if (set_count->fetch_sub(1) == 1) {
             reply_message(entry, *result);
         }
@@ -1189,7 +1680,6 @@ void redis_parser::geo_dist(message_entry &entry)
     if (redis_request.sub_requests.size() < 4) {
         simple_error_reply(entry, "wrong number of arguments for 'geodist' command");
     } else {
-        // TODO: set the timeout
         std::string hash_key1 =
             redis_request.sub_requests[2].data.to_string(); // member1 => hash_key1
         std::string hash_key2 =
@@ -1220,7 +1710,8 @@ void redis_parser::geo_dist(message_entry &entry)
                 reply_message(entry, redis_bulk_string(std::to_string(distance)));
             }
         };
-        _geo_client->async_distance(hash_key1, "", hash_key2, "", 2000, get_callback);
+        _geo_client->async_distance(
+            hash_key1, "", hash_key2, "", FLAGS_proxy_rpc_timeout_ms, get_callback);
     }
 }
 
@@ -1272,8 +1763,11 @@ void redis_parser::geo_pos(message_entry &entry)
     };
 
     for (int i = 0; i < member_count; ++i) {
-        _geo_client->async_get(
-            redis_request.sub_requests[i + 2].data.to_string(), "", i, get_latlng_callback, 2000);
+        _geo_client->async_get(redis_request.sub_requests[i + 2].data.to_string(),
+                               "",
+                               i,
+                               get_latlng_callback,
+                               FLAGS_proxy_rpc_timeout_ms);
     }
 }
 
@@ -1290,6 +1784,11 @@ void redis_parser::handle_command(std::unique_ptr<message_entry> &&entry)
     CHECK_GT_PREFIX_MSG(request.sub_request_count, 0, "invalid request");
     ::dsn::blob &command = request.sub_requests[0].data;
     redis_call_handler handler = redis_parser::get_handler(command.data(), command.length());
+    // the pending reads are sent before any other command, to keep them from being reordered with
+    // the writes pipelined after them
+    if (handler != g_get && handler != g_mget && handler != g_hget && handler != g_hmget) {
+        send_pending_reads();
+    }
     handler(this, e);
 }
 
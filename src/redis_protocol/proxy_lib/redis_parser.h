@@ -36,6 +36,7 @@
 #include "runtime/rpc/rpc_message.h"
 #include "runtime/rpc/rpc_stream.h"
 #include "utils/blob.h"
+#include "utils/error_code.h"
 #include "utils/zlocks.h"
 
 namespace dsn {
@@ -125,6 +126,44 @@ protected:
         std::atomic<dsn::message_ex *> response;
         int64_t sequence_id = 0;
     };
+    // A command on several keys, which are handled by separate RPCs and replied together once all
+    // of them are done.
+    struct multi_key_command
+    {
+        enum class reply_type
+        {
+            kValue,    // the value of the only key, e.g. GET
+            kArray,    // the values of all the keys, e.g. MGET
+            kOk,       // "OK" if all the keys are done, e.g. MSET
+            kKeyCount, // the count of the keys done successfully, e.g. DEL
+        };
+        struct key_result
+        {
+            std::shared_ptr<redis_bulk_string> value;
+            // Not empty if the key failed, which fails the whole command.
+            std::string error;
+        };
+
+        multi_key_command(message_entry &e, reply_type t, size_t key_count)
+            : entry(e), type(t), results(key_count), pending_keys(key_count)
+        {
+        }
+
+        message_entry &entry;
+        const reply_type type;
+        std::vector<key_result> results;
+        std::atomic<size_t> pending_keys;
+    };
+    // A key to be read by a command, which is held until all the commands in the received message
+    // are parsed, to be read together with the other keys in the same partition.
+    struct pending_read
+    {
+        std::shared_ptr<multi_key_command> command;
+        size_t index;
+        ::dsn::blob hash_key;
+        ::dsn::blob sort_key;
+        uint64_t partition_hash;
+    };
 
     bool parse(dsn::message_ex *msg) override;
 
@@ -160,6 +199,9 @@ private:
     size_t _current_cursor;
     // ]
 
+    // the reads of the commands parsed from the current received message
+    std::vector<pending_read> _pending_reads;
+
     // for rrdb
     std::unique_ptr<::dsn::apps::rrdb_client> client;
     std::unique_ptr<geo::geo_client> _geo_client;
@@ -201,12 +243,19 @@ protected:
     DECLARE_REDIS_HANDLER(incr_by)
     DECLARE_REDIS_HANDLER(decr)
     DECLARE_REDIS_HANDLER(decr_by)
+    DECLARE_REDIS_HANDLER(mget)
+    DECLARE_REDIS_HANDLER(mset)
+    DECLARE_REDIS_HANDLER(hget)
+    DECLARE_REDIS_HANDLER(hmget)
+    DECLARE_REDIS_HANDLER(hset)
+    DECLARE_REDIS_HANDLER(hdel)
     DECLARE_REDIS_HANDLER(default_handler)
 
     void set_internal(message_entry &entry);
     void set_geo_internal(message_entry &entry);
     void del_internal(message_entry &entry);
     void del_geo_internal(message_entry &entry);
+    void del_multi_internal(message_entry &entry);
     void counter_internal(message_entry &entry);
     static void parse_set_parameters(const std::vector<redis_bulk_string> &opts, int &ttl_seconds);
     static void parse_geo_radius_parameters(const std::vector<redis_bulk_string> &opts,
@@ -226,6 +275,20 @@ protected:
                                    int ec,
                                    std::list<geo::SearchResult> &&results);
 
+    // function for the commands on several keys
+    void add_pending_read(const std::shared_ptr<multi_key_command> &command,
+                          size_t index,
+                          const ::dsn::blob &hash_key,
+                          const ::dsn::blob &sort_key);
+    void send_pending_reads();
+    void send_get(pending_read &&read);
+    void send_batch_get(std::vector<pending_read> &&reads);
+    void on_update_reply(const std::shared_ptr<multi_key_command> &command,
+                         size_t index,
+                         ::dsn::error_code ec,
+                         dsn::message_ex *response);
+    void on_key_done(const std::shared_ptr<multi_key_command> &command);
+
     // function for pipeline reply
     void enqueue_pending_response(std::unique_ptr<message_entry> &&entry);
     void fetch_and_dequeue_messages(std::vector<dsn::message_ex *> &msgs, bool only_ready_ones);
@@ -619,6 +619,104 @@ TEST(proxy, connection)
         ASSERT_STREQ(resps, got_reply);
     }
 
+    // the multi-key commands
+    {
+        const char *req = "*5\r\n$4\r\nMSET\r\n$3\r\nmk1\r\n$2\r\nv1\r\n$3\r\nmk2\r\n$2\r\nv2\r\n";
+        boost::asio::write(client_socket, boost::asio::buffer(req, strlen(req)));
+
+        const char *resps = "+OK\r\n";
+        size_t got_length =
+            boost::asio::read(client_socket, boost::asio::buffer(got_reply, strlen(resps)));
+        got_reply[got_length] = 0;
+        ASSERT_STREQ(resps, got_reply);
+    }
+
+    // the reads of the pipelined commands are coalesced, while replied in order
+    {
+        const char *req = "*4\r\n$4\r\nMGET\r\n$3\r\nmk2\r\n$3\r\nmk0\r\n$3\r\nmk1\r\n"
+                          "*2\r\n$3\r\nGET\r\n$3\r\nmk1\r\n"
+                          "*3\r\n$4\r\nMGET\r\n$3\r\nmk1\r\n$3\r\nmk1\r\n";
+        boost::asio::write(client_socket, boost::asio::buffer(req, strlen(req)));
+
+        const char *resps = "*3\r\n$2\r\nv2\r\n$-1\r\n$2\r\nv1\r\n"
+                            "$2\r\nv1\r\n"
+                            "*2\r\n$2\r\nv1\r\n$2\r\nv1\r\n";
+        size_t got_length =
+            boost::asio::read(client_socket, boost::asio::buffer(got_reply, strlen(resps)));
+        got_reply[got_length] = 0;
+        ASSERT_STREQ(resps, got_reply);
+    }
+
+    {
+        const char *req = "*4\r\n$3\r\nDEL\r\n$3\r\nmk1\r\n$3\r\nmk2\r\n$3\r\nmk3\r\n";
+        boost::asio::write(client_socket, boost::asio::buffer(req, strlen(req)));
+
+        const char *resps = ":3\r\n";
+        size_t got_length =
+            boost::asio::read(client_socket, boost::asio::buffer(got_reply, strlen(resps)));
+        got_reply[got_length] = 0;
+        ASSERT_STREQ(resps, got_reply);
+    }
+
+    {
+        const char *req = "*3\r\n$4\r\nMGET\r\n$3\r\nmk1\r\n$3\r\nmk2\r\n";
+        boost::asio::write(client_socket, boost::asio::buffer(req, strlen(req)));
+
+        const char *resps = "*2\r\n$-1\r\n$-1\r\n";
+        size_t got_length =
+            boost::asio::read(client_socket, boost::asio::buffer(got_reply, strlen(resps)));
+        got_reply[got_length] = 0;
+        ASSERT_STREQ(resps, got_reply);
+    }
+
+    // the hash commands, whose fields are stored as the sort keys
+    {
+        const char *req = "*6\r\n$4\r\nHSET\r\n$2\r\nhk\r\n"
+                          "$2\r\nf1\r\n$2\r\nv1\r\n$2\r\nf2\r\n$2\r\nv2\r\n";
+        boost::asio::write(client_socket, boost::asio::buffer(req, strlen(req)));
+
+        const char *resps = ":2\r\n";
+        size_t got_length =
+            boost::asio::read(client_socket, boost::asio::buffer(got_reply, strlen(resps)));
+        got_reply[got_length] = 0;
+        ASSERT_STREQ(resps, got_reply);
+    }
+
+    {
+        const char *req = "*3\r\n$4\r\nHGET\r\n$2\r\nhk\r\n$2\r\nf1\r\n"
+                          "*5\r\n$5\r\nHMGET\r\n$2\r\nhk\r\n$2\r\nf2\r\n$2\r\nf0\r\n$2\r\nf1\r\n";
+        boost::asio::write(client_socket, boost::asio::buffer(req, strlen(req)));
+
+        const char *resps = "$2\r\nv1\r\n"
+                            "*3\r\n$2\r\nv2\r\n$-1\r\n$2\r\nv1\r\n";
+        size_t got_length =
+            boost::asio::read(client_socket, boost::asio::buffer(got_reply, strlen(resps)));
+        got_reply[got_length] = 0;
+        ASSERT_STREQ(resps, got_reply);
+    }
+
+    {
+        const char *req = "*4\r\n$4\r\nHDEL\r\n$2\r\nhk\r\n$2\r\nf1\r\n$2\r\nf2\r\n";
+        boost::asio::write(client_socket, boost::asio::buffer(req, strlen(req)));
+
+        const char *resps = ":2\r\n";
+        size_t got_length =
+            boost::asio::read(client_socket, boost::asio::buffer(got_reply, strlen(resps)));
+        got_reply[got_length] = 0;
+        ASSERT_STREQ(resps, got_reply);
+    }
+
+    {
+        const char *req = "*3\r\n$4\r\nHGET\r\n$2\r\nhk\r\n$2\r\nf1\r\n";
+        boost::asio::write(client_socket, boost::asio::buffer(req, strlen(req)));
+
+        const char *resps = "$-1\r\n";
+        size_t got_length =
+            boost::asio::read(client_socket, boost::asio::buffer(got_reply, strlen(resps)));
+        got_reply[got_length] = 0;
+        ASSERT_STREQ(resps, got_reply);
+    }
+
     // let's send partitial message then close the socket
     {
         const char *req = "*3\r\n$3\r\nSET\r\n$3\r\nfoo\r\n$4\r\nbar1\r\n"
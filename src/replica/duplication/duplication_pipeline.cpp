@@ -83,6 +83,7 @@ load_mutation::load_mutation(replica_duplicator *duplicator,
 void ship_mutation::ship(mutation_tuple_set &&in)
 {
     _mutation_duplicator->duplicate(std::move(in), [this](size_t total_shipped_size) mutable {
+        _duplicator->set_preferred_batch_bytes(_mutation_duplicator->preferred_batch_bytes());
         update_progress();
         METRIC_VAR_INCREMENT_BY(dup_shipped_bytes, total_shipped_size);
         step_down_next_stage();
@@ -15,10 +15,12 @@
 // specific language governing permissions and limitations
 // under the License.
 
+#include <algorithm>
 #include <iterator>
 #include <map>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "common/duplication_common.h"
@@ -58,6 +60,12 @@ METRIC_DEFINE_counter(replica,
                       dsn::metric_unit::kMutations,
                       "The number of mutations read from private log for dup");
 
+METRIC_DEFINE_counter(replica,
+                      dup_tail_cache_read_mutations,
+                      dsn::metric_unit::kMutations,
+                      "The number of mutations read from the tail cache rather than private log "
+                      "for dup");
+
 namespace dsn {
 namespace replication {
 
@@ -133,6 +141,10 @@ void load_from_private_log::run()
         }
     }
 
+    if (load_from_tail_cache()) {
+        return;
+    }
+
     if (_current == nullptr) {
         find_log_file_to_start();
         if (_current == nullptr) {
@@ -169,6 +181,47 @@ void load_from_private_log::find_log_file_to_start()
     find_log_file_to_start(std::move(new_file_map));
 }
 
+bool load_from_private_log::load_from_tail_cache()
+{
+    // All the mutations up to the max loaded decree, including those not committed yet, have been
+    // added into the batch, thus it continues from the next one.
+    const decree next_decree = _mutation_batch.max_loaded_decree() + 1;
+    std::vector<mutation_ptr> mutations;
+    if (!_duplicator->tail_cache().read(next_decree, batch_bytes(), mutations)) {
+        if (_reading_tail_cache) {
+            LOG_INFO_PREFIX("decree {} has been evicted from the tail cache, fall back to loading "
+                            "from private log files",
+                            next_decree);
+            _reading_tail_cache = false;
+            // The offset in the current log file is out of date.
+            _resume_decree = next_decree;
+            _current = nullptr;
+        }
+        return false;
+    }
+
+    if (!_reading_tail_cache) {
+        LOG_INFO_PREFIX("start loading from the tail cache at decree {}", next_decree);
+        _reading_tail_cache = true;
+    }
+
+    for (auto &mu : mutations) {
+        auto es = _mutation_batch.add(std::move(mu));
+        CHECK_PREFIX_MSG(es.is_ok(), es.description());
+    }
+    METRIC_VAR_INCREMENT_BY(dup_tail_cache_read_mutations, mutations.size());
+
+    // Step down even if nothing is read, just like reaching the end of the last log file.
+    step_down_next_stage(_mutation_batch.last_decree(), _mutation_batch.move_all_mutations());
+    return true;
+}
+
+uint64_t load_from_private_log::batch_bytes() const
+{
+    return std::max<uint64_t>(FLAGS_duplicate_log_batch_bytes,
+                              _duplicator->preferred_batch_bytes());
+}
+
 void load_from_private_log::find_log_file_to_start(
     const mutation_log::log_file_map_by_index &log_file_map)
 {
@@ -178,6 +231,9 @@ void load_from_private_log::find_log_file_to_start(
         return;
     }
 
+    // The mutations before `_resume_decree` have been loaded from the tail cache.
+    const decree start_decree = std::max(_start_decree, _resume_decree);
+
     for (auto it = log_file_map.begin(); it != log_file_map.end(); it++) {
         auto next_it = std::next(it);
         if (next_it == log_file_map.end()) {
@@ -187,8 +243,8 @@ void load_from_private_log::find_log_file_to_start(
             }
             break;
         }
-        if (it->second->previous_log_max_decree(get_gpid()) < _start_decree &&
-            _start_decree <= next_it->second->previous_log_max_decree(get_gpid())) {
+        if (it->second->previous_log_max_decree(get_gpid()) < start_decree &&
+            start_decree <= next_it->second->previous_log_max_decree(get_gpid())) {
             // `start_decree` is within the range
             _current = it->second;
             // find the latest file that matches the condition
@@ -258,7 +314,7 @@ void load_from_private_log::replay_log_block()
 
     if (err.is_ok()) {
         _start_offset = static_cast<size_t>(_current_global_end_offset - _current->start_offset());
-        if (_mutation_batch.bytes() < FLAGS_duplicate_log_batch_bytes) {
+        if (_mutation_batch.bytes() < batch_bytes()) {
             repeat();
             return;
         }
@@ -270,7 +326,7 @@ void load_from_private_log::replay_log_block()
     }
     // update last_decree even for empty batch.
     // case1: err.is_ok(err.code() != ERR_HANDLE_EOF), but _mutation_batch.bytes() >=
-    // FLAGS_duplicate_log_batch_bytes
+    // FLAGS_duplicate_log_batch_bytes, or the batch bytes preferred by the duplicator if larger
     // case2: !err.is_ok(err.code() == ERR_HANDLE_EOF) and no next file, need commit the last
     // mutations()
     step_down_next_stage(_mutation_batch.last_decree(), _mutation_batch.move_all_mutations());
@@ -285,7 +341,8 @@ load_from_private_log::load_from_private_log(replica *r, replica_duplicator *dup
       METRIC_VAR_INIT_replica(dup_log_file_load_failed_count),
       METRIC_VAR_INIT_replica(dup_log_file_load_skipped_bytes),
       METRIC_VAR_INIT_replica(dup_log_read_bytes),
-      METRIC_VAR_INIT_replica(dup_log_read_mutations)
+      METRIC_VAR_INIT_replica(dup_log_read_mutations),
+      METRIC_VAR_INIT_replica(dup_tail_cache_read_mutations)
 {
 }
 
@@ -64,6 +64,11 @@ public:
 
     void replay_log_block();
 
+    // Loads the mutations following the loaded ones from the tail cache of the duplication, which
+    // saves reading the log files once the duplication has caught up with the private log.
+    // Returns false if they are not cached, and then they should be loaded from the log files.
+    bool load_from_tail_cache();
+
     // Switches to the log file with index = current_log_index + 1.
     // Returns true if succeeds.
     bool switch_to_next_log_file();
@@ -84,6 +89,8 @@ public:
 private:
     void find_log_file_to_start(const mutation_log::log_file_map_by_index &log_files);
 
+    uint64_t batch_bytes() const;
+
 private:
     friend class load_from_private_log_test;
     friend class load_fail_mode_test;
@@ -108,10 +115,17 @@ private:
 
     decree _start_decree{0};
 
+    // Whether the mutations are loaded from the tail cache rather than the log files.
+    bool _reading_tail_cache{false};
+    // The decree to locate the log file once falling back from the tail cache, before which all
+    // the mutations have been loaded.
+    decree _resume_decree{invalid_decree};
+
     METRIC_VAR_DECLARE_counter(dup_log_file_load_failed_count);
     METRIC_VAR_DECLARE_counter(dup_log_file_load_skipped_bytes);
     METRIC_VAR_DECLARE_counter(dup_log_read_bytes);
     METRIC_VAR_DECLARE_counter(dup_log_read_mutations);
+    METRIC_VAR_DECLARE_counter(dup_tail_cache_read_mutations);
 
     std::chrono::milliseconds _repeat_delay{10_s};
 };
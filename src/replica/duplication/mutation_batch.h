@@ -65,6 +65,9 @@ public:
 
     decree last_decree() const;
 
+    // The max decree of the mutations added, including those not committed yet.
+    decree max_loaded_decree() const { return _mutation_buffer->max_decree(); }
+
     // mutations with decree < d will be ignored.
     void set_start_decree(decree d);
 
@@ -66,6 +66,11 @@ public:
     /// \param cb: Call it when all the given mutations were sent successfully
     virtual void duplicate(mutation_tuple_set mutations, callback cb) = 0;
 
+    /// The bytes of mutations the implementation prefers to duplicate in each call, which is
+    /// a hint to the loading of mutations. 0 means no preference.
+    /// Thread-safe.
+    virtual uint64_t preferred_batch_bytes() const { return 0; }
+
     // Singleton creator of mutation_duplicator.
     static std::function<std::unique_ptr<mutation_duplicator>(
         replica_base *, absl::string_view /*remote cluster*/, absl::string_view /*app name*/)>
@@ -0,0 +1,189 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "mutation_tail_cache.h"
+
+#include <atomic>
+
+#include "consensus_types.h"
+#include "utils/autoref_ptr.h"
+#include "utils/blob.h"
+
+DSN_DEFINE_uint64(replication,
+                  duplicate_log_tail_cache_bytes,
+                  1024 * 1024,
+                  "The max bytes of the mutations recently written to the private log which are "
+                  "kept in memory for each duplication on the primary, so that the duplication "
+                  "which has caught up with the log reads them without disk IO. 0 means reading "
+                  "all the mutations from the private log files");
+DSN_TAG_VARIABLE(duplicate_log_tail_cache_bytes, FT_MUTABLE);
+
+DSN_DEFINE_uint64(replication,
+                  duplicate_log_tail_cache_total_bytes,
+                  256 * 1024 * 1024,
+                  "The max bytes of the mutations kept in memory by all the duplications on this "
+                  "replica server as duplicate_log_tail_cache_bytes describes. Once exceeded, "
+                  "each cache evicts its oldest mutations on its next append");
+DSN_TAG_VARIABLE(duplicate_log_tail_cache_total_bytes, FT_MUTABLE);
+
+namespace dsn {
+namespace replication {
+namespace {
+
+std::atomic<uint64_t> s_total_bytes{0};
+
+// The bytes taken by a cached mutation, which owns nothing but its header and updates.
+uint64_t cached_bytes(const mutation_ptr &mu)
+{
+    uint64_t bytes = sizeof(mutation_header);
+    for (const auto &update : mu->data.updates) {
+        bytes += sizeof(update) + update.data.length();
+    }
+    return bytes;
+}
+
+// Copies the header and the updates of the mutation into a standalone one. The updates of the
+// logged mutation refer to the buffers of the client requests, which are much larger than the
+// updates themselves (e.g. a batch of the requests received in one read from the socket), thus
+// caching the mutation itself would pin all of them.
+mutation_ptr copy_for_cache(const mutation_ptr &mu)
+{
+    mutation_ptr cached(new mutation());
+    cached->data.header = mu->data.header;
+    cached->data.updates.reserve(mu->data.updates.size());
+    for (const auto &update : mu->data.updates) {
+        cached->data.updates.push_back(update);
+        cached->data.updates.back().data =
+            blob::create_from_bytes(update.data.data(), update.data.length());
+    }
+    cached->set_logged();
+    return cached;
+}
+
+} // anonymous namespace
+
+mutation_tail_cache::~mutation_tail_cache() { clear(); }
+
+void mutation_tail_cache::append(const mutation_ptr &mu)
+{
+    zauto_lock l(_lock);
+    if (FLAGS_duplicate_log_tail_cache_bytes == 0) {
+        clear_unlocked();
+        return;
+    }
+
+    const decree d = mu->get_decree();
+    if (!_mutations.empty()) {
+        const decree min_d = _mutations.front()->get_decree();
+        const decree max_d = _mutations.back()->get_decree();
+        if (d < min_d || d > max_d + 1) {
+            clear_unlocked();
+        } else {
+            while (!_mutations.empty() && _mutations.back()->get_decree() >= d) {
+                sub_bytes(cached_bytes(_mutations.back()));
+                _mutations.pop_back();
+            }
+        }
+    }
+
+    _mutations.push_back(copy_for_cache(mu));
+    add_bytes(cached_bytes(_mutations.back()));
+    evict_if_needed();
+}
+
+bool mutation_tail_cache::read(decree start,
+                               uint64_t max_bytes,
+                               /*out*/ std::vector<mutation_ptr> &muts) const
+{
+    zauto_lock l(_lock);
+    if (_mutations.empty() || start < _mutations.front()->get_decree()) {
+        return false;
+    }
+
+    uint64_t bytes = 0;
+    for (auto i = static_cast<size_t>(start - _mutations.front()->get_decree());
+         i < _mutations.size() && bytes < max_bytes;
+         ++i) {
+        const auto &cached = _mutations[i];
+        // Only the data is copied, which is cheap since the updates are reference counted blobs.
+        mutation_ptr mu(new mutation());
+        mu->data = cached->data;
+        mu->set_id(cached->get_ballot(), cached->get_decree());
+        mu->set_logged();
+        bytes += cached_bytes(cached);
+        muts.emplace_back(std::move(mu));
+    }
+    return true;
+}
+
+void mutation_tail_cache::clear()
+{
+    zauto_lock l(_lock);
+    clear_unlocked();
+}
+
+decree mutation_tail_cache::min_decree() const
+{
+    zauto_lock l(_lock);
+    return _mutations.empty() ? invalid_decree : _mutations.front()->get_decree();
+}
+
+decree mutation_tail_cache::max_decree() const
+{
+    zauto_lock l(_lock);
+    return _mutations.empty() ? invalid_decree : _mutations.back()->get_decree();
+}
+
+uint64_t mutation_tail_cache::bytes() const
+{
+    zauto_lock l(_lock);
+    return _bytes;
+}
+
+/*static*/ uint64_t mutation_tail_cache::total_bytes() { return s_total_bytes.load(); }
+
+void mutation_tail_cache::clear_unlocked()
+{
+    _mutations.clear();
+    sub_bytes(_bytes);
+}
+
+void mutation_tail_cache::add_bytes(uint64_t bytes)
+{
+    _bytes += bytes;
+    s_total_bytes.fetch_add(bytes);
+}
+
+void mutation_tail_cache::sub_bytes(uint64_t bytes)
+{
+    _bytes -= bytes;
+    s_total_bytes.fetch_sub(bytes);
+}
+
+void mutation_tail_cache::evict_if_needed()
+{
+    // The latest mutation is always kept even if it alone exceeds the limits.
+    while ((_bytes > FLAGS_duplicate_log_tail_cache_bytes ||
+            s_total_bytes.load() > FLAGS_duplicate_log_tail_cache_total_bytes) &&
+           _mutations.size() > 1) {
+        sub_bytes(cached_bytes(_mutations.front()));
+        _mutations.pop_front();
+    }
+}
+
+} // namespace replication
+} // namespace dsn
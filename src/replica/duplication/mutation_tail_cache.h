@@ -0,0 +1,85 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
+#include "common/replication_other_types.h"
+#include "replica/mutation.h"
+#include "utils/flags.h"
+#include "utils/zlocks.h"
+
+DSN_DECLARE_uint64(duplicate_log_tail_cache_bytes);
+DSN_DECLARE_uint64(duplicate_log_tail_cache_total_bytes);
+
+namespace dsn {
+namespace replication {
+
+/// Keeps the mutations recently written to the private log by the primary in memory, so that
+/// the duplication which has caught up with the tail of the log loads them from here rather
+/// than reading the log files back.
+///
+/// The cached mutations are always of continuous decrees, and evicted from the oldest once
+/// their size exceeds [replication]duplicate_log_tail_cache_bytes, or the size of all the caches
+/// on this node exceeds [replication]duplicate_log_tail_cache_total_bytes. Only the headers and
+/// the updates are cached, copied out of the buffers of the client requests.
+///
+/// Thread-safe: the mutations are appended in THREAD_POOL_REPLICATION and read in
+/// THREAD_POOL_REPLICATION_LONG.
+class mutation_tail_cache
+{
+public:
+    ~mutation_tail_cache();
+
+    // Appends the mutation which has been written to the private log. The cached mutations with
+    // decrees >= its decree are replaced since they are prepared again with a larger ballot, and
+    // the cache restarts from this mutation once any decree is missing in between.
+    void append(const mutation_ptr &mu);
+
+    // Reads the cached mutations with decrees >= `start`, until their size reaches `max_bytes`.
+    // Each of them is copied, thus the reader is free to move the data out of it.
+    //
+    // Returns false if `start` is not in the cache, which means the reader lags behind (or the
+    // cache has just started) and should read from the private log files. `muts` is left empty
+    // if all the cached mutations have been read.
+    bool read(decree start, uint64_t max_bytes, /*out*/ std::vector<mutation_ptr> &muts) const;
+
+    void clear();
+
+    decree min_decree() const;
+    decree max_decree() const;
+    uint64_t bytes() const;
+
+    // The bytes cached by all the duplications on this node.
+    static uint64_t total_bytes();
+
+private:
+    void clear_unlocked();
+    void add_bytes(uint64_t bytes);
+    void sub_bytes(uint64_t bytes);
+    void evict_if_needed();
+
+    mutable zlock _lock;
+    std::deque<mutation_ptr> _mutations;
+    uint64_t _bytes{0};
+};
+
+} // namespace replication
+} // namespace dsn
@@ -129,6 +129,7 @@ void replica_duplicator::pause_dup_log()
     _load.reset();
     _ship.reset();
     _load_private.reset();
+    _tail_cache.clear();
 
     LOG_INFO_PREFIX("duplication paused: {}", to_string());
 }
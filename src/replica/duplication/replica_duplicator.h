@@ -25,6 +25,7 @@
 #include "common//duplication_common.h"
 #include "common/replication_other_types.h"
 #include "duplication_types.h"
+#include "replica/duplication/mutation_tail_cache.h"
 #include "replica/replica_base.h"
 #include "runtime/pipeline.h"
 #include "runtime/task/task_tracker.h"
@@ -143,6 +144,22 @@ public:
 
     void set_duplication_plog_checking(bool checking);
 
+    // The bytes of mutations preferred by the mutation duplicator for each batch, which is
+    // updated after shipping and used by loading as the least size of a batch.
+    // Thread-safe.
+    uint64_t preferred_batch_bytes() const
+    {
+        return _preferred_batch_bytes.load(std::memory_order_relaxed);
+    }
+    void set_preferred_batch_bytes(uint64_t bytes)
+    {
+        _preferred_batch_bytes.store(bytes, std::memory_order_relaxed);
+    }
+
+    // The mutations recently written to the private log, which are appended by the replica
+    // while duplicating and read by loading.
+    mutation_tail_cache &tail_cache() { return _tail_cache; }
+
 private:
     friend class duplication_test_base;
     friend class replica_duplicator_test;
@@ -166,6 +183,8 @@ private:
     decree _start_point_decree = invalid_decree;
     duplication_status::type _status{duplication_status::DS_INIT};
     std::atomic<duplication_fail_mode::type> _fail_mode{duplication_fail_mode::FAIL_SLOW};
+    std::atomic<uint64_t> _preferred_batch_bytes{0};
+    mutation_tail_cache _tail_cache;
 
     // protect the access of _progress.
     mutable zrwlock_nr _lock;
@@ -72,13 +72,13 @@ void replica_duplicator_manager::sync_duplication(const duplication_entry &ent)
 {
     // state is inconsistent with meta-server
     auto it = ent.progress.find(get_gpid().get_partition_index());
+    zauto_lock l(_lock);
     if (it == ent.progress.end()) {
         _duplications.erase(ent.dupid);
+        update_has_duplications();
         return;
     }
 
-    zauto_lock l(_lock);
-
     dupid_t dupid = ent.dupid;
     duplication_status::type next_status = ent.status;
 
@@ -90,6 +90,7 @@ void replica_duplicator_manager::sync_duplication(const duplication_entry &ent)
             LOG_ERROR_PREFIX("illegal duplication status: {}",
                              duplication_status_to_string(next_status));
         }
+        update_has_duplications();
     } else {
         // update progress
         duplication_progress newp = dup->progress().set_confirmed_decree(it->second);
@@ -140,6 +141,7 @@ void replica_duplicator_manager::remove_non_existed_duplications(
     for (dupid_t dupid : removal_set) {
         _duplications.erase(dupid);
     }
+    update_has_duplications();
 }
 
 void replica_duplicator_manager::update_confirmed_decree_if_secondary(decree confirmed)
@@ -161,6 +163,23 @@ void replica_duplicator_manager::update_confirmed_decree_if_secondary(decree con
     }
 }
 
+void replica_duplicator_manager::on_mutation_logged(const mutation_ptr &mu)
+{
+    // Fast path for the replicas without duplication, which are the most, to avoid taking the
+    // lock on every write. A duplication added concurrently misses nothing since its cache
+    // starts from the next mutation anyway.
+    if (!_has_duplications.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    zauto_lock l(_lock);
+    for (const auto &kv : _duplications) {
+        if (kv.second->status() == duplication_status::DS_LOG && !kv.second->paused()) {
+            kv.second->tail_cache().append(mu);
+        }
+    }
+}
+
 void replica_duplicator_manager::METRIC_FUNC_NAME_SET(dup_pending_mutations)()
 {
     int64_t total = 0;
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <atomic>
 #include <map>
 #include <string>
 #include <utility>
@@ -28,6 +29,7 @@
 #include "common/replication_other_types.h"
 #include "duplication_types.h"
 #include "metadata_types.h"
+#include "replica/mutation.h"
 #include "replica/replica.h"
 #include "replica/replica_base.h"
 #include "replica_duplicator.h"
@@ -79,6 +81,12 @@ public:
     /// \see replica_check.cpp
     void update_confirmed_decree_if_secondary(decree confirmed);
 
+    /// Keeps the mutation which has just been written to the private log in memory for the
+    /// ongoing duplications, \see mutation_tail_cache.
+    /// THREAD_POOL_REPLICATION
+    /// \see replica::on_append_log_completed()
+    void on_mutation_logged(const mutation_ptr &mu);
+
     /// Sums up the number of pending mutations for all duplications on this replica.
     void METRIC_FUNC_NAME_SET(dup_pending_mutations)();
 
@@ -107,6 +115,12 @@ private:
         LOG_WARNING_PREFIX("remove all duplication, replica status = {}",
                            enum_to_string(_replica->status()));
         _duplications.clear();
+        update_has_duplications();
+    }
+
+    void update_has_duplications()
+    {
+        _has_duplications.store(!_duplications.empty(), std::memory_order_release);
     }
 
 private:
@@ -118,6 +132,9 @@ private:
 
     std::map<dupid_t, replica_duplicator_u_ptr> _duplications;
 
+    // Whether _duplications is not empty, which is read without _lock.
+    std::atomic<bool> _has_duplications{false};
+
     decree _primary_confirmed_decree{invalid_decree};
 
     // avoid thread conflict between replica::on_checkpoint_timer and
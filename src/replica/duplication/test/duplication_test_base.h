@@ -42,7 +42,9 @@ public:
 
     void add_dup(mock_replica *r, replica_duplicator_u_ptr dup)
     {
-        r->get_replica_duplicator_manager()._duplications[dup->id()] = std::move(dup);
+        auto &dup_mgr = r->get_replica_duplicator_manager();
+        dup_mgr._duplications[dup->id()] = std::move(dup);
+        dup_mgr.update_has_duplications();
     }
 
     replica_duplicator *find_dup(mock_replica *r, dupid_t dupid)
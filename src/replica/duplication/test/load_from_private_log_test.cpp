@@ -247,6 +247,49 @@ public:
         ASSERT_EQ(load._current->index(), 2);
     }
 
+    void test_load_from_tail_cache()
+    {
+        duplicator = create_test_duplicator(0);
+        load_from_private_log load(_replica.get(), duplicator.get());
+        load.set_start_decree(1);
+
+        decree last_decree = invalid_decree;
+        mutation_tuple_set loaded_mutations;
+        pipeline::do_when<decree, mutation_tuple_set> end_stage(
+            [&last_decree, &loaded_mutations](decree &&d, mutation_tuple_set &&mutations) {
+                last_decree = d;
+                for (const auto &mut : mutations) {
+                    loaded_mutations.emplace(mut);
+                }
+            });
+        duplicator->from(load).link(end_stage);
+
+        // Nothing is cached, thus it should be loaded from the log files.
+        ASSERT_FALSE(load.load_from_tail_cache());
+        ASSERT_FALSE(load._reading_tail_cache);
+
+        for (int i = 1; i <= 10; i++) {
+            duplicator->tail_cache().append(create_test_mutation(i, "hello!"));
+        }
+        duplicator->run_pipeline();
+        duplicator->wait_all();
+        ASSERT_TRUE(load._reading_tail_cache);
+        // The last mutation is not committed yet.
+        ASSERT_EQ(9, last_decree);
+        ASSERT_EQ(9, loaded_mutations.size());
+        ASSERT_EQ(10, METRIC_VALUE(load, dup_tail_cache_read_mutations));
+
+        // Fall back to the log files once the next mutation is evicted.
+        PRESERVE_FLAG(duplicate_log_tail_cache_bytes);
+        FLAGS_duplicate_log_tail_cache_bytes = 1;
+        duplicator->tail_cache().append(create_test_mutation(11, "hello!"));
+        duplicator->tail_cache().append(create_test_mutation(12, "hello!"));
+        ASSERT_FALSE(load.load_from_tail_cache());
+        ASSERT_FALSE(load._reading_tail_cache);
+        ASSERT_EQ(11, load._resume_decree);
+        ASSERT_FALSE(load._current);
+    }
+
     mutation_log_ptr create_private_log(gpid id) { return create_private_log(1, id); }
 
     mutation_log_ptr create_private_log(int private_log_size_mb = 1, gpid id = gpid(1, 1))
@@ -354,6 +397,8 @@ TEST_P(load_from_private_log_test, handle_real_private_log)
 
 TEST_P(load_from_private_log_test, restart_duplication) { test_restart_duplication(); }
 
+TEST_P(load_from_private_log_test, load_from_tail_cache) { test_load_from_tail_cache(); }
+
 TEST_P(load_from_private_log_test, ignore_useless)
 {
     utils::filesystem::remove_path(_log_dir);
@@ -0,0 +1,169 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <string>
+#include <vector>
+
+#include "common/replication_other_types.h"
+#include "consensus_types.h"
+#include "duplication_test_base.h"
+#include "gtest/gtest.h"
+#include "replica/duplication/mutation_tail_cache.h"
+#include "replica/mutation.h"
+#include "test_util/test_util.h"
+#include "utils/autoref_ptr.h"
+#include "utils/flags.h"
+
+namespace dsn {
+namespace replication {
+
+class mutation_tail_cache_test : public duplication_test_base
+{
+public:
+    void append(decree d, ballot b = 1)
+    {
+        auto mu = create_test_mutation(d, "hello!");
+        mu->data.header.ballot = b;
+        _cache.append(mu);
+    }
+
+    mutation_tail_cache _cache;
+};
+
+INSTANTIATE_TEST_SUITE_P(, mutation_tail_cache_test, ::testing::Values(false, true));
+
+TEST_P(mutation_tail_cache_test, read)
+{
+    std::vector<mutation_ptr> muts;
+    ASSERT_FALSE(_cache.read(1, 1024, muts));
+
+    for (decree d = 1; d <= 5; ++d) {
+        append(d);
+    }
+    ASSERT_EQ(1, _cache.min_decree());
+    ASSERT_EQ(5, _cache.max_decree());
+
+    ASSERT_TRUE(_cache.read(3, 1024, muts));
+    ASSERT_EQ(3, muts.size());
+    for (int i = 0; i < muts.size(); ++i) {
+        ASSERT_EQ(3 + i, muts[i]->get_decree());
+        ASSERT_TRUE(muts[i]->is_logged());
+        ASSERT_EQ("hello!", muts[i]->data.updates[0].data.to_string());
+    }
+
+    // The reads are limited by the bytes, while at least one mutation is read.
+    muts.clear();
+    ASSERT_TRUE(_cache.read(1, 1, muts));
+    ASSERT_EQ(1, muts.size());
+
+    // All the cached mutations have been read.
+    muts.clear();
+    ASSERT_TRUE(_cache.read(6, 1024, muts));
+    ASSERT_TRUE(muts.empty());
+}
+
+TEST_P(mutation_tail_cache_test, append)
+{
+    for (decree d = 1; d <= 5; ++d) {
+        append(d);
+    }
+
+    // The mutations prepared again with a larger ballot replace the cached ones.
+    append(3, 2);
+    ASSERT_EQ(1, _cache.min_decree());
+    ASSERT_EQ(3, _cache.max_decree());
+    std::vector<mutation_ptr> muts;
+    ASSERT_TRUE(_cache.read(3, 1024, muts));
+    ASSERT_EQ(2, muts[0]->get_ballot());
+
+    // The cache restarts once a decree is missing.
+    append(5, 2);
+    ASSERT_EQ(5, _cache.min_decree());
+    ASSERT_EQ(5, _cache.max_decree());
+    muts.clear();
+    ASSERT_FALSE(_cache.read(4, 1024, muts));
+
+    _cache.clear();
+    ASSERT_EQ(invalid_decree, _cache.min_decree());
+    ASSERT_EQ(0, _cache.bytes());
+}
+
+TEST_P(mutation_tail_cache_test, evict)
+{
+    PRESERVE_FLAG(duplicate_log_tail_cache_bytes);
+
+    append(1);
+    const auto mutation_bytes = _cache.bytes();
+    FLAGS_duplicate_log_tail_cache_bytes = mutation_bytes * 3;
+    for (decree d = 2; d <= 5; ++d) {
+        append(d);
+    }
+    ASSERT_EQ(3, _cache.min_decree());
+    ASSERT_EQ(5, _cache.max_decree());
+    ASSERT_EQ(mutation_bytes * 3, _cache.bytes());
+
+    // Nothing is cached once disabled.
+    FLAGS_duplicate_log_tail_cache_bytes = 0;
+    append(6);
+    ASSERT_EQ(invalid_decree, _cache.max_decree());
+}
+
+TEST_P(mutation_tail_cache_test, evict_by_total_bytes)
+{
+    PRESERVE_FLAG(duplicate_log_tail_cache_total_bytes);
+
+    append(1);
+    const auto mutation_bytes = _cache.bytes();
+    const auto base_total_bytes = mutation_tail_cache::total_bytes() - mutation_bytes;
+
+    mutation_tail_cache other;
+    auto mu = create_test_mutation(1, "hello!");
+    other.append(mu);
+    mu = create_test_mutation(2, "hello!");
+    other.append(mu);
+    ASSERT_EQ(base_total_bytes + mutation_bytes * 3, mutation_tail_cache::total_bytes());
+
+    // The cache evicts its own mutations once all the caches exceed the limit.
+    FLAGS_duplicate_log_tail_cache_total_bytes = base_total_bytes + mutation_bytes * 4;
+    for (decree d = 2; d <= 3; ++d) {
+        append(d);
+    }
+    ASSERT_EQ(2, _cache.min_decree());
+    ASSERT_EQ(3, _cache.max_decree());
+    ASSERT_EQ(base_total_bytes + mutation_bytes * 4, mutation_tail_cache::total_bytes());
+
+    // The cleared caches return their bytes.
+    other.clear();
+    ASSERT_EQ(base_total_bytes + mutation_bytes * 2, mutation_tail_cache::total_bytes());
+}
+
+TEST_P(mutation_tail_cache_test, copy_data)
+{
+    auto mu = create_test_mutation(1, "hello!");
+    _cache.append(mu);
+
+    // The cached data is copied out of the buffer of the appended mutation.
+    std::vector<mutation_ptr> muts;
+    ASSERT_TRUE(_cache.read(1, 1024, muts));
+    ASSERT_EQ(1, muts.size());
+    ASSERT_EQ("hello!", muts[0]->data.updates[0].data.to_string());
+    ASSERT_NE(mu->data.updates[0].data.data(), muts[0]->data.updates[0].data.data());
+    ASSERT_TRUE(muts[0]->client_requests.empty());
+}
+
+} // namespace replication
+} // namespace dsn
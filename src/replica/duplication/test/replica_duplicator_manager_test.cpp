@@ -46,6 +46,7 @@ public:
     {
         auto r = stub->add_primary_replica(2, 1);
         auto &d = r->get_replica_duplicator_manager();
+        ASSERT_FALSE(d._has_duplications);
 
         duplication_entry ent;
         ent.dupid = 1;
@@ -54,14 +55,20 @@ public:
         ent.progress[r->get_gpid().get_partition_index()] = 0;
         d.sync_duplication(ent);
         ASSERT_EQ(d._duplications.size(), 1);
+        ASSERT_TRUE(d._has_duplications);
 
         // remove all dup
         d.remove_non_existed_duplications({});
         ASSERT_EQ(d._duplications.size(), 0);
+        ASSERT_FALSE(d._has_duplications);
 
         ent.dupid = 2;
         d.sync_duplication(ent);
         ASSERT_EQ(d._duplications.size(), 1);
+        ASSERT_TRUE(d._has_duplications);
+
+        d.remove_all_duplications();
+        ASSERT_FALSE(d._has_duplications);
     }
 
     void test_set_confirmed_decree_non_primary()
@@ -51,6 +51,13 @@ DSN_DEFINE_uint64(
     1000 * 1000 * 1000, // 1s
     "Latency trace will be logged when exceed the write latency threshold, in nanoseconds");
 DSN_TAG_VARIABLE(abnormal_write_trace_latency_threshold, FT_MUTABLE);
+DSN_DEFINE_uint32(replication,
+                  mutation_zero_copy_min_update_bytes,
+                  4096,
+                  "The update data of a mutation not less than this size are attached to the "
+                  "message rather than copied into it while sending the mutation, thus they are "
+                  "shared by the prepare messages to all secondaries");
+DSN_TAG_VARIABLE(mutation_zero_copy_min_update_bytes, FT_MUTABLE);
 
 namespace dsn {
 namespace replication {
@@ -204,7 +211,7 @@ void mutation::write_to(const std::function<void(const blob &)> &inserter) const
     }
 }
 
-void mutation::write_to(binary_writer &writer, dsn::message_ex * /*to*/) const
+void mutation::write_to(binary_writer &writer, dsn::message_ex *to) const
 {
     write_mutation_header(writer, data.header);
     writer.write_pod(static_cast<int>(data.updates.size()));
@@ -221,8 +228,14 @@ void mutation::write_to(binary_writer &writer, dsn::message_ex * /*to*/) const
 
         writer.write_pod(static_cast<int>(update.data.length()));
     }
-    // TODO(qinzuoyan): directly append buffer to message to avoid memory copy
+    // Only the header above is serialized for each message; the large update data are appended
+    // to the message directly, which avoids copying them once for every secondary.
+    const uint32_t zero_copy_min_bytes = FLAGS_mutation_zero_copy_min_update_bytes;
     for (const mutation_update &update : data.updates) {
+        if (to != nullptr && update.data.length() >= zero_copy_min_bytes &&
+            writer.write_zero_copy(update.data)) {
+            continue;
+        }
         writer.write(update.data.data(), update.data.length());
     }
 }
@@ -28,6 +28,7 @@
 
 #include <fmt/core.h>
 #include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <ctime>
 #include <iterator>
@@ -45,6 +46,7 @@
 #include "replica/log_file.h"
 #include "replica/mutation.h"
 #include "runtime/api_layer1.h"
+#include "runtime/task/async_calls.h"
 #include "utils/binary_writer.h"
 #include "utils/blob.h"
 #include "utils/defer.h"
@@ -52,12 +54,42 @@
 #include "utils/flags.h"
 #include "utils/fmt_logging.h"
 #include "utils/latency_tracer.h"
+#include "utils/metrics.h"
 #include "utils/ports.h"
 
 DSN_DEFINE_bool(replication,
                 plog_force_flush,
                 false,
                 "when write private log, whether to flush file after write done");
+DSN_DEFINE_uint32(replication,
+                  plog_group_commit_max_window_ms,
+                  0,
+                  "The max time that the pending mutations of private log could be held to be "
+                  "written and flushed together with the following ones, 0 means group commit "
+                  "is disabled. The actual window adapts to the load of the replica.");
+DSN_TAG_VARIABLE(plog_group_commit_max_window_ms, FT_MUTABLE);
+DSN_DEFINE_uint32(replication,
+                  plog_group_commit_max_bytes,
+                  1024 * 1024,
+                  "The pending mutations of private log are written at once if their size "
+                  "reaches this threshold, even if the group commit window doesn't expire.");
+DSN_TAG_VARIABLE(plog_group_commit_max_bytes, FT_MUTABLE);
+
+METRIC_DEFINE_percentile_int64(replica,
+                               plog_group_commit_mutations,
+                               dsn::metric_unit::kMutations,
+                               "The number of mutations written by one write of private log");
+
+METRIC_DEFINE_percentile_int64(replica,
+                               plog_group_commit_bytes,
+                               dsn::metric_unit::kBytes,
+                               "The number of bytes written by one write of private log");
+
+METRIC_DEFINE_percentile_int64(replica,
+                               plog_group_commit_wait_latency_ns,
+                               dsn::metric_unit::kNanoSeconds,
+                               "The duration from the first mutation of a group is appended to "
+                               "private log until the group is written");
 
 namespace dsn {
 namespace replication {
@@ -66,7 +98,11 @@ mutation_log_private::mutation_log_private(const std::string &dir,
                                            int32_t max_log_file_mb,
                                            gpid gpid,
                                            replica *r)
-    : mutation_log(dir, max_log_file_mb, gpid, r), replica_base(r)
+    : mutation_log(dir, max_log_file_mb, gpid, r),
+      replica_base(r),
+      METRIC_VAR_INIT_replica(plog_group_commit_mutations),
+      METRIC_VAR_INIT_replica(plog_group_commit_bytes),
+      METRIC_VAR_INIT_replica(plog_group_commit_wait_latency_ns)
 {
     mutation_log_private::init_states();
 }
@@ -87,9 +123,17 @@ mutation_log_private::mutation_log_private(const std::string &dir,
 
     ADD_POINT(mu->_tracer);
 
+    const uint64_t now_us = dsn_now_us();
+    if (_last_append_us > 0) {
+        const uint64_t interval_us = now_us > _last_append_us ? now_us - _last_append_us : 0;
+        _append_interval_us = (_append_interval_us * 7 + interval_us) / 8;
+    }
+    _last_append_us = now_us;
+
     // init pending buffer
     if (nullptr == _pending_write) {
         _pending_write = std::make_unique<log_appender>(mark_new_offset(0, true).second);
+        _pending_write_start_us = now_us;
     }
     _pending_write->append_mutation(mu, cb);
 
@@ -99,7 +143,7 @@ mutation_log_private::mutation_log_private(const std::string &dir,
     _pending_write_max_decree = std::max(_pending_write_max_decree, mu->data.header.decree);
 
     // start to write if possible
-    if (!_is_writing.load(std::memory_order_acquire)) {
+    if (!_is_writing.load(std::memory_order_acquire) && !hold_pending_mutations(now_us)) {
         write_pending_mutations(true);
         if (pending_size) {
             *pending_size = 0;
@@ -225,6 +269,48 @@ void mutation_log_private::init_states()
     _pending_write = nullptr;
     _pending_write_max_commit = 0;
     _pending_write_max_decree = 0;
+    _pending_write_start_us = 0;
+    _append_interval_us = 0;
+    _last_append_us = 0;
+    _group_commit_scheduled = false;
+}
+
+bool mutation_log_private::hold_pending_mutations(uint64_t now_us)
+{
+    const uint64_t window_us = static_cast<uint64_t>(FLAGS_plog_group_commit_max_window_ms) * 1000;
+    if (window_us == 0 || _pending_write->size() >= FLAGS_plog_group_commit_max_bytes) {
+        return false;
+    }
+
+    const uint64_t waited_us =
+        now_us > _pending_write_start_us ? now_us - _pending_write_start_us : 0;
+    // Under low load the following mutations are not expected to arrive within the window,
+    // holding the pending ones only adds latency.
+    if (waited_us >= window_us || _append_interval_us >= window_us) {
+        return false;
+    }
+
+    if (!_group_commit_scheduled) {
+        _group_commit_scheduled = true;
+        // Wait for about two more appends. Under high load it's 0, which means only yielding to
+        // the appends already queued on this thread.
+        const uint64_t delay_ms = std::min(window_us - waited_us, _append_interval_us * 2) / 1000;
+        tasking::enqueue(
+            LPC_GROUP_COMMIT_LOG_PRIVATE,
+            &_tracker,
+            [this]() {
+                _plock.lock();
+                _group_commit_scheduled = false;
+                if (!_is_writing.load(std::memory_order_acquire) && _pending_write) {
+                    write_pending_mutations(true);
+                } else {
+                    _plock.unlock();
+                }
+            },
+            get_gpid().thread_hash(),
+            std::chrono::milliseconds(delay_ms));
+    }
+    return true;
 }
 
 void mutation_log_private::write_pending_mutations(bool release_lock_required)
@@ -240,6 +326,13 @@ void mutation_log_private::write_pending_mutations(bool release_lock_required)
 
     update_max_decree(_private_gpid, _pending_write_max_decree);
 
+    METRIC_VAR_SET(plog_group_commit_mutations, _pending_write->mutations().size());
+    METRIC_VAR_SET(plog_group_commit_bytes, _pending_write->size());
+    const uint64_t now_us = dsn_now_us();
+    METRIC_VAR_SET(plog_group_commit_wait_latency_ns,
+                   now_us > _pending_write_start_us ? (now_us - _pending_write_start_us) * 1000
+                                                    : 0);
+
     // move or reset pending variables
     std::shared_ptr<log_appender> pending = std::move(_pending_write);
     _issued_write = pending;
@@ -314,7 +407,8 @@ void mutation_log_private::commit_pending_mutations(log_file_ptr &lf,
                               // start to write if possible
                               _plock.lock();
 
-                              if (!_is_writing.load(std::memory_order_acquire) && _pending_write) {
+                              if (!_is_writing.load(std::memory_order_acquire) && _pending_write &&
+                                  !hold_pending_mutations(dsn_now_us())) {
                                   write_pending_mutations(true);
                               } else {
                                   _plock.unlock();
@@ -49,6 +49,7 @@
 #include "utils/autoref_ptr.h"
 #include "utils/error_code.h"
 #include "utils/errors.h"
+#include "utils/metrics.h"
 #include "utils/zlocks.h"
 
 namespace dsn {
@@ -420,6 +421,14 @@ private:
                                   std::shared_ptr<log_appender> &pending,
                                   decree max_commit);
 
+    // Group commit: decide whether the pending mutations should be held for a while to be
+    // written together with the following ones, which saves the writes and fsyncs under high
+    // load. If true is returned, a task has been scheduled to write them once the window expires.
+    // Preconditions:
+    // - _plock is held
+    // - _pending_write != nullptr
+    bool hold_pending_mutations(uint64_t now_us);
+
     void init_states() override;
 
     // flush at most count times
@@ -437,7 +446,18 @@ private:
     std::shared_ptr<log_appender> _pending_write;
     decree _pending_write_max_commit;
     decree _pending_write_max_decree;
+    // The time when the first mutation of `_pending_write` was appended.
+    uint64_t _pending_write_start_us;
+    // The moving average of the intervals between appends, used to estimate the load.
+    uint64_t _append_interval_us;
+    uint64_t _last_append_us;
+    // Whether a task has been scheduled to write the held pending mutations.
+    bool _group_commit_scheduled;
     mutable zlock _plock;
+
+    METRIC_VAR_DECLARE_percentile_int64(plog_group_commit_mutations);
+    METRIC_VAR_DECLARE_percentile_int64(plog_group_commit_bytes);
+    METRIC_VAR_DECLARE_percentile_int64(plog_group_commit_wait_latency_ns);
 };
 
 } // namespace replication
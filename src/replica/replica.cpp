@@ -60,6 +60,7 @@
 #include "utils/latency_tracer.h"
 #include "utils/ports.h"
 #include "utils/rand.h"
+#include "utils/zlocks.h"
 
 DSN_DEFINE_bool(replication,
                 batch_write_disabled,
@@ -437,6 +438,7 @@ void replica::on_client_read(dsn::message_ex *request, bool ignore_throttling)
     }
 
     CHECK(_app, "");
+    _client_read_count.fetch_add(1, std::memory_order_relaxed);
     auto storage_error = _app->on_request(request);
     // kNotFound is normal, it indicates that the key is not found (including expired)
     // in the storage engine, so just ignore it.
@@ -689,6 +691,38 @@ uint32_t replica::query_data_version() const
     return _app->query_data_version();
 }
 
+void replica::query_hotkeys(hotkey_type::type type, /*out*/ std::vector<hotkey_info> &hotkeys) const
+{
+    CHECK_PREFIX(_app);
+    _app->query_hotkeys(type, hotkeys);
+}
+
+void replica::sample_load(/*out*/ int64_t &read_qps, /*out*/ int64_t &write_bytes_per_sec)
+{
+    const auto read_count = _client_read_count.load(std::memory_order_relaxed);
+    const auto write_bytes = _client_write_bytes.load(std::memory_order_relaxed);
+    const auto now_ms = dsn_now_ms();
+
+    zauto_lock l(_load_sample_lock);
+    read_qps = 0;
+    write_bytes_per_sec = 0;
+    // The first sampling only sets the baseline.
+    if (_last_load_sample_time_ms > 0 && now_ms > _last_load_sample_time_ms) {
+        const auto elapsed_ms = static_cast<int64_t>(now_ms - _last_load_sample_time_ms);
+        read_qps = (read_count - _last_sampled_read_count) * 1000 / elapsed_ms;
+        write_bytes_per_sec = (write_bytes - _last_sampled_write_bytes) * 1000 / elapsed_ms;
+    }
+    _last_load_sample_time_ms = now_ms;
+    _last_sampled_read_count = read_count;
+    _last_sampled_write_bytes = write_bytes;
+}
+
+int64_t replica::get_storage_size_mb() const
+{
+    CHECK_PREFIX(_app);
+    return _app->query_storage_size_mb();
+}
+
 error_code replica::store_app_info(app_info &info, const std::string &path)
 {
     replica_app_info new_info((app_info *)&info);
@@ -34,6 +34,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "common/replication_other_types.h"
 #include "dsn.layer2_types.h"
@@ -45,6 +46,7 @@
 #include "ranger/access_type.h"
 #include "replica/backup/cold_backup_context.h"
 #include "replica/replica_base.h"
+#include "replica_admin_types.h"
 #include "replica_context.h"
 #include "runtime/api_layer1.h"
 #include "runtime/rpc/rpc_message.h"
@@ -57,6 +59,7 @@
 #include "utils/thread_access_checker.h"
 #include "utils/throttling_controller.h"
 #include "utils/uniq_timestamp_us.h"
+#include "utils/zlocks.h"
 
 namespace pegasus {
 namespace server {
@@ -103,6 +106,7 @@ class replica_stub;
 class replication_app_base;
 class replication_options;
 struct dir_node;
+struct hotkey_info;
 
 typedef dsn::ref_ptr<cold_backup_context> cold_backup_context_ptr;
 
@@ -227,6 +231,9 @@ public:
     decree last_durable_decree() const;
     const std::string &dir() const { return _dir; }
     uint64_t create_time_milliseconds() const { return _create_time_ms; }
+    // The time used to open the app and to replay the private log while being initialized.
+    uint64_t app_open_duration_ms() const { return _app_open_duration_ms; }
+    uint64_t private_log_replay_duration_ms() const { return _private_log_replay_duration_ms; }
     const char *name() const { return replica_name(); }
     mutation_log_ptr private_log() const { return _private_log; }
     const replication_options *options() const { return _options; }
@@ -486,6 +493,16 @@ private:
 
     uint32_t query_data_version() const;
 
+    void query_hotkeys(hotkey_type::type type, /*out*/ std::vector<hotkey_info> &hotkeys) const;
+
+    // Sample the load of the replica since the last sampling, which is reported to the meta
+    // server by config sync.
+    //
+    // Thread-safe.
+    void sample_load(/*out*/ int64_t &read_qps, /*out*/ int64_t &write_bytes_per_sec);
+
+    int64_t get_storage_size_mb() const;
+
     //
     //    Throttling
     //
@@ -562,6 +579,8 @@ private:
     // replica configuration, updated by update_local_configuration ONLY
     replica_configuration _config;
     uint64_t _create_time_ms;
+    uint64_t _app_open_duration_ms{0};
+    uint64_t _private_log_replay_duration_ms{0};
     uint64_t _last_config_change_time_ms;
     uint64_t _last_checkpoint_generate_time_ms;
     uint64_t _next_checkpoint_interval_trigger_time_ms;
@@ -652,6 +671,14 @@ private:
 
     std::unique_ptr<replica_follower> _replica_follower;
 
+    // The accumulative client requests, sampled by sample_load().
+    std::atomic<int64_t> _client_read_count{0};
+    std::atomic<int64_t> _client_write_bytes{0};
+    zlock _load_sample_lock;
+    uint64_t _last_load_sample_time_ms{0};
+    int64_t _last_sampled_read_count{0};
+    int64_t _last_sampled_write_bytes{0};
+
     METRIC_VAR_DECLARE_gauge_int64(private_log_size_mb);
     METRIC_VAR_DECLARE_counter(throttling_delayed_write_requests);
     METRIC_VAR_DECLARE_counter(throttling_rejected_write_requests);
@@ -46,6 +46,7 @@
 #include "common/replication_other_types.h"
 #include "consensus_types.h"
 #include "dsn.layer2_types.h"
+#include "duplication/replica_duplicator_manager.h"
 #include "metadata_types.h"
 #include "mutation.h"
 #include "mutation_log.h"
@@ -220,6 +221,7 @@ void replica::on_client_write(dsn::message_ex *request, bool ignore_throttling)
     }
 
     LOG_DEBUG_PREFIX("got write request from {}", request->header->from_address);
+    _client_write_bytes.fetch_add(request->body_size(), std::memory_order_relaxed);
     auto mu = _primary_states.write_queue.add_work(request->rpc_code(), request, this);
     if (mu) {
         init_prepare(mu, false);
@@ -572,6 +574,7 @@ void replica::on_append_log_completed(mutation_ptr &mu, error_code err, size_t s
         switch (status()) {
         case partition_status::PS_PRIMARY:
             if (err == ERR_OK) {
+                _duplication_mgr->on_mutation_logged(mu);
                 do_possible_commit_on_primary(mu);
             } else {
                 handle_local_failure(err);
@@ -25,6 +25,7 @@
 #include <memory>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "common/duplication_common.h"
 #include "common/gpid.h"
@@ -32,6 +33,9 @@
 #include "http/http_server.h"
 #include "http/http_status_code.h"
 #include "replica/replica_stub.h"
+#include "replica/replication_app_base.h"
+#include "replica_admin_types.h"
+#include "runtime/api_layer1.h"
 #include "utils/string_conv.h"
 
 namespace dsn {
@@ -166,6 +170,97 @@ void replica_http_service::query_manual_compaction_handler(const http_request &r
     resp.body = json.dump();
 }
 
+void replica_http_service::query_app_hotkeys_handler(const http_request &req,
+                                                     http_response &resp)
+{
+    auto it = req.query_args.find("app_id");
+    if (it == req.query_args.end()) {
+        resp.body = "app_id should not be empty";
+        resp.status_code = http_status_code::kBadRequest;
+        return;
+    }
+
+    int32_t app_id = -1;
+    if (!buf2int32(it->second, app_id) || app_id < 0) {
+        resp.body = fmt::format("invalid app_id={}", it->second);
+        resp.status_code = http_status_code::kBadRequest;
+        return;
+    }
+
+    // partition_index -> hotkeys
+    std::unordered_map<int32_t, std::vector<hotkey_info>> read_hotkeys;
+    std::unordered_map<int32_t, std::vector<hotkey_info>> write_hotkeys;
+    _stub->query_app_hotkeys(app_id, hotkey_type::READ, read_hotkeys);
+    _stub->query_app_hotkeys(app_id, hotkey_type::WRITE, write_hotkeys);
+
+    if (read_hotkeys.empty()) {
+        resp.body = fmt::format("app_id={} not found", it->second);
+        resp.status_code = http_status_code::kNotFound;
+        return;
+    }
+
+    const auto to_json = [](const std::vector<hotkey_info> &hotkeys) {
+        auto json = nlohmann::json::array();
+        for (const auto &hotkey : hotkeys) {
+            json.push_back(nlohmann::json{{"hash_key", hotkey.hash_key}, {"qps", hotkey.qps}});
+        }
+        return json;
+    };
+
+    nlohmann::json json;
+    for (const auto &kv : read_hotkeys) {
+        json[std::to_string(kv.first)] = nlohmann::json{
+            {"read", to_json(kv.second)},
+            {"write", to_json(write_hotkeys[kv.first])},
+        };
+    }
+    resp.status_code = http_status_code::kOk;
+    resp.body = json.dump();
+}
+
+void replica_http_service::query_load_progress_handler(const http_request &req,
+                                                       http_response &resp)
+{
+    uint64_t start_time_ms = 0;
+    uint64_t finish_time_ms = 0;
+    // data dir tag -> progress
+    std::map<std::string, replica_load_progress> progress_map;
+    _stub->query_load_replicas_progress(start_time_ms, finish_time_ms, progress_map);
+
+    const auto to_json = [](const replica_load_progress &progress) {
+        return nlohmann::json{
+            {"total_dirs", progress.total_dirs},
+            {"loaded_dirs", progress.loaded_dirs},
+            {"loading_replicas", progress.loading_replicas},
+        };
+    };
+
+    replica_load_progress total_progress;
+    nlohmann::json disks_json = nlohmann::json::object();
+    for (const auto &kv : progress_map) {
+        total_progress.total_dirs += kv.second.total_dirs;
+        total_progress.loaded_dirs += kv.second.loaded_dirs;
+        total_progress.loading_replicas += kv.second.loading_replicas;
+        disks_json[kv.first] = to_json(kv.second);
+    }
+
+    nlohmann::json json = to_json(total_progress);
+    if (start_time_ms == 0) {
+        json["status"] = "not_started";
+        json["time_used_ms"] = 0;
+    } else if (finish_time_ms == 0) {
+        json["status"] = "loading";
+        json["time_used_ms"] = dsn_now_ms() - start_time_ms;
+    } else {
+        json["status"] = "finished";
+        json["time_used_ms"] = finish_time_ms - start_time_ms;
+    }
+    json["disks"] = disks_json;
+
+    resp.status_code = http_status_code::kOk;
+    resp.body = json.dump();
+}
+
 void replica_http_service::update_config(const std::string &name) { _stub->update_config(name); }
 
 } // namespace replication
@@ -53,6 +53,19 @@ public:
                                    std::placeholders::_2),
                          "app_id=<app_id>",
                          "Query the manual compaction status of an app.");
+        register_handler("hotkeys",
+                         std::bind(&replica_http_service::query_app_hotkeys_handler,
+                                   this,
+                                   std::placeholders::_1,
+                                   std::placeholders::_2),
+                         "app_id=<app_id>",
+                         "Query the hot hash keys of an app with their read and write qps.");
+        register_handler("load_progress",
+                         std::bind(&replica_http_service::query_load_progress_handler,
+                                   this,
+                                   std::placeholders::_1,
+                                   std::placeholders::_2),
+                         "Query the progress of loading replicas on startup for each data dir.");
     }
 
     ~replica_http_service()
@@ -60,6 +73,8 @@ public:
         deregister_http_call("replica/duplication");
         deregister_http_call("replica/data_version");
         deregister_http_call("replica/manual_compaction");
+        deregister_http_call("replica/hotkeys");
+        deregister_http_call("replica/load_progress");
     }
 
     std::string path() const override { return replication_options::kReplicaAppType; }
@@ -67,6 +82,8 @@ public:
     void query_duplication_handler(const http_request &req, http_response &resp);
     void query_app_data_version_handler(const http_request &req, http_response &resp);
     void query_manual_compaction_handler(const http_request &req, http_response &resp);
+    void query_app_hotkeys_handler(const http_request &req, http_response &resp);
+    void query_load_progress_handler(const http_request &req, http_response &resp);
 
     inline const char *manual_compaction_status_to_string(manual_compaction_status::type status)
     {
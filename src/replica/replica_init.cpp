@@ -24,11 +24,16 @@
  * THE SOFTWARE.
  */
 
+#include <fcntl.h>
 #include <inttypes.h>
+#include <unistd.h>
 #include <chrono>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "backup/replica_backup_manager.h"
 #include "common/gpid.h"
@@ -50,6 +55,9 @@
 #include "utils/filesystem.h"
 #include "utils/flags.h"
 #include "utils/fmt_logging.h"
+#include "utils/load_dump_object.h"
+#include "utils/string_conv.h"
+#include "utils/strings.h"
 #include "utils/uniq_timestamp_us.h"
 
 DSN_DEFINE_bool(replication,
@@ -70,9 +78,70 @@ DSN_DEFINE_int32(replication,
                  32,
                  "The maximum size (MB) of private log segment file");
 
+DSN_DEFINE_bool(replication,
+                prefetch_private_log_on_load,
+                true,
+                "Whether to prefetch the private log files to be replayed asynchronously before "
+                "opening the app of a replica on load, so that reading the log for replay overlaps "
+                "with opening the app");
+DSN_TAG_VARIABLE(prefetch_private_log_on_load, FT_MUTABLE);
+
 namespace dsn {
 namespace replication {
 
+namespace {
+
+// Parse the index and the start offset from the name of a private log file, which is
+// "log.<index>.<start_offset>". Return false if it's not a log file, e.g. a file renamed with the
+// ".removed" suffix since it's corrupted.
+bool parse_log_file_name(const std::string &path, int32_t &index, int64_t &start_offset)
+{
+    const char splitters[] = {'\\', '/', 0};
+    std::vector<std::string> parts;
+    utils::split_args(utils::get_last_component(path, splitters).c_str(), parts, '.', true);
+    return parts.size() == 3 && parts[0] == "log" && buf2int32(parts[1], index) &&
+           buf2int64(parts[2], start_offset);
+}
+
+// Hint the kernel to read the private log files that would be replayed into page cache in the
+// background, which is only advisory, thus all errors are ignored.
+//
+// The files are picked by their names only, without opening them or parsing their headers, which
+// is left to mutation_log::open(). Each file ends at the start offset of the next one, and the
+// files ending before 'valid_start_offset' are skipped, since the replay never reads them.
+void prefetch_private_log_files(const std::string &log_dir, int64_t valid_start_offset)
+{
+    std::vector<std::string> files;
+    if (!utils::filesystem::get_subfiles(log_dir, files, false)) {
+        return;
+    }
+
+    // index => <start offset, path>
+    std::map<int32_t, std::pair<int64_t, std::string>> logs;
+    for (auto &file : files) {
+        int32_t index = 0;
+        int64_t start_offset = 0;
+        if (parse_log_file_name(file, index, start_offset)) {
+            logs.emplace(index, std::make_pair(start_offset, std::move(file)));
+        }
+    }
+
+    for (auto it = logs.begin(); it != logs.end(); ++it) {
+        auto next = std::next(it);
+        if (next != logs.end() && next->second.first <= valid_start_offset) {
+            continue;
+        }
+        const int fd = ::open(it->second.second.c_str(), O_RDONLY);
+        if (fd < 0) {
+            continue;
+        }
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+        ::close(fd);
+    }
+}
+
+} // anonymous namespace
+
 error_code replica::initialize_on_new()
 {
     // TODO: check if _dir contain other file or directory except for
@@ -134,7 +203,18 @@ error_code replica::init_app_and_prepare_list(bool create_new)
         //         in prepare_list is 0, so should make it equal to last_committed_decree in app
         _prepare_list->reset(_app->last_committed_decree());
     } else {
+        if (FLAGS_prefetch_private_log_on_load) {
+            replica_init_info init_info;
+            if (utils::load_rjobj_from_file(
+                    utils::filesystem::path_combine(dir(), replica_init_info::kInitInfo),
+                    &init_info) == ERR_OK) {
+                prefetch_private_log_files(log_dir, init_info.init_offset_in_private_log);
+            }
+        }
+
+        const uint64_t open_start_time = dsn_now_ms();
         err = _app->open_internal(this);
+        _app_open_duration_ms = dsn_now_ms() - open_start_time;
         if (err == ERR_OK) {
             CHECK_EQ(_app->last_committed_decree(), _app->last_durable_decree());
             _config.ballot = _app->init_info().init_ballot;
@@ -165,6 +245,7 @@ error_code replica::init_app_and_prepare_list(bool create_new)
                     replay_condition);
 
                 uint64_t finish_time = dsn_now_ms();
+                _private_log_replay_duration_ms = finish_time - start_time;
 
                 if (err == ERR_OK) {
                     LOG_INFO_PREFIX("replay private log succeed, durable = {}, committed = {}, "
@@ -898,7 +898,9 @@ void replica::on_learn_reply(error_code err, learn_request &&req, learn_response
 
     else if (resp.state.files.size() > 0) {
         auto learn_dir = _app->learn_dir();
-        utils::filesystem::remove_path(learn_dir);
+        // Keep the files partially copied by the last interrupted learning, so that they could be
+        // resumed rather than copied from scratch.
+        nfs_node::clean_dir_for_resuming_copy(learn_dir, resp.state.files);
         utils::filesystem::create_directory(learn_dir);
 
         if (!dsn::utils::filesystem::directory_exists(learn_dir)) {
@@ -34,7 +34,6 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdint>
-#include <deque>
 #include <iterator>
 #include <mutex>
 #include <ostream>
@@ -67,6 +66,7 @@
 #include "runtime/rpc/rpc_message.h"
 #include "runtime/rpc/serialization.h"
 #include "runtime/task/async_calls.h"
+#include "runtime/task/task_spec.h"
 #include "security/access_controller.h"
 #include "split/replica_split_manager.h"
 #include "utils/command_manager.h"
@@ -98,6 +98,23 @@ DSN_DEFINE_int32(replication,
 DSN_DEFINE_validator(max_concurrent_bulk_load_downloading_count,
                      [](int32_t value) -> bool { return value >= 0; });
 
+DSN_DEFINE_uint32(replication,
+                  max_replicas_on_load_for_each_disk,
+                  8,
+                  "The max number of replicas that are loaded concurrently for each data dir on "
+                  "startup, while the total concurrency is still bounded by the worker count of "
+                  "THREAD_POOL_REPLICATION");
+DSN_TAG_VARIABLE(max_replicas_on_load_for_each_disk, FT_MUTABLE);
+DSN_DEFINE_validator(max_replicas_on_load_for_each_disk,
+                     [](uint32_t value) -> bool { return value > 0; });
+
+DSN_DEFINE_uint32(replication,
+                  load_replica_max_wait_time_ms,
+                  10,
+                  "The max time in milliseconds to wait for a loading replica on startup before "
+                  "checking whether more replicas could be loaded on the other data dirs");
+DSN_TAG_VARIABLE(load_replica_max_wait_time_ms, FT_MUTABLE);
+
 METRIC_DEFINE_gauge_int64(server,
                           total_replicas,
                           dsn::metric_unit::kReplicas,
@@ -113,6 +130,38 @@ METRIC_DEFINE_gauge_int64(server,
                           dsn::metric_unit::kReplicas,
                           "The number of closing replicas");
 
+METRIC_DEFINE_gauge_int64(server,
+                          replica_dirs_to_load,
+                          dsn::metric_unit::kDirs,
+                          "The number of replica dirs to be loaded on startup");
+
+METRIC_DEFINE_gauge_int64(server,
+                          loaded_replica_dirs,
+                          dsn::metric_unit::kDirs,
+                          "The number of replica dirs that have been loaded on startup, whether "
+                          "succeeded or not");
+
+METRIC_DEFINE_gauge_int64(server,
+                          loading_replicas,
+                          dsn::metric_unit::kReplicas,
+                          "The number of replicas being loaded on startup");
+
+METRIC_DEFINE_gauge_int64(server,
+                          load_replicas_duration_ms,
+                          dsn::metric_unit::kMilliSeconds,
+                          "The duration of loading all replicas on startup");
+
+METRIC_DEFINE_percentile_int64(server,
+                               replica_app_open_duration_ms,
+                               dsn::metric_unit::kMilliSeconds,
+                               "The duration of opening the app of a replica loaded on startup");
+
+METRIC_DEFINE_percentile_int64(
+    server,
+    replica_private_log_replay_duration_ms,
+    dsn::metric_unit::kMilliSeconds,
+    "The duration of replaying the private log of a replica loaded on startup");
+
 METRIC_DEFINE_gauge_int64(server,
                           learning_replicas,
                           dsn::metric_unit::kReplicas,
@@ -365,6 +414,12 @@ replica_stub::replica_stub(replica_state_subscriber subscriber /*= nullptr*/,
       METRIC_VAR_INIT_server(total_replicas),
       METRIC_VAR_INIT_server(opening_replicas),
       METRIC_VAR_INIT_server(closing_replicas),
+      METRIC_VAR_INIT_server(replica_dirs_to_load),
+      METRIC_VAR_INIT_server(loaded_replica_dirs),
+      METRIC_VAR_INIT_server(loading_replicas),
+      METRIC_VAR_INIT_server(load_replicas_duration_ms),
+      METRIC_VAR_INIT_server(replica_app_open_duration_ms),
+      METRIC_VAR_INIT_server(replica_private_log_replay_duration_ms),
       METRIC_VAR_INIT_server(learning_replicas),
       METRIC_VAR_INIT_server(learning_replicas_max_duration_ms),
       METRIC_VAR_INIT_server(learning_replicas_max_copy_file_bytes),
@@ -491,73 +546,8 @@ void replica_stub::initialize(const replication_options &opts, bool clear /* = f
     }
 
     // Start to load replicas in available data directories.
-    LOG_INFO("start to load replicas");
-    std::map<dir_node *, std::vector<std::string>> dirs_by_dn;
-    for (const auto &dn : _fs_manager.get_dir_nodes()) {
-        // Skip IO error dir_node.
-        if (dsn_unlikely(dn->status == disk_status::IO_ERROR)) {
-            continue;
-        }
-        std::vector<std::string> sub_directories;
-        CHECK(dsn::utils::filesystem::get_subdirectories(dn->full_dir, sub_directories, false),
-              "fail to get sub_directories in {}",
-              dn->full_dir);
-        dirs_by_dn.emplace(dn.get(), sub_directories);
-    }
-
     replicas rps;
-    utils::ex_lock rps_lock;
-    std::deque<task_ptr> load_tasks;
-    uint64_t start_time = dsn_now_ms();
-    for (const auto &dn_dirs : dirs_by_dn) {
-        const auto dn = dn_dirs.first;
-        for (const auto &dir : dn_dirs.second) {
-            if (dsn::replication::is_data_dir_invalid(dir)) {
-                LOG_WARNING("ignore dir {}", dir);
-                continue;
-            }
-
-            load_tasks.push_back(
-                tasking::create_task(LPC_REPLICATION_INIT_LOAD,
-                                     &_tracker,
-                                     [this, dn, dir, &rps, &rps_lock] {
-                                         LOG_INFO("process dir {}", dir);
-
-                                         auto r = load_replica(dn, dir.c_str());
-                                         if (r == nullptr) {
-                                             return;
-                                         }
-                                         LOG_INFO("{}@{}: load replica '{}' success, <durable, "
-                                                  "commit> = <{}, {}>, last_prepared_decree = {}",
-                                                  r->get_gpid(),
-                                                  dsn_primary_address(),
-                                                  dir,
-                                                  r->last_durable_decree(),
-                                                  r->last_committed_decree(),
-                                                  r->last_prepared_decree());
-
-                                         utils::auto_lock<utils::ex_lock> l(rps_lock);
-                                         CHECK(rps.find(r->get_gpid()) == rps.end(),
-                                               "conflict replica dir: {} <--> {}",
-                                               r->dir(),
-                                               rps[r->get_gpid()]->dir());
-
-                                         rps[r->get_gpid()] = r;
-                                     },
-                                     load_tasks.size()));
-            load_tasks.back()->enqueue();
-        }
-    }
-    for (auto &tsk : load_tasks) {
-        tsk->wait();
-    }
-    uint64_t finish_time = dsn_now_ms();
-
-    dirs_by_dn.clear();
-    load_tasks.clear();
-    LOG_INFO("load replicas succeed, replica_count = {}, time_used = {} ms",
-             rps.size(),
-             finish_time - start_time);
+    load_replicas(rps);
 
     bool is_log_complete = true;
     for (auto it = rps.begin(); it != rps.end(); ++it) {
@@ -619,6 +609,7 @@ void replica_stub::initialize(const replication_options &opts, bool clear /* = f
 
     // attach rps
     _replicas = std::move(rps);
+    publish_replicas();
     METRIC_VAR_INCREMENT_BY(total_replicas, _replicas.size());
     for (const auto &kv : _replicas) {
         _fs_manager.add_replica(kv.first, kv.second->dir());
@@ -768,14 +759,24 @@ std::vector<replica_ptr> replica_stub::get_all_primaries() const
 
 replica_ptr replica_stub::get_replica(gpid id) const
 {
-    zauto_read_lock l(_replicas_lock);
-    auto it = _replicas.find(id);
-    if (it != _replicas.end())
+    utils::rcu_read_guard guard;
+    const replicas *rs = _replicas_snapshot.get();
+    if (rs == nullptr) {
+        return nullptr;
+    }
+
+    auto it = rs->find(id);
+    if (it != rs->end())
         return it->second;
     else
         return nullptr;
 }
 
+void replica_stub::publish_replicas()
+{
+    _replicas_snapshot.reset(std::make_unique<const replicas>(_replicas));
+}
+
 replica_stub::replica_life_cycle replica_stub::get_replica_life_cycle(gpid id)
 {
     zauto_read_lock l(_replicas_lock);
@@ -1231,6 +1232,13 @@ void replica_stub::get_local_replicas(std::vector<replica_info> &replicas)
         }
         replica_info info;
         get_replica_info(info, rep);
+        // The load is only sampled for config sync, thus it's the average since the last sync.
+        int64_t read_qps = 0;
+        int64_t write_bytes_per_sec = 0;
+        rep->sample_load(read_qps, write_bytes_per_sec);
+        info.__set_storage_mb(rep->get_storage_size_mb());
+        info.__set_read_qps(read_qps);
+        info.__set_write_bytes_per_sec(write_bytes_per_sec);
         replicas.push_back(std::move(info));
     }
 
@@ -1732,6 +1740,7 @@ task_ptr replica_stub::begin_open_replica(
             METRIC_VAR_DECREMENT(closing_replicas);
 
             _replicas.emplace(id, rep);
+            publish_replicas();
             METRIC_VAR_INCREMENT(total_replicas);
 
             _closed_replicas.erase(id);
@@ -1880,6 +1889,7 @@ void replica_stub::open_replica(
 
         CHECK(_replicas.find(id) == _replicas.end(), "replica {} is already in _replicas", id);
         _replicas.insert(replicas::value_type(rep->get_gpid(), rep));
+        publish_replicas();
         METRIC_VAR_INCREMENT(total_replicas);
 
         _closed_replicas.erase(id);
@@ -2003,6 +2013,10 @@ replica *replica_stub::load_replica(dir_node *dn, const char *dir)
     FAIL_POINT_INJECT_F("mock_replica_load",
                         [&](absl::string_view) -> replica * { return nullptr; });
 
+    if (_replica_loader) {
+        return _replica_loader(dn, dir);
+    }
+
     app_info ai;
     gpid pid;
     std::string hint_message;
@@ -2035,6 +2049,169 @@ replica *replica_stub::load_replica(dir_node *dn, const char *dir)
     return rep;
 }
 
+void replica_stub::load_replicas(replicas &rps)
+{
+    LOG_INFO("start to load replicas");
+
+    // The replica dirs in a data dir, and the tasks loading them.
+    struct disk_load_queue
+    {
+        dir_node *dn;
+        std::vector<std::string> dirs;
+        size_t next_dir_index;
+        std::vector<task_ptr> tasks;
+    };
+
+    std::vector<disk_load_queue> queues;
+    int64_t total_dirs = 0;
+    for (const auto &dn : _fs_manager.get_dir_nodes()) {
+        // Skip IO error dir_node.
+        if (dsn_unlikely(dn->status == disk_status::IO_ERROR)) {
+            continue;
+        }
+        std::vector<std::string> sub_directories;
+        CHECK(dsn::utils::filesystem::get_subdirectories(dn->full_dir, sub_directories, false),
+              "fail to get sub_directories in {}",
+              dn->full_dir);
+
+        disk_load_queue queue{dn.get(), {}, 0, {}};
+        for (auto &dir : sub_directories) {
+            if (dsn::replication::is_data_dir_invalid(dir)) {
+                LOG_WARNING("ignore dir {}", dir);
+                continue;
+            }
+            queue.dirs.push_back(std::move(dir));
+        }
+        total_dirs += queue.dirs.size();
+        queues.push_back(std::move(queue));
+    }
+
+    uint64_t start_time = dsn_now_ms();
+    {
+        zauto_lock l(_load_progress_lock);
+        _load_start_time_ms = start_time;
+        for (const auto &queue : queues) {
+            _load_progress_map[queue.dn->tag].total_dirs += queue.dirs.size();
+        }
+    }
+    METRIC_VAR_SET(replica_dirs_to_load, total_dirs);
+
+    // Schedule the replicas of each data dir separately rather than all at once, so that the
+    // slow disks would not occupy all the workers, and the replicas opening the app and the
+    // ones replaying the private log would overlap on each disk.
+    utils::ex_lock rps_lock;
+    int task_hash = 0;
+    while (true) {
+        task_ptr waiting_task;
+        for (auto &queue : queues) {
+            queue.tasks.erase(std::remove_if(queue.tasks.begin(),
+                                             queue.tasks.end(),
+                                             [](const task_ptr &tsk) {
+                                                 return tsk->state() == TASK_STATE_FINISHED;
+                                             }),
+                              queue.tasks.end());
+
+            while (queue.next_dir_index < queue.dirs.size() &&
+                   queue.tasks.size() < FLAGS_max_replicas_on_load_for_each_disk) {
+                const auto dn = queue.dn;
+                const auto &dir = queue.dirs[queue.next_dir_index++];
+                queue.tasks.push_back(tasking::enqueue(
+                    LPC_REPLICATION_INIT_LOAD,
+                    &_tracker,
+                    [this, dn, dir, &rps, &rps_lock] {
+                        LOG_INFO("process dir {}", dir);
+
+                        update_load_progress(dn->tag, 1, 0);
+                        auto r = load_replica(dn, dir.c_str());
+                        update_load_progress(dn->tag, -1, 1);
+                        if (r == nullptr) {
+                            return;
+                        }
+                        METRIC_VAR_SET(replica_app_open_duration_ms, r->app_open_duration_ms());
+                        METRIC_VAR_SET(replica_private_log_replay_duration_ms,
+                                       r->private_log_replay_duration_ms());
+                        LOG_INFO("{}@{}: load replica '{}' success, <durable, commit> = <{}, {}>, "
+                                 "last_prepared_decree = {}, app_open_time_used = {} ms, "
+                                 "private_log_replay_time_used = {} ms",
+                                 r->get_gpid(),
+                                 dsn_primary_address(),
+                                 dir,
+                                 r->last_durable_decree(),
+                                 r->last_committed_decree(),
+                                 r->last_prepared_decree(),
+                                 r->app_open_duration_ms(),
+                                 r->private_log_replay_duration_ms());
+
+                        utils::auto_lock<utils::ex_lock> l(rps_lock);
+                        CHECK(rps.find(r->get_gpid()) == rps.end(),
+                              "conflict replica dir: {} <--> {}",
+                              r->dir(),
+                              rps[r->get_gpid()]->dir());
+
+                        rps[r->get_gpid()] = r;
+                    },
+                    task_hash++));
+            }
+
+            if (waiting_task == nullptr && !queue.tasks.empty()) {
+                waiting_task = queue.tasks.front();
+            }
+        }
+
+        // All the replicas have been loaded.
+        if (waiting_task == nullptr) {
+            break;
+        }
+
+        // Wait for a while rather than until the task finishes, so that the data dirs whose
+        // replicas have been loaded earlier could be refilled in time.
+        waiting_task->wait(static_cast<int>(FLAGS_load_replica_max_wait_time_ms));
+    }
+    uint64_t finish_time = dsn_now_ms();
+
+    {
+        zauto_lock l(_load_progress_lock);
+        _load_finish_time_ms = finish_time;
+    }
+    METRIC_VAR_SET(load_replicas_duration_ms, finish_time - start_time);
+    LOG_INFO("load replicas succeed, replica_count = {}, time_used = {} ms",
+             rps.size(),
+             finish_time - start_time);
+}
+
+void replica_stub::update_load_progress(const std::string &tag,
+                                        int64_t loading_delta,
+                                        int64_t loaded_delta)
+{
+    int64_t loading_replicas = 0;
+    int64_t loaded_dirs = 0;
+    {
+        zauto_lock l(_load_progress_lock);
+        auto &progress = _load_progress_map[tag];
+        progress.loading_replicas += loading_delta;
+        progress.loaded_dirs += loaded_delta;
+
+        for (const auto &kv : _load_progress_map) {
+            loading_replicas += kv.second.loading_replicas;
+            loaded_dirs += kv.second.loaded_dirs;
+        }
+    }
+
+    METRIC_VAR_SET(loading_replicas, loading_replicas);
+    METRIC_VAR_SET(loaded_replica_dirs, loaded_dirs);
+}
+
+void replica_stub::query_load_replicas_progress(
+    uint64_t &start_time_ms,
+    uint64_t &finish_time_ms,
+    std::map<std::string, replica_load_progress> &progress_map) const
+{
+    zauto_lock l(_load_progress_lock);
+    start_time_ms = _load_start_time_ms;
+    finish_time_ms = _load_finish_time_ms;
+    progress_map = _load_progress_map;
+}
+
 void replica_stub::clear_on_failure(replica *rep)
 {
     const auto rep_dir = rep->dir();
@@ -2066,6 +2243,7 @@ task_ptr replica_stub::begin_close_replica(replica_ptr r)
     if (_replicas.erase(id) == 0) {
         return nullptr;
     }
+    publish_replicas();
 
     METRIC_VAR_DECREMENT(total_replicas);
 
@@ -2145,6 +2323,13 @@ void replica_stub::handle_log_failure(error_code err)
 
 void replica_stub::open_service()
 {
+    // These requests are sent without the partition hash, thus all of them are dispatched to the
+    // first queue of THREAD_POOL_REPLICATION. They only read the replicas under _replicas_lock
+    // rather than relying on the thread of any replica, thus could be stolen by the idle workers
+    // once the pool uses dsn::tools::work_stealing_task_queue.
+    task_spec::get(RPC_QUERY_REPLICA_INFO)->allow_work_stealing = true;
+    task_spec::get(RPC_QUERY_APP_INFO)->allow_work_stealing = true;
+
     register_rpc_handler(RPC_CONFIG_PROPOSAL, "ProposeConfig", &replica_stub::on_config_proposal);
     register_rpc_handler(RPC_PREPARE, "prepare", &replica_stub::on_prepare);
     register_rpc_handler(RPC_LEARN, "Learn", &replica_stub::on_learn);
@@ -2515,6 +2700,8 @@ void replica_stub::close()
             _opening_replicas.erase(_opening_replicas.begin());
         }
 
+        // Hide all replicas from the lookups before closing them.
+        _replicas_snapshot.reset(std::make_unique<const replicas>());
         while (!_replicas.empty()) {
             _replicas.begin()->second->close();
 
@@ -2627,6 +2814,7 @@ replica_ptr replica_stub::create_child_replica_if_not_found(gpid child_pid,
             auto *rep = new replica(this, child_pid, *app, dn, false);
             rep->_config.status = partition_status::PS_INACTIVE;
             _replicas.insert(replicas::value_type(child_pid, rep));
+            publish_replicas();
             LOG_INFO("mock create_child_replica_if_not_found succeed");
             return rep;
         });
@@ -2647,6 +2835,7 @@ replica_ptr replica_stub::create_child_replica_if_not_found(gpid child_pid,
             if (rep != nullptr) {
                 auto pr = _replicas.insert(replicas::value_type(child_pid, rep));
                 CHECK(pr.second, "child replica {} has been existed", rep->name());
+                publish_replicas();
                 METRIC_VAR_INCREMENT(total_replicas);
                 _closed_replicas.erase(child_pid);
             }
@@ -2800,6 +2989,22 @@ void replica_stub::query_app_data_version(
     }
 }
 
+void replica_stub::query_app_hotkeys(
+    int32_t app_id,
+    hotkey_type::type type,
+    /*pidx => hotkeys*/ std::unordered_map<int32_t, std::vector<hotkey_info>> &hotkeys_map)
+{
+    zauto_read_lock l(_replicas_lock);
+    for (const auto &kv : _replicas) {
+        if (kv.first.get_app_id() == app_id) {
+            replica_ptr rep = kv.second;
+            if (rep != nullptr) {
+                rep->query_hotkeys(type, hotkeys_map[kv.first.get_partition_index()]);
+            }
+        }
+    }
+}
+
 void replica_stub::query_app_manual_compact_status(
     int32_t app_id, std::unordered_map<gpid, manual_compaction_status::type> &status)
 {
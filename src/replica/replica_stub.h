@@ -68,6 +68,7 @@
 #include "utils/flags.h"
 #include "utils/fmt_utils.h"
 #include "utils/metrics.h"
+#include "utils/rcu.h"
 #include "utils/zlocks.h"
 
 DSN_DECLARE_uint32(max_concurrent_manual_emergency_checkpointing_count);
@@ -118,6 +119,17 @@ typedef std::unordered_map<gpid, replica_ptr> replicas;
 typedef std::function<void(
     ::dsn::host_port /*from*/, const replica_configuration & /*new_config*/, bool /*is_closing*/)>
     replica_state_subscriber;
+// Load the replica located in the data dir with the replica dir, used to replace the way of
+// loading replicas in tests.
+typedef std::function<replica *(dir_node * /*dn*/, const char * /*dir*/)> replica_loader;
+
+// The progress of loading the replicas in a data dir on startup.
+struct replica_load_progress
+{
+    int64_t total_dirs = 0;
+    int64_t loaded_dirs = 0;
+    int64_t loading_replicas = 0;
+};
 
 class replica_stub;
 
@@ -191,6 +203,7 @@ public:
     void set_meta_server_connected_for_test(const configuration_query_by_node_response &config);
     void set_replica_state_subscriber_for_test(replica_state_subscriber subscriber,
                                                bool is_long_subscriber);
+    void set_replica_loader_for_test(replica_loader loader) { _replica_loader = std::move(loader); }
 
     //
     // common routines for inquiry
@@ -358,6 +371,10 @@ private:
                          const std::string &parent_dir = "");
     // Load an existing replica which is located in 'dn' with 'dir' directory.
     replica *load_replica(dir_node *dn, const char *dir);
+    // Load all the replicas in the available data dirs on startup, with at most
+    // FLAGS_max_replicas_on_load_for_each_disk replicas being loaded on each data dir.
+    void load_replicas(/*out*/ replicas &rps);
+    void update_load_progress(const std::string &tag, int64_t loading_delta, int64_t loaded_delta);
     // Clean up the memory state and on disk data if creating replica failed.
     void clear_on_failure(replica *rep);
     task_ptr begin_close_replica(replica_ptr r);
@@ -391,6 +408,10 @@ private:
 
     void register_ctrl_command();
 
+    // Publish a copy of `_replicas` for the lookups by get_replica(), which should be called
+    // whenever `_replicas` is changed, with `_replicas_lock` held for writing.
+    void publish_replicas();
+
     int get_app_id_from_replicas(std::string app_name)
     {
         for (const auto &replica : _replicas) {
@@ -406,6 +427,19 @@ private:
         int32_t app_id,
         /*pidx => data_version*/ std::unordered_map<int32_t, uint32_t> &version_map);
 
+    void query_app_hotkeys(
+        int32_t app_id,
+        hotkey_type::type type,
+        /*pidx => hotkeys*/ std::unordered_map<int32_t, std::vector<hotkey_info>> &hotkeys_map);
+
+    // Query the progress of loading replicas on startup. The start and finish time are 0 if
+    // the loading has not started or finished yet.
+    void query_load_replicas_progress(
+        uint64_t &start_time_ms,
+        uint64_t &finish_time_ms,
+        /*data dir tag => progress*/ std::map<std::string, replica_load_progress> &progress_map)
+        const;
+
 #ifdef DSN_ENABLE_GPERF
     // Try to release tcmalloc memory back to operating system
     // If release_all = true, it will release all reserved-not-used memory
@@ -441,6 +475,7 @@ private:
     friend class replica_follower;
     friend class replica_follower_test;
     friend class replica_http_service_test;
+    friend class load_replicas_test;
     FRIEND_TEST(open_replica_test, open_replica_add_decree_and_ballot_check);
     FRIEND_TEST(replica_test, test_auto_trash_of_corruption);
     FRIEND_TEST(replica_test, test_clear_on_failure);
@@ -453,6 +488,9 @@ private:
 
     mutable zrwlock_nr _replicas_lock;
     replicas _replicas;
+    // The immutable snapshot of `_replicas`, through which the replicas are looked up for every
+    // client request without any lock, since `_replicas` is rarely changed.
+    utils::rcu_ptr<replicas> _replicas_snapshot;
     opening_replicas _opening_replicas;
     closing_replicas _closing_replicas;
     closed_replicas _closed_replicas;
@@ -461,6 +499,11 @@ private:
     // The stringify of '_primary_host_port', used by logging usually.
     std::string _primary_host_port_cache;
 
+    mutable zlock _load_progress_lock;
+    uint64_t _load_start_time_ms{0};
+    uint64_t _load_finish_time_ms{0};
+    std::map<std::string, replica_load_progress> _load_progress_map;
+
     std::shared_ptr<dsn::dist::slave_failure_detector_with_multimaster> _failure_detector;
     mutable zlock _state_lock;
     volatile replica_node_state _state;
@@ -469,6 +512,8 @@ private:
     replication_options _options;
     replica_state_subscriber _replica_state_subscriber;
     bool _is_long_subscriber;
+    // Only set in tests, see set_replica_loader_for_test().
+    replica_loader _replica_loader;
 
     // temproal states
     ::dsn::task_ptr _config_query_task;
@@ -525,6 +570,13 @@ private:
     METRIC_VAR_DECLARE_gauge_int64(opening_replicas);
     METRIC_VAR_DECLARE_gauge_int64(closing_replicas);
 
+    METRIC_VAR_DECLARE_gauge_int64(replica_dirs_to_load);
+    METRIC_VAR_DECLARE_gauge_int64(loaded_replica_dirs);
+    METRIC_VAR_DECLARE_gauge_int64(loading_replicas);
+    METRIC_VAR_DECLARE_gauge_int64(load_replicas_duration_ms);
+    METRIC_VAR_DECLARE_percentile_int64(replica_app_open_duration_ms);
+    METRIC_VAR_DECLARE_percentile_int64(replica_private_log_replay_duration_ms);
+
     METRIC_VAR_DECLARE_gauge_int64(learning_replicas);
     METRIC_VAR_DECLARE_gauge_int64(learning_replicas_max_duration_ms);
     METRIC_VAR_DECLARE_gauge_int64(learning_replicas_max_copy_file_bytes);
@@ -30,6 +30,7 @@
 #include <cstdint>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "bulk_load_types.h"
 #include "common/json_helper.h"
@@ -106,6 +107,13 @@ struct kms_info
     }
 };
 
+// A hot hash key found in a replica, along with its estimated qps.
+struct hotkey_info
+{
+    std::string hash_key;
+    double qps;
+};
+
 /// The store engine interface of Pegasus.
 /// Inherited by pegasus::pegasus_server_impl
 /// Inherited by apps::rrdb_service
@@ -285,11 +293,21 @@ public:
         resp.__set_err_hint("on_detect_hotkey implementation not found");
     }
 
+    // Query the hot keys of the type which are continuously detected, in the descending order
+    // of qps.
+    virtual void query_hotkeys(hotkey_type::type type,
+                               /*out*/ std::vector<hotkey_info> &hotkeys) const
+    {
+    }
+
     // query pegasus data version
     virtual uint32_t query_data_version() const = 0;
 
     virtual manual_compaction_status::type query_compact_status() const = 0;
 
+    // query the size of the data in storage engine, in MB.
+    virtual int64_t query_storage_size_mb() const { return 0; }
+
 public:
     //
     // utility functions to be used by app
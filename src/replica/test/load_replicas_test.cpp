@@ -0,0 +1,219 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <fmt/core.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/fs_manager.h"
+#include "common/gpid.h"
+#include "common/replication_common.h"
+#include "dsn.layer2_types.h"
+#include "gtest/gtest.h"
+#include "replica/replica.h"
+#include "replica/replica_stub.h"
+#include "replica/test/mock_utils.h"
+#include "test_util/test_util.h"
+#include "utils/filesystem.h"
+#include "utils/flags.h"
+#include "utils/test_macros.h"
+
+DSN_DECLARE_uint32(max_replicas_on_load_for_each_disk);
+
+namespace dsn {
+namespace replication {
+
+// Load the replicas without opening them, while recording how many replicas are being loaded
+// concurrently on each data dir.
+class mock_load_replica_stub : public mock_replica_stub
+{
+public:
+    mock_load_replica_stub()
+    {
+        set_replica_loader_for_test(
+            [this](dir_node *dn, const char *dir) { return load_replica_for_test(dn, dir); });
+    }
+
+    void create_replica_dir(dir_node *dn, const gpid &pid)
+    {
+        const auto dir = dn->replica_dir(replication_options::kReplicaAppType, pid);
+        ASSERT_TRUE(utils::filesystem::create_directory(dir));
+        _pids_by_dir_name[utils::filesystem::get_file_name(dir)] = pid;
+    }
+
+    replica *load_replica_for_test(dir_node *dn, const char *dir)
+    {
+        const auto dir_name = utils::filesystem::get_file_name(dir);
+        {
+            std::lock_guard<std::mutex> guard(_mtx);
+            const auto loading_replicas = ++_loading_replicas_by_tag[dn->tag];
+            auto &max_loading_replicas = max_loading_replicas_by_tag[dn->tag];
+            max_loading_replicas = std::max(max_loading_replicas, loading_replicas);
+            loaded_dir_names.insert(dir_name);
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(kLoadReplicaTimeMs));
+
+        std::lock_guard<std::mutex> guard(_mtx);
+        --_loading_replicas_by_tag[dn->tag];
+
+        const auto iter = _pids_by_dir_name.find(dir_name);
+        if (iter == _pids_by_dir_name.end()) {
+            return nullptr;
+        }
+
+        app_info info;
+        info.app_type = replication_options::kReplicaAppType;
+        info.app_name = "temp";
+        return new mock_replica(this, iter->second, info, dn);
+    }
+
+    static const uint64_t kLoadReplicaTimeMs = 20;
+
+    // data dir tag => max number of replicas being loaded at the same time
+    std::map<std::string, size_t> max_loading_replicas_by_tag;
+    std::set<std::string> loaded_dir_names;
+
+private:
+    std::mutex _mtx;
+    std::map<std::string, size_t> _loading_replicas_by_tag;
+    std::map<std::string, gpid> _pids_by_dir_name;
+};
+
+class load_replicas_test : public pegasus::encrypt_data_test_base
+{
+public:
+    load_replicas_test() : _stub(std::make_unique<mock_load_replica_stub>()) {}
+
+    ~load_replicas_test() override
+    {
+        _stub.reset();
+        for (const auto &data_dir : _data_dirs) {
+            utils::filesystem::remove_path(data_dir);
+        }
+    }
+
+    // Create 'replicas_per_disk' valid replica dirs and an invalid one for each data dir.
+    void prepare_data_dirs(size_t disk_count, int64_t replicas_per_disk)
+    {
+        std::vector<std::string> tags;
+        for (size_t i = 0; i < disk_count; ++i) {
+            _data_dirs.push_back(fmt::format("load_replicas_test_dir_{}", i));
+            tags.push_back(fmt::format("tag_{}", i));
+            utils::filesystem::remove_path(_data_dirs.back());
+        }
+        _stub->_fs_manager.initialize(_data_dirs, tags);
+
+        int partition_index = 0;
+        for (const auto &dn : _stub->_fs_manager.get_dir_nodes()) {
+            for (int64_t i = 0; i < replicas_per_disk; ++i) {
+                NO_FATALS(_stub->create_replica_dir(dn.get(), gpid(1, partition_index++)));
+            }
+            ASSERT_TRUE(utils::filesystem::create_directory(
+                utils::filesystem::path_combine(dn->full_dir, "1.999.pegasus.gar")));
+        }
+        _total_replicas = disk_count * static_cast<size_t>(replicas_per_disk);
+    }
+
+    void test_load_replicas(size_t disk_count, int64_t replicas_per_disk)
+    {
+        NO_FATALS(prepare_data_dirs(disk_count, replicas_per_disk));
+
+        replicas rps;
+        _stub->load_replicas(rps);
+
+        // All the valid replica dirs are loaded exactly once, while the invalid ones are ignored.
+        ASSERT_EQ(_total_replicas, rps.size());
+        ASSERT_EQ(_total_replicas, _stub->loaded_dir_names.size());
+        for (const auto &dir_name : _stub->loaded_dir_names) {
+            ASSERT_EQ(std::string::npos, dir_name.find(".gar"));
+        }
+
+        // The replicas being loaded concurrently on each data dir never exceed the limit.
+        ASSERT_EQ(replicas_per_disk == 0 ? 0 : disk_count,
+                  _stub->max_loading_replicas_by_tag.size());
+        for (const auto &kv : _stub->max_loading_replicas_by_tag) {
+            ASSERT_LE(1U, kv.second);
+            ASSERT_GE(FLAGS_max_replicas_on_load_for_each_disk, kv.second);
+        }
+
+        // The progress of each data dir has been finished.
+        uint64_t start_time_ms = 0;
+        uint64_t finish_time_ms = 0;
+        std::map<std::string, replica_load_progress> progress_map;
+        _stub->query_load_replicas_progress(start_time_ms, finish_time_ms, progress_map);
+        ASSERT_LT(0U, start_time_ms);
+        ASSERT_LE(start_time_ms, finish_time_ms);
+        ASSERT_EQ(disk_count, progress_map.size());
+        for (const auto &kv : progress_map) {
+            ASSERT_EQ(replicas_per_disk, kv.second.total_dirs);
+            ASSERT_EQ(replicas_per_disk, kv.second.loaded_dirs);
+            ASSERT_EQ(0, kv.second.loading_replicas);
+        }
+
+        const auto total_replicas = static_cast<int64_t>(_total_replicas);
+        ASSERT_EQ(total_replicas, _stub->METRIC_VAR_VALUE(replica_dirs_to_load));
+        ASSERT_EQ(total_replicas, _stub->METRIC_VAR_VALUE(loaded_replica_dirs));
+        ASSERT_EQ(0, _stub->METRIC_VAR_VALUE(loading_replicas));
+
+        // Each data dir loads its replicas in at least 'replicas_per_disk / limit' rounds.
+        const auto min_rounds = (replicas_per_disk + FLAGS_max_replicas_on_load_for_each_disk - 1) /
+                                FLAGS_max_replicas_on_load_for_each_disk;
+        const auto min_duration_ms = min_rounds * mock_load_replica_stub::kLoadReplicaTimeMs;
+        ASSERT_LE(min_duration_ms, finish_time_ms - start_time_ms);
+        ASSERT_EQ(static_cast<int64_t>(finish_time_ms - start_time_ms),
+                  _stub->METRIC_VAR_VALUE(load_replicas_duration_ms));
+    }
+
+private:
+    std::unique_ptr<mock_load_replica_stub> _stub;
+    std::vector<std::string> _data_dirs;
+    size_t _total_replicas{0};
+};
+
+INSTANTIATE_TEST_SUITE_P(, load_replicas_test, ::testing::Values(false, true));
+
+TEST_P(load_replicas_test, load_one_replica_at_a_time_for_each_disk)
+{
+    PRESERVE_FLAG(max_replicas_on_load_for_each_disk);
+    FLAGS_max_replicas_on_load_for_each_disk = 1;
+    NO_FATALS(test_load_replicas(3, 4));
+}
+
+TEST_P(load_replicas_test, load_replicas_concurrently_for_each_disk)
+{
+    PRESERVE_FLAG(max_replicas_on_load_for_each_disk);
+    FLAGS_max_replicas_on_load_for_each_disk = 2;
+    NO_FATALS(test_load_replicas(2, 5));
+}
+
+TEST_P(load_replicas_test, load_no_replica)
+{
+    NO_FATALS(test_load_replicas(2, 0));
+}
+
+} // namespace replication
+} // namespace dsn
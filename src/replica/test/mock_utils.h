@@ -252,7 +252,11 @@ public:
 
     ~mock_replica_stub() override = default;
 
-    void add_replica(replica *r) { _replicas[r->get_gpid()] = replica_ptr(r); }
+    void add_replica(replica *r)
+    {
+        _replicas[r->get_gpid()] = replica_ptr(r);
+        publish_replicas();
+    }
 
     mock_replica *add_primary_replica(int appid, int part_index = 1)
     {
@@ -306,6 +310,7 @@ public:
             new mock_replica(this, pid, info, dn, need_restore, is_duplication_follower);
         rep->set_replica_config(config);
         _replicas[pid] = rep;
+        publish_replicas();
 
         return rep;
     }
@@ -28,6 +28,7 @@
 
 // IWYU pragma: no_include <ext/alloc_traits.h>
 #include <sys/types.h>
+#include <algorithm>
 #include <unordered_map>
 
 #include "aio/aio_task.h"
@@ -47,9 +48,12 @@
 #include "utils/blob.h"
 #include "utils/env.h"
 #include "utils/filesystem.h"
+#include "utils/flags.h"
 #include "utils/fmt_logging.h"
 #include "utils/ports.h"
 
+DSN_DECLARE_uint32(plog_group_commit_max_window_ms);
+
 namespace dsn {
 class message_ex;
 } // namespace dsn
@@ -489,6 +493,57 @@ TEST_P(mutation_log_test, open)
     }
 }
 
+TEST_P(mutation_log_test, group_commit)
+{
+    PRESERVE_FLAG(plog_group_commit_max_window_ms);
+    FLAGS_plog_group_commit_max_window_ms = 10;
+
+    std::vector<mutation_ptr> mutations;
+    { // writing logs, the pending mutations may be held and written in groups
+        mutation_log_ptr mlog = create_private_log(4);
+
+        for (int i = 0; i < 1000; i++) {
+            mutation_ptr mu = create_test_mutation(2 + i, "hello!");
+            mutations.push_back(mu);
+            mlog->append(mu, LPC_AIO_IMMEDIATE_CALLBACK, nullptr, nullptr, 0);
+        }
+        mlog->flush();
+    }
+
+    { // reading logs, all of the mutations should be written in order
+        mutation_log_ptr mlog = new mutation_log_private(_log_dir, 4, get_gpid(), _replica.get());
+
+        // Each write of the pending mutations is a separate log block, and the mutations in the
+        // same block are adjacent. Once a mutation doesn't follow the previous one, it is the
+        // first mutation of a new block since there is a block header (or a file header) ahead.
+        int mutation_index = -1;
+        int block_count = 0;
+        int block_mutations = 0;
+        int max_block_mutations = 0;
+        int64_t next_offset = -1;
+        mlog->open(
+            [&](int log_length, mutation_ptr &mu) -> bool {
+                mutation_ptr wmu = mutations[++mutation_index];
+                EXPECT_EQ(wmu->data.header, mu->data.header);
+                ASSERT_BLOB_EQ(wmu->data.updates[0].data, mu->data.updates[0].data);
+
+                if (mu->data.header.log_offset != next_offset) {
+                    ++block_count;
+                    block_mutations = 0;
+                }
+                max_block_mutations = std::max(max_block_mutations, ++block_mutations);
+                next_offset = mu->data.header.log_offset + log_length;
+                return true;
+            },
+            nullptr);
+        ASSERT_EQ(mutation_index + 1, (int)mutations.size());
+
+        // The mutations have been written in groups rather than one by one.
+        ASSERT_LT(block_count, (int)mutations.size());
+        ASSERT_LT(1, max_block_mutations);
+    }
+}
+
 TEST_P(mutation_log_test, replay_multiple_files_10000_1mb) { test_replay_multiple_files(10000, 1); }
 
 TEST_P(mutation_log_test, replay_multiple_files_20000_1mb) { test_replay_multiple_files(20000, 1); }
@@ -0,0 +1,113 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "common/replication.codes.h"
+#include "consensus_types.h"
+#include "gtest/gtest.h"
+#include "replica/mutation.h"
+#include "replica_test_base.h"
+#include "runtime/rpc/rpc_message.h"
+#include "runtime/rpc/rpc_stream.h"
+#include "test_util/test_util.h"
+#include "utils/autoref_ptr.h"
+#include "utils/binary_writer.h"
+#include "utils/blob.h"
+#include "utils/flags.h"
+
+DSN_DECLARE_uint32(mutation_zero_copy_min_update_bytes);
+
+namespace dsn {
+namespace replication {
+
+class mutation_test : public replica_test_base
+{
+public:
+    mutation_ptr create_mutation(const std::vector<std::string> &datas)
+    {
+        mutation_ptr mu = create_test_mutation(1, datas.front());
+        for (size_t i = 1; i < datas.size(); ++i) {
+            mu->data.updates.emplace_back(mutation_update());
+            mu->data.updates.back().code = RPC_COLD_BACKUP;
+            mu->data.updates.back().data = blob::create_from_bytes(std::string(datas[i]));
+            mu->client_requests.push_back(nullptr);
+        }
+        return mu;
+    }
+
+    static bool contains_buffer(const message_ex *msg, const blob &bb)
+    {
+        for (const auto &buffer : msg->buffers) {
+            if (buffer.data() == bb.data()) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+INSTANTIATE_TEST_SUITE_P(, mutation_test, ::testing::Values(false, true));
+
+TEST_P(mutation_test, write_to_message)
+{
+    PRESERVE_FLAG(mutation_zero_copy_min_update_bytes);
+    FLAGS_mutation_zero_copy_min_update_bytes = 1024;
+
+    const std::vector<std::string> datas = {
+        std::string(16, 'a'), std::string(4096, 'b'), std::string(1024, 'c'), std::string(8, 'd')};
+    mutation_ptr mu = create_mutation(datas);
+
+    // The data written to a plain writer would be the same as the ones written to the messages.
+    binary_writer plain_writer;
+    mu->write_to(plain_writer, nullptr);
+    const std::string expected_body = plain_writer.get_buffer().to_string();
+
+    // Write the same mutation to the messages as the prepare messages to the secondaries.
+    for (int i = 0; i < 3; ++i) {
+        message_ptr msg(message_ex::create_request(RPC_PREPARE));
+        {
+            rpc_write_stream writer(msg.get());
+            mu->write_to(writer, msg.get());
+        }
+        ASSERT_EQ(expected_body.size(), msg->body_size());
+
+        // Only the large updates are shared by the messages, while the small ones are copied.
+        ASSERT_FALSE(contains_buffer(msg.get(), mu->data.updates[0].data));
+        ASSERT_TRUE(contains_buffer(msg.get(), mu->data.updates[1].data));
+        ASSERT_TRUE(contains_buffer(msg.get(), mu->data.updates[2].data));
+        ASSERT_FALSE(contains_buffer(msg.get(), mu->data.updates[3].data));
+
+        // The message received by the secondaries should be decoded as the same mutation.
+        message_ptr recv_msg(msg->copy(true, true));
+        std::string body(recv_msg->buffers[0].data(), recv_msg->buffers[0].length());
+        ASSERT_EQ(expected_body, body);
+
+        rpc_read_stream reader(recv_msg.get());
+        mutation_ptr recv_mu = mutation::read_from(reader, recv_msg.get());
+        ASSERT_EQ(mu->data.header.decree, recv_mu->data.header.decree);
+        ASSERT_EQ(datas.size(), recv_mu->data.updates.size());
+        for (size_t j = 0; j < datas.size(); ++j) {
+            ASSERT_EQ(datas[j], recv_mu->data.updates[j].data.to_string());
+        }
+    }
+}
+
+} // namespace replication
+} // namespace dsn
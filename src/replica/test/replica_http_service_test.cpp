@@ -16,6 +16,8 @@
 // under the License.
 
 #include <fmt/core.h>
+#include <nlohmann/json.hpp>
+#include <stdint.h>
 #include <map>
 #include <memory>
 #include <string>
@@ -28,8 +30,10 @@
 #include "http/http_server.h"
 #include "http/http_status_code.h"
 #include "replica/replica_http_service.h"
+#include "replica/replica_stub.h"
 #include "replica/test/mock_utils.h"
 #include "replica/test/replica_test_base.h"
+#include "runtime/api_layer1.h"
 #include "utils/flags.h"
 #include "utils/test_macros.h"
 
@@ -99,6 +103,24 @@ public:
         ASSERT_EQ(fmt::format(unfilled_resp, expect_value), resp.body);
     }
 
+    void set_load_progress(uint64_t start_time_ms,
+                           uint64_t finish_time_ms,
+                           const map<string, replica_load_progress> &progress_map)
+    {
+        stub->_load_start_time_ms = start_time_ms;
+        stub->_load_finish_time_ms = finish_time_ms;
+        stub->_load_progress_map = progress_map;
+    }
+
+    void test_load_progress(nlohmann::json &json)
+    {
+        http_request req;
+        http_response resp;
+        _http_svc->query_load_progress_handler(req, resp);
+        ASSERT_EQ(resp.status_code, http_status_code::kOk);
+        json = nlohmann::json::parse(resp.body);
+    }
+
 private:
     std::unique_ptr<replica_http_service> _http_svc;
 };
@@ -142,5 +164,39 @@ TEST_P(replica_http_service_test, update_config_handler)
     ASSERT_EQ(10, FLAGS_config_sync_interval_ms);
 }
 
+TEST_P(replica_http_service_test, load_progress_handler)
+{
+    // The replicas have not been loaded.
+    nlohmann::json json;
+    NO_FATALS(test_load_progress(json));
+    ASSERT_EQ("not_started", json["status"]);
+    ASSERT_EQ(0, json["total_dirs"]);
+    ASSERT_TRUE(json["disks"].empty());
+
+    // The replicas are being loaded.
+    set_load_progress(dsn_now_ms(), 0, {{"tag1", {2, 1, 1}}, {"tag2", {3, 1, 2}}});
+    NO_FATALS(test_load_progress(json));
+    ASSERT_EQ("loading", json["status"]);
+    ASSERT_EQ(5, json["total_dirs"]);
+    ASSERT_EQ(2, json["loaded_dirs"]);
+    ASSERT_EQ(3, json["loading_replicas"]);
+    ASSERT_EQ(2U, json["disks"].size());
+    ASSERT_EQ(2, json["disks"]["tag1"]["total_dirs"]);
+    ASSERT_EQ(1, json["disks"]["tag1"]["loaded_dirs"]);
+    ASSERT_EQ(1, json["disks"]["tag1"]["loading_replicas"]);
+    ASSERT_EQ(3, json["disks"]["tag2"]["total_dirs"]);
+    ASSERT_EQ(1, json["disks"]["tag2"]["loaded_dirs"]);
+    ASSERT_EQ(2, json["disks"]["tag2"]["loading_replicas"]);
+
+    // All the replicas have been loaded.
+    set_load_progress(100, 350, {{"tag1", {2, 2, 0}}, {"tag2", {3, 3, 0}}});
+    NO_FATALS(test_load_progress(json));
+    ASSERT_EQ("finished", json["status"]);
+    ASSERT_EQ(250, json["time_used_ms"]);
+    ASSERT_EQ(5, json["total_dirs"]);
+    ASSERT_EQ(5, json["loaded_dirs"]);
+    ASSERT_EQ(0, json["loading_replicas"]);
+}
+
 } // namespace replication
 } // namespace dsn
@@ -39,10 +39,13 @@
 #include <boost/asio/ip/impl/address_v4.ipp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/socket_base.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/system/error_code.hpp>
 // IWYU pragma: no_include <ext/alloc_traits.h>
+#include <chrono>
 #include <cstddef>
 #include <iterator>
+#include <memory>
 #include <new>
 #include <vector>
 
@@ -57,6 +60,7 @@
 // IWYU pragma: no_include "boost/asio/ip/impl/address.ipp"
 // IWYU pragma: no_include "boost/asio/ip/impl/address_v4.ipp"
 // IWYU pragma: no_include "boost/asio/socket_base.hpp"
+// IWYU pragma: no_include "boost/asio/steady_timer.hpp"
 // IWYU pragma: no_include "boost/system/error_code.hpp"
 #include "runtime/rpc/asio_net_provider.h"
 #include "runtime/rpc/rpc_address.h"
@@ -187,6 +191,20 @@ void asio_rpc_session::send(uint64_t signature)
         });
 }
 
+void asio_rpc_session::delay_send(uint64_t signature, uint32_t delay_us)
+{
+    // The timer runs on the io_context of the socket, thus the messages would be written by the
+    // network threads as usual once the delay is over.
+    auto timer = std::make_shared<boost::asio::steady_timer>(_socket->get_executor(),
+                                                             std::chrono::microseconds(delay_us));
+
+    add_ref();
+    timer->async_wait([this, timer, signature](const boost::system::error_code &) {
+        flush_delayed_send(signature);
+        release_ref();
+    });
+}
+
 asio_rpc_session::asio_rpc_session(asio_network_provider &net,
                                    ::dsn::rpc_address remote_addr,
                                    std::shared_ptr<boost::asio::ip::tcp::socket> &socket,
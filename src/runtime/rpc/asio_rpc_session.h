@@ -55,6 +55,8 @@ public:
 
     void send(uint64_t signature) override;
 
+    void delay_send(uint64_t signature, uint32_t delay_us) override;
+
     void close() override;
 
     void connect() override;
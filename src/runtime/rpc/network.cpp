@@ -28,12 +28,15 @@
 
 #include <errno.h>
 #include <unistd.h>
+#include <algorithm>
 #include <chrono>
 #include <list>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "message_parser_manager.h"
+#include "runtime/api_layer1.h"
 #include "runtime/api_task.h"
 #include "runtime/rpc/rpc_address.h"
 #include "runtime/rpc/rpc_engine.h"
@@ -59,6 +62,16 @@ METRIC_DEFINE_gauge_int64(server,
                           dsn::metric_unit::kSessions,
                           "The number of sessions from server side");
 
+METRIC_DEFINE_histogram(server,
+                        network_send_batch_messages,
+                        dsn::metric_unit::kMessages,
+                        "The number of messages coalesced into a single write of sessions");
+
+METRIC_DEFINE_histogram(server,
+                        network_send_batch_bytes,
+                        dsn::metric_unit::kBytes,
+                        "The bytes of messages coalesced into a single write of sessions");
+
 DSN_DEFINE_uint32(network,
                   conn_threshold_per_ip,
                   0,
@@ -74,8 +87,35 @@ DSN_DEFINE_string(network,
                   "",
                   "network interface name used to init primary ipv4 address, "
                   "if empty, means using a site local address");
+DSN_DEFINE_int32(network,
+                 max_buffer_block_count_per_send,
+                 64,
+                 "The max number of buffer blocks of the queued messages that are coalesced into "
+                 "a single write of a session");
+DSN_DEFINE_validator(max_buffer_block_count_per_send, [](int32_t value) -> bool {
+    return value > 0;
+});
+DSN_DEFINE_uint32(network,
+                  max_bytes_per_send,
+                  0,
+                  "The max bytes of the queued messages that are coalesced into a single write of "
+                  "a session, 0 means no limit. A message larger than this is still sent alone");
+DSN_TAG_VARIABLE(max_bytes_per_send, FT_MUTABLE);
+DSN_DEFINE_uint32(network,
+                  send_coalesce_delay_us,
+                  0,
+                  "The max time in microseconds an idle session waits for more messages before "
+                  "writing, like Nagle's algorithm. It's applied only if the messages are queued "
+                  "more frequently than that on the session. 0 means never waiting");
+DSN_TAG_VARIABLE(send_coalesce_delay_us, FT_MUTABLE);
 
 namespace dsn {
+namespace {
+// The intervals between the messages queued on a session are capped, so that the average could
+// recover quickly from an idle period.
+const uint64_t kMaxMessageIntervalNs = 1000000000;
+} // anonymous namespace
+
 /*static*/ join_point<void, rpc_session *>
     rpc_session::on_rpc_session_connected("rpc.session.connected");
 /*static*/ join_point<void, rpc_session *>
@@ -212,6 +252,8 @@ inline bool rpc_session::unlink_message_for_send()
 {
     auto n = _messages.next();
     int bcount = 0;
+    size_t bytes = 0;
+    const size_t max_bytes = FLAGS_max_bytes_per_send;
 
     DCHECK_EQ(0, _sending_buffers.size());
     DCHECK_EQ(0, _sending_msgs.size());
@@ -226,18 +268,106 @@ inline bool rpc_session::unlink_message_for_send()
         _sending_buffers.resize(bcount + lcount);
         auto rcount = _parser->get_buffers_on_send(lmsg, &_sending_buffers[bcount]);
         CHECK_GE(lcount, rcount);
+
+        size_t lbytes = 0;
+        for (int i = bcount; i < bcount + rcount; ++i) {
+            lbytes += _sending_buffers[i].sz;
+        }
+        if (max_bytes > 0 && bcount > 0 && bytes + lbytes > max_bytes) {
+            _sending_buffers.resize(bcount);
+            break;
+        }
+
         if (lcount != rcount)
             _sending_buffers.resize(bcount + rcount);
         bcount += rcount;
+        bytes += lbytes;
         _sending_msgs.push_back(lmsg);
 
         n = n->next();
         lmsg->dl.remove();
     }
 
+    if (_sending_msgs.empty()) {
+        return false;
+    }
+
     // added in send_message
     _message_count -= (int)_sending_msgs.size();
-    return _sending_msgs.size() > 0;
+    _net.on_send_batch_prepared(_sending_msgs.size(), bytes);
+    return true;
+}
+
+uint32_t rpc_session::update_send_delay_us(uint64_t now_ns)
+{
+    const uint32_t delay_us = FLAGS_send_coalesce_delay_us;
+    if (delay_us == 0) {
+        return 0;
+    }
+
+    if (_last_message_queued_ns != 0) {
+        uint64_t interval_ns = 0;
+        if (now_ns > _last_message_queued_ns) {
+            interval_ns = std::min(now_ns - _last_message_queued_ns, kMaxMessageIntervalNs);
+        }
+        _avg_message_interval_ns = _avg_message_interval_ns - _avg_message_interval_ns / 8 +
+                                   interval_ns / 8;
+    }
+    _last_message_queued_ns = std::max(_last_message_queued_ns, now_ns);
+
+    // Wait only if more messages are expected to be queued during the delay, otherwise the
+    // message would just be delayed for nothing.
+    return _avg_message_interval_ns < delay_us * 1000ULL ? delay_us : 0;
+}
+
+void rpc_session::get_send_size(message_ex *msg, int &buffer_block_count, size_t &bytes)
+{
+    const int lcount = _parser->get_buffer_count_on_send(msg);
+    std::vector<message_parser::send_buf> buffers(lcount);
+    buffer_block_count = _parser->get_buffers_on_send(msg, buffers.data());
+    CHECK_GE(lcount, buffer_block_count);
+
+    bytes = 0;
+    for (int i = 0; i < buffer_block_count; ++i) {
+        bytes += buffers[i].sz;
+    }
+}
+
+bool rpc_session::add_delayed_send_size(int buffer_block_count, size_t bytes)
+{
+    _delayed_buffer_block_count += buffer_block_count;
+    _delayed_bytes += bytes;
+
+    const size_t max_bytes = FLAGS_max_bytes_per_send;
+    return _delayed_buffer_block_count >= _max_buffer_block_count_per_send ||
+           (max_bytes > 0 && _delayed_bytes >= max_bytes);
+}
+
+void rpc_session::delay_send(uint64_t signature, uint32_t delay_us)
+{
+    flush_delayed_send(signature);
+}
+
+void rpc_session::flush_delayed_send(uint64_t signature)
+{
+    {
+        utils::auto_lock<utils::ex_lock_nr> l(_lock);
+        // The messages may have been sent since enough of them were queued during the delay.
+        if (!_is_send_delayed || signature != _message_sent + 1) {
+            return;
+        }
+        _is_send_delayed = false;
+
+        CHECK(_is_sending_next, "delayed msg must be sending");
+        // The session may have been closed, or the messages may have been cleared or cancelled
+        // during the delay.
+        if (SS_CONNECTED != _connect_state || !unlink_message_for_send()) {
+            _is_sending_next = false;
+            return;
+        }
+    }
+
+    this->send(signature);
 }
 
 DEFINE_TASK_CODE(LPC_DELAY_RPC_REQUEST_RATE, TASK_PRIORITY_COMMON, THREAD_POOL_DEFAULT)
@@ -301,22 +431,50 @@ void rpc_session::send_message(message_ex *msg)
     CHECK_NOTNULL(_parser, "parser should not be null when send");
     _parser->prepare_on_send(msg);
 
+    // Avoid reading the clock and the buffers if the send delay is disabled.
+    uint64_t now_ns = 0;
+    int buffer_block_count = 0;
+    size_t bytes = 0;
+    if (FLAGS_send_coalesce_delay_us > 0) {
+        now_ns = dsn_now_ns();
+        get_send_size(msg, buffer_block_count, bytes);
+    }
+
     uint64_t sig;
+    uint32_t delay_us = 0;
     {
         utils::auto_lock<utils::ex_lock_nr> l(_lock);
         msg->dl.insert_before(&_messages);
         ++_message_count;
 
+        const uint32_t send_delay_us = update_send_delay_us(now_ns);
         if ((SS_CONNECTED == _connect_state) && !_is_sending_next) {
             _is_sending_next = true;
             sig = _message_sent + 1;
+            _delayed_buffer_block_count = 0;
+            _delayed_bytes = 0;
+            if (send_delay_us > 0 && !add_delayed_send_size(buffer_block_count, bytes)) {
+                _is_send_delayed = true;
+                delay_us = send_delay_us;
+            } else {
+                unlink_message_for_send();
+            }
+        } else if ((SS_CONNECTED == _connect_state) && _is_send_delayed &&
+                   add_delayed_send_size(buffer_block_count, bytes)) {
+            // Enough messages have been queued to fill a write, stop waiting for more.
+            _is_send_delayed = false;
+            sig = _message_sent + 1;
             unlink_message_for_send();
         } else {
             return;
         }
     }
 
-    this->send(sig);
+    if (delay_us > 0) {
+        delay_send(sig, delay_us);
+    } else {
+        this->send(sig);
+    }
 }
 
 bool rpc_session::cancel(message_ex *request)
@@ -385,6 +543,11 @@ rpc_session::rpc_session(connection_oriented_network &net,
     : _connect_state(is_client ? SS_DISCONNECTED : SS_CONNECTED),
       _message_count(0),
       _is_sending_next(false),
+      _is_send_delayed(false),
+      _last_message_queued_ns(0),
+      _avg_message_interval_ns(kMaxMessageIntervalNs),
+      _delayed_buffer_block_count(0),
+      _delayed_bytes(0),
       _message_sent(0),
       _net(net),
       _remote_addr(remote_addr),
@@ -549,7 +712,7 @@ network::network(rpc_engine *srv, network *inner_provider)
     : _engine(srv), _client_hdr_format(NET_HDR_DSN), _unknown_msg_header_format(NET_HDR_INVALID)
 {
     _message_buffer_block_size = 1024 * 64;
-    _max_buffer_block_count_per_send = 64; // TODO: windows, how about the other platforms?
+    _max_buffer_block_count_per_send = FLAGS_max_buffer_block_count_per_send;
     _unknown_msg_header_format =
         network_header_format::from_string(FLAGS_unknown_message_header_format, NET_HDR_INVALID);
 }
@@ -607,7 +770,9 @@ uint32_t network::get_local_ipv4()
 connection_oriented_network::connection_oriented_network(rpc_engine *srv, network *inner_provider)
     : network(srv, inner_provider),
       METRIC_VAR_INIT_server(network_client_sessions),
-      METRIC_VAR_INIT_server(network_server_sessions)
+      METRIC_VAR_INIT_server(network_server_sessions),
+      METRIC_VAR_INIT_server(network_send_batch_messages),
+      METRIC_VAR_INIT_server(network_send_batch_bytes)
 {
 }
 
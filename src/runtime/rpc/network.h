@@ -177,6 +177,13 @@ public:
     // called upon RPC call, rpc client session is created on demand
     virtual void send_message(message_ex *request) override;
 
+    // called by sessions once the queued messages are coalesced into a single write
+    void on_send_batch_prepared(size_t message_count, size_t bytes)
+    {
+        METRIC_VAR_SET(network_send_batch_messages, message_count);
+        METRIC_VAR_SET(network_send_batch_bytes, bytes);
+    }
+
     // called by rpc engine
     virtual void inject_drop_message(message_ex *msg, bool is_send) override;
 
@@ -196,6 +203,8 @@ protected:
 
     METRIC_VAR_DECLARE_gauge_int64(network_client_sessions);
     METRIC_VAR_DECLARE_gauge_int64(network_server_sessions);
+    METRIC_VAR_DECLARE_histogram(network_send_batch_messages);
+    METRIC_VAR_DECLARE_histogram(network_send_batch_bytes);
 };
 
 /*!
@@ -274,6 +283,11 @@ public:
     // should always be called in lock
     bool unlink_message_for_send();
     virtual void send(uint64_t signature) = 0;
+    // Send the queued messages after `delay_us` microseconds, to coalesce the messages arriving
+    // in the meantime into the same write. Subclasses should call flush_delayed_send() once the
+    // delay is over; by default the messages are sent immediately.
+    virtual void delay_send(uint64_t signature, uint32_t delay_us);
+    void flush_delayed_send(uint64_t signature);
     void on_send_completed(uint64_t signature = 0);
     virtual void on_failure(bool is_write = false);
 
@@ -307,6 +321,18 @@ protected:
     int _message_count; // count of _messages
 
     bool _is_sending_next;
+    // Whether the next send is delayed to coalesce more messages, see delay_send().
+    bool _is_send_delayed;
+
+    // The time the last message is queued, and the moving average of the intervals between the
+    // messages queued, in nanoseconds. Both are updated only if the send delay is enabled.
+    uint64_t _last_message_queued_ns;
+    uint64_t _avg_message_interval_ns;
+
+    // The buffer blocks and bytes of the messages queued during the send delay, which end the
+    // delay once they could fill a write. Both are updated only if the send delay is enabled.
+    int _delayed_buffer_block_count;
+    size_t _delayed_bytes;
 
     std::vector<message_ex *> _sending_msgs;
     std::vector<message_parser::send_buf> _sending_buffers;
@@ -327,6 +353,16 @@ protected:
     void clear_send_queue(bool resend_msgs);
     bool on_disconnected(bool is_write);
 
+    // Update the average interval between messages by the one just queued at `now_ns`, and return
+    // how long the next send should be delayed, in microseconds. Should be called in lock.
+    uint32_t update_send_delay_us(uint64_t now_ns);
+
+    // Get the number of buffer blocks and the bytes that `msg` takes in a write.
+    void get_send_size(message_ex *msg, /*out*/ int &buffer_block_count, /*out*/ size_t &bytes);
+    // Add the size of a message queued during the send delay, and return whether the messages
+    // queued during the delay could fill a write. Should be called in lock.
+    bool add_delayed_send_size(int buffer_block_count, size_t bytes);
+
 protected:
     // constant info
     connection_oriented_network &_net;
@@ -440,6 +440,20 @@ void message_ex::write_commit(size_t size)
     this->header->body_length += (int)size;
 }
 
+void message_ex::write_append(const blob &data)
+{
+    CHECK(!this->_is_read && this->_rw_committed,
+          "there are pending msg write not committed"
+          ", please invoke dsn_msg_write_next and dsn_msg_write_commit in pairs");
+
+    this->buffers.push_back(data);
+    this->_rw_index++;
+    this->_rw_offset = static_cast<int>(data.length());
+    this->header->body_length += static_cast<int>(data.length());
+
+    CHECK_EQ_MSG(_rw_index + 1, buffers.size(), "message write buffer count is not right");
+}
+
 bool message_ex::read_next(void **ptr, size_t *size)
 {
     // printf("%p %s %d\n", this, __FUNCTION__, utils::get_current_tid());
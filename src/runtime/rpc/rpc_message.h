@@ -203,6 +203,8 @@ public:
     //
     void write_next(void **ptr, size_t *size, size_t min_size);
     void write_commit(size_t size);
+    // Append `data` to the body as a separate buffer without copying.
+    void write_append(const blob &data);
     bool read_next(void **ptr, size_t *size);
     bool read_next(blob &data);
     void read_commit(size_t size);
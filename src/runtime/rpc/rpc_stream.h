@@ -112,6 +112,16 @@ public:
         commit_buffer();
     }
 
+    // Attach the buffer of `val` to the message as a separate segment, which is released after
+    // the message is sent.
+    bool write_zero_copy(const blob &val) override
+    {
+        flush();
+        _msg->write_append(val);
+        add_external_size(static_cast<int>(val.length()));
+        return true;
+    }
+
 private:
     virtual void create_new_buffer(size_t size, /*out*/ blob &bb) override
     {
@@ -83,12 +83,13 @@ public:
     int index() const { return _index; }
     volatile int *get_virtual_length_ptr() { return &_virtual_queue_length; }
 
+protected:
+    const metric_entity_ptr &queue_metric_entity() const;
+
 private:
     friend class task_worker_pool;
     void enqueue_internal(task *task);
 
-    const metric_entity_ptr &queue_metric_entity() const;
-
 private:
     task_worker_pool *_pool;
     std::string _name;
@@ -148,6 +148,7 @@ task_spec::task_spec(int code,
       rpc_call_header_format(NET_HDR_DSN),
       rpc_call_channel(RPC_CHANNEL_TCP),
       rpc_message_crc_required(false),
+      allow_work_stealing(false),
       on_task_create((std::string(name) + std::string(".create")).c_str()),
       on_task_enqueue((std::string(name) + std::string(".enqueue")).c_str()),
       on_task_begin((std::string(name) + std::string(".begin")).c_str()),
@@ -181,6 +181,9 @@ public:
     throttling_mode_t rpc_request_throttling_mode;    //
     std::vector<int> rpc_request_delays_milliseconds; // see exp_delay for delaying recving
     bool rpc_request_dropped_before_execution_when_timeout;
+    // whether the task could be executed by any worker of a partitioned pool, rather than only
+    // by the one its hash is mapped to, see work_stealing_task_queue
+    bool allow_work_stealing;
 
     // COMPUTE
     /*!
@@ -315,6 +318,13 @@ CONFIG_FLD(bool,
            false,
            "whether to drop a request right before execution when its queueing time is already "
            "greater than its timeout value")
+CONFIG_FLD(bool,
+           bool,
+           allow_work_stealing,
+           false,
+           "Whether the task could be stolen by the idle workers of a partitioned thread pool "
+           "whose queue provider is dsn::tools::work_stealing_task_queue. Only set it for the "
+           "tasks that neither rely on the thread affinity nor the execution order of the hash.")
 CONFIG_END
 
 } // end namespace
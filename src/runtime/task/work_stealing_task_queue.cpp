@@ -0,0 +1,263 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "work_stealing_task_queue.h"
+
+#include <algorithm>
+
+#include "runtime/task/task.h"
+#include "runtime/task/task_engine.h"
+#include "runtime/task/task_spec.h"
+#include "utils/threadpool_spec.h"
+
+METRIC_DEFINE_counter(queue,
+                      queue_stolen_tasks,
+                      dsn::metric_unit::kTasks,
+                      "The accumulative number of tasks stolen from the queue by the workers of "
+                      "the other queues");
+
+METRIC_DEFINE_gauge_int64(queue,
+                          queue_length_skew,
+                          dsn::metric_unit::kTasks,
+                          "The difference between the longest and the shortest queue of the "
+                          "thread pool, sampled when the worker of the queue looks for the tasks "
+                          "to steal");
+
+namespace dsn {
+namespace tools {
+
+work_stealing_task_queue::work_stealing_task_queue(task_worker_pool *pool,
+                                                   int index,
+                                                   task_queue *inner_provider)
+    : task_queue(pool, index, inner_provider),
+      _next_seq(0),
+      _local_count(0),
+      _steal_hint(false),
+      _stealable_count(0),
+      _idle(false),
+      METRIC_VAR_INIT_queue(queue_stolen_tasks),
+      METRIC_VAR_INIT_queue(queue_length_skew)
+{
+}
+
+bool work_stealing_task_queue::is_stealable(task *tsk) const
+{
+    return pool()->spec().partitioned && tsk->spec().allow_work_stealing;
+}
+
+const std::vector<work_stealing_task_queue *> &work_stealing_task_queue::siblings()
+{
+    // All the queues have been created before the pool is started, and never change since then.
+    std::call_once(_siblings_once, [this]() {
+        const auto &queues = pool()->queues();
+        for (size_t i = 1; i < queues.size(); ++i) {
+            // Start from the next queue, so that the steals of the workers are spread.
+            auto *q = dynamic_cast<work_stealing_task_queue *>(
+                queues[(index() + i) % queues.size()]);
+            if (q != nullptr) {
+                _siblings.push_back(q);
+            }
+        }
+    });
+    return _siblings;
+}
+
+void work_stealing_task_queue::enqueue(task *tsk)
+{
+    const bool stealable = is_stealable(tsk);
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        auto &q = stealable ? _stealable[tsk->spec().priority] : _affined[tsk->spec().priority];
+        q.push_back({_next_seq++, tsk});
+        ++_local_count;
+    }
+    if (stealable) {
+        // Sequentially consistent with the idle worker which marks itself idle and then reads
+        // the count, so that either the worker sees the task, or the task sees the worker.
+        _stealable_count.fetch_add(1);
+    }
+    _cond.notify_one();
+
+    // The owner worker is busy, let an idle one take the task.
+    if (stealable && !_idle.load()) {
+        wake_up_idle_sibling();
+    }
+}
+
+task *work_stealing_task_queue::dequeue(/*inout*/ int &batch_size)
+{
+    const int max_batch_size = std::max(batch_size, 1);
+    while (true) {
+        {
+            std::lock_guard<std::mutex> l(_lock);
+            batch_size = max_batch_size;
+            task *head = pop_local(batch_size);
+            if (head != nullptr) {
+                return head;
+            }
+            // Mark the worker idle before looking for the tasks to steal, thus the stealable
+            // task enqueued to a busy sibling after the look wakes it up by the hint.
+            _idle.store(true);
+        }
+
+        batch_size = max_batch_size;
+        task *head = steal_from_siblings(batch_size);
+        if (head != nullptr) {
+            return head;
+        }
+
+        // Wait for the local tasks or the hint of a sibling, without polling.
+        std::unique_lock<std::mutex> l(_lock);
+        _cond.wait(l, [this]() { return _local_count > 0 || _steal_hint; });
+        _idle.store(false);
+        _steal_hint = false;
+    }
+}
+
+task *work_stealing_task_queue::pop_local(/*inout*/ int &batch_size)
+{
+    task *head = nullptr, *last = nullptr;
+    int count = 0;
+    int stealable_popped = 0;
+    for (int pri = TASK_PRIORITY_COUNT - 1; pri >= 0 && count < batch_size; --pri) {
+        auto &affined = _affined[pri];
+        auto &stealable = _stealable[pri];
+        while (count < batch_size && (!affined.empty() || !stealable.empty())) {
+            bool from_affined = stealable.empty() ||
+                                (!affined.empty() && affined.front().seq < stealable.front().seq);
+            auto &q = from_affined ? affined : stealable;
+            task *tsk = q.front().tsk;
+            q.pop_front();
+            if (!from_affined) {
+                ++stealable_popped;
+            }
+
+            tsk->next = nullptr;
+            if (last != nullptr) {
+                last->next = tsk;
+            } else {
+                head = tsk;
+            }
+            last = tsk;
+            ++count;
+        }
+    }
+
+    _local_count -= count;
+    if (stealable_popped > 0) {
+        _stealable_count.fetch_sub(stealable_popped, std::memory_order_relaxed);
+    }
+    batch_size = count;
+    return head;
+}
+
+task *work_stealing_task_queue::steal(int max_count, /*out*/ int &count)
+{
+    task *head = nullptr, *last = nullptr;
+    count = 0;
+    {
+        std::lock_guard<std::mutex> l(_lock);
+        for (int pri = TASK_PRIORITY_COUNT - 1; pri >= 0 && count < max_count; --pri) {
+            auto &q = _stealable[pri];
+            while (count < max_count && !q.empty()) {
+                task *tsk = q.front().tsk;
+                q.pop_front();
+
+                tsk->next = nullptr;
+                if (last != nullptr) {
+                    last->next = tsk;
+                } else {
+                    head = tsk;
+                }
+                last = tsk;
+                ++count;
+            }
+        }
+        _local_count -= count;
+    }
+
+    if (count > 0) {
+        _stealable_count.fetch_sub(count, std::memory_order_relaxed);
+        // The stolen tasks are counted by the thief from now on.
+        decrease_count(count);
+        METRIC_VAR_INCREMENT_BY(queue_stolen_tasks, count);
+    }
+    return head;
+}
+
+task *work_stealing_task_queue::steal_from_siblings(/*inout*/ int &batch_size)
+{
+    const auto &queues = siblings();
+    work_stealing_task_queue *victim = nullptr;
+    int victim_stealable_count = 0;
+    int max_length = count();
+    int min_length = max_length;
+    for (auto *q : queues) {
+        int length = q->count();
+        max_length = std::max(max_length, length);
+        min_length = std::min(min_length, length);
+
+        int stealable_count = q->_stealable_count.load();
+        if (stealable_count > victim_stealable_count) {
+            victim = q;
+            victim_stealable_count = stealable_count;
+        }
+    }
+    METRIC_VAR_SET(queue_length_skew, max_length - min_length);
+
+    if (victim == nullptr) {
+        batch_size = 0;
+        return nullptr;
+    }
+
+    // Steal half of the stealable tasks, so that the victim's worker could still take the rest
+    // in its next batch.
+    int count = 0;
+    task *head = victim->steal(std::min(batch_size, (victim_stealable_count + 1) / 2), count);
+    if (count > 0) {
+        // Balanced by the decrease_count() of the worker after dequeue.
+        increase_count(count);
+        _idle.store(false);
+        // The idle workers are not woken up again by the tasks left in the victim, hand them
+        // over to another idle worker.
+        if (victim->_stealable_count.load() > 0) {
+            victim->wake_up_idle_sibling();
+        }
+    }
+    batch_size = count;
+    return head;
+}
+
+void work_stealing_task_queue::wake_up_idle_sibling()
+{
+    for (auto *q : siblings()) {
+        if (!q->_idle.load()) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> l(q->_lock);
+            q->_steal_hint = true;
+        }
+        q->_cond.notify_one();
+        return;
+    }
+}
+
+} // namespace tools
+} // namespace dsn
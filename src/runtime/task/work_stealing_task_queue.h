@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "runtime/task/task_code.h"
+#include "runtime/task/task_queue.h"
+#include "utils/metrics.h"
+
+namespace dsn {
+class task;
+class task_worker_pool;
+
+namespace tools {
+
+// The task queue for the partitioned thread pools, which lets the idle workers steal tasks from
+// the queues of the busy ones:
+// - Each worker owns a queue, the tasks are still dispatched to the queues by their hashes.
+// - Only the tasks whose spec enables `allow_work_stealing` could be stolen, the others are
+//   always executed by the owner worker in the enqueue order, thus the per-hash ordering and the
+//   thread affinity (e.g. of the replica) are kept.
+// - Once a stealable task is enqueued while the owner worker is busy, an idle worker is woken up
+//   to steal half of the stealable tasks from the queue with the most of them. The idle workers
+//   never poll, they wait until a task is enqueued to their own queues or a sibling wakes them.
+class work_stealing_task_queue : public task_queue
+{
+public:
+    work_stealing_task_queue(task_worker_pool *pool, int index, task_queue *inner_provider);
+    ~work_stealing_task_queue() override = default;
+
+    void enqueue(task *task) override;
+    task *dequeue(/*inout*/ int &batch_size) override;
+
+    // Take at most `max_count` stealable tasks in the enqueue order for the worker of another
+    // queue, the count of the returned tasks is stored in `count`.
+    task *steal(int max_count, /*out*/ int &count);
+
+private:
+    struct entry
+    {
+        uint64_t seq;
+        task *tsk;
+    };
+
+    bool is_stealable(task *tsk) const;
+    const std::vector<work_stealing_task_queue *> &siblings();
+
+    // Pop at most `batch_size` local tasks by priority, then by the enqueue order.
+    // Preconditions: `_lock` is held.
+    task *pop_local(/*inout*/ int &batch_size);
+    task *steal_from_siblings(/*inout*/ int &batch_size);
+    void wake_up_idle_sibling();
+
+    std::mutex _lock;
+    std::condition_variable _cond;
+    uint64_t _next_seq;
+    int _local_count;
+    std::deque<entry> _affined[TASK_PRIORITY_COUNT];
+    std::deque<entry> _stealable[TASK_PRIORITY_COUNT];
+    // Set by a sibling to let the idle worker of this queue try to steal.
+    bool _steal_hint;
+
+    std::atomic<int> _stealable_count;
+    std::atomic<bool> _idle;
+
+    std::once_flag _siblings_once;
+    std::vector<work_stealing_task_queue *> _siblings;
+
+    METRIC_VAR_DECLARE_counter(queue_stolen_tasks);
+    METRIC_VAR_DECLARE_gauge_int64(queue_length_skew);
+};
+
+} // namespace tools
+} // namespace dsn
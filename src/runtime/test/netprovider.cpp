@@ -30,12 +30,14 @@
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "runtime/api_layer1.h"
 #include "runtime/api_task.h"
 #include "runtime/global_config.h"
 #include "runtime/rpc/asio_net_provider.h"
+#include "runtime/rpc/message_parser.h"
 #include "runtime/rpc/network.h"
 #include "runtime/rpc/network.sim.h"
 #include "runtime/rpc/rpc_address.h"
@@ -51,8 +53,11 @@
 #include "utils/error_code.h"
 #include "utils/flags.h"
 #include "utils/fmt_logging.h"
+#include "utils/synchronize.h"
 
 DSN_DECLARE_uint32(conn_threshold_per_ip);
+DSN_DECLARE_uint32(max_bytes_per_send);
+DSN_DECLARE_uint32(send_coalesce_delay_us);
 
 namespace dsn {
 
@@ -305,4 +310,274 @@ TEST(tools_common, asio_network_provider_connection_threshold)
 
     TEST_PORT++;
 }
+
+// A server session which records the batches to be written rather than writing them, and never
+// ends the send delay by itself.
+class mock_rpc_session : public rpc_session
+{
+public:
+    struct sent_batch
+    {
+        size_t message_count;
+        size_t buffer_count;
+        size_t bytes;
+    };
+
+    mock_rpc_session(connection_oriented_network &net, message_parser_ptr &parser)
+        : rpc_session(net, rpc_address::from_ip_port("127.0.0.1", 12321), parser, false)
+    {
+    }
+
+    void connect() override {}
+    void close() override {}
+    void do_read(int read_next) override {}
+
+    void send(uint64_t signature) override
+    {
+        size_t bytes = 0;
+        for (const auto &buf : _sending_buffers) {
+            bytes += buf.sz;
+        }
+        sent_batches.push_back({_sending_msgs.size(), _sending_buffers.size(), bytes});
+        sending_signature = signature;
+    }
+
+    void delay_send(uint64_t signature, uint32_t delay_us) override
+    {
+        delayed_signature = signature;
+        delayed_us = delay_us;
+    }
+
+    // Complete the ongoing write, and the queued messages would be sent in the next batch.
+    void complete_send() { on_send_completed(sending_signature); }
+
+    // Pretend that the messages have been queued frequently enough to delay the sending.
+    void expect_frequent_messages()
+    {
+        utils::auto_lock<utils::ex_lock_nr> l(_lock);
+        _last_message_queued_ns = dsn_now_ns();
+        _avg_message_interval_ns = 0;
+    }
+
+    uint32_t update_send_delay(uint64_t now_ns)
+    {
+        utils::auto_lock<utils::ex_lock_nr> l(_lock);
+        return update_send_delay_us(now_ns);
+    }
+
+    bool is_send_delayed() const
+    {
+        utils::auto_lock<utils::ex_lock_nr> l(_lock);
+        return _is_send_delayed;
+    }
+
+    int message_count() const
+    {
+        utils::auto_lock<utils::ex_lock_nr> l(_lock);
+        return _message_count;
+    }
+
+    void set_max_buffer_block_count_per_send(int count)
+    {
+        _max_buffer_block_count_per_send = count;
+    }
+
+    std::vector<sent_batch> sent_batches;
+    uint64_t sending_signature = 0;
+    uint64_t delayed_signature = 0;
+    uint32_t delayed_us = 0;
+};
+
+class rpc_session_send_test : public testing::Test
+{
+public:
+    rpc_session_send_test()
+        : _old_max_bytes_per_send(FLAGS_max_bytes_per_send),
+          _old_send_coalesce_delay_us(FLAGS_send_coalesce_delay_us),
+          _net(task::get_current_rpc(), nullptr)
+    {
+        message_parser_ptr parser(_net.new_message_parser(NET_HDR_DSN));
+        _session = new mock_rpc_session(_net, parser);
+    }
+
+    ~rpc_session_send_test() override
+    {
+        _session = nullptr;
+        FLAGS_max_bytes_per_send = _old_max_bytes_per_send;
+        FLAGS_send_coalesce_delay_us = _old_send_coalesce_delay_us;
+    }
+
+    static message_ex *create_test_message()
+    {
+        message_ex *msg = message_ex::create_request(RPC_TEST_NETPROVIDER, 0, 0);
+        ::dsn::marshall(msg, std::string(100, 'a'));
+        return msg;
+    }
+
+    // Send a message on the idle session without delay, and return the batch written.
+    mock_rpc_session::sent_batch send_single_message()
+    {
+        FLAGS_send_coalesce_delay_us = 0;
+        _session->send_message(create_test_message());
+        _session->complete_send();
+        return _session->sent_batches.back();
+    }
+
+protected:
+    const uint32_t _old_max_bytes_per_send;
+    const uint32_t _old_send_coalesce_delay_us;
+    tools::sim_network_provider _net;
+    ref_ptr<mock_rpc_session> _session;
+};
+
+TEST_F(rpc_session_send_test, update_send_delay_us)
+{
+    // The send delay is disabled.
+    FLAGS_send_coalesce_delay_us = 0;
+    ASSERT_EQ(0U, _session->update_send_delay(1000));
+
+    // The average interval starts from the max, thus the sparse messages are never delayed.
+    FLAGS_send_coalesce_delay_us = 100;
+    uint64_t now_ns = 1000000000;
+    ASSERT_EQ(0U, _session->update_send_delay(now_ns));
+
+    // The frequent messages lower the average interval below the delay.
+    uint32_t delay_us = 0;
+    for (int i = 0; i < 1000 && delay_us == 0; ++i) {
+        now_ns += 10000;
+        delay_us = _session->update_send_delay(now_ns);
+    }
+    ASSERT_EQ(100U, delay_us);
+
+    // An idle period raises the average interval above the delay at once.
+    now_ns += 1000000000;
+    ASSERT_EQ(0U, _session->update_send_delay(now_ns));
+}
+
+TEST_F(rpc_session_send_test, flush_delayed_send)
+{
+    FLAGS_send_coalesce_delay_us = 1000000;
+    _session->expect_frequent_messages();
+
+    // The first message on the idle session waits for more messages.
+    _session->send_message(create_test_message());
+    ASSERT_TRUE(_session->is_send_delayed());
+    ASSERT_EQ(1U, _session->delayed_signature);
+    ASSERT_EQ(1000000U, _session->delayed_us);
+    ASSERT_TRUE(_session->sent_batches.empty());
+
+    _session->send_message(create_test_message());
+    ASSERT_TRUE(_session->is_send_delayed());
+    ASSERT_TRUE(_session->sent_batches.empty());
+
+    // Once the delay is over, the messages queued in the meantime are written at once.
+    _session->flush_delayed_send(_session->delayed_signature);
+    ASSERT_FALSE(_session->is_send_delayed());
+    ASSERT_EQ(1U, _session->sent_batches.size());
+    ASSERT_EQ(2U, _session->sent_batches[0].message_count);
+    _session->complete_send();
+    ASSERT_EQ(0, _session->message_count());
+
+    // A stale flush is ignored.
+    _session->flush_delayed_send(_session->delayed_signature);
+    ASSERT_EQ(1U, _session->sent_batches.size());
+}
+
+TEST_F(rpc_session_send_test, end_send_delay_once_batch_filled)
+{
+    const auto single = send_single_message();
+    ASSERT_EQ(1U, single.message_count);
+
+    // The delay ends once the bytes of the queued messages reach the limit.
+    FLAGS_send_coalesce_delay_us = 1000000;
+    FLAGS_max_bytes_per_send = static_cast<uint32_t>(single.bytes * 3);
+    _session->expect_frequent_messages();
+    for (int i = 0; i < 2; ++i) {
+        _session->send_message(create_test_message());
+        ASSERT_TRUE(_session->is_send_delayed());
+    }
+    ASSERT_EQ(1U, _session->sent_batches.size());
+    _session->send_message(create_test_message());
+    ASSERT_FALSE(_session->is_send_delayed());
+    ASSERT_EQ(2U, _session->sent_batches.size());
+    ASSERT_EQ(3U, _session->sent_batches.back().message_count);
+    ASSERT_EQ(single.bytes * 3, _session->sent_batches.back().bytes);
+
+    // The timer of the ended delay is ignored.
+    _session->flush_delayed_send(_session->delayed_signature);
+    ASSERT_EQ(2U, _session->sent_batches.size());
+    _session->complete_send();
+
+    // The delay ends once the buffer blocks of the queued messages reach the limit, rather
+    // than the number of messages.
+    FLAGS_max_bytes_per_send = 0;
+    _session->set_max_buffer_block_count_per_send(static_cast<int>(single.buffer_count * 2));
+    _session->expect_frequent_messages();
+    _session->send_message(create_test_message());
+    ASSERT_TRUE(_session->is_send_delayed());
+    _session->send_message(create_test_message());
+    ASSERT_FALSE(_session->is_send_delayed());
+    ASSERT_EQ(3U, _session->sent_batches.size());
+    ASSERT_EQ(2U, _session->sent_batches.back().message_count);
+    ASSERT_EQ(single.buffer_count * 2, _session->sent_batches.back().buffer_count);
+    _session->complete_send();
+    ASSERT_EQ(0, _session->message_count());
+}
+
+TEST_F(rpc_session_send_test, split_batches_by_max_bytes)
+{
+    const auto single = send_single_message();
+
+    // Queue the messages while the first one is being written.
+    const size_t max_bytes = single.bytes * 2 + single.bytes / 2;
+    FLAGS_max_bytes_per_send = static_cast<uint32_t>(max_bytes);
+    _session->send_message(create_test_message());
+    for (int i = 0; i < 5; ++i) {
+        _session->send_message(create_test_message());
+    }
+    ASSERT_EQ(2U, _session->sent_batches.size());
+
+    // The queued messages are split into the batches of at most 'max_bytes'.
+    for (int i = 0; i < 3; ++i) {
+        _session->complete_send();
+    }
+    ASSERT_EQ(5U, _session->sent_batches.size());
+    ASSERT_EQ(2U, _session->sent_batches[2].message_count);
+    ASSERT_EQ(2U, _session->sent_batches[3].message_count);
+    ASSERT_EQ(1U, _session->sent_batches[4].message_count);
+    for (const auto &batch : _session->sent_batches) {
+        ASSERT_GE(max_bytes, batch.bytes);
+    }
+    _session->complete_send();
+    ASSERT_EQ(0, _session->message_count());
+
+    // A message larger than the limit is still sent alone.
+    FLAGS_max_bytes_per_send = static_cast<uint32_t>(single.bytes / 2);
+    _session->send_message(create_test_message());
+    _session->send_message(create_test_message());
+    _session->complete_send();
+    _session->complete_send();
+    ASSERT_EQ(7U, _session->sent_batches.size());
+    ASSERT_EQ(1U, _session->sent_batches[5].message_count);
+    ASSERT_EQ(1U, _session->sent_batches[6].message_count);
+    ASSERT_EQ(0, _session->message_count());
+}
+
+TEST_F(rpc_session_send_test, close_during_send_delay)
+{
+    FLAGS_send_coalesce_delay_us = 1000000;
+    _session->expect_frequent_messages();
+    _session->send_message(create_test_message());
+    ASSERT_TRUE(_session->is_send_delayed());
+
+    // The session is closed before the delay is over, and the queued messages are dropped.
+    _session->on_failure(true);
+    ASSERT_EQ(0, _session->message_count());
+
+    // Neither the messages queued after closed nor the flush would write to the session.
+    _session->send_message(create_test_message());
+    _session->flush_delayed_send(_session->delayed_signature);
+    ASSERT_FALSE(_session->is_send_delayed());
+    ASSERT_TRUE(_session->sent_batches.empty());
+}
 } // namespace dsn
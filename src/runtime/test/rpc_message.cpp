@@ -229,3 +229,45 @@ TEST(rpc_message, copy_message_no_reply)
     // so we only need to call release_ref here.
     msg->release_ref();
 }
+
+TEST(rpc_message, write_large_blob_without_copy)
+{
+    std::string data(blob::kMinZeroCopyWriteLength, 'x');
+    auto value = blob::create_from_bytes(data.data(), data.size());
+
+    // The large blob is still copied unless it opts in.
+    message_ptr copied_request = message_ex::create_request(RPC_CODE_FOR_TEST, 100, 1);
+    marshall(copied_request, value, DSF_THRIFT_BINARY);
+    ASSERT_EQ(2u, copied_request->buffers.size());
+
+    value.enable_zero_copy_write();
+    message_ptr request = message_ex::create_request(RPC_CODE_FOR_TEST, 100, 1);
+    marshall(request, value, DSF_THRIFT_BINARY);
+
+    // The large blob is attached to the message as a separate buffer rather than copied.
+    ASSERT_EQ(3u, request->buffers.size());
+    ASSERT_EQ(value.data(), request->buffers[2].data());
+    ASSERT_EQ(sizeof(int32_t) + data.size(), request->header->body_length);
+
+    std::string body;
+    for (size_t i = 1; i < request->buffers.size(); ++i) {
+        body.append(request->buffers[i].data(), request->buffers[i].length());
+    }
+    message_ptr receive = message_ex::create_received_request(request->local_rpc_code,
+                                                              DSF_THRIFT_BINARY,
+                                                              (void *)body.data(),
+                                                              static_cast<int>(body.size()),
+                                                              0,
+                                                              0);
+
+    blob result;
+    unmarshall(receive, result);
+    ASSERT_EQ(data, result.to_string());
+
+    // The small blob is still copied into the buffer of the message.
+    message_ptr small_request = message_ex::create_request(RPC_CODE_FOR_TEST, 100, 1);
+    auto small_value = blob::create_from_bytes("10086");
+    small_value.enable_zero_copy_write();
+    marshall(small_request, small_value, DSF_THRIFT_BINARY);
+    ASSERT_EQ(2u, small_request->buffers.size());
+}
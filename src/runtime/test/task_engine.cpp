@@ -27,13 +27,20 @@
 #include "runtime/task/task_engine.h"
 
 #include <stdio.h>
+#include <chrono>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "runtime/global_config.h"
 #include "runtime/service_engine.h"
+#include "runtime/task/async_calls.h"
 #include "runtime/task/task.h"
+#include "runtime/task/task_queue.h"
+#include "runtime/task/task_spec.h"
 #include "runtime/test_utils.h"
 #include "utils/enum_helper.h"
+#include "utils/synchronize.h"
 #include "utils/threadpool_code.h"
 
 namespace dsn {
@@ -44,6 +51,9 @@ using namespace ::dsn;
 
 DEFINE_THREAD_POOL_CODE(THREAD_POOL_FOR_TEST_1)
 DEFINE_THREAD_POOL_CODE(THREAD_POOL_FOR_TEST_2)
+DEFINE_THREAD_POOL_CODE(THREAD_POOL_FOR_TEST_3)
+DEFINE_TASK_CODE(LPC_WORK_STEALING_AFFINED, TASK_PRIORITY_COMMON, THREAD_POOL_FOR_TEST_3)
+DEFINE_TASK_CODE(LPC_WORK_STEALING_STEALABLE, TASK_PRIORITY_COMMON, THREAD_POOL_FOR_TEST_3)
 
 TEST(core, task_engine)
 {
@@ -94,3 +104,52 @@ TEST(core, task_engine)
     std::vector<task_worker *> workers2 = pool2->workers();
     ASSERT_EQ(2u, workers2.size());
 }
+
+TEST(core, work_stealing_task_queue)
+{
+    if (dsn::service_engine::instance().spec().tool == "simulator")
+        return;
+    task_spec::get(LPC_WORK_STEALING_STEALABLE)->allow_work_stealing = true;
+
+    task_worker_pool *pool =
+        task::get_current_node2()->computation()->get_pool(THREAD_POOL_FOR_TEST_3);
+    ASSERT_NE(nullptr, pool);
+    ASSERT_EQ(2u, pool->queues().size());
+
+    // Block the worker of the queue of hash 0.
+    utils::notify_event blocker;
+    auto blocking_task =
+        tasking::enqueue(LPC_WORK_STEALING_AFFINED, nullptr, [&blocker]() { blocker.wait(); }, 0);
+
+    // The affined tasks are kept in the queue of their hash until the worker is unblocked.
+    std::vector<int> affined_order;
+    std::vector<task_ptr> affined_tasks;
+    for (int i = 0; i < 3; ++i) {
+        affined_tasks.push_back(
+            tasking::enqueue(LPC_WORK_STEALING_AFFINED,
+                             nullptr,
+                             [&affined_order, i]() { affined_order.push_back(i); },
+                             0));
+    }
+
+    // The stealable tasks are executed by the idle worker, which has been waiting and is woken
+    // up by the enqueue rather than polling.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    for (int i = 0; i < 4; ++i) {
+        auto t = tasking::enqueue(LPC_WORK_STEALING_STEALABLE, nullptr, []() {}, 0);
+        ASSERT_TRUE(t->wait(10000));
+    }
+    ASSERT_TRUE(affined_order.empty());
+
+    blocker.notify();
+    ASSERT_TRUE(blocking_task->wait(10000));
+    for (auto &t : affined_tasks) {
+        ASSERT_TRUE(t->wait(10000));
+    }
+    ASSERT_EQ(std::vector<int>({0, 1, 2}), affined_order);
+
+    // The stolen tasks are counted by the queue of the thief.
+    for (auto *q : pool->queues()) {
+        ASSERT_EQ(0, q->count());
+    }
+}
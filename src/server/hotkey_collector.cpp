@@ -34,6 +34,7 @@
 #include "utils/error_code.h"
 #include "utils/flags.h"
 #include "utils/fmt_logging.h"
+#include "utils/metrics.h"
 
 DSN_DEFINE_uint32(
     pegasus.server,
@@ -74,9 +75,50 @@ DSN_DEFINE_uint32(
     "the max time (in seconds) allowed to capture hotkey, will stop if hotkey's not found");
 DSN_TAG_VARIABLE(max_seconds_to_detect_hotkey, FT_MUTABLE);
 
+DSN_DEFINE_bool(pegasus.server,
+                enable_hotkey_sketch,
+                false,
+                "whether to count the hash keys continuously by a sketch to find the top hot keys, "
+                "besides the hotkey detection on demand. It costs a hash and a locked update of "
+                "the sketch on each read and write, thus disabled by default");
+DSN_TAG_VARIABLE(enable_hotkey_sketch, FT_MUTABLE);
+
+DSN_DEFINE_uint32(pegasus.server,
+                  hotkey_sketch_capacity,
+                  32,
+                  "the max number of hash keys counted by each shard of the hotkey sketch, the "
+                  "more keys are counted the more accurate the top hot keys are");
+DSN_DEFINE_validator(hotkey_sketch_capacity, [](uint32_t value) -> bool { return value > 0; });
+
+DSN_DEFINE_uint32(pegasus.server,
+                  hotkey_sketch_top_k,
+                  10,
+                  "the max number of the top hot keys reported by the hotkey sketch");
+DSN_TAG_VARIABLE(hotkey_sketch_top_k, FT_MUTABLE);
+
+METRIC_DEFINE_gauge_int64(replica,
+                          read_hotkey_max_qps,
+                          dsn::metric_unit::kRequests,
+                          "The estimated read qps of the hottest hash key of a replica during the "
+                          "last hotkey analysis interval");
+
+METRIC_DEFINE_gauge_int64(replica,
+                          write_hotkey_max_qps,
+                          dsn::metric_unit::kRequests,
+                          "The estimated write qps of the hottest hash key of a replica during the "
+                          "last hotkey analysis interval");
+
 namespace pegasus {
 namespace server {
 
+namespace {
+
+// The number of the shards of the hotkey sketch, over which the threads capturing keys are
+// spread to avoid the contention.
+const uint32_t kHotkeySketchShardCount = 8;
+
+} // anonymous namespace
+
 // 68–95–99.7 rule, same algorithm as hotspot_partition_calculator::stat_histories_analyse
 /*extern*/ bool
 find_outlier_index(const std::vector<uint64_t> &captured_keys, int threshold, int &hot_index)
@@ -136,7 +178,14 @@ find_outlier_index(const std::vector<uint64_t> &captured_keys, int threshold, in
 
 hotkey_collector::hotkey_collector(dsn::replication::hotkey_type::type hotkey_type,
                                    dsn::replication::replica_base *r_base)
-    : replica_base(r_base), _hotkey_type(hotkey_type)
+    : replica_base(r_base),
+      _hotkey_type(hotkey_type),
+      _sketch(FLAGS_hotkey_sketch_capacity, kHotkeySketchShardCount),
+      _last_analyse_sketch_time_ms(dsn_now_ms()),
+      METRIC_VAR_NAME(hotkey_max_qps)(
+          hotkey_type == dsn::replication::hotkey_type::READ
+              ? METRIC_read_hotkey_max_qps.instantiate(replica_metric_entity())
+              : METRIC_write_hotkey_max_qps.instantiate(replica_metric_entity()))
 {
     int now_hash_bucket_num = FLAGS_hotkey_buckets_num;
     _internal_coarse_collector =
@@ -235,6 +284,10 @@ void hotkey_collector::capture_raw_key(const dsn::blob &raw_key, int64_t weight)
 
 void hotkey_collector::capture_hash_key(const dsn::blob &hash_key, int64_t weight)
 {
+    if (FLAGS_enable_hotkey_sketch) {
+        _sketch.add(hash_key.to_string_view(), weight > 0 ? weight : 1);
+    }
+
     // TODO: (Tangyanzhao) add a unit test to ensure data integrity
     switch (_state.load()) {
     case hotkey_collector_state::COARSE_DETECTING:
@@ -248,6 +301,8 @@ void hotkey_collector::capture_hash_key(const dsn::blob &hash_key, int64_t weigh
 
 void hotkey_collector::analyse_data()
 {
+    analyse_sketch();
+
     switch (_state.load()) {
     case hotkey_collector_state::COARSE_DETECTING:
     case hotkey_collector_state::FINE_DETECTING:
@@ -261,6 +316,37 @@ void hotkey_collector::analyse_data()
     }
 }
 
+std::vector<dsn::replication::hotkey_info> hotkey_collector::hotkeys() const
+{
+    dsn::zauto_lock l(_hotkeys_lock);
+    return _hotkeys;
+}
+
+void hotkey_collector::analyse_sketch()
+{
+    const auto now_ms = dsn_now_ms();
+    const auto elapsed_ms = now_ms - _last_analyse_sketch_time_ms;
+    _last_analyse_sketch_time_ms = now_ms;
+
+    // The sketch is always collected to be reset, even if it's disabled right now.
+    const auto top_keys = _sketch.collect(FLAGS_hotkey_sketch_top_k);
+    std::vector<dsn::replication::hotkey_info> hotkeys;
+    if (FLAGS_enable_hotkey_sketch && elapsed_ms > 0) {
+        hotkeys.reserve(top_keys.size());
+        for (const auto &key : top_keys) {
+            dsn::replication::hotkey_info info;
+            info.hash_key = key.hash_key;
+            info.qps = key.count * 1000.0 / elapsed_ms;
+            hotkeys.emplace_back(std::move(info));
+        }
+    }
+    METRIC_VAR_SET(hotkey_max_qps,
+                   hotkeys.empty() ? 0 : static_cast<int64_t>(std::llround(hotkeys.front().qps)));
+
+    dsn::zauto_lock l(_hotkeys_lock);
+    _hotkeys.swap(hotkeys);
+}
+
 void hotkey_collector::on_start_detect(dsn::replication::detect_hotkey_response &resp)
 {
     auto now_state = _state.load();
@@ -26,9 +26,13 @@
 #include <vector>
 
 #include "hotkey_collector_state.h"
+#include "hotkey_sketch.h"
 #include "replica/replica_base.h"
+#include "replica/replication_app_base.h"
 #include "replica_admin_types.h"
 #include "utils/blob.h"
+#include "utils/metrics.h"
+#include "utils/zlocks.h"
 #include "absl/strings/string_view.h"
 
 namespace pegasus {
@@ -90,6 +94,10 @@ find_outlier_index(const std::vector<uint64_t> &captured_keys, int threshold, in
 //    | +----------------+ |  |                       v                            |
 //    |                    |  |                     Hotkey                         |
 //    +--------------------+  +----------------------------------------------------+
+//
+//    Besides the detection on demand above, the hash keys could be counted continuously by a
+//    hotkey_sketch (if [pegasus.server]enable_hotkey_sketch is true), from which the top hot keys
+//    with their qps are refreshed on each analysis and could be queried at any time.
 
 class hotkey_collector : public dsn::replication::replica_base
 {
@@ -104,7 +112,13 @@ public:
     void handle_rpc(const dsn::replication::detect_hotkey_request &req,
                     /*out*/ dsn::replication::detect_hotkey_response &resp);
 
+    // The top hot keys found by the sketch during the last analysis interval, in the descending
+    // order of qps.
+    std::vector<dsn::replication::hotkey_info> hotkeys() const;
+
 private:
+    void analyse_sketch();
+
     void on_start_detect(dsn::replication::detect_hotkey_response &resp);
     void on_stop_detect(dsn::replication::detect_hotkey_response &resp);
     void query_result(dsn::replication::detect_hotkey_response &resp);
@@ -127,6 +141,13 @@ private:
     std::shared_ptr<hotkey_coarse_data_collector> _internal_coarse_collector;
     std::shared_ptr<hotkey_fine_data_collector> _internal_fine_collector;
 
+    hotkey_sketch _sketch;
+    uint64_t _last_analyse_sketch_time_ms;
+    mutable dsn::zlock _hotkeys_lock;
+    std::vector<dsn::replication::hotkey_info> _hotkeys;
+
+    METRIC_VAR_DECLARE_gauge_int64(hotkey_max_qps);
+
     friend class hotkey_collector_test;
 };
 
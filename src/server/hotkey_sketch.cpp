@@ -0,0 +1,108 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "hotkey_sketch.h"
+
+#include <boost/container_hash/extensions.hpp>
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+#include "utils/fmt_logging.h"
+#include "utils/process_utils.h"
+
+namespace pegasus {
+namespace server {
+
+hotkey_sketch::hotkey_sketch(uint32_t capacity, uint32_t shard_count)
+    : _capacity(capacity), _shard_count(shard_count), _shards(new shard[shard_count])
+{
+    CHECK_GT(_capacity, 0);
+    CHECK_GT(_shard_count, 0);
+}
+
+void hotkey_sketch::add(absl::string_view hash_key, uint64_t weight)
+{
+    const uint64_t fingerprint = boost::hash_range(hash_key.begin(), hash_key.end());
+    auto &s = _shards[static_cast<uint32_t>(dsn::utils::get_current_tid()) % _shard_count];
+
+    ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(s.lock);
+    entry *min_entry = nullptr;
+    for (auto &e : s.entries) {
+        if (e.fingerprint == fingerprint && e.hash_key == hash_key) {
+            e.count += weight;
+            return;
+        }
+        if (min_entry == nullptr || e.count < min_entry->count) {
+            min_entry = &e;
+        }
+    }
+
+    if (s.entries.size() < _capacity) {
+        entry e;
+        e.fingerprint = fingerprint;
+        e.count = weight;
+        e.hash_key.assign(hash_key.data(), hash_key.size());
+        s.entries.emplace_back(std::move(e));
+        return;
+    }
+
+    // Replace the least frequent key, whose count is inherited as the error.
+    min_entry->fingerprint = fingerprint;
+    min_entry->error = min_entry->count;
+    min_entry->count += weight;
+    min_entry->hash_key.assign(hash_key.data(), hash_key.size());
+}
+
+std::vector<hotkey_sketch::hotkey> hotkey_sketch::collect(uint32_t top_k)
+{
+    // The entries of a hash key in different shards are summed up, both the counts and the errors.
+    std::unordered_map<std::string, hotkey> merged;
+    for (uint32_t i = 0; i < _shard_count; ++i) {
+        std::vector<entry> entries;
+        entries.reserve(_capacity);
+        {
+            ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_shards[i].lock);
+            entries.swap(_shards[i].entries);
+        }
+
+        for (auto &e : entries) {
+            auto &key = merged[e.hash_key];
+            if (key.hash_key.empty()) {
+                key.hash_key = std::move(e.hash_key);
+            }
+            key.count += e.count;
+            key.error += e.error;
+        }
+    }
+
+    std::vector<hotkey> result;
+    result.reserve(merged.size());
+    for (auto &kv : merged) {
+        result.emplace_back(std::move(kv.second));
+    }
+    std::sort(result.begin(), result.end(), [](const hotkey &lhs, const hotkey &rhs) {
+        return lhs.count > rhs.count;
+    });
+    if (result.size() > top_k) {
+        result.resize(top_k);
+    }
+    return result;
+}
+
+} // namespace server
+} // namespace pegasus
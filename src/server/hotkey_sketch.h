@@ -0,0 +1,80 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "utils/synchronize.h"
+
+namespace pegasus {
+namespace server {
+
+/// Finds the most frequent hash keys continuously in bounded memory by the Space-Saving
+/// algorithm: each sketch keeps at most `capacity` keys with their counts, and a key missing from
+/// a full sketch takes the place of the one with the least count, inheriting that count as its
+/// overestimation error.
+///
+/// The keys are added into the sketch owned by the current thread (the threads are spread over a
+/// fixed number of sketches), which is locked by a spin lock that is almost never contended.
+/// The sketches are merged and reset periodically by `collect`.
+class hotkey_sketch
+{
+public:
+    struct hotkey
+    {
+        std::string hash_key;
+        // The estimated count, which is never less than the real count.
+        uint64_t count{0};
+        // The max overestimation in `count`.
+        uint64_t error{0};
+    };
+
+    hotkey_sketch(uint32_t capacity, uint32_t shard_count);
+
+    void add(absl::string_view hash_key, uint64_t weight);
+
+    // Merges the keys added since the last call, and returns at most `top_k` of them in the
+    // descending order of count.
+    std::vector<hotkey> collect(uint32_t top_k);
+
+private:
+    struct entry
+    {
+        uint64_t fingerprint{0};
+        uint64_t count{0};
+        uint64_t error{0};
+        std::string hash_key;
+    };
+
+    struct alignas(64) shard
+    {
+        ::dsn::utils::ex_lock_nr_spin lock;
+        std::vector<entry> entries;
+    };
+
+    const uint32_t _capacity;
+    const uint32_t _shard_count;
+    std::unique_ptr<shard[]> _shards;
+};
+
+} // namespace server
+} // namespace pegasus
@@ -0,0 +1,137 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "incr_merge_operator.h"
+
+#include <rocksdb/slice.h>
+
+#include "base/pegasus_utils.h"
+#include "utils/endians.h"
+#include "utils/fmt_logging.h"
+#include "utils/string_conv.h"
+
+namespace pegasus {
+namespace server {
+
+std::string incr_merge_operand::encode() const
+{
+    std::string data(kSize, '\0');
+    dsn::data_output(data)
+        .write_u8(kType)
+        .write_u64(static_cast<uint64_t>(increment))
+        .write_u32(static_cast<uint32_t>(expire_ts_seconds))
+        .write_u32(default_expire_ts)
+        .write_u32(write_ts)
+        .write_u64(timetag);
+    return data;
+}
+
+bool incr_merge_operand::decode(absl::string_view data)
+{
+    if (data.size() != kSize) {
+        return false;
+    }
+
+    dsn::data_input input(data);
+    if (input.read_u8() != kType) {
+        return false;
+    }
+    increment = static_cast<int64_t>(input.read_u64());
+    expire_ts_seconds = static_cast<int32_t>(input.read_u32());
+    default_expire_ts = input.read_u32();
+    write_ts = input.read_u32();
+    timetag = input.read_u64();
+    return true;
+}
+
+bool IncrMergeOperator::FullMergeV2(const MergeOperationInput &merge_in,
+                                    MergeOperationOutput *merge_out) const
+{
+    const uint32_t version = _pegasus_data_version.load(std::memory_order_acquire);
+
+    bool exists = false;
+    bool is_integer = true;
+    int64_t value = 0;
+    uint32_t expire_ts = 0;
+    uint64_t timetag = 0;
+    if (merge_in.existing_value != nullptr) {
+        const auto raw_value = utils::to_string_view(*merge_in.existing_value);
+        exists = true;
+        expire_ts = pegasus_extract_expire_ts(version, raw_value);
+        if (version == 1) {
+            timetag = pegasus_extract_timetag(version, raw_value);
+        }
+        const auto user_data = pegasus_extract_user_data_view(version, raw_value);
+        is_integer = user_data.empty() || dsn::buf2int64(user_data, value);
+    }
+
+    bool changed = false;
+    for (const auto &operand_slice : merge_in.operand_list) {
+        incr_merge_operand operand;
+        if (!operand.decode(utils::to_string_view(operand_slice))) {
+            LOG_ERROR("invalid incr merge operand of size {}", operand_slice.size());
+            return false;
+        }
+
+        int64_t new_value = 0;
+        uint32_t new_expire_ts = 0;
+        if (!exists || check_if_ts_expired(operand.write_ts, expire_ts)) {
+            // The absent or expired record is regarded as 0.
+            new_value = operand.increment;
+            new_expire_ts = operand.expire_ts_seconds > 0 ? operand.expire_ts_seconds : 0;
+        } else {
+            if (!is_integer || __builtin_add_overflow(value, operand.increment, &new_value)) {
+                // The incr fails and nothing is written.
+                continue;
+            }
+            if (operand.expire_ts_seconds == 0) {
+                new_expire_ts = expire_ts;
+            } else if (operand.expire_ts_seconds > 0) {
+                new_expire_ts = operand.expire_ts_seconds;
+            }
+        }
+        if (new_expire_ts == 0) {
+            new_expire_ts = operand.default_expire_ts;
+        }
+
+        exists = true;
+        is_integer = true;
+        value = new_value;
+        expire_ts = new_expire_ts;
+        timetag = operand.timetag;
+        changed = true;
+    }
+
+    if (!changed) {
+        merge_out->existing_operand = *merge_in.existing_value;
+        return true;
+    }
+
+    pegasus_value_generator generator;
+    const std::string user_data = std::to_string(value);
+    const auto parts = generator.generate_value(version, user_data, expire_ts, timetag);
+    merge_out->new_value.clear();
+    for (int i = 0; i < parts.num_parts; ++i) {
+        merge_out->new_value.append(parts.parts[i].data(), parts.parts[i].size());
+    }
+    return true;
+}
+
+} // namespace server
+} // namespace pegasus
@@ -0,0 +1,82 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <rocksdb/merge_operator.h>
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "base/pegasus_value_schema.h"
+
+namespace pegasus {
+namespace server {
+
+/// The operand of an incr recorded by rocksdb Merge, which is resolved lazily on read and
+/// compaction by \see IncrMergeOperator, thus the incr needs no read before write.
+///
+/// operand = [type(uint8_t)] [increment(int64_t)] [expire_ts_seconds(int32_t)]
+///           [default_expire_ts(uint32_t)] [write_ts(uint32_t)] [timetag(uint64_t)]
+struct incr_merge_operand
+{
+    static constexpr uint8_t kType = 1;
+    static constexpr size_t kSize = sizeof(uint8_t) + sizeof(int64_t) + sizeof(int32_t) +
+                                    sizeof(uint32_t) + sizeof(uint32_t) + sizeof(uint64_t);
+
+    int64_t increment = 0;
+    // Same as incr_request.expire_ts_seconds: 0 means keeping the original ttl, >0 means
+    // resetting to the new ttl, <0 means resetting to no ttl.
+    int32_t expire_ts_seconds = 0;
+    // The expire_ts of the table level default ttl, used once the record has no ttl, 0 if the
+    // default ttl is not set.
+    uint32_t default_expire_ts = 0;
+    // When the incr is written, the existing record which has expired by then is regarded as
+    // absent.
+    uint32_t write_ts = 0;
+    uint64_t timetag = 0;
+
+    std::string encode() const;
+    // Returns false if `data` is not a valid operand.
+    bool decode(absl::string_view data);
+};
+
+/// Resolves the incr operands against the existing record in the same way as the incr with
+/// read before write, except that the incr which fails on the existing record (i.e. it's not an
+/// integer, or the result overflows) is skipped silently, since merge has no way to respond.
+class IncrMergeOperator : public rocksdb::MergeOperator
+{
+public:
+    bool FullMergeV2(const MergeOperationInput &merge_in,
+                     MergeOperationOutput *merge_out) const override;
+
+    const char *Name() const override { return "IncrMergeOperator"; }
+
+    void SetPegasusDataVersion(uint32_t version)
+    {
+        _pegasus_data_version.store(version, std::memory_order_release);
+    }
+
+private:
+    std::atomic<uint32_t> _pegasus_data_version{PEGASUS_DATA_VERSION_MAX};
+};
+
+} // namespace server
+} // namespace pegasus
@@ -23,6 +23,8 @@
 #include <fmt/core.h>
 #include <pegasus/error.h>
 #include <sys/types.h>
+#include <zstd.h>
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <functional>
@@ -38,10 +40,12 @@
 #include "pegasus_key_schema.h"
 #include "rrdb/rrdb.code.definition.h"
 #include "rrdb/rrdb_types.h"
+#include "runtime/api_layer1.h"
 #include "runtime/message_utils.h"
 #include "runtime/rpc/rpc_message.h"
 #include "server/pegasus_write_service.h"
 #include "utils/autoref_ptr.h"
+#include "utils/binary_writer.h"
 #include "utils/blob.h"
 #include "utils/chrono_literals.h"
 #include "utils/error_code.h"
@@ -82,11 +86,144 @@ DSN_TAG_VARIABLE(dup_max_allowed_write_size, FT_MUTABLE);
 } // namespace replication
 } // namespace dsn
 
+DSN_DEFINE_uint32(pegasus.server,
+                  dup_frame_window_size,
+                  0,
+                  "The max number of frames in flight to the remote partition while shipping "
+                  "the mutations in frames. Each mutation is packed into the frame of the lane "
+                  "selected by its hash modulo the window size, and the frames of the same lane "
+                  "are shipped one by one, thus the writes with the same hash are still "
+                  "duplicated in order. 0 means shipping a batch for each hash group instead");
+DSN_TAG_VARIABLE(dup_frame_window_size, FT_MUTABLE);
+
+DSN_DEFINE_uint64(pegasus.server,
+                  dup_frame_min_bytes,
+                  64 * 1024,
+                  "The min bytes of the mutations packed into a frame while shipping in frames");
+DSN_TAG_VARIABLE(dup_frame_min_bytes, FT_MUTABLE);
+DSN_DEFINE_validator(dup_frame_min_bytes, [](uint64_t value) -> bool { return value > 0; });
+
+DSN_DEFINE_uint64(pegasus.server,
+                  dup_frame_max_bytes,
+                  1 << 20,
+                  "The max bytes of the mutations packed into a frame while shipping in frames, "
+                  "which should not be larger than [replication]dup_max_allowed_write_size");
+DSN_TAG_VARIABLE(dup_frame_max_bytes, FT_MUTABLE);
+
+DSN_DEFINE_group_validator(dup_frame_bytes, [](std::string &message) -> bool {
+    if (FLAGS_dup_frame_min_bytes > FLAGS_dup_frame_max_bytes) {
+        message = fmt::format("[pegasus.server]dup_frame_min_bytes({}) should be <= "
+                              "[pegasus.server]dup_frame_max_bytes({})",
+                              FLAGS_dup_frame_min_bytes,
+                              FLAGS_dup_frame_max_bytes);
+        return false;
+    }
+    // The frames larger than that would be rejected by the remote cluster forever.
+    if (dsn::replication::FLAGS_dup_max_allowed_write_size > 0 &&
+        FLAGS_dup_frame_max_bytes > dsn::replication::FLAGS_dup_max_allowed_write_size) {
+        message = fmt::format("[pegasus.server]dup_frame_max_bytes({}) should be <= "
+                              "[replication]dup_max_allowed_write_size({})",
+                              FLAGS_dup_frame_max_bytes,
+                              dsn::replication::FLAGS_dup_max_allowed_write_size);
+        return false;
+    }
+    return true;
+});
+
+DSN_DEFINE_uint64(pegasus.server,
+                  dup_frame_target_latency_ms,
+                  500,
+                  "The frames are enlarged while all of them are shipped within this latency, "
+                  "and shrunk once any of them is beyond it");
+DSN_TAG_VARIABLE(dup_frame_target_latency_ms, FT_MUTABLE);
+
+DSN_DEFINE_bool(pegasus.server,
+                dup_compress_frames,
+                false,
+                "Whether to compress the frames by zstd while shipping in frames. Only enable it "
+                "after the remote cluster is able to decompress them, otherwise the frames are "
+                "rejected with ERR_HANDLER_NOT_FOUND and the duplication would get stuck");
+DSN_TAG_VARIABLE(dup_compress_frames, FT_MUTABLE);
+
+DSN_DEFINE_int32(pegasus.server,
+                 dup_frame_compression_level,
+                 1,
+                 "The zstd compression level of the frames");
+DSN_TAG_VARIABLE(dup_frame_compression_level, FT_MUTABLE);
+
+DSN_DEFINE_uint64(pegasus.server,
+                  dup_max_decompressed_frame_bytes,
+                  16 * 1024 * 1024,
+                  "The max bytes of a compressed frame after decompressed, the frames larger "
+                  "than that received from the remote cluster are rejected");
+DSN_TAG_VARIABLE(dup_max_decompressed_frame_bytes, FT_MUTABLE);
+DSN_DEFINE_validator(dup_max_decompressed_frame_bytes,
+                     [](uint64_t value) -> bool { return value > 0; });
+
 namespace pegasus {
 namespace server {
 
 using namespace dsn::literals::chrono_literals;
 
+namespace {
+
+// The estimated bytes of the fields of a duplicate_entry other than the raw message, while
+// packing the entries into a frame.
+const uint64_t kDuplicateEntryOverheadBytes = 64;
+
+// The DUPLICATEs come from other clusters, which should not be forwarded to any other
+// destinations.
+inline bool is_duplicate_rpc_code(dsn::task_code rpc_code)
+{
+    return rpc_code == dsn::apps::RPC_RRDB_RRDB_DUPLICATE ||
+           rpc_code == dsn::apps::RPC_RRDB_RRDB_DUPLICATE_COMPRESSED;
+}
+
+} // anonymous namespace
+
+/*extern*/ void compress_duplicate_entries(dsn::apps::duplicate_request &request)
+{
+    dsn::binary_writer writer;
+    dsn::marshall_thrift_binary(writer, request);
+    const auto data = writer.get_buffer();
+
+    std::string compressed(ZSTD_compressBound(data.length()), '\0');
+    const auto size = ZSTD_compress(&compressed[0],
+                                    compressed.size(),
+                                    data.data(),
+                                    data.length(),
+                                    FLAGS_dup_frame_compression_level);
+    CHECK(!ZSTD_isError(size), "failed to compress duplicate entries: {}", ZSTD_getErrorName(size));
+    compressed.resize(size);
+
+    request.entries.clear();
+    request.__set_compressed_entries(dsn::blob::create_from_bytes(std::move(compressed)));
+}
+
+/*extern*/ bool decompress_duplicate_entries(const dsn::blob &compressed,
+                                             dsn::apps::duplicate_request &request)
+{
+    const auto content_size = ZSTD_getFrameContentSize(compressed.data(), compressed.length());
+    if (content_size == ZSTD_CONTENTSIZE_ERROR || content_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+        return false;
+    }
+    // The content size is declared by the remote cluster, thus never trust it before allocating.
+    if (content_size > FLAGS_dup_max_decompressed_frame_bytes) {
+        return false;
+    }
+
+    std::string data(content_size, '\0');
+    const auto size =
+        ZSTD_decompress(&data[0], data.size(), compressed.data(), compressed.length());
+    if (ZSTD_isError(size) || size != content_size) {
+        return false;
+    }
+
+    dsn::from_blob_to_thrift(dsn::blob::create_from_bytes(std::move(data)), request);
+    // The compressed entries are never nested.
+    return !request.__isset.compressed_entries;
+}
+
 /*extern*/ uint64_t get_hash_from_request(dsn::task_code tc, const dsn::blob &data)
 {
     if (tc == dsn::apps::RPC_RRDB_RRDB_PUT) {
@@ -118,6 +255,7 @@ pegasus_mutation_duplicator::pegasus_mutation_duplicator(dsn::replication::repli
                                                          absl::string_view app)
     : mutation_duplicator(r),
       _remote_cluster(remote_cluster),
+      _frame_bytes(FLAGS_dup_frame_min_bytes),
       METRIC_VAR_INIT_replica(dup_shipped_successful_requests),
       METRIC_VAR_INIT_replica(dup_shipped_failed_requests)
 {
@@ -154,8 +292,14 @@ void pegasus_mutation_duplicator::send(uint64_t hash, callback cb)
         _inflights[hash].pop_front();
     }
 
+    const auto start_ms = dsn_now_ms();
     _client->async_duplicate(rpc,
-                             [hash, cb, rpc, this](dsn::error_code err) mutable {
+                             [hash, cb, rpc, start_ms, this](dsn::error_code err) mutable {
+                                 {
+                                     dsn::zauto_lock _(_lock);
+                                     _max_frame_latency_ms = std::max(
+                                         _max_frame_latency_ms, dsn_now_ms() - start_ms);
+                                 }
                                  on_duplicate_reply(hash, std::move(cb), std::move(rpc), err);
                              },
                              _env.__conf.tracker);
@@ -194,6 +338,7 @@ void pegasus_mutation_duplicator::on_duplicate_reply(uint64_t hash,
     {
         dsn::zauto_lock _(_lock);
         if (perr != PERR_OK || err != dsn::ERR_OK) {
+            _frame_failed = true;
             // retry this rpc
             _inflights[hash].push_front(rpc);
             _env.schedule([hash, cb, this]() { send(hash, cb); }, 1_s);
@@ -202,6 +347,9 @@ void pegasus_mutation_duplicator::on_duplicate_reply(uint64_t hash,
         if (_inflights[hash].empty()) {
             _inflights.erase(hash);
             if (_inflights.empty()) {
+                if (_in_frames) {
+                    adjust_frame_bytes();
+                }
                 // move forward to the next step.
                 cb(_total_shipped_size);
             }
@@ -213,10 +361,139 @@ void pegasus_mutation_duplicator::on_duplicate_reply(uint64_t hash,
     }
 }
 
+void pegasus_mutation_duplicator::enqueue(uint64_t key,
+                                          std::unique_ptr<dsn::apps::duplicate_request> request,
+                                          uint64_t hash)
+{
+    // The compressed frames are shipped by another rpc code, which would be rejected by the
+    // remote cluster unable to decompress them rather than be acknowledged as empty writes.
+    auto rpc_code = dsn::apps::RPC_RRDB_RRDB_DUPLICATE;
+    if (FLAGS_dup_compress_frames) {
+        compress_duplicate_entries(*request);
+        rpc_code = dsn::apps::RPC_RRDB_RRDB_DUPLICATE_COMPRESSED;
+    }
+    duplicate_rpc rpc(std::move(request),
+                      rpc_code,
+                      100_s, // TODO(wutao1): configurable timeout.
+                      hash);
+    _inflights[key].push_back(std::move(rpc));
+}
+
+void pegasus_mutation_duplicator::pack_frames(const mutation_tuple_set &muts)
+{
+    struct frame
+    {
+        std::unique_ptr<dsn::apps::duplicate_request> request;
+        uint64_t bytes{0};
+        // The hash of the last mutation, which represents the frame as the batch does.
+        uint64_t hash{0};
+    };
+
+    const uint32_t window_size = FLAGS_dup_frame_window_size;
+    // The frames are also limited by the max size of a write allowed by the remote cluster,
+    // otherwise they would be rejected and retried forever.
+    uint64_t frame_bytes = _frame_bytes.load(std::memory_order_relaxed);
+    if (dsn::replication::FLAGS_dup_max_allowed_write_size > 0) {
+        frame_bytes = std::min(frame_bytes, dsn::replication::FLAGS_dup_max_allowed_write_size);
+    }
+    std::vector<frame> frames(window_size);
+    for (const auto &mut : muts) {
+        // mut: 0=timestamp, 1=rpc_code, 2=raw_message
+        dsn::task_code rpc_code = std::get<1>(mut);
+        const dsn::blob &raw_message = std::get<2>(mut);
+        if (is_duplicate_rpc_code(rpc_code)) {
+            // ignore if it is a DUPLICATE, see batch_by_hash().
+            continue;
+        }
+
+        const uint64_t hash = get_hash_from_request(rpc_code, raw_message);
+        const uint64_t lane = hash % window_size;
+        auto &f = frames[lane];
+        const uint64_t entry_bytes = raw_message.length() + kDuplicateEntryOverheadBytes;
+        // Ship the frame before it would be beyond the limit, unless it's empty.
+        if (f.request != nullptr && !f.request->entries.empty() &&
+            f.bytes + entry_bytes > frame_bytes) {
+            enqueue(lane, std::move(f.request), f.hash);
+            f.bytes = 0;
+            _full_frames++;
+        }
+        if (f.request == nullptr) {
+            f.request = std::make_unique<dsn::apps::duplicate_request>();
+        }
+
+        dsn::apps::duplicate_entry entry;
+        entry.__set_raw_message(raw_message);
+        entry.__set_task_code(rpc_code);
+        entry.__set_timestamp(std::get<0>(mut));
+        entry.__set_cluster_id(get_current_cluster_id());
+        f.request->entries.emplace_back(std::move(entry));
+        f.bytes += entry_bytes;
+        f.hash = hash;
+
+        if (f.bytes >= frame_bytes) {
+            enqueue(lane, std::move(f.request), f.hash);
+            f.bytes = 0;
+            _full_frames++;
+        }
+    }
+
+    for (uint32_t lane = 0; lane < window_size; ++lane) {
+        auto &f = frames[lane];
+        if (f.request != nullptr && !f.request->entries.empty()) {
+            enqueue(lane, std::move(f.request), f.hash);
+        }
+    }
+}
+
+void pegasus_mutation_duplicator::adjust_frame_bytes()
+{
+    auto frame_bytes = _frame_bytes.load(std::memory_order_relaxed);
+    if (_frame_failed || _max_frame_latency_ms > FLAGS_dup_frame_target_latency_ms) {
+        // The smaller frames are shipped with lower latency, and retried at lower cost.
+        frame_bytes /= 2;
+    } else if (_full_frames > 0) {
+        // The frames were limited by the size rather than the mutations to be shipped while
+        // there's still room for the latency, thus the larger frames are shipped for higher
+        // throughput.
+        frame_bytes *= 2;
+    }
+    frame_bytes = std::min(frame_bytes, FLAGS_dup_frame_max_bytes);
+    frame_bytes = std::max(frame_bytes, FLAGS_dup_frame_min_bytes);
+    _frame_bytes.store(frame_bytes, std::memory_order_relaxed);
+}
+
+uint64_t pegasus_mutation_duplicator::preferred_batch_bytes() const
+{
+    // Each lane is expected to ship a full frame in a round.
+    return FLAGS_dup_frame_window_size * _frame_bytes.load(std::memory_order_relaxed);
+}
+
 void pegasus_mutation_duplicator::duplicate(mutation_tuple_set muts, callback cb)
 {
     _total_shipped_size = 0;
+    _in_frames = FLAGS_dup_frame_window_size > 0;
+    _full_frames = 0;
+    _max_frame_latency_ms = 0;
+    _frame_failed = false;
+
+    if (_in_frames) {
+        pack_frames(muts);
+    } else {
+        batch_by_hash(muts);
+    }
+
+    if (_inflights.empty()) {
+        cb(0);
+        return;
+    }
+    auto inflights = _inflights;
+    for (const auto &kv : inflights) {
+        send(kv.first, cb);
+    }
+}
 
+void pegasus_mutation_duplicator::batch_by_hash(const mutation_tuple_set &muts)
+{
     auto batch_request = std::make_unique<dsn::apps::duplicate_request>();
     uint batch_count = 0;
     uint batch_bytes = 0;
@@ -227,7 +504,7 @@ void pegasus_mutation_duplicator::duplicate(mutation_tuple_set muts, callback cb
         dsn::blob raw_message = std::get<2>(mut);
         auto dreq = std::make_unique<dsn::apps::duplicate_request>();
 
-        if (rpc_code == dsn::apps::RPC_RRDB_RRDB_DUPLICATE) {
+        if (is_duplicate_rpc_code(rpc_code)) {
             // ignore if it is a DUPLICATE
             // Because DUPLICATE comes from other clusters should not be forwarded to any other
             // destinations. A DUPLICATE is meant to be targeting only one cluster.
@@ -257,15 +534,6 @@ void pegasus_mutation_duplicator::duplicate(mutation_tuple_set muts, callback cb
             batch_bytes = 0;
         }
     }
-
-    if (_inflights.empty()) {
-        cb(0);
-        return;
-    }
-    auto inflights = _inflights;
-    for (const auto &kv : inflights) {
-        send(kv.first, cb);
-    }
 }
 
 } // namespace server
@@ -21,8 +21,10 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <atomic>
 #include <deque>
 #include <map>
+#include <memory>
 #include <string>
 
 #include "replica/duplication/mutation_duplicator.h"
@@ -53,6 +55,12 @@ namespace server {
 using namespace dsn::literals::chrono_literals;
 
 // Duplicates the loaded mutations to the remote pegasus cluster using pegasus client.
+//
+// Once [pegasus.server]dup_frame_window_size is set, the mutations are shipped in frames: each
+// mutation is packed into the frame of the lane selected by its hash, the lanes ship their
+// frames one by one while up to `dup_frame_window_size` frames of different lanes are in
+// flight. The bytes of a frame are adapted to the latency of shipping in each round, and the
+// frames are optionally compressed by zstd.
 class pegasus_mutation_duplicator : public dsn::replication::mutation_duplicator
 {
     using mutation_tuple_set = dsn::replication::mutation_tuple_set;
@@ -66,6 +74,8 @@ public:
 
     void duplicate(mutation_tuple_set muts, callback cb) override;
 
+    uint64_t preferred_batch_bytes() const override;
+
     ~pegasus_mutation_duplicator() override { _env.__conf.tracker->cancel_outstanding_tasks(); }
 
 private:
@@ -73,6 +83,17 @@ private:
 
     void on_duplicate_reply(uint64_t hash, callback, duplicate_rpc, dsn::error_code err);
 
+    // Packs `muts` into the batches, which are queued into `_inflights` by the hash of the last
+    // mutation of each batch.
+    void batch_by_hash(const mutation_tuple_set &muts);
+    // Packs `muts` into the frames of the lanes, which are queued into `_inflights` by lane.
+    void pack_frames(const mutation_tuple_set &muts);
+    void
+    enqueue(uint64_t key, std::unique_ptr<dsn::apps::duplicate_request> request, uint64_t hash);
+
+    // Adjusts the frame bytes by the shipping of the last round. Must be called under `_lock`.
+    void adjust_frame_bytes();
+
 private:
     friend class pegasus_mutation_duplicator_test;
 
@@ -81,7 +102,8 @@ private:
     uint8_t _remote_cluster_id{0};
     std::string _remote_cluster;
 
-    // The duplicate_rpc are isolated by their hash value from hash key.
+    // The duplicate_rpc are isolated by their hash value from hash key, or by the lane of the
+    // hash while shipping in frames.
     // Writes with the same hash are duplicated in mutation order to preserve data consistency,
     // otherwise they are duplicated concurrently to improve performance.
     std::map<uint64_t, std::deque<duplicate_rpc>> _inflights; // hash -> duplicate_rpc
@@ -89,6 +111,14 @@ private:
 
     size_t _total_shipped_size{0};
 
+    // The states of shipping in frames.
+    std::atomic<uint64_t> _frame_bytes;
+    bool _in_frames{false};
+    // The number of the frames in this round which are cut by `_frame_bytes`.
+    size_t _full_frames{0};
+    uint64_t _max_frame_latency_ms{0};
+    bool _frame_failed{false};
+
     METRIC_VAR_DECLARE_counter(dup_shipped_successful_requests);
     METRIC_VAR_DECLARE_counter(dup_shipped_failed_requests);
 };
@@ -97,5 +127,14 @@ private:
 // calculates the hash value from the write's hash key.
 extern uint64_t get_hash_from_request(dsn::task_code rpc_code, const dsn::blob &request_data);
 
+// Serializes `request` and compresses it by zstd into `request.compressed_entries`, then the
+// plain entries are cleared.
+extern void compress_duplicate_entries(dsn::apps::duplicate_request &request);
+
+// Decompresses `compressed` built by compress_duplicate_entries() into `request`.
+// Returns false if `compressed` is corrupted or too large after decompressed.
+extern bool decompress_duplicate_entries(const dsn::blob &compressed,
+                                         dsn::apps::duplicate_request &request);
+
 } // namespace server
 } // namespace pegasus
@@ -19,17 +19,50 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <deque>
+#include <iterator>
+#include <limits>
+#include <list>
 #include <map>
+#include <memory>
 #include <rocksdb/db.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "runtime/tool_api.h"
 #include "utils/rand.h"
+#include "utils/synchronize.h"
 #include <rrdb/rrdb_types.h>
 
 #include "base/pegasus_utils.h"
+#include "read_pushdown_filter.h"
 
 namespace pegasus {
 namespace server {
 
+// The result of iterating one batch on a scan context, it is either returned to the client
+// directly, or buffered in the context by prefetching in streaming scan mode.
+struct pegasus_scan_batch
+{
+    std::vector<::dsn::apps::key_value> kvs;
+    int32_t kv_count = 0;
+    int error = rocksdb::Status::kOk;
+    // The description of 'error', used for logging.
+    std::string error_message;
+    // true if the iterator has reached the stop key or the end of the data.
+    bool complete = false;
+    // true if the iteration time exceeds the threshold.
+    bool exceed_limit = false;
+    uint32_t batch_count = 0;
+    uint64_t expire_count = 0;
+    uint64_t filter_count = 0;
+
+    // no more batch could be produced from the context after this one.
+    bool is_last() const { return error != rocksdb::Status::kOk || exceed_limit || complete; }
+};
+
 struct pegasus_scan_context
 {
     pegasus_scan_context(std::unique_ptr<rocksdb::Iterator> &&iterator_,
@@ -43,7 +76,8 @@ struct pegasus_scan_context
                          bool no_value_,
                          bool validate_partition_hash_,
                          bool return_expire_ts_,
-                         bool only_return_count_)
+                         bool only_return_count_,
+                         int32_t prefetch_credits_ = 0)
         : _stop_holder(std::move(stop_)),
           _hash_key_filter_pattern_holder(std::move(hash_key_filter_pattern_)),
           _sort_key_filter_pattern_holder(std::move(sort_key_filter_pattern_)),
@@ -60,7 +94,8 @@ struct pegasus_scan_context
           no_value(no_value_),
           validate_partition_hash(validate_partition_hash_),
           return_expire_ts(return_expire_ts_),
-          only_return_count(only_return_count_)
+          only_return_count(only_return_count_),
+          prefetch_credits(prefetch_credits_)
     {
     }
 
@@ -86,8 +121,35 @@ public:
     bool validate_partition_hash;
     bool return_expire_ts;
     bool only_return_count;
+    // The predicates and projection pushed down by the client, nullptr if not set.
+    std::shared_ptr<read_pushdown_filter> pushdown;
+
+    // Streaming scan mode: the count of batches which are allowed to be prefetched ahead,
+    // 0 means disabled. It is granted by the client, and capped by the server.
+    int32_t prefetch_credits;
+    // The batches prefetched but not consumed yet, ordered by the iteration.
+    std::deque<pegasus_scan_batch> prefetched_batches;
+    // No more batch could be produced once the last batch has been iterated.
+    bool finished = false;
+    // Parallel sub-range scan mode: the key range is split into disjoint sub-ranges, each of
+    // them is iterated by its own context, and 'iterator' of this context is nullptr. The sub
+    // contexts are protected by 'iterate_lock' of this context as well.
+    std::vector<std::unique_ptr<pegasus_scan_context>> sub_scans;
+    // Protects the iterator and 'finished', thus only one batch is iterated at a time, either
+    // by the prefetch task or by the scan request.
+    ::dsn::utils::ex_lock_nr iterate_lock;
+    // Protects the prefetched batches and the credits. It is never held while iterating, thus
+    // the scan request could take a prefetched batch while the next one is being prefetched.
+    // If both are needed, 'iterate_lock' is locked first.
+    ::dsn::utils::ex_lock_nr lock;
 };
 
+// The scan contexts are distributed into shards by their handles, each shard is protected by
+// its own spin lock, thus the concurrent scanners on the same replica won't contend for one lock.
+// Each context records its last access time, so that the contexts abandoned by the clients,
+// which pin the RocksDB iterators and the obsolete memtables/SST files, could be evicted in time.
+// A context is always put back with a new handle once accessed, thus each shard keeps its
+// handles in the order of access, and the least recently accessed one is at the front.
 class pegasus_context_cache
 {
 public:
@@ -104,39 +166,157 @@ public:
         //
         // however, currently the implementation is not 100% correct.
         //
-        _counter = dsn::rand::next_u64(0, 2L << 31);
-        _counter <<= 32;
+        int64_t counter = dsn::rand::next_u64(0, 2L << 31);
+        counter <<= 32;
+        _counter.store(counter);
     }
 
     void clear()
     {
-        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
-        _map.clear();
+        for (auto &shard : _shards) {
+            std::unordered_map<int64_t, entry> map;
+            {
+                ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(shard.lock);
+                map.swap(shard.map);
+                shard.lru.clear();
+            }
+            _size.fetch_sub(map.size(), std::memory_order_relaxed);
+        }
     }
 
-    int64_t put(std::unique_ptr<pegasus_scan_context> context)
+    int64_t put(std::shared_ptr<pegasus_scan_context> context, uint64_t now_ms)
     {
-        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
-        int64_t handle = _counter++;
-        _map[handle] = std::move(context);
+        int64_t handle = _counter.fetch_add(1, std::memory_order_relaxed);
+        auto &shard = get_shard(handle);
+        {
+            ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(shard.lock);
+            shard.lru.push_back(handle);
+            shard.map[handle] = {std::move(context), now_ms, std::prev(shard.lru.end())};
+        }
+        _size.fetch_add(1, std::memory_order_relaxed);
         return handle;
     }
 
-    std::unique_ptr<pegasus_scan_context> fetch(int64_t handle)
+    // The context is shared with the prefetch task in streaming scan mode.
+    std::shared_ptr<pegasus_scan_context> fetch(int64_t handle)
     {
-        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(_lock);
-        auto kv = _map.find(handle);
-        if (kv == _map.end())
-            return nullptr;
-        std::unique_ptr<pegasus_scan_context> ret = std::move(kv->second);
-        _map.erase(kv);
+        std::shared_ptr<pegasus_scan_context> ret;
+        auto &shard = get_shard(handle);
+        {
+            ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(shard.lock);
+            auto kv = shard.map.find(handle);
+            if (kv == shard.map.end()) {
+                return nullptr;
+            }
+            ret = std::move(kv->second.context);
+            shard.erase(kv);
+        }
+        _size.fetch_sub(1, std::memory_order_relaxed);
         return ret;
     }
 
+    // Evict the contexts which have not been accessed for 'idle_ttl_ms'.
+    // Return the count of the evicted contexts.
+    size_t evict_idle(uint64_t now_ms, uint64_t idle_ttl_ms)
+    {
+        size_t evicted_count = 0;
+        for (auto &shard : _shards) {
+            // the contexts are released out of the lock, since destroying the iterators
+            // may be expensive.
+            std::vector<std::shared_ptr<pegasus_scan_context>> evicted;
+            {
+                ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(shard.lock);
+                while (!shard.lru.empty()) {
+                    auto kv = shard.map.find(shard.lru.front());
+                    if (kv->second.last_access_ms + idle_ttl_ms > now_ms) {
+                        break;
+                    }
+                    evicted.emplace_back(std::move(kv->second.context));
+                    shard.erase(kv);
+                }
+            }
+            _size.fetch_sub(evicted.size(), std::memory_order_relaxed);
+            evicted_count += evicted.size();
+        }
+        return evicted_count;
+    }
+
+    // Evict the least recently accessed contexts until there are at most 'max_count' contexts.
+    // Return the count of the evicted contexts.
+    size_t evict_overflow(size_t max_count)
+    {
+        size_t evicted_count = 0;
+        while (size() > max_count) {
+            // the least recently accessed context is at the front of some shard.
+            shard *oldest_shard = nullptr;
+            uint64_t oldest_access_ms = std::numeric_limits<uint64_t>::max();
+            for (auto &shard : _shards) {
+                ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(shard.lock);
+                if (shard.lru.empty()) {
+                    continue;
+                }
+                uint64_t access_ms = shard.map.find(shard.lru.front())->second.last_access_ms;
+                if (access_ms < oldest_access_ms) {
+                    oldest_shard = &shard;
+                    oldest_access_ms = access_ms;
+                }
+            }
+            if (oldest_shard == nullptr) {
+                break;
+            }
+
+            std::shared_ptr<pegasus_scan_context> evicted;
+            {
+                ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr_spin> l(oldest_shard->lock);
+                if (oldest_shard->lru.empty()) {
+                    // it has been fetched concurrently, just retry.
+                    continue;
+                }
+                auto kv = oldest_shard->map.find(oldest_shard->lru.front());
+                evicted = std::move(kv->second.context);
+                oldest_shard->erase(kv);
+            }
+            _size.fetch_sub(1, std::memory_order_relaxed);
+            ++evicted_count;
+        }
+        return evicted_count;
+    }
+
+    size_t size() const { return _size.load(std::memory_order_relaxed); }
+
 private:
-    int64_t _counter;
-    std::unordered_map<int64_t, std::unique_ptr<pegasus_scan_context>> _map;
-    ::dsn::utils::ex_lock_nr_spin _lock;
+    static const size_t kShardCount = 16;
+
+    struct entry
+    {
+        std::shared_ptr<pegasus_scan_context> context;
+        uint64_t last_access_ms;
+        // the position of the handle in 'shard::lru'.
+        std::list<int64_t>::iterator lru_pos;
+    };
+
+    struct shard
+    {
+        ::dsn::utils::ex_lock_nr_spin lock;
+        std::unordered_map<int64_t, entry> map;
+        // the handles in 'map', from the least recently accessed to the most.
+        std::list<int64_t> lru;
+
+        void erase(std::unordered_map<int64_t, entry>::iterator kv)
+        {
+            lru.erase(kv->second.lru_pos);
+            map.erase(kv);
+        }
+    };
+
+    shard &get_shard(int64_t handle)
+    {
+        return _shards[static_cast<uint64_t>(handle) % kShardCount];
+    }
+
+    std::atomic<int64_t> _counter;
+    std::atomic<size_t> _size{0};
+    std::array<shard, kShardCount> _shards;
 };
 }
 }
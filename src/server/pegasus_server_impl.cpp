@@ -36,8 +36,11 @@
 #include <time.h>
 #include <unistd.h> // IWYU pragma: keep
 #include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <functional>
+#include <iterator>
 #include <limits>
 #include <list>
 #include <mutex>
@@ -66,6 +69,7 @@
 #include "runtime/rpc/rpc_message.h"
 #include "runtime/task/async_calls.h"
 #include "runtime/task/task_code.h"
+#include "server/incr_merge_operator.h"
 #include "server/key_ttl_compaction_filter.h"
 #include "server/pegasus_manual_compact_service.h"
 #include "server/pegasus_read_service.h"
@@ -103,6 +107,42 @@ DSN_DEFINE_int32(pegasus.server,
                  0,
                  "Which error code to inject in read path, 0 means no error. Only for test.");
 DSN_TAG_VARIABLE(inject_read_error_for_test, FT_MUTABLE);
+DSN_DEFINE_int32(pegasus.server,
+                 rocksdb_scan_max_prefetch_batches,
+                 4,
+                 "The max count of batches which could be prefetched ahead for each scan context "
+                 "in streaming scan mode, 0 means streaming scan is disabled on this server.");
+DSN_TAG_VARIABLE(rocksdb_scan_max_prefetch_batches, FT_MUTABLE);
+DSN_DEFINE_int32(pegasus.server,
+                 rocksdb_scan_max_sub_scans,
+                 4,
+                 "The max count of sub-ranges which a full scan on one partition could be split "
+                 "into and iterated in parallel, <= 1 means parallel sub-range scan is disabled on "
+                 "this server.");
+DSN_TAG_VARIABLE(rocksdb_scan_max_sub_scans, FT_MUTABLE);
+DSN_DEFINE_bool(pegasus.server,
+                rocksdb_pin_read_values,
+                false,
+                "Whether to pin the values read by get, batch_get and multi_get in RocksDB and "
+                "attach them to the responses without copying. The pinned blocks, the RocksDB "
+                "super version and the DB itself are held until the responses are sent.");
+DSN_TAG_VARIABLE(rocksdb_pin_read_values, FT_MUTABLE);
+DSN_DEFINE_uint32(pegasus.server,
+                  scan_context_idle_ttl_seconds,
+                  300,
+                  "The scan context which is not accessed by the client for this time will be "
+                  "evicted, to release the RocksDB iterator pinned by it.");
+DSN_TAG_VARIABLE(scan_context_idle_ttl_seconds, FT_MUTABLE);
+DSN_DEFINE_uint32(pegasus.server,
+                  scan_context_evict_interval_seconds,
+                  10,
+                  "The interval seconds to check and evict the idle scan contexts.");
+DSN_DEFINE_uint32(pegasus.server,
+                  scan_context_max_count,
+                  10000,
+                  "The max count of scan contexts, i.e. the pinned RocksDB iterators, in one "
+                  "replica. The least recently accessed ones will be evicted once exceeded.");
+DSN_TAG_VARIABLE(scan_context_max_count, FT_MUTABLE);
 
 DSN_DECLARE_int32(read_amp_bytes_per_bit);
 DSN_DECLARE_uint32(checkpoint_reserve_min_count);
@@ -120,6 +160,8 @@ namespace pegasus {
 namespace server {
 
 DEFINE_TASK_CODE(LPC_PEGASUS_SERVER_DELAY, TASK_PRIORITY_COMMON, ::dsn::THREAD_POOL_DEFAULT)
+DEFINE_TASK_CODE(LPC_PEGASUS_SCAN_PREFETCH, TASK_PRIORITY_LOW, THREAD_POOL_SCAN)
+DEFINE_TASK_CODE(LPC_PEGASUS_SUB_SCAN, TASK_PRIORITY_COMMON, THREAD_POOL_SCAN)
 
 static std::string chkpt_get_dir_name(int64_t decree)
 {
@@ -134,12 +176,23 @@ static bool chkpt_init_from_dir(const char *name, int64_t &decree)
            std::string(name) == chkpt_get_dir_name(decree);
 }
 
+// Return 'it' if its current value stays pinned until 'it' is deleted, otherwise null.
+static std::shared_ptr<void> pinned_value_holder(const std::shared_ptr<rocksdb::Iterator> &it)
+{
+    if (!it->IsValuePinned()) {
+        return nullptr;
+    }
+    return it;
+}
+
 std::shared_ptr<rocksdb::RateLimiter> pegasus_server_impl::_s_rate_limiter;
 int64_t pegasus_server_impl::_rocksdb_limiter_last_total_through;
 std::shared_ptr<rocksdb::Cache> pegasus_server_impl::_s_block_cache;
+std::shared_ptr<rocksdb::Cache> pegasus_server_impl::_s_row_cache;
 std::shared_ptr<rocksdb::WriteBufferManager> pegasus_server_impl::_s_write_buffer_manager;
 ::dsn::task_ptr pegasus_server_impl::_update_server_rdb_stat;
 METRIC_VAR_DEFINE_gauge_int64(rdb_block_cache_mem_usage_bytes, pegasus_server_impl);
+METRIC_VAR_DEFINE_gauge_int64(rdb_row_cache_mem_usage_bytes, pegasus_server_impl);
 METRIC_VAR_DEFINE_gauge_int64(rdb_write_rate_limiter_through_bytes_per_sec, pegasus_server_impl);
 const std::string pegasus_server_impl::COMPRESSION_HEADER = "per_level:";
 const std::chrono::seconds pegasus_server_impl::kServerStatUpdateTimeSec = std::chrono::seconds(10);
@@ -431,11 +484,12 @@ void pegasus_server_impl::on_get(get_rpc rpc)
 
     const auto &key = rpc.request();
     rocksdb::Slice skey(key.data(), key.length());
-    std::string value;
-    rocksdb::Status status = _db->Get(_data_cf_rd_opts, _data_cf, skey, &value);
+    // The value is pinned in the block cache or the memtable if possible, rather than copied.
+    auto value = make_db_pinned(new rocksdb::PinnableSlice());
+    rocksdb::Status status = _db->Get(_data_cf_rd_opts, _data_cf, skey, value.get());
 
     if (status.ok()) {
-        if (check_if_record_expired(utils::epoch_now(), value)) {
+        if (check_if_record_expired(utils::epoch_now(), *value)) {
             METRIC_VAR_INCREMENT(read_expired_values);
             LOG_EXPIRED_DATA_IF_VERBOSE(key);
             status = rocksdb::Status::NotFound();
@@ -464,7 +518,7 @@ void pegasus_server_impl::on_get(get_rpc rpc)
 #endif
 
     auto time_used = METRIC_VAR_AUTO_LATENCY_DURATION_NS(get_latency_ns);
-    if (is_get_abnormal(time_used, value.size())) {
+    if (is_get_abnormal(time_used, value->size())) {
         ::dsn::blob hash_key, sort_key;
         pegasus_restore_key(key, hash_key, sort_key);
         LOG_WARNING_PREFIX("rocksdb abnormal get from {}: "
@@ -474,14 +528,14 @@ void pegasus_server_impl::on_get(get_rpc rpc)
                            ::pegasus::utils::c_escape_sensitive_string(hash_key),
                            ::pegasus::utils::c_escape_sensitive_string(sort_key),
                            status.ToString(),
-                           value.size(),
+                           value->size(),
                            time_used);
         METRIC_VAR_INCREMENT(abnormal_read_requests);
     }
 
     resp.error = status.code();
     if (status.ok()) {
-        pegasus_extract_user_data(_pegasus_data_version, std::move(value), resp.value);
+        extract_user_data(*value, value, nullptr, resp.value);
     }
 
     _cu_calculator->add_get_cu(rpc.dsn_request(), resp.error, key, resp.value);
@@ -514,6 +568,14 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
         return;
     }
 
+    std::shared_ptr<read_pushdown_filter> pushdown;
+    if (request.__isset.pushdown &&
+        !parse_read_pushdown(request.pushdown, "multi_get", rpc.remote_address(), pushdown)) {
+        resp.error = rocksdb::Status::kInvalidArgument;
+        _cu_calculator->add_multi_get_cu(req, resp.error, request.hash_key, resp.kvs);
+        return;
+    }
+
     uint32_t max_kv_count = _rng_rd_opts.multi_get_max_iteration_count;
     uint32_t max_iteration_count = _rng_rd_opts.multi_get_max_iteration_count;
     if (request.max_kv_count > 0 && request.max_kv_count < max_kv_count) {
@@ -600,7 +662,8 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
             return;
         }
 
-        std::unique_ptr<rocksdb::Iterator> it;
+        // The iterator is shared by the values pinned by it, see append_key_value_for_multi_get.
+        std::shared_ptr<rocksdb::Iterator> it;
         bool complete = false;
 
         std::unique_ptr<range_read_limiter> limiter =
@@ -609,7 +672,9 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
                                                  _rng_rd_opts.rocksdb_iteration_threshold_time_ms);
 
         if (!request.reverse) {
-            it.reset(_db->NewIterator(_data_cf_rd_opts, _data_cf));
+            rocksdb::ReadOptions rd_opts(_data_cf_rd_opts);
+            rd_opts.pin_data = FLAGS_rocksdb_pin_read_values;
+            it = make_db_pinned(_db->NewIterator(rd_opts, _data_cf));
             it->Seek(start);
             bool first_exclusive = !start_inclusive;
             while (count < max_kv_count && limiter->valid() && it->Valid()) {
@@ -640,7 +705,9 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
                                                             request.sort_key_filter_type,
                                                             request.sort_key_filter_pattern,
                                                             epoch_now,
-                                                            request.no_value);
+                                                            request.no_value,
+                                                            pushdown.get(),
+                                                            pinned_value_holder(it));
 
                 switch (state) {
                 case range_iteration_state::kNormal: {
@@ -680,7 +747,8 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
                 rd_opts.total_order_seek = true;
                 rd_opts.prefix_same_as_start = false;
             }
-            it.reset(_db->NewIterator(rd_opts, _data_cf));
+            rd_opts.pin_data = FLAGS_rocksdb_pin_read_values;
+            it = make_db_pinned(_db->NewIterator(rd_opts, _data_cf));
             it->SeekForPrev(stop);
             bool first_exclusive = !stop_inclusive;
             std::vector<::dsn::apps::key_value> reverse_kvs;
@@ -712,7 +780,9 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
                                                             request.sort_key_filter_type,
                                                             request.sort_key_filter_pattern,
                                                             epoch_now,
-                                                            request.no_value);
+                                                            request.no_value,
+                                                            pushdown.get(),
+                                                            pinned_value_holder(it));
                 switch (state) {
                 case range_iteration_state::kNormal: {
                     count++;
@@ -785,7 +855,6 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
         bool exceed_limit = false;
         std::vector<::dsn::blob> keys_holder;
         std::vector<rocksdb::Slice> keys;
-        std::vector<std::string> values;
         keys_holder.reserve(request.sort_keys.size());
         keys.reserve(request.sort_keys.size());
         for (auto &sort_key : request.sort_keys) {
@@ -795,10 +864,14 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
             keys_holder.emplace_back(std::move(raw_key));
         }
 
-        std::vector<rocksdb::Status> statuses = _db->MultiGet(_data_cf_rd_opts, keys, &values);
+        // The values are pinned together, and released once all of them are sent.
+        auto values = make_db_pinned(new std::vector<rocksdb::PinnableSlice>(keys.size()));
+        std::vector<rocksdb::Status> statuses(keys.size());
+        _db->MultiGet(
+            _data_cf_rd_opts, _data_cf, keys.size(), keys.data(), values->data(), statuses.data());
         for (int i = 0; i < keys.size(); i++) {
             rocksdb::Status &status = statuses[i];
-            std::string &value = values[i];
+            const rocksdb::PinnableSlice &value = (*values)[i];
             if (!status.ok()) {
                 if (FLAGS_rocksdb_verbose_log) {
                     LOG_ERROR_PREFIX(
@@ -831,6 +904,12 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
                 continue;
             }
 
+            if (pushdown && pushdown->has_predicates() &&
+                !match_read_pushdown(*pushdown, request.sort_keys[i], value, epoch_now)) {
+                filter_count++;
+                continue;
+            }
+
             // check if exceed limit
             if (dsn_unlikely(count >= max_kv_count || size >= max_kv_size)) {
                 exceed_limit = true;
@@ -840,7 +919,7 @@ void pegasus_server_impl::on_multi_get(multi_get_rpc rpc)
             ::dsn::apps::key_value kv;
             kv.key = request.sort_keys[i];
             if (!request.no_value) {
-                pegasus_extract_user_data(_pegasus_data_version, std::move(value), kv.value);
+                extract_user_data(value, values, pushdown.get(), kv.value);
             }
             count++;
             size += kv.key.length() + kv.value.length();
@@ -938,8 +1017,11 @@ void pegasus_server_impl::on_batch_get(batch_get_rpc rpc)
     uint32_t epoch_now = pegasus::utils::epoch_now();
     uint64_t expire_count = 0;
 
-    std::vector<std::string> values;
-    std::vector<rocksdb::Status> statuses = _db->MultiGet(_data_cf_rd_opts, keys, &values);
+    // The values are pinned together, and released once all of them are sent.
+    auto values = make_db_pinned(new std::vector<rocksdb::PinnableSlice>(keys.size()));
+    std::vector<rocksdb::Status> statuses(keys.size());
+    _db->MultiGet(
+        _data_cf_rd_opts, _data_cf, keys.size(), keys.data(), values->data(), statuses.data());
     response.data.reserve(request.keys.size());
     for (int i = 0; i < keys.size(); i++) {
         const auto &status = statuses[i];
@@ -949,7 +1031,7 @@ void pegasus_server_impl::on_batch_get(batch_get_rpc rpc)
 
         const ::dsn::blob &hash_key = request.keys[i].hash_key;
         const ::dsn::blob &sort_key = request.keys[i].sort_key;
-        std::string &value = values[i];
+        const rocksdb::PinnableSlice &value = (*values)[i];
 
         if (dsn_likely(status.ok())) {
             if (check_if_record_expired(epoch_now, value)) {
@@ -959,7 +1041,7 @@ void pegasus_server_impl::on_batch_get(batch_get_rpc rpc)
             }
 
             dsn::blob real_value;
-            pegasus_extract_user_data(_pegasus_data_version, std::move(value), real_value);
+            extract_user_data(value, values, nullptr, real_value);
             dsn::apps::full_data current_data;
             current_data.hash_key = hash_key;
             current_data.sort_key = sort_key;
@@ -1179,6 +1261,14 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
         return;
     }
 
+    std::shared_ptr<read_pushdown_filter> pushdown;
+    if (request.__isset.pushdown &&
+        !parse_read_pushdown(request.pushdown, "get_scanner", rpc.remote_address(), pushdown)) {
+        resp.error = rocksdb::Status::kInvalidArgument;
+        _cu_calculator->add_scan_cu(req, resp.error, resp.kvs);
+        return;
+    }
+
     rocksdb::ReadOptions rd_opts(_data_cf_rd_opts);
     if (_data_cf_opts.prefix_extractor) {
         ::dsn::blob start_hash_key, tmp;
@@ -1234,15 +1324,6 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
         return;
     }
 
-    std::unique_ptr<rocksdb::Iterator> it(_db->NewIterator(rd_opts, _data_cf));
-    it->Seek(start);
-    bool complete = false;
-    bool first_exclusive = !start_inclusive;
-    uint32_t epoch_now = ::pegasus::utils::epoch_now();
-    uint64_t expire_count = 0;
-    uint64_t filter_count = 0;
-    int32_t count = 0;
-
     uint32_t batch_count = _rng_rd_opts.rocksdb_max_iteration_count;
     if (request.batch_size > 0 && request.batch_size < batch_count) {
         batch_count = request.batch_size;
@@ -1251,6 +1332,81 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
 
     bool return_expire_ts = request.__isset.return_expire_ts ? request.return_expire_ts : false;
     bool only_return_count = request.__isset.only_return_count ? request.only_return_count : false;
+    int32_t prefetch_credits =
+        request.__isset.prefetch_credits
+            ? std::min(request.prefetch_credits, FLAGS_rocksdb_scan_max_prefetch_batches)
+            : 0;
+    auto new_scan_context = [&](std::unique_ptr<rocksdb::Iterator> iter,
+                                std::string &&stop_key,
+                                bool stop_key_inclusive) {
+        auto context = std::make_unique<pegasus_scan_context>(
+            std::move(iter),
+            std::move(stop_key),
+            stop_key_inclusive,
+            request.hash_key_filter_type,
+            std::string(request.hash_key_filter_pattern.data(),
+                        request.hash_key_filter_pattern.length()),
+            request.sort_key_filter_type,
+            std::string(request.sort_key_filter_pattern.data(),
+                        request.sort_key_filter_pattern.length()),
+            batch_count,
+            request.no_value,
+            request.__isset.validate_partition_hash ? request.validate_partition_hash : true,
+            return_expire_ts,
+            only_return_count,
+            prefetch_credits);
+        context->pushdown = pushdown;
+        return context;
+    };
+
+    // Parallel sub-range scan mode, fall back to the single iterator if the range couldn't be
+    // split, e.g. all of the data are still in the memtables.
+    int32_t sub_scan_count =
+        request.__isset.sub_scan_count
+            ? std::min(request.sub_scan_count, FLAGS_rocksdb_scan_max_sub_scans)
+            : 0;
+    if (request.full_scan && sub_scan_count > 1) {
+        std::vector<std::string> split_keys = get_scan_split_keys(start, stop, sub_scan_count);
+        if (!split_keys.empty()) {
+            std::shared_ptr<pegasus_scan_context> context =
+                new_scan_context(nullptr, std::string(stop.data(), stop.size()), stop_inclusive);
+            for (size_t i = 0; i <= split_keys.size(); ++i) {
+                std::unique_ptr<rocksdb::Iterator> sub_it(_db->NewIterator(rd_opts, _data_cf));
+                if (i == 0) {
+                    sub_it->Seek(start);
+                    if (!start_inclusive && sub_it->Valid() && sub_it->key().compare(start) == 0) {
+                        // discard start_sortkey
+                        sub_it->Next();
+                    }
+                } else {
+                    sub_it->Seek(split_keys[i - 1]);
+                }
+                if (i < split_keys.size()) {
+                    context->sub_scans.emplace_back(
+                        new_scan_context(std::move(sub_it), std::string(split_keys[i]), false));
+                } else {
+                    context->sub_scans.emplace_back(new_scan_context(
+                        std::move(sub_it), std::string(stop.data(), stop.size()), stop_inclusive));
+                }
+            }
+
+            pegasus_scan_batch batch;
+            scan_next_batch(*context, batch);
+            fill_scan_response(
+                "get_scanner", rpc.remote_address(), std::move(context), batch, resp);
+            _cu_calculator->add_scan_cu(req, resp.error, resp.kvs);
+            return;
+        }
+    }
+
+    std::unique_ptr<rocksdb::Iterator> it(_db->NewIterator(rd_opts, _data_cf));
+    it->Seek(start);
+    bool complete = false;
+    bool first_exclusive = !start_inclusive;
+    uint32_t epoch_now = ::pegasus::utils::epoch_now();
+    uint64_t expire_count = 0;
+    uint64_t filter_count = 0;
+    int32_t count = 0;
 
     std::unique_ptr<range_read_limiter> limiter =
         std::make_unique<range_read_limiter>(_rng_rd_opts.rocksdb_max_iteration_count,
@@ -1284,14 +1440,19 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
             request.sort_key_filter_type,
             request.sort_key_filter_pattern,
             epoch_now,
-            request.__isset.validate_partition_hash ? request.validate_partition_hash : true);
+            request.__isset.validate_partition_hash ? request.validate_partition_hash : true,
+            pushdown.get());
 
         switch (state) {
         case range_iteration_state::kNormal:
             count++;
             if (!only_return_count) {
-                append_key_value(
-                    resp.kvs, it->key(), it->value(), request.no_value, return_expire_ts);
+                append_key_value(resp.kvs,
+                                 it->key(),
+                                 it->value(),
+                                 request.no_value,
+                                 return_expire_ts,
+                                 pushdown.get());
             }
             break;
         case range_iteration_state::kExpired:
@@ -1353,31 +1514,12 @@ void pegasus_server_impl::on_get_scanner(get_scanner_rpc rpc)
                            limiter->max_duration_time());
     } else if (it->Valid() && !complete) {
         // scan not completed
-        std::unique_ptr<pegasus_scan_context> context(new pegasus_scan_context(
-            std::move(it),
-            std::string(stop.data(), stop.size()),
-            request.stop_inclusive,
-            request.hash_key_filter_type,
-            std::string(request.hash_key_filter_pattern.data(),
-                        request.hash_key_filter_pattern.length()),
-            request.sort_key_filter_type,
-            std::string(request.sort_key_filter_pattern.data(),
-                        request.sort_key_filter_pattern.length()),
-            batch_count,
-            request.no_value,
-            request.__isset.validate_partition_hash ? request.validate_partition_hash : true,
-            return_expire_ts,
-            only_return_count));
-        int64_t handle = _context_cache.put(std::move(context));
-        resp.context_id = handle;
-        // if the context is used, it will be fetched and re-put into cache,
-        // which will change the handle,
-        // then the delayed task will fetch null context by old handle, and do nothing.
-        ::dsn::tasking::enqueue(LPC_PEGASUS_SERVER_DELAY,
-                                &_tracker,
-                                [this, handle]() { _context_cache.fetch(handle); },
-                                0,
-                                std::chrono::minutes(5));
+        std::shared_ptr<pegasus_scan_context> context = new_scan_context(
+            std::move(it), std::string(stop.data(), stop.size()), request.stop_inclusive);
+        // if the context is used, it will be fetched and re-put into cache, which will change
+        // the handle; if the context is not used for a while, it will be evicted.
+        resp.context_id = put_scan_context(context);
+        start_scan_prefetch(std::move(context));
     } else {
         // scan completed
         resp.context_id = pegasus_scan_context::SCAN_CONTEXT_ID_COMPLETED;
@@ -1406,139 +1548,402 @@ void pegasus_server_impl::on_scan(scan_rpc rpc)
 
     const auto &request = rpc.request();
     dsn::message_ex *req = rpc.dsn_request();
-    std::unique_ptr<pegasus_scan_context> context = _context_cache.fetch(request.context_id);
+    std::shared_ptr<pegasus_scan_context> context = _context_cache.fetch(request.context_id);
     if (context) {
-        rocksdb::Iterator *it = context->iterator.get();
-        const rocksdb::Slice &stop = context->stop;
-        bool stop_inclusive = context->stop_inclusive;
-        ::dsn::apps::filter_type::type hash_key_filter_type = context->hash_key_filter_type;
-        const ::dsn::blob &hash_key_filter_pattern = context->hash_key_filter_pattern;
-        ::dsn::apps::filter_type::type sort_key_filter_type = context->sort_key_filter_type;
-        const ::dsn::blob &sort_key_filter_pattern = context->sort_key_filter_pattern;
-        bool no_value = context->no_value;
-        bool validate_hash = context->validate_partition_hash;
-        bool return_expire_ts = context->return_expire_ts;
-        bool complete = false;
-        uint32_t epoch_now = ::pegasus::utils::epoch_now();
-        uint64_t expire_count = 0;
-        uint64_t filter_count = 0;
-        int32_t count = 0;
+        pegasus_scan_batch batch;
+        // Take the batch which has been prefetched while the client was consuming the previous
+        // one, should be called with 'context->lock' held.
+        auto take_prefetched_batch = [&context, &batch]() {
+            if (context->prefetched_batches.empty()) {
+                return false;
+            }
+            batch = std::move(context->prefetched_batches.front());
+            context->prefetched_batches.pop_front();
+            return true;
+        };
 
-        uint32_t batch_count = _rng_rd_opts.rocksdb_max_iteration_count;
-        if (context->batch_size > 0 && context->batch_size < batch_count) {
-            batch_count = context->batch_size;
+        bool prefetched = false;
+        {
+            ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr> l(context->lock);
+            if (request.__isset.prefetch_credits) {
+                context->prefetch_credits = std::min(
+                    request.prefetch_credits, FLAGS_rocksdb_scan_max_prefetch_batches);
+            }
+            prefetched = take_prefetched_batch();
+        }
+        if (!prefetched) {
+            // Wait for the batch being prefetched if any, which is taken once it is done,
+            // rather than iterating concurrently with the prefetch task.
+            ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr> il(context->iterate_lock);
+            {
+                ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr> l(context->lock);
+                prefetched = take_prefetched_batch();
+            }
+            if (!prefetched) {
+                scan_next_batch(*context, batch);
+            }
+        }
+        if (prefetched) {
+            METRIC_VAR_INCREMENT(scan_prefetch_hit_batches);
         }
 
-        std::unique_ptr<range_read_limiter> limiter = std::make_unique<range_read_limiter>(
-            batch_count, 0, _rng_rd_opts.rocksdb_iteration_threshold_time_ms);
+        fill_scan_response("scan", rpc.remote_address(), std::move(context), batch, resp);
+    } else {
+        resp.error = rocksdb::Status::Code::kNotFound;
+    }
 
-        while (count < batch_count && limiter->valid() && it->Valid()) {
-            int c = it->key().compare(stop);
-            if (c > 0 || (c == 0 && !stop_inclusive)) {
-                // out of range
-                complete = true;
-                break;
-            }
+    _cu_calculator->add_scan_cu(req, resp.error, resp.kvs);
+}
 
-            limiter->add_count();
-
-            auto state = validate_key_value_for_scan(it->key(),
-                                                     it->value(),
-                                                     hash_key_filter_type,
-                                                     hash_key_filter_pattern,
-                                                     sort_key_filter_type,
-                                                     sort_key_filter_pattern,
-                                                     epoch_now,
-                                                     validate_hash);
-
-            switch (state) {
-            case range_iteration_state::kNormal:
-                count++;
-                if (!context->only_return_count) {
-                    append_key_value(resp.kvs, it->key(), it->value(), no_value, return_expire_ts);
-                }
-                break;
-            case range_iteration_state::kExpired:
-                expire_count++;
-                break;
-            case range_iteration_state::kFiltered:
-                filter_count++;
-                break;
-            default:
-                break;
-            }
+void pegasus_server_impl::fill_scan_response(const char *op,
+                                             const dsn::rpc_address &remote_address,
+                                             std::shared_ptr<pegasus_scan_context> context,
+                                             pegasus_scan_batch &batch,
+                                             ::dsn::apps::scan_response &resp)
+{
+    if (context->only_return_count) {
+        resp.__set_kv_count(batch.kv_count);
+    }
 
-            if (c == 0) {
-                // seek to the last position
-                complete = true;
-                break;
-            }
+    resp.error = batch.error;
+    resp.kvs = std::move(batch.kvs);
+    if (batch.error != rocksdb::Status::kOk) {
+        // error occur
+        if (FLAGS_rocksdb_verbose_log) {
+            LOG_ERROR_PREFIX("rocksdb scan failed for {} from {}: stop_key = \"{}\" ({}), "
+                             "batch_size = {}, read_count = {}, error = {}",
+                             op,
+                             remote_address,
+                             ::pegasus::utils::c_escape_sensitive_string(context->stop),
+                             context->stop_inclusive ? "inclusive" : "exclusive",
+                             batch.batch_count,
+                             batch.kv_count,
+                             batch.error_message);
+        } else {
+            LOG_ERROR_PREFIX("rocksdb scan failed for {} from {}: error = {}",
+                             op,
+                             remote_address,
+                             batch.error_message);
+        }
+    } else if (batch.exceed_limit) {
+        // scan exceed limit time
+        resp.error = rocksdb::Status::kIncomplete;
+        LOG_WARNING_PREFIX("rocksdb abnormal scan from {}: batch_count={}, exceed the "
+                           "iteration time threshold({}ms)",
+                           remote_address,
+                           batch.batch_count,
+                           _rng_rd_opts.rocksdb_iteration_threshold_time_ms);
+    } else if (!batch.complete) {
+        // scan not completed
+        resp.context_id = put_scan_context(context);
+        start_scan_prefetch(std::move(context));
+    } else {
+        // scan completed
+        resp.context_id = pegasus_scan_context::SCAN_CONTEXT_ID_COMPLETED;
+    }
+
+    METRIC_VAR_INCREMENT_BY(read_expired_values, batch.expire_count);
+    METRIC_VAR_INCREMENT_BY(read_filtered_values, batch.filter_count);
+}
+
+void pegasus_server_impl::scan_next_batch(pegasus_scan_context &context, pegasus_scan_batch &batch)
+{
+    if (!context.sub_scans.empty()) {
+        scan_sub_ranges(context, batch);
+        context.finished = batch.is_last();
+        return;
+    }
+
+    rocksdb::Iterator *it = context.iterator.get();
+    const rocksdb::Slice &stop = context.stop;
+    bool complete = false;
+    uint32_t epoch_now = ::pegasus::utils::epoch_now();
+
+    uint32_t batch_count = _rng_rd_opts.rocksdb_max_iteration_count;
+    if (context.batch_size > 0 && context.batch_size < batch_count) {
+        batch_count = context.batch_size;
+    }
+    batch.batch_count = batch_count;
 
-            it->Next();
+    std::unique_ptr<range_read_limiter> limiter = std::make_unique<range_read_limiter>(
+        batch_count, 0, _rng_rd_opts.rocksdb_iteration_threshold_time_ms);
+
+    while (batch.kv_count < batch_count && limiter->valid() && it->Valid()) {
+        int c = it->key().compare(stop);
+        if (c > 0 || (c == 0 && !context.stop_inclusive)) {
+            // out of range
+            complete = true;
+            break;
+        }
+
+        limiter->add_count();
+
+        auto state = validate_key_value_for_scan(it->key(),
+                                                 it->value(),
+                                                 context.hash_key_filter_type,
+                                                 context.hash_key_filter_pattern,
+                                                 context.sort_key_filter_type,
+                                                 context.sort_key_filter_pattern,
+                                                 epoch_now,
+                                                 context.validate_partition_hash,
+                                                 context.pushdown.get());
+
+        switch (state) {
+        case range_iteration_state::kNormal:
+            batch.kv_count++;
+            if (!context.only_return_count) {
+                append_key_value(batch.kvs,
+                                 it->key(),
+                                 it->value(),
+                                 context.no_value,
+                                 context.return_expire_ts,
+                                 context.pushdown.get());
+            }
+            break;
+        case range_iteration_state::kExpired:
+            batch.expire_count++;
+            break;
+        case range_iteration_state::kFiltered:
+            batch.filter_count++;
+            break;
+        default:
+            break;
         }
 
-        if (context->only_return_count) {
-            resp.__set_kv_count(count);
+        if (c == 0) {
+            // seek to the last position
+            complete = true;
+            break;
         }
 
-        // check iteration time whether exceed limit
-        if (!complete) {
-            limiter->time_check_after_incomplete_scan();
+        it->Next();
+    }
+
+    // check iteration time whether exceed limit
+    if (!complete) {
+        limiter->time_check_after_incomplete_scan();
+    }
+
+    batch.error = it->status().code();
+    if (!it->status().ok()) {
+        batch.error_message = it->status().ToString();
+        batch.kvs.clear();
+    } else {
+        batch.exceed_limit = limiter->exceed_limit();
+        batch.complete = complete || !it->Valid();
+    }
+    context.finished = batch.is_last();
+}
+
+namespace {
+// The state shared by the tasks iterating the sub-ranges of one batch, it may outlive the batch
+// in the helper tasks which start after all of the sub-ranges have been claimed.
+struct sub_scan_state
+{
+    std::vector<pegasus_scan_context *> contexts;
+    std::vector<pegasus_scan_batch> batches;
+    // The index of the next sub-range to be claimed.
+    std::atomic<size_t> next{0};
+    std::mutex mtx;
+    std::condition_variable cv;
+    size_t done = 0;
+};
+} // anonymous namespace
+
+void pegasus_server_impl::scan_sub_ranges(pegasus_scan_context &context, pegasus_scan_batch &batch)
+{
+    auto state = std::make_shared<sub_scan_state>();
+    for (const auto &sub_scan : context.sub_scans) {
+        if (!sub_scan->finished) {
+            state->contexts.push_back(sub_scan.get());
         }
+    }
+    batch.batch_count = context.batch_size;
+    if (state->contexts.empty()) {
+        batch.complete = true;
+        return;
+    }
 
-        resp.error = it->status().code();
-        if (!it->status().ok()) {
-            // error occur
-            if (FLAGS_rocksdb_verbose_log) {
-                LOG_ERROR_PREFIX("rocksdb scan failed for scan from {}: context_id= {}, stop_key = "
-                                 "\"{}\" ({}), batch_size = {}, read_count = {}, error = {}",
-                                 rpc.remote_address(),
-                                 request.context_id,
-                                 ::pegasus::utils::c_escape_sensitive_string(stop),
-                                 stop_inclusive ? "inclusive" : "exclusive",
-                                 batch_count,
-                                 count,
-                                 it->status().ToString());
-            } else {
-                LOG_ERROR_PREFIX("rocksdb scan failed for scan from {}: error = {}",
-                                 rpc.remote_address(),
-                                 it->status().ToString());
+    // The batch is shared evenly by the sub-ranges which are not finished yet.
+    const size_t count = state->contexts.size();
+    const int32_t sub_batch_size =
+        std::max<int32_t>(1, (context.batch_size + static_cast<int32_t>(count) - 1) / count);
+    for (auto *sub_scan : state->contexts) {
+        sub_scan->batch_size = sub_batch_size;
+    }
+    state->batches.resize(count);
+
+    auto run = [this, state]() {
+        size_t i;
+        while ((i = state->next.fetch_add(1)) < state->contexts.size()) {
+            scan_next_batch(*state->contexts[i], state->batches[i]);
+            std::lock_guard<std::mutex> l(state->mtx);
+            if (++state->done == state->contexts.size()) {
+                state->cv.notify_one();
             }
-            resp.kvs.clear();
-        } else if (limiter->exceed_limit()) {
-            // scan exceed limit time
-            resp.error = rocksdb::Status::kIncomplete;
-            LOG_WARNING_PREFIX("rocksdb abnormal scan from {}: batch_count={}, time_used({}ns) VS "
-                               "time_threshold({}ns)",
-                               rpc.remote_address(),
-                               batch_count,
-                               limiter->duration_time(),
-                               limiter->max_duration_time());
-        } else if (it->Valid() && !complete) {
-            // scan not completed
-            int64_t handle = _context_cache.put(std::move(context));
-            resp.context_id = handle;
-            ::dsn::tasking::enqueue(LPC_PEGASUS_SERVER_DELAY,
-                                    &_tracker,
-                                    [this, handle]() { _context_cache.fetch(handle); },
-                                    0,
-                                    std::chrono::minutes(5));
-        } else {
-            // scan completed
-            resp.context_id = pegasus_scan_context::SCAN_CONTEXT_ID_COMPLETED;
         }
+    };
+    // The current thread iterates the sub-ranges as well, thus the scan always makes progress
+    // even if the helper tasks are queued behind others on the busy thread pool.
+    for (size_t i = 1; i < count; ++i) {
+        ::dsn::tasking::enqueue(LPC_PEGASUS_SUB_SCAN, &_tracker, run);
+    }
+    run();
+    {
+        std::unique_lock<std::mutex> l(state->mtx);
+        state->cv.wait(l, [&state, count]() { return state->done == count; });
+    }
+
+    // Merge the batches in the order of the sub-ranges.
+    for (size_t i = 0; i < count; ++i) {
+        auto &sub_batch = state->batches[i];
+        batch.kv_count += sub_batch.kv_count;
+        batch.expire_count += sub_batch.expire_count;
+        batch.filter_count += sub_batch.filter_count;
+        if (sub_batch.error != rocksdb::Status::kOk && batch.error == rocksdb::Status::kOk) {
+            batch.error = sub_batch.error;
+            batch.error_message = std::move(sub_batch.error_message);
+        }
+        batch.exceed_limit = batch.exceed_limit || sub_batch.exceed_limit;
+        std::move(sub_batch.kvs.begin(), sub_batch.kvs.end(), std::back_inserter(batch.kvs));
+    }
 
-        METRIC_VAR_INCREMENT_BY(read_expired_values, expire_count);
-        METRIC_VAR_INCREMENT_BY(read_filtered_values, filter_count);
-
+    if (batch.error != rocksdb::Status::kOk) {
+        batch.kvs.clear();
     } else {
-        resp.error = rocksdb::Status::Code::kNotFound;
+        batch.complete = std::all_of(context.sub_scans.begin(),
+                                     context.sub_scans.end(),
+                                     [](const std::unique_ptr<pegasus_scan_context> &sub_scan) {
+                                         return sub_scan->finished;
+                                     });
     }
+}
 
-    _cu_calculator->add_scan_cu(req, resp.error, resp.kvs);
+std::vector<std::string> pegasus_server_impl::get_scan_split_keys(const rocksdb::Slice &start,
+                                                                  const rocksdb::Slice &stop,
+                                                                  int32_t count)
+{
+    std::vector<rocksdb::LiveFileMetaData> files;
+    _db->GetLiveFilesMetaData(&files);
+
+    // The smallest key of each SST file inside the range is a candidate split key, weighted by
+    // the size of the file. The files started before the range are all accounted to the first
+    // sub-range.
+    std::vector<std::pair<std::string, uint64_t>> candidates;
+    uint64_t total_size = 0;
+    uint64_t accumulated_size = 0;
+    for (auto &file : files) {
+        if (file.column_family_name != meta_store::DATA_COLUMN_FAMILY_NAME) {
+            continue;
+        }
+        const rocksdb::Slice smallest(file.smallestkey);
+        const rocksdb::Slice largest(file.largestkey);
+        if (largest.compare(start) < 0 || smallest.compare(stop) >= 0) {
+            continue;
+        }
+        total_size += file.size;
+        if (smallest.compare(start) <= 0) {
+            accumulated_size += file.size;
+            continue;
+        }
+        candidates.emplace_back(std::move(file.smallestkey), file.size);
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    // Pick the candidate once the size of the data before it reaches the next 1/count of the
+    // total size.
+    std::vector<std::string> split_keys;
+    for (const auto &candidate : candidates) {
+        if (split_keys.size() + 1 >= static_cast<size_t>(count)) {
+            break;
+        }
+        uint64_t target_size = total_size / count * (split_keys.size() + 1);
+        if (accumulated_size >= target_size &&
+            (split_keys.empty() || split_keys.back() != candidate.first)) {
+            split_keys.push_back(candidate.first);
+        }
+        accumulated_size += candidate.second;
+    }
+    return split_keys;
+}
+
+void pegasus_server_impl::start_scan_prefetch(std::shared_ptr<pegasus_scan_context> context)
+{
+    if (context->prefetch_credits <= 0) {
+        return;
+    }
+
+    // The task never owns the context, otherwise the RocksDB iterator of the context might be
+    // released with the task after the DB is released, even if the task has been cancelled.
+    std::weak_ptr<pegasus_scan_context> weak_context(context);
+    ::dsn::tasking::enqueue(
+        LPC_PEGASUS_SCAN_PREFETCH, &_tracker, [this, weak_context = std::move(weak_context)]() {
+            auto context = weak_context.lock();
+            if (context == nullptr || !_is_open) {
+                return;
+            }
+
+            // The batches are produced until the credits granted by the client are used up,
+            // thus a slow client won't make the server buffer too many data in memory.
+            while (true) {
+                ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr> il(context->iterate_lock);
+                {
+                    ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr> l(context->lock);
+                    // Once only this task holds the context, it has been cleared or expired.
+                    if (context.use_count() == 1 || context->finished ||
+                        context->prefetched_batches.size() >=
+                            static_cast<size_t>(context->prefetch_credits)) {
+                        break;
+                    }
+                }
+
+                // Iterate into a separate batch without 'context->lock', and append it once done.
+                pegasus_scan_batch batch;
+                scan_next_batch(*context, batch);
+                {
+                    ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr> l(context->lock);
+                    context->prefetched_batches.emplace_back(std::move(batch));
+                }
+                METRIC_VAR_INCREMENT(scan_prefetched_batches);
+            }
+        });
+}
+
+void pegasus_server_impl::on_clear_scanner(const int64_t &args)
+{
+    _context_cache.fetch(args);
+    METRIC_VAR_SET(scan_contexts, _context_cache.size());
 }
 
-void pegasus_server_impl::on_clear_scanner(const int64_t &args) { _context_cache.fetch(args); }
+int64_t pegasus_server_impl::put_scan_context(std::shared_ptr<pegasus_scan_context> context)
+{
+    int64_t handle = _context_cache.put(std::move(context), dsn_now_ms());
+
+    // Each context pins a RocksDB iterator, limit the count of them to avoid holding too many
+    // obsolete memtables and SST files.
+    auto evicted_count = _context_cache.evict_overflow(FLAGS_scan_context_max_count);
+    if (evicted_count > 0) {
+        METRIC_VAR_INCREMENT_BY(scan_context_evicted, evicted_count);
+        LOG_WARNING_PREFIX("{} scan contexts are evicted since the count exceeds the limit {}",
+                           evicted_count,
+                           FLAGS_scan_context_max_count);
+    }
+
+    METRIC_VAR_SET(scan_contexts, _context_cache.size());
+    return handle;
+}
+
+void pegasus_server_impl::evict_idle_scan_contexts()
+{
+    auto evicted_count = _context_cache.evict_idle(
+        dsn_now_ms(), static_cast<uint64_t>(FLAGS_scan_context_idle_ttl_seconds) * 1000);
+    if (evicted_count > 0) {
+        METRIC_VAR_INCREMENT_BY(scan_context_evicted, evicted_count);
+        LOG_INFO_PREFIX("{} idle scan contexts are evicted", evicted_count);
+    }
+
+    METRIC_VAR_SET(scan_contexts, _context_cache.size());
+}
 
 dsn::error_code pegasus_server_impl::start(int argc, char **argv)
 {
@@ -1733,6 +2138,7 @@ dsn::error_code pegasus_server_impl::start(int argc, char **argv)
     CHECK_EQ_PREFIX(handles_opened[1]->GetName(), meta_store::META_COLUMN_FAMILY_NAME);
     _data_cf = handles_opened[0];
     _meta_cf = handles_opened[1];
+    _db_owner = std::make_shared<db_holder>(_db, _data_cf, _meta_cf);
 
     // Create _meta_store which provide Pegasus meta data read and write.
     _meta_store = std::make_unique<meta_store>(replica_name(), _db, _meta_cf);
@@ -1771,6 +2177,7 @@ dsn::error_code pegasus_server_impl::start(int argc, char **argv)
 
     // only enable filter after correct pegasus_data_version set
     _key_ttl_compaction_filter_factory->SetPegasusDataVersion(_pegasus_data_version);
+    _incr_merge_operator->SetPegasusDataVersion(_pegasus_data_version);
     _key_ttl_compaction_filter_factory->SetPartitionIndex(_gpid.get_partition_index());
     _key_ttl_compaction_filter_factory->SetPartitionVersion(_gpid.get_partition_index() - 1);
     _key_ttl_compaction_filter_factory->EnableFilter();
@@ -1829,6 +2236,12 @@ dsn::error_code pegasus_server_impl::start(int argc, char **argv)
     _cu_calculator = std::make_unique<capacity_unit_calculator>(
         this, _read_hotkey_collector, _write_hotkey_collector, _read_size_throttling_controller);
     _server_write = std::make_unique<pegasus_server_write>(this);
+    _server_write->set_incr_by_merge(_incr_by_merge);
+
+    dsn::tasking::enqueue_timer(LPC_PEGASUS_SERVER_DELAY,
+                                &_tracker,
+                                [this]() { evict_idle_scan_contexts(); },
+                                std::chrono::seconds(FLAGS_scan_context_evict_interval_seconds));
 
     dsn::tasking::enqueue_timer(LPC_ANALYZE_HOTKEY,
                                 &_tracker,
@@ -1877,6 +2290,7 @@ void pegasus_server_impl::cancel_background_work(bool wait)
     _tracker.cancel_outstanding_tasks();
 
     _context_cache.clear();
+    METRIC_VAR_SET(scan_contexts, 0);
 
     _is_open = false;
     release_db();
@@ -1909,6 +2323,8 @@ void pegasus_server_impl::cancel_background_work(bool wait)
         METRIC_VAR_SET(rdb_memtable_mem_usage_bytes, 0);
         METRIC_VAR_SET(rdb_block_cache_hit_count, 0);
         METRIC_VAR_SET(rdb_block_cache_total_count, 0);
+        METRIC_VAR_SET(rdb_row_cache_hit_count, 0);
+        METRIC_VAR_SET(rdb_row_cache_total_count, 0);
     }
 
     LOG_INFO_PREFIX("close app succeed, clear_state = {}", clear_state ? "true" : "false");
@@ -2359,7 +2775,8 @@ range_iteration_state pegasus_server_impl::validate_key_value_for_scan(
     ::dsn::apps::filter_type::type sort_key_filter_type,
     const ::dsn::blob &sort_key_filter_pattern,
     uint32_t epoch_now,
-    bool request_validate_hash)
+    bool request_validate_hash,
+    const read_pushdown_filter *pushdown)
 {
     if (check_if_record_expired(epoch_now, value)) {
         if (FLAGS_rocksdb_verbose_log) {
@@ -2380,8 +2797,9 @@ range_iteration_state pegasus_server_impl::validate_key_value_for_scan(
 
     // extract raw key
     ::dsn::blob raw_key(key.data(), 0, key.size());
+    bool has_predicates = pushdown != nullptr && pushdown->has_predicates();
     if (hash_key_filter_type != ::dsn::apps::filter_type::FT_NO_FILTER ||
-        sort_key_filter_type != ::dsn::apps::filter_type::FT_NO_FILTER) {
+        sort_key_filter_type != ::dsn::apps::filter_type::FT_NO_FILTER || has_predicates) {
         ::dsn::blob hash_key, sort_key;
         pegasus_restore_key(raw_key, hash_key, sort_key);
         if (hash_key_filter_type != ::dsn::apps::filter_type::FT_NO_FILTER &&
@@ -2398,16 +2816,78 @@ range_iteration_state pegasus_server_impl::validate_key_value_for_scan(
             }
             return range_iteration_state::kFiltered;
         }
+        if (has_predicates && !match_read_pushdown(*pushdown, sort_key, value, epoch_now)) {
+            if (FLAGS_rocksdb_verbose_log) {
+                LOG_ERROR_PREFIX("record filtered by pushdown predicates for scan");
+            }
+            return range_iteration_state::kFiltered;
+        }
     }
 
     return range_iteration_state::kNormal;
 }
 
+bool pegasus_server_impl::match_read_pushdown(const read_pushdown_filter &pushdown,
+                                              const ::dsn::blob &sort_key,
+                                              const rocksdb::Slice &value,
+                                              uint32_t epoch_now)
+{
+    return visit_value_view(
+        _pegasus_data_version, utils::to_string_view(value), [&](auto view) {
+            return pushdown.match(
+                sort_key.to_string_view(), view.user_data(), view.expire_ts(), epoch_now);
+        });
+}
+
+void pegasus_server_impl::extract_user_data(const rocksdb::Slice &raw_value,
+                                            const std::shared_ptr<void> &holder,
+                                            const read_pushdown_filter *pushdown,
+                                            ::dsn::blob &user_data)
+{
+    auto view = pegasus_extract_user_data_view(_pegasus_data_version,
+                                               utils::to_string_view(raw_value));
+    if (pushdown != nullptr && pushdown->has_projection()) {
+        view = pushdown->project(view);
+    }
+
+    if (!FLAGS_rocksdb_pin_read_values || holder == nullptr) {
+        // Only the user data is copied, into the same allocation as the control block unless
+        // it's too long for the small string optimization.
+        auto s = std::make_shared<std::string>(view.data(), view.size());
+        std::shared_ptr<char> buf(s, const_cast<char *>(s->data()));
+        user_data.assign(std::move(buf), 0, static_cast<unsigned int>(s->size()));
+    } else {
+        // The blob shares the ownership of 'holder', which keeps 'raw_value' pinned.
+        std::shared_ptr<char> buf(holder, const_cast<char *>(view.data()));
+        user_data.assign(std::move(buf), 0, static_cast<unsigned int>(view.length()));
+    }
+
+    // The buffer is only referred to by the response, so it's attached to the response message
+    // rather than copied into it.
+    user_data.enable_zero_copy_write();
+}
+
+bool pegasus_server_impl::parse_read_pushdown(const ::dsn::apps::read_pushdown &pushdown,
+                                              const char *op,
+                                              const dsn::rpc_address &remote_address,
+                                              std::shared_ptr<read_pushdown_filter> &filter)
+{
+    auto f = std::make_shared<read_pushdown_filter>();
+    std::string err_msg;
+    if (!f->init(pushdown, err_msg)) {
+        LOG_ERROR_PREFIX("invalid argument for {} from {}: {}", op, remote_address, err_msg);
+        return false;
+    }
+    filter = std::move(f);
+    return true;
+}
+
 void pegasus_server_impl::append_key_value(std::vector<::dsn::apps::key_value> &kvs,
                                            const rocksdb::Slice &key,
                                            const rocksdb::Slice &value,
                                            bool no_value,
-                                           bool request_expire_ts)
+                                           bool request_expire_ts,
+                                           const read_pushdown_filter *pushdown)
 {
     ::dsn::apps::key_value kv;
     ::dsn::blob raw_key(key.data(), 0, key.size());
@@ -2424,8 +2904,7 @@ void pegasus_server_impl::append_key_value(std::vector<::dsn::apps::key_value> &
 
     // extract value
     if (!no_value) {
-        std::string value_buf(value.data(), value.size());
-        pegasus_extract_user_data(_pegasus_data_version, std::move(value_buf), kv.value);
+        extract_user_data(value, nullptr, pushdown, kv.value);
     }
 
     kvs.emplace_back(std::move(kv));
@@ -2438,7 +2917,9 @@ range_iteration_state pegasus_server_impl::append_key_value_for_multi_get(
     ::dsn::apps::filter_type::type sort_key_filter_type,
     const ::dsn::blob &sort_key_filter_pattern,
     uint32_t epoch_now,
-    bool no_value)
+    bool no_value,
+    const read_pushdown_filter *pushdown,
+    const std::shared_ptr<void> &value_holder)
 {
     if (check_if_record_expired(epoch_now, value)) {
         if (FLAGS_rocksdb_verbose_log) {
@@ -2461,14 +2942,20 @@ range_iteration_state pegasus_server_impl::append_key_value_for_multi_get(
         }
         return range_iteration_state::kFiltered;
     }
+    if (pushdown != nullptr && pushdown->has_predicates() &&
+        !match_read_pushdown(*pushdown, sort_key, value, epoch_now)) {
+        if (FLAGS_rocksdb_verbose_log) {
+            LOG_ERROR_PREFIX("record filtered by pushdown predicates for multi get");
+        }
+        return range_iteration_state::kFiltered;
+    }
     std::shared_ptr<char> sort_key_buf(::dsn::utils::make_shared_array<char>(sort_key.length()));
     ::memcpy(sort_key_buf.get(), sort_key.data(), sort_key.length());
     kv.key.assign(std::move(sort_key_buf), 0, sort_key.length());
 
     // extract value
     if (!no_value) {
-        std::string value_buf(value.data(), value.size());
-        pegasus_extract_user_data(_pegasus_data_version, std::move(value_buf), kv.value);
+        extract_user_data(value, value_holder, pushdown, kv.value);
     }
 
     kvs.emplace_back(std::move(kv));
@@ -2495,10 +2982,19 @@ void pegasus_server_impl::update_replica_rocksdb_statistics()
     }
     METRIC_VAR_SET(rdb_total_sst_files, val);
 
+    uint64_t total_sst_size = 0;
     if (_db->GetProperty(_data_cf, rocksdb::DB::Properties::kTotalSstFilesSize, &str_val) &&
-        dsn::buf2uint64(str_val, val)) {
+        dsn::buf2uint64(str_val, total_sst_size)) {
         static uint64_t bytes_per_mb = 1U << 20U;
-        METRIC_VAR_SET(rdb_total_sst_size_mb, val / bytes_per_mb);
+        METRIC_VAR_SET(rdb_total_sst_size_mb, total_sst_size / bytes_per_mb);
+
+        // The SST files which are not in the current version but still referenced by iterators
+        // (mostly pinned by the scan contexts) or snapshots.
+        if (_db->GetProperty(_data_cf, rocksdb::DB::Properties::kLiveSstFilesSize, &str_val) &&
+            dsn::buf2uint64(str_val, val)) {
+            METRIC_VAR_SET(rdb_obsolete_sst_pinned_bytes,
+                           total_sst_size > val ? total_sst_size - val : 0);
+        }
     }
 
     std::map<std::string, std::string> props;
@@ -2563,6 +3059,13 @@ void pegasus_server_impl::update_replica_rocksdb_statistics()
     auto block_cache_total = block_cache_hit + block_cache_miss;
     METRIC_VAR_SET(rdb_block_cache_total_count, block_cache_total);
 
+    auto row_cache_hit = _statistics->getTickerCount(rocksdb::ROW_CACHE_HIT);
+    METRIC_VAR_SET(rdb_row_cache_hit_count, row_cache_hit);
+
+    auto row_cache_miss = _statistics->getTickerCount(rocksdb::ROW_CACHE_MISS);
+    auto row_cache_total = row_cache_hit + row_cache_miss;
+    METRIC_VAR_SET(rdb_row_cache_total_count, row_cache_total);
+
     auto memtable_hit_count = _statistics->getTickerCount(rocksdb::MEMTABLE_HIT);
     METRIC_VAR_SET(rdb_memtable_hit_count, memtable_hit_count);
 
@@ -2584,6 +3087,11 @@ void pegasus_server_impl::update_server_rocksdb_statistics()
         METRIC_VAR_SET(rdb_block_cache_mem_usage_bytes, val);
     }
 
+    if (_s_row_cache) {
+        uint64_t val = _s_row_cache->GetUsage();
+        METRIC_VAR_SET(rdb_row_cache_mem_usage_bytes, val);
+    }
+
     if (_s_rate_limiter) {
         uint64_t current_total_through = _s_rate_limiter->GetTotalBytesThrough();
         uint64_t through_bytes_per_sec =
@@ -2697,6 +3205,7 @@ void pegasus_server_impl::update_app_envs(const std::map<std::string, std::strin
     update_slow_query_threshold(envs);
     update_rocksdb_iteration_threshold(envs);
     update_validate_partition_hash(envs);
+    update_incr_by_merge(envs);
     update_user_specified_compaction(envs);
     _manual_compact_svc.start_manual_compact_if_needed(envs);
 
@@ -2713,6 +3222,7 @@ void pegasus_server_impl::update_app_envs_before_open_db(
     update_slow_query_threshold(envs);
     update_rocksdb_iteration_threshold(envs);
     update_validate_partition_hash(envs);
+    update_incr_by_merge(envs);
     update_user_specified_compaction(envs);
     _manual_compact_svc.start_manual_compact_if_needed(envs);
     set_rocksdb_options_before_creating(envs);
@@ -2946,6 +3456,26 @@ void pegasus_server_impl::update_validate_partition_hash(
     }
 }
 
+void pegasus_server_impl::update_incr_by_merge(const std::map<std::string, std::string> &envs)
+{
+    bool new_value = false;
+    auto iter = envs.find(dsn::replica_envs::INCR_BY_MERGE);
+    if (iter != envs.end()) {
+        if (!dsn::buf2bool(iter->second, new_value)) {
+            LOG_ERROR_PREFIX("{}={} is invalid.", iter->first, iter->second);
+            return;
+        }
+    }
+    if (new_value != _incr_by_merge) {
+        LOG_INFO_PREFIX("update '_incr_by_merge' from {} to {}", _incr_by_merge, new_value);
+        _incr_by_merge = new_value;
+        // It's set once the write service is created if the db is not opened yet.
+        if (_server_write) {
+            _server_write->set_incr_by_merge(_incr_by_merge);
+        }
+    }
+}
+
 void pegasus_server_impl::update_user_specified_compaction(
     const std::map<std::string, std::string> &envs)
 {
@@ -3447,15 +3977,30 @@ void pegasus_server_impl::release_db()
     if (_db) {
         CHECK_NOTNULL_PREFIX(_data_cf);
         CHECK_NOTNULL_PREFIX(_meta_cf);
-        _db->DestroyColumnFamilyHandle(_data_cf);
+        CHECK_NOTNULL_PREFIX(_db_owner);
+
+        // The values pinned by the responses in flight share the ownership of the DB and its
+        // column family handles, which are destroyed once the last of them is sent.
+        const auto use_count = _db_owner.use_count();
+        if (use_count > 1) {
+            LOG_INFO_PREFIX("rocksdb is still shared by {} pinned values, it will be closed once "
+                            "they are released",
+                            use_count - 1);
+        }
         _data_cf = nullptr;
-        _db->DestroyColumnFamilyHandle(_meta_cf);
         _meta_cf = nullptr;
-        delete _db;
         _db = nullptr;
+        _db_owner.reset();
     }
 }
 
+pegasus_server_impl::db_holder::~db_holder()
+{
+    db->DestroyColumnFamilyHandle(data_cf);
+    db->DestroyColumnFamilyHandle(meta_cf);
+    delete db;
+}
+
 std::string pegasus_server_impl::dump_write_request(dsn::message_ex *request)
 {
     dsn::task_code rpc_code(request->rpc_code());
@@ -3527,6 +4072,22 @@ void pegasus_server_impl::on_detect_hotkey(const dsn::replication::detect_hotkey
     collector->handle_rpc(req, resp);
 }
 
+void pegasus_server_impl::query_hotkeys(dsn::replication::hotkey_type::type type,
+                                        std::vector<dsn::replication::hotkey_info> &hotkeys) const
+{
+    const auto &collector = type == dsn::replication::hotkey_type::READ ? _read_hotkey_collector
+                                                                        : _write_hotkey_collector;
+    if (!collector) {
+        return;
+    }
+
+    hotkeys = collector->hotkeys();
+    // Hot keys should not be encrypted, the same as query_result() in hotkey_collector.
+    for (auto &hotkey : hotkeys) {
+        hotkey.hash_key = pegasus::utils::c_escape_string(hotkey.hash_key);
+    }
+}
+
 uint32_t pegasus_server_impl::query_data_version() const { return _pegasus_data_version; }
 
 dsn::replication::manual_compaction_status::type pegasus_server_impl::query_compact_status() const
@@ -3534,5 +4095,10 @@ dsn::replication::manual_compaction_status::type pegasus_server_impl::query_comp
     return _manual_compact_svc.query_compact_status();
 }
 
+int64_t pegasus_server_impl::query_storage_size_mb() const
+{
+    return METRIC_VAR_VALUE(rdb_total_sst_size_mb);
+}
+
 } // namespace server
 } // namespace pegasus
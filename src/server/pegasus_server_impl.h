@@ -45,6 +45,7 @@
 #include "pegasus_utils.h"
 #include "pegasus_value_schema.h"
 #include "range_read_limiter.h"
+#include "read_pushdown_filter.h"
 #include "replica/replication_app_base.h"
 #include "runtime/task/task.h"
 #include "runtime/task/task_tracker.h"
@@ -62,6 +63,7 @@ DSN_DECLARE_uint64(rocksdb_abnormal_multi_get_size_threshold);
 
 namespace pegasus {
 namespace server {
+class IncrMergeOperator;
 class KeyWithTTLCompactionFilterFactory;
 } // namespace server
 } // namespace pegasus
@@ -251,6 +253,11 @@ private:
     FRIEND_TEST(pegasus_server_impl_test, test_open_db_with_app_envs);
     FRIEND_TEST(pegasus_server_impl_test, test_stop_db_twice);
     FRIEND_TEST(pegasus_server_impl_test, test_update_user_specified_compaction);
+    FRIEND_TEST(pegasus_server_impl_test, test_streaming_scan);
+    FRIEND_TEST(pegasus_server_impl_test, test_scan_prefetch_after_stop);
+    FRIEND_TEST(pegasus_server_impl_test, test_pinned_values_outlive_db);
+    FRIEND_TEST(pegasus_server_impl_test, test_parallel_sub_range_scan);
+    FRIEND_TEST(pegasus_server_impl_test, test_row_cache);
 
     friend class pegasus_manual_compact_service;
     friend class pegasus_write_service;
@@ -270,7 +277,39 @@ private:
                           const rocksdb::Slice &key,
                           const rocksdb::Slice &value,
                           bool no_value,
-                          bool request_expire_ts);
+                          bool request_expire_ts,
+                          const read_pushdown_filter *pushdown = nullptr);
+
+    // Put the scan context into the cache and return its handle, the least recently accessed
+    // contexts will be evicted if the count exceeds the limit.
+    int64_t put_scan_context(std::shared_ptr<pegasus_scan_context> context);
+
+    // Evict the scan contexts abandoned by the clients.
+    void evict_idle_scan_contexts();
+
+    // Iterate the next batch of 'context' into 'batch', the caller should hold 'context.lock'.
+    void scan_next_batch(pegasus_scan_context &context, pegasus_scan_batch &batch);
+
+    // Iterate the sub-ranges of 'context' in parallel on the read thread pool, and merge their
+    // results into 'batch' in the order of the sub-ranges.
+    void scan_sub_ranges(pegasus_scan_context &context, pegasus_scan_batch &batch);
+
+    // Return at most 'count - 1' keys in (start, stop) which split the range into sub-ranges of
+    // roughly equal data size, estimated by the boundaries and sizes of the live SST files.
+    std::vector<std::string>
+    get_scan_split_keys(const rocksdb::Slice &start, const rocksdb::Slice &stop, int32_t count);
+
+    // Fill 'resp' by 'batch' iterated from 'context', and put 'context' back into the cache if
+    // the scan is not completed.
+    void fill_scan_response(const char *op,
+                            const dsn::rpc_address &remote_address,
+                            std::shared_ptr<pegasus_scan_context> context,
+                            pegasus_scan_batch &batch,
+                            ::dsn::apps::scan_response &resp);
+
+    // Prefetch the following batches of 'context' asynchronously in streaming scan mode, until
+    // the credits granted by the client are used up.
+    void start_scan_prefetch(std::shared_ptr<pegasus_scan_context> context);
 
     range_iteration_state
     validate_key_value_for_scan(const rocksdb::Slice &key,
@@ -280,7 +319,8 @@ private:
                                 ::dsn::apps::filter_type::type sort_key_filter_type,
                                 const ::dsn::blob &sort_key_filter_pattern,
                                 uint32_t epoch_now,
-                                bool request_validate_hash);
+                                bool request_validate_hash,
+                                const read_pushdown_filter *pushdown = nullptr);
 
     range_iteration_state
     append_key_value_for_multi_get(std::vector<::dsn::apps::key_value> &kvs,
@@ -289,7 +329,32 @@ private:
                                    ::dsn::apps::filter_type::type sort_key_filter_type,
                                    const ::dsn::blob &sort_key_filter_pattern,
                                    uint32_t epoch_now,
-                                   bool no_value);
+                                   bool no_value,
+                                   const read_pushdown_filter *pushdown = nullptr,
+                                   const std::shared_ptr<void> &value_holder = nullptr);
+
+    // Return true if the record matches all of the pushdown predicates.
+    bool match_read_pushdown(const read_pushdown_filter &pushdown,
+                             const ::dsn::blob &sort_key,
+                             const rocksdb::Slice &value,
+                             uint32_t epoch_now);
+
+    // Extract the user data from 'raw_value', only the projected slice is extracted if
+    // 'pushdown' has projection. The result refers to the memory of 'raw_value' rather than
+    // copying it, and shares the ownership of 'holder' which keeps 'raw_value' pinned. Only the
+    // user data is copied if [pegasus.server]rocksdb_pin_read_values is disabled or 'holder' is
+    // null. Either way, the result is not copied again while the response is serialized.
+    void extract_user_data(const rocksdb::Slice &raw_value,
+                           const std::shared_ptr<void> &holder,
+                           const read_pushdown_filter *pushdown,
+                           ::dsn::blob &user_data);
+
+    // Compile the pushdown predicates and projection of a read request into 'filter'.
+    // Return false if the pushdown is invalid.
+    bool parse_read_pushdown(const ::dsn::apps::read_pushdown &pushdown,
+                             const char *op,
+                             const dsn::rpc_address &remote_address,
+                             std::shared_ptr<read_pushdown_filter> &filter);
 
     // return true if the filter type is supported
     bool is_filter_type_supported(::dsn::apps::filter_type::type filter_type)
@@ -330,6 +395,8 @@ private:
 
     void update_validate_partition_hash(const std::map<std::string, std::string> &envs);
 
+    void update_incr_by_merge(const std::map<std::string, std::string> &envs);
+
     void update_user_specified_compaction(const std::map<std::string, std::string> &envs);
 
     void update_rocksdb_dynamic_options(const std::map<std::string, std::string> &envs);
@@ -455,15 +522,46 @@ private:
 
     void release_db();
 
+    // Owns the DB and its column family handles, which are destroyed together once the last
+    // owner is released.
+    struct db_holder
+    {
+        db_holder(rocksdb::DB *db,
+                  rocksdb::ColumnFamilyHandle *data_cf,
+                  rocksdb::ColumnFamilyHandle *meta_cf)
+            : db(db), data_cf(data_cf), meta_cf(meta_cf)
+        {
+        }
+        ~db_holder();
+
+        rocksdb::DB *const db;
+        rocksdb::ColumnFamilyHandle *const data_cf;
+        rocksdb::ColumnFamilyHandle *const meta_cf;
+    };
+
+    // Share the ownership of the DB and its column family handles with `obj`, which pins the
+    // values read from the DB and may be released after release_db() by the responses sharing
+    // it, see extract_user_data().
+    template <typename T>
+    std::shared_ptr<T> make_db_pinned(T *obj)
+    {
+        return std::shared_ptr<T>(obj, [db = _db_owner](T *p) { delete p; });
+    }
+
     ::dsn::error_code flush_all_family_columns(bool wait);
 
     void on_detect_hotkey(const dsn::replication::detect_hotkey_request &req,
                           dsn::replication::detect_hotkey_response &resp) override;
 
+    void query_hotkeys(dsn::replication::hotkey_type::type type,
+                       /*out*/ std::vector<dsn::replication::hotkey_info> &hotkeys) const override;
+
     uint32_t query_data_version() const override;
 
     dsn::replication::manual_compaction_status::type query_compact_status() const override;
 
+    int64_t query_storage_size_mb() const override;
+
     // Log expired keys for verbose mode.
     void log_expired_data(const char *op,
                           const dsn::rpc_address &addr,
@@ -485,6 +583,9 @@ private:
     range_read_limiter_options _rng_rd_opts;
 
     std::shared_ptr<KeyWithTTLCompactionFilterFactory> _key_ttl_compaction_filter_factory;
+    // Always set even if incr by merge is disabled, since the merge operands written before must
+    // still be resolved.
+    std::shared_ptr<IncrMergeOperator> _incr_merge_operator;
     std::shared_ptr<rocksdb::Statistics> _statistics;
     rocksdb::DBOptions _db_opts;
     // The value of option in data_cf according to conf template file config.ini
@@ -502,9 +603,13 @@ private:
     bool _table_data_cf_opts_recalculated;
 
     rocksdb::DB *_db;
+    // Owns `_db`, `_data_cf` and `_meta_cf`, and is shared by the values pinned by the responses
+    // in flight.
+    std::shared_ptr<db_holder> _db_owner;
     rocksdb::ColumnFamilyHandle *_data_cf;
     rocksdb::ColumnFamilyHandle *_meta_cf;
     static std::shared_ptr<rocksdb::Cache> _s_block_cache;
+    static std::shared_ptr<rocksdb::Cache> _s_row_cache;
     static std::shared_ptr<rocksdb::WriteBufferManager> _s_write_buffer_manager;
     static std::shared_ptr<rocksdb::RateLimiter> _s_rate_limiter;
     static int64_t _rocksdb_limiter_last_total_through;
@@ -531,6 +636,7 @@ private:
 
     std::atomic<int32_t> _partition_version;
     bool _validate_partition_hash{false};
+    bool _incr_by_merge{false};
 
     dsn::replication::ingestion_status::type _ingestion_status{
         dsn::replication::ingestion_status::IS_INVALID};
@@ -547,10 +653,15 @@ private:
     METRIC_VAR_DECLARE_counter(batch_get_requests);
     METRIC_VAR_DECLARE_counter(scan_requests);
 
-    METRIC_VAR_DECLARE_percentile_int64(get_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(multi_get_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(batch_get_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(scan_latency_ns);
+    METRIC_VAR_DECLARE_histogram(get_latency_ns);
+    METRIC_VAR_DECLARE_histogram(multi_get_latency_ns);
+    METRIC_VAR_DECLARE_histogram(batch_get_latency_ns);
+    METRIC_VAR_DECLARE_histogram(scan_latency_ns);
+
+    METRIC_VAR_DECLARE_gauge_int64(scan_contexts);
+    METRIC_VAR_DECLARE_counter(scan_context_evicted);
+    METRIC_VAR_DECLARE_counter(scan_prefetched_batches);
+    METRIC_VAR_DECLARE_counter(scan_prefetch_hit_batches);
 
     METRIC_VAR_DECLARE_counter(read_expired_values);
     METRIC_VAR_DECLARE_counter(read_filtered_values);
@@ -559,17 +670,21 @@ private:
 
     // Server-level metrics for rocksdb.
     METRIC_VAR_DECLARE_gauge_int64(rdb_block_cache_mem_usage_bytes, static);
+    METRIC_VAR_DECLARE_gauge_int64(rdb_row_cache_mem_usage_bytes, static);
     METRIC_VAR_DECLARE_gauge_int64(rdb_write_rate_limiter_through_bytes_per_sec, static);
 
     // Replica-level metrics for rocksdb.
     METRIC_VAR_DECLARE_gauge_int64(rdb_total_sst_files);
     METRIC_VAR_DECLARE_gauge_int64(rdb_total_sst_size_mb);
+    METRIC_VAR_DECLARE_gauge_int64(rdb_obsolete_sst_pinned_bytes);
     METRIC_VAR_DECLARE_gauge_int64(rdb_estimated_keys);
 
     METRIC_VAR_DECLARE_gauge_int64(rdb_index_and_filter_blocks_mem_usage_bytes);
     METRIC_VAR_DECLARE_gauge_int64(rdb_memtable_mem_usage_bytes);
     METRIC_VAR_DECLARE_gauge_int64(rdb_block_cache_hit_count);
     METRIC_VAR_DECLARE_gauge_int64(rdb_block_cache_total_count);
+    METRIC_VAR_DECLARE_gauge_int64(rdb_row_cache_hit_count);
+    METRIC_VAR_DECLARE_gauge_int64(rdb_row_cache_total_count);
     METRIC_VAR_DECLARE_gauge_int64(rdb_memtable_hit_count);
     METRIC_VAR_DECLARE_gauge_int64(rdb_memtable_total_count);
     METRIC_VAR_DECLARE_gauge_int64(rdb_l0_hit_count);
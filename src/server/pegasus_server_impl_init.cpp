@@ -48,6 +48,7 @@
 #include "runtime/api_layer1.h"
 #include "runtime/rpc/rpc_host_port.h"
 #include "server/capacity_unit_calculator.h" // IWYU pragma: keep
+#include "server/incr_merge_operator.h"
 #include "server/key_ttl_compaction_filter.h"
 #include "server/pegasus_read_service.h"
 #include "server/pegasus_server_write.h" // IWYU pragma: keep
@@ -79,25 +80,48 @@ METRIC_DEFINE_counter(replica,
                       dsn::metric_unit::kRequests,
                       "The number of SCAN requests");
 
-METRIC_DEFINE_percentile_int64(replica,
-                               get_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of GET requests");
+METRIC_DEFINE_histogram(replica,
+                        get_latency_ns,
+                        dsn::metric_unit::kNanoSeconds,
+                        "The latency of GET requests");
 
-METRIC_DEFINE_percentile_int64(replica,
-                               multi_get_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of MULTI_GET requests");
+METRIC_DEFINE_histogram(replica,
+                        multi_get_latency_ns,
+                        dsn::metric_unit::kNanoSeconds,
+                        "The latency of MULTI_GET requests");
 
-METRIC_DEFINE_percentile_int64(replica,
-                               batch_get_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of BATCH_GET requests");
+METRIC_DEFINE_histogram(replica,
+                        batch_get_latency_ns,
+                        dsn::metric_unit::kNanoSeconds,
+                        "The latency of BATCH_GET requests");
 
-METRIC_DEFINE_percentile_int64(replica,
-                               scan_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of SCAN requests");
+METRIC_DEFINE_histogram(replica,
+                        scan_latency_ns,
+                        dsn::metric_unit::kNanoSeconds,
+                        "The latency of SCAN requests");
+
+METRIC_DEFINE_gauge_int64(replica,
+                          scan_contexts,
+                          dsn::metric_unit::kContexts,
+                          "The number of live scan contexts, each of which pins a RocksDB "
+                          "iterator");
+
+METRIC_DEFINE_counter(replica,
+                      scan_context_evicted,
+                      dsn::metric_unit::kContexts,
+                      "The number of scan contexts evicted since idle for too long or exceeding "
+                      "the count limit");
+
+METRIC_DEFINE_counter(replica,
+                      scan_prefetched_batches,
+                      dsn::metric_unit::kBatches,
+                      "The number of batches prefetched for streaming SCAN requests");
+
+METRIC_DEFINE_counter(replica,
+                      scan_prefetch_hit_batches,
+                      dsn::metric_unit::kBatches,
+                      "The number of batches served from the prefetched ones for streaming SCAN "
+                      "requests");
 
 METRIC_DEFINE_counter(replica,
                       read_expired_values,
@@ -126,6 +150,12 @@ METRIC_DEFINE_gauge_int64(replica,
                           dsn::metric_unit::kMegaBytes,
                           "The total size of rocksdb sst files");
 
+METRIC_DEFINE_gauge_int64(replica,
+                          rdb_obsolete_sst_pinned_bytes,
+                          dsn::metric_unit::kBytes,
+                          "The size of obsolete rocksdb sst files which are still pinned by "
+                          "iterators or snapshots");
+
 METRIC_DEFINE_gauge_int64(replica,
                           rdb_estimated_keys,
                           dsn::metric_unit::kKeys,
@@ -151,6 +181,16 @@ METRIC_DEFINE_gauge_int64(replica,
                           dsn::metric_unit::kPointLookups,
                           "The total number of lookups on rocksdb block cache");
 
+METRIC_DEFINE_gauge_int64(replica,
+                          rdb_row_cache_hit_count,
+                          dsn::metric_unit::kPointLookups,
+                          "The hit number of point lookups on rocksdb row cache");
+
+METRIC_DEFINE_gauge_int64(replica,
+                          rdb_row_cache_total_count,
+                          dsn::metric_unit::kPointLookups,
+                          "The total number of point lookups on rocksdb row cache");
+
 METRIC_DEFINE_gauge_int64(replica,
                           rdb_memtable_hit_count,
                           dsn::metric_unit::kPointLookups,
@@ -238,6 +278,11 @@ METRIC_DEFINE_gauge_int64(server,
                           dsn::metric_unit::kBytes,
                           "The memory usage of rocksdb block cache");
 
+METRIC_DEFINE_gauge_int64(server,
+                          rdb_row_cache_mem_usage_bytes,
+                          dsn::metric_unit::kBytes,
+                          "The memory usage of rocksdb row cache");
+
 METRIC_DEFINE_gauge_int64(server,
                           rdb_write_rate_limiter_through_bytes_per_sec,
                           dsn::metric_unit::kBytesPerSec,
@@ -288,6 +333,11 @@ DSN_DEFINE_int32(pegasus.server,
                  -1,
                  "The number of shard bits of the block cache, it means the block cache is sharded "
                  "into 2^n shards to reduce lock contention. -1 means automatically determined");
+DSN_DEFINE_int32(pegasus.server,
+                 rocksdb_row_cache_num_shard_bits,
+                 -1,
+                 "The number of shard bits of the row cache, it means the row cache is sharded "
+                 "into 2^n shards to reduce lock contention. -1 means automatically determined");
 
 // COMPATIBILITY ATTENTION:
 // Although old releases would see the new structure as corrupt filter data and read the
@@ -523,6 +573,12 @@ DSN_DEFINE_uint64(
     rocksdb_block_cache_capacity,
     10 * 1024 * 1024 * 1024ULL,
     "The Block Cache capacity shared by all RocksDB instances in the process, in bytes");
+DSN_DEFINE_uint64(pegasus.server,
+                  rocksdb_row_cache_capacity,
+                  0,
+                  "The Row Cache capacity shared by all RocksDB instances in the process, in "
+                  "bytes. The Row Cache keeps the recently read key-value pairs to serve the point "
+                  "lookups without touching the blocks. 0 means the Row Cache is disabled");
 DSN_DEFINE_uint64(pegasus.server,
                   rocksdb_total_size_across_write_buffer,
                   0,
@@ -604,17 +660,24 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
       METRIC_VAR_INIT_replica(multi_get_latency_ns),
       METRIC_VAR_INIT_replica(batch_get_latency_ns),
       METRIC_VAR_INIT_replica(scan_latency_ns),
+      METRIC_VAR_INIT_replica(scan_contexts),
+      METRIC_VAR_INIT_replica(scan_context_evicted),
+      METRIC_VAR_INIT_replica(scan_prefetched_batches),
+      METRIC_VAR_INIT_replica(scan_prefetch_hit_batches),
       METRIC_VAR_INIT_replica(read_expired_values),
       METRIC_VAR_INIT_replica(read_filtered_values),
       METRIC_VAR_INIT_replica(abnormal_read_requests),
       METRIC_VAR_INIT_replica(throttling_rejected_read_requests),
       METRIC_VAR_INIT_replica(rdb_total_sst_files),
       METRIC_VAR_INIT_replica(rdb_total_sst_size_mb),
+      METRIC_VAR_INIT_replica(rdb_obsolete_sst_pinned_bytes),
       METRIC_VAR_INIT_replica(rdb_estimated_keys),
       METRIC_VAR_INIT_replica(rdb_index_and_filter_blocks_mem_usage_bytes),
       METRIC_VAR_INIT_replica(rdb_memtable_mem_usage_bytes),
       METRIC_VAR_INIT_replica(rdb_block_cache_hit_count),
       METRIC_VAR_INIT_replica(rdb_block_cache_total_count),
+      METRIC_VAR_INIT_replica(rdb_row_cache_hit_count),
+      METRIC_VAR_INIT_replica(rdb_row_cache_total_count),
       METRIC_VAR_INIT_replica(rdb_memtable_hit_count),
       METRIC_VAR_INIT_replica(rdb_memtable_total_count),
       METRIC_VAR_INIT_replica(rdb_l0_hit_count),
@@ -710,6 +773,19 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
         _tbl_opts.block_cache = _s_block_cache;
     }
 
+    // The row cache is shared by all replicas on this server as the block cache. It's filled by
+    // the point lookups on the SST files and keyed by the file number and the internal key, thus
+    // the entries would never be stale: a newer write shadows them in the memtable, and the
+    // entries of the compacted files are never hit again and would be evicted by LRU.
+    if (FLAGS_rocksdb_row_cache_capacity > 0) {
+        static std::once_flag flag;
+        std::call_once(flag, [&]() {
+            _s_row_cache = rocksdb::NewLRUCache(FLAGS_rocksdb_row_cache_capacity,
+                                                FLAGS_rocksdb_row_cache_num_shard_bits);
+        });
+        _db_opts.row_cache = _s_row_cache;
+    }
+
     // FLAGS_rocksdb_limiter_max_write_megabytes_per_sec <= 0 means close the rate limit.
     // For more detail arguments see
     // https://github.com/facebook/rocksdb/blob/v6.6.4/include/rocksdb/rate_limiter.h#L111-L137
@@ -824,6 +900,8 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
 
     _key_ttl_compaction_filter_factory = std::make_shared<KeyWithTTLCompactionFilterFactory>();
     _data_cf_opts.compaction_filter_factory = _key_ttl_compaction_filter_factory;
+    _incr_merge_operator = std::make_shared<IncrMergeOperator>();
+    _data_cf_opts.merge_operator = _incr_merge_operator;
     _data_cf_opts.periodic_compaction_seconds = FLAGS_rocksdb_periodic_compaction_seconds;
     _checkpoint_reserve_min_count = FLAGS_checkpoint_reserve_min_count;
     _checkpoint_reserve_time_seconds = FLAGS_checkpoint_reserve_time_seconds;
@@ -837,6 +915,7 @@ pegasus_server_impl::pegasus_server_impl(dsn::replication::replica *r)
     static std::once_flag flag;
     std::call_once(flag, [&]() {
         METRIC_VAR_ASSIGN_server(rdb_block_cache_mem_usage_bytes);
+        METRIC_VAR_ASSIGN_server(rdb_row_cache_mem_usage_bytes);
         METRIC_VAR_ASSIGN_server(rdb_write_rate_limiter_through_bytes_per_sec);
     });
 }
@@ -94,6 +94,11 @@ int pegasus_server_write::on_batched_write_requests(dsn::message_ex **requests,
 
 void pegasus_server_write::set_default_ttl(uint32_t ttl) { _write_svc->set_default_ttl(ttl); }
 
+void pegasus_server_write::set_incr_by_merge(bool enabled)
+{
+    _write_svc->set_incr_by_merge(enabled);
+}
+
 int pegasus_server_write::on_batched_writes(dsn::message_ex **requests, int count)
 {
     int err = rocksdb::Status::kOk;
@@ -200,6 +205,11 @@ void pegasus_server_write::init_non_batch_write_handlers()
              auto rpc = duplicate_rpc::auto_reply(request);
              return _write_svc->duplicate(_decree, rpc.request(), rpc.response());
          }},
+        {dsn::apps::RPC_RRDB_RRDB_DUPLICATE_COMPRESSED,
+         [this](dsn::message_ex *request) -> int {
+             auto rpc = duplicate_rpc::auto_reply(request);
+             return _write_svc->duplicate(_decree, rpc.request(), rpc.response());
+         }},
         {dsn::apps::RPC_RRDB_RRDB_CHECK_AND_SET,
          [this](dsn::message_ex *request) -> int {
              auto rpc = check_and_set_rpc::auto_reply(request);
@@ -62,6 +62,8 @@ public:
 
     void set_default_ttl(uint32_t ttl);
 
+    void set_incr_by_merge(bool enabled);
+
 private:
     /// Delay replying for the batched requests until all of them complete.
     int on_batched_writes(dsn::message_ex **requests, int count);
@@ -40,6 +40,7 @@
 #include "runtime/message_utils.h"
 #include "runtime/task/async_calls.h"
 #include "runtime/task/task_code.h"
+#include "server/pegasus_mutation_duplicator.h"
 #include "server/pegasus_server_impl.h"
 #include "utils/autoref_ptr.h"
 #include "utils/error_code.h"
@@ -81,40 +82,40 @@ METRIC_DEFINE_counter(replica,
                       dsn::metric_unit::kRequests,
                       "The number of CHECK_AND_MUTATE requests");
 
-METRIC_DEFINE_percentile_int64(replica,
-                               put_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of PUT requests");
-
-METRIC_DEFINE_percentile_int64(replica,
-                               multi_put_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of MULTI_PUT requests");
-
-METRIC_DEFINE_percentile_int64(replica,
-                               remove_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of REMOVE requests");
-
-METRIC_DEFINE_percentile_int64(replica,
-                               multi_remove_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of MULTI_REMOVE requests");
-
-METRIC_DEFINE_percentile_int64(replica,
-                               incr_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of INCR requests");
-
-METRIC_DEFINE_percentile_int64(replica,
-                               check_and_set_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of CHECK_AND_SET requests");
-
-METRIC_DEFINE_percentile_int64(replica,
-                               check_and_mutate_latency_ns,
-                               dsn::metric_unit::kNanoSeconds,
-                               "The latency of CHECK_AND_MUTATE requests");
+METRIC_DEFINE_histogram(replica,
+                        put_latency_ns,
+                        dsn::metric_unit::kNanoSeconds,
+                        "The latency of PUT requests");
+
+METRIC_DEFINE_histogram(replica,
+                        multi_put_latency_ns,
+                        dsn::metric_unit::kNanoSeconds,
+                        "The latency of MULTI_PUT requests");
+
+METRIC_DEFINE_histogram(replica,
+                        remove_latency_ns,
+                        dsn::metric_unit::kNanoSeconds,
+                        "The latency of REMOVE requests");
+
+METRIC_DEFINE_histogram(replica,
+                        multi_remove_latency_ns,
+                        dsn::metric_unit::kNanoSeconds,
+                        "The latency of MULTI_REMOVE requests");
+
+METRIC_DEFINE_histogram(replica,
+                        incr_latency_ns,
+                        dsn::metric_unit::kNanoSeconds,
+                        "The latency of INCR requests");
+
+METRIC_DEFINE_histogram(replica,
+                        check_and_set_latency_ns,
+                        dsn::metric_unit::kNanoSeconds,
+                        "The latency of CHECK_AND_SET requests");
+
+METRIC_DEFINE_histogram(replica,
+                        check_and_mutate_latency_ns,
+                        dsn::metric_unit::kNanoSeconds,
+                        "The latency of CHECK_AND_MUTATE requests");
 
 METRIC_DEFINE_counter(replica,
                       dup_requests,
@@ -324,6 +325,8 @@ void pegasus_write_service::batch_abort(int64_t decree, int err)
 
 void pegasus_write_service::set_default_ttl(uint32_t ttl) { _impl->set_default_ttl(ttl); }
 
+void pegasus_write_service::set_incr_by_merge(bool enabled) { _impl->set_incr_by_merge(enabled); }
+
 void pegasus_write_service::clear_up_batch_states()
 {
 #define PROCESS_WRITE_BATCH(op)                                                                    \
@@ -347,8 +350,19 @@ int pegasus_write_service::duplicate(int64_t decree,
                                      const dsn::apps::duplicate_request &requests,
                                      dsn::apps::duplicate_response &resp)
 {
+    const auto *entries = &requests.entries;
+    dsn::apps::duplicate_request decompressed;
+    if (requests.__isset.compressed_entries) {
+        if (!decompress_duplicate_entries(requests.compressed_entries, decompressed)) {
+            resp.__set_error(rocksdb::Status::kInvalidArgument);
+            resp.__set_error_hint("corrupted compressed entries");
+            return empty_put(decree);
+        }
+        entries = &decompressed.entries;
+    }
+
     // Verifies the cluster_id.
-    for (const auto &request : requests.entries) {
+    for (const auto &request : *entries) {
         if (!dsn::replication::is_cluster_id_configured(request.cluster_id)) {
             resp.__set_error(rocksdb::Status::kInvalidArgument);
             resp.__set_error_hint("request cluster id is unconfigured");
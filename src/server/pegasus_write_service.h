@@ -196,6 +196,8 @@ public:
 
     void set_default_ttl(uint32_t ttl);
 
+    void set_incr_by_merge(bool enabled);
+
 private:
     void clear_up_batch_states();
 
@@ -223,13 +225,13 @@ private:
     METRIC_VAR_DECLARE_counter(check_and_set_requests);
     METRIC_VAR_DECLARE_counter(check_and_mutate_requests);
 
-    METRIC_VAR_DECLARE_percentile_int64(put_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(multi_put_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(remove_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(multi_remove_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(incr_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(check_and_set_latency_ns);
-    METRIC_VAR_DECLARE_percentile_int64(check_and_mutate_latency_ns);
+    METRIC_VAR_DECLARE_histogram(put_latency_ns);
+    METRIC_VAR_DECLARE_histogram(multi_put_latency_ns);
+    METRIC_VAR_DECLARE_histogram(remove_latency_ns);
+    METRIC_VAR_DECLARE_histogram(multi_remove_latency_ns);
+    METRIC_VAR_DECLARE_histogram(incr_latency_ns);
+    METRIC_VAR_DECLARE_histogram(check_and_set_latency_ns);
+    METRIC_VAR_DECLARE_histogram(check_and_mutate_latency_ns);
 
     METRIC_VAR_DECLARE_counter(dup_requests);
     METRIC_VAR_DECLARE_percentile_int64(dup_time_lag_ms);
@@ -188,6 +188,10 @@ public:
         resp.decree = decree;
         resp.server = _primary_address;
 
+        if (_incr_by_merge) {
+            return incr_by_merge(decree, update, resp);
+        }
+
         absl::string_view raw_key = update.key.to_string_view();
         int64_t new_value = 0;
         uint32_t new_expire_ts = 0;
@@ -263,6 +267,23 @@ public:
         return resp.error;
     }
 
+    // The incr is recorded as a merge operand without reading the existing record, thus the new
+    // value is unknown and not responded.
+    int incr_by_merge(int64_t decree,
+                      const dsn::apps::incr_request &update,
+                      dsn::apps::incr_response &resp)
+    {
+        auto cleanup = dsn::defer([this]() { _rocksdb_wrapper->clear_up_write_batch(); });
+        resp.error = _rocksdb_wrapper->write_batch_incr_merge(
+            decree, update.key.to_string_view(), update.increment, update.expire_ts_seconds);
+        if (resp.error) {
+            return resp.error;
+        }
+
+        resp.error = _rocksdb_wrapper->write(decree);
+        return resp.error;
+    }
+
     int check_and_set(int64_t decree,
                       const dsn::apps::check_and_set_request &update,
                       dsn::apps::check_and_set_response &resp)
@@ -553,6 +574,8 @@ public:
 
     void set_default_ttl(uint32_t ttl) { _rocksdb_wrapper->set_default_ttl(ttl); }
 
+    void set_incr_by_merge(bool enabled) { _incr_by_merge = enabled; }
+
 private:
     void clear_up_batch_states(int64_t decree, int err)
     {
@@ -701,6 +724,9 @@ private:
 
     std::unique_ptr<rocksdb_wrapper> _rocksdb_wrapper;
 
+    // Whether to do incr by rocksdb merge, see replica_envs::INCR_BY_MERGE.
+    bool _incr_by_merge{false};
+
     // for setting update_response.error after committed.
     std::vector<dsn::apps::update_response *> _update_responses;
 };
@@ -0,0 +1,166 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "read_pushdown_filter.h"
+
+#include <fmt/core.h>
+
+#include "absl/strings/match.h"
+#include "base/idl_utils.h" // IWYU pragma: keep
+#include "utils/blob.h"
+
+namespace pegasus {
+namespace server {
+
+bool read_pushdown_filter::init(const ::dsn::apps::read_pushdown &pushdown, std::string &err_msg)
+{
+    _predicates.clear();
+    _predicates.reserve(pushdown.predicates.size());
+    for (const auto &p : pushdown.predicates) {
+        predicate pred;
+        pred.type = p.type;
+        pred.operand = p.operand.to_string();
+        switch (p.type) {
+        case ::dsn::apps::pushdown_predicate_type::PPT_VALUE_PREFIX:
+            break;
+        case ::dsn::apps::pushdown_predicate_type::PPT_VALUE_RANGE:
+            if (p.__isset.operand_end) {
+                pred.has_operand_end = true;
+                pred.operand_end = p.operand_end.to_string();
+            }
+            break;
+        case ::dsn::apps::pushdown_predicate_type::PPT_TTL_RANGE:
+            if (p.__isset.min_ttl_seconds) {
+                if (p.min_ttl_seconds < 0) {
+                    err_msg = fmt::format("invalid min_ttl_seconds {}", p.min_ttl_seconds);
+                    return false;
+                }
+                pred.has_min_ttl = true;
+                pred.min_ttl_seconds = static_cast<uint32_t>(p.min_ttl_seconds);
+            }
+            if (p.__isset.max_ttl_seconds) {
+                if (p.max_ttl_seconds < 0) {
+                    err_msg = fmt::format("invalid max_ttl_seconds {}", p.max_ttl_seconds);
+                    return false;
+                }
+                pred.has_max_ttl = true;
+                pred.max_ttl_seconds = static_cast<uint32_t>(p.max_ttl_seconds);
+            }
+            break;
+        case ::dsn::apps::pushdown_predicate_type::PPT_SORT_KEY_REGEX:
+            if (pred.operand.size() > kMaxRegexLength) {
+                err_msg = fmt::format(
+                    "the length of sort key regex exceeds the limit {}", kMaxRegexLength);
+                return false;
+            }
+            {
+                RE2::Options options;
+                // The sort keys are matched byte by byte, since they are not always in UTF-8.
+                options.set_encoding(RE2::Options::EncodingLatin1);
+                options.set_log_errors(false);
+                options.set_max_mem(kMaxRegexMemoryBytes);
+                pred.regex = std::make_unique<re2::RE2>(
+                    re2::StringPiece(pred.operand.data(), pred.operand.size()), options);
+                if (!pred.regex->ok()) {
+                    err_msg = fmt::format("invalid sort key regex: {}", pred.regex->error());
+                    return false;
+                }
+            }
+            break;
+        default:
+            err_msg = fmt::format("unsupported predicate type {}", p.type);
+            return false;
+        }
+        _predicates.emplace_back(std::move(pred));
+    }
+
+    _has_projection = pushdown.__isset.value_offset || pushdown.__isset.value_length;
+    _value_offset = 0;
+    _value_length = std::string::npos;
+    if (pushdown.__isset.value_offset) {
+        if (pushdown.value_offset < 0) {
+            err_msg = fmt::format("invalid value_offset {}", pushdown.value_offset);
+            return false;
+        }
+        _value_offset = static_cast<size_t>(pushdown.value_offset);
+    }
+    if (pushdown.__isset.value_length && pushdown.value_length >= 0) {
+        _value_length = static_cast<size_t>(pushdown.value_length);
+    }
+    return true;
+}
+
+bool read_pushdown_filter::match(absl::string_view sort_key,
+                                 absl::string_view user_data,
+                                 uint32_t expire_ts,
+                                 uint32_t epoch_now) const
+{
+    for (const auto &pred : _predicates) {
+        if (!match(pred, sort_key, user_data, expire_ts, epoch_now)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool read_pushdown_filter::match(const predicate &pred,
+                                 absl::string_view sort_key,
+                                 absl::string_view user_data,
+                                 uint32_t expire_ts,
+                                 uint32_t epoch_now) const
+{
+    switch (pred.type) {
+    case ::dsn::apps::pushdown_predicate_type::PPT_VALUE_PREFIX:
+        return absl::StartsWith(user_data, pred.operand);
+    case ::dsn::apps::pushdown_predicate_type::PPT_VALUE_RANGE:
+        if (user_data.compare(pred.operand) < 0) {
+            return false;
+        }
+        return !pred.has_operand_end || user_data.compare(pred.operand_end) < 0;
+    case ::dsn::apps::pushdown_predicate_type::PPT_TTL_RANGE: {
+        if (expire_ts == 0) {
+            // the record without ttl lives forever
+            return !pred.has_max_ttl;
+        }
+        uint32_t ttl = expire_ts > epoch_now ? expire_ts - epoch_now : 0;
+        if (pred.has_min_ttl && ttl < pred.min_ttl_seconds) {
+            return false;
+        }
+        return !pred.has_max_ttl || ttl <= pred.max_ttl_seconds;
+    }
+    case ::dsn::apps::pushdown_predicate_type::PPT_SORT_KEY_REGEX:
+        return RE2::FullMatch(re2::StringPiece(sort_key.data(), sort_key.size()), *pred.regex);
+    default:
+        return false;
+    }
+}
+
+absl::string_view read_pushdown_filter::project(absl::string_view user_data) const
+{
+    if (!_has_projection) {
+        return user_data;
+    }
+    if (_value_offset >= user_data.size()) {
+        return absl::string_view();
+    }
+    return user_data.substr(_value_offset, _value_length);
+}
+
+} // namespace server
+} // namespace pegasus
@@ -0,0 +1,95 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#pragma once
+
+#include <re2/re2.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "rrdb/rrdb_types.h"
+
+namespace pegasus {
+namespace server {
+
+// read_pushdown_filter evaluates the predicates and the projection pushed down by the read
+// requests (see read_pushdown in rrdb.thrift) on the server side, so that the records which
+// would be dropped by the client are not transferred at all.
+//
+// It is compiled once per request (or per scan context) and is immutable afterwards, thus it
+// could be shared among threads.
+class read_pushdown_filter
+{
+public:
+    // The sort key regex is compiled and matched by RE2, which runs in linear time of the sort
+    // key without recursion. The length of the regex and the memory of the compiled one are
+    // limited as well, to bound the cost of evaluation.
+    static const size_t kMaxRegexLength = 256;
+    static const int64_t kMaxRegexMemoryBytes = 1 << 20;
+
+    // Return false and set 'err_msg' if the pushdown is invalid.
+    bool init(const ::dsn::apps::read_pushdown &pushdown, std::string &err_msg);
+
+    bool has_predicates() const { return !_predicates.empty(); }
+
+    bool has_projection() const { return _has_projection; }
+
+    // Return true if the record matches all of the predicates.
+    //   - user_data: the value without the header of value schema.
+    //   - expire_ts: 0 means no ttl.
+    bool match(absl::string_view sort_key,
+               absl::string_view user_data,
+               uint32_t expire_ts,
+               uint32_t epoch_now) const;
+
+    // Return the projected slice of 'user_data'.
+    absl::string_view project(absl::string_view user_data) const;
+
+private:
+    struct predicate
+    {
+        ::dsn::apps::pushdown_predicate_type::type type;
+        std::string operand;
+        bool has_operand_end = false;
+        std::string operand_end;
+        bool has_min_ttl = false;
+        uint32_t min_ttl_seconds = 0;
+        bool has_max_ttl = false;
+        uint32_t max_ttl_seconds = 0;
+        std::unique_ptr<re2::RE2> regex;
+    };
+
+    bool match(const predicate &pred,
+               absl::string_view sort_key,
+               absl::string_view user_data,
+               uint32_t expire_ts,
+               uint32_t epoch_now) const;
+
+    std::vector<predicate> _predicates;
+    bool _has_projection = false;
+    size_t _value_offset = 0;
+    // std::string::npos means to the end of the value.
+    size_t _value_length = std::string::npos;
+};
+
+} // namespace server
+} // namespace pegasus
@@ -26,6 +26,7 @@
 
 #include "base/meta_store.h"
 #include "base/pegasus_value_schema.h"
+#include "incr_merge_operator.h"
 #include "pegasus_key_schema.h"
 #include "pegasus_utils.h"
 #include "pegasus_write_service_impl.h"
@@ -165,6 +166,37 @@ int rocksdb_wrapper::write_batch_put_ctx(const db_write_context &ctx,
     return s.code();
 }
 
+int rocksdb_wrapper::write_batch_incr_merge(int64_t decree,
+                                            absl::string_view raw_key,
+                                            int64_t increment,
+                                            int32_t expire_ts_seconds)
+{
+    FAIL_POINT_INJECT_F("db_write_batch_put",
+                        [](absl::string_view) -> int { return FAIL_DB_WRITE_BATCH_PUT; });
+
+    incr_merge_operand operand;
+    operand.increment = increment;
+    operand.expire_ts_seconds = expire_ts_seconds;
+    operand.default_expire_ts = db_expire_ts(0);
+    operand.write_ts = utils::epoch_now();
+    operand.timetag = generate_timetag(0, get_cluster_id_if_exists(), false);
+
+    rocksdb::Status s =
+        _write_batch->Merge(utils::to_rocksdb_slice(raw_key), rocksdb::Slice(operand.encode()));
+    if (dsn_unlikely(!s.ok())) {
+        ::dsn::blob hash_key, sort_key;
+        pegasus_restore_key(::dsn::blob(raw_key.data(), 0, raw_key.size()), hash_key, sort_key);
+        LOG_ERROR_ROCKSDB("WriteBatchMerge",
+                          s.ToString(),
+                          "decree: {}, hash_key: {}, sort_key: {}, increment: {}",
+                          decree,
+                          utils::c_escape_sensitive_string(hash_key),
+                          utils::c_escape_sensitive_string(sort_key),
+                          increment);
+    }
+    return s.code();
+}
+
 int rocksdb_wrapper::write(int64_t decree)
 {
     CHECK_GT(_write_batch->Count(), 0);
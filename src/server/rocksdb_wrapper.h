@@ -64,6 +64,12 @@ public:
                             absl::string_view raw_key,
                             absl::string_view value,
                             uint32_t expire_sec);
+    /// Records the incr as a merge operand without reading the existing record, which is
+    /// resolved by \see IncrMergeOperator on read and compaction.
+    int write_batch_incr_merge(int64_t decree,
+                               absl::string_view raw_key,
+                               int64_t increment,
+                               int32_t expire_ts_seconds);
     int write(int64_t decree);
     int write_batch_delete(int64_t decree, absl::string_view raw_key);
     void clear_up_write_batch();
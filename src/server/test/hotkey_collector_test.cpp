@@ -21,6 +21,7 @@
 #include <fmt/core.h>
 #include <chrono>
 #include <thread>
+#include <vector>
 
 #include "base/pegasus_key_schema.h"
 #include "common/gpid.h"
@@ -35,11 +36,14 @@
 #include "server/hotkey_collector_state.h"
 #include "server/pegasus_read_service.h"
 #include "server/test/message_utils.h"
+#include "test_util/test_util.h"
 #include "utils/error_code.h"
 #include "utils/flags.h"
 #include "utils/fmt_logging.h"
+#include "utils/metrics.h"
 #include "utils/rand.h"
 
+DSN_DECLARE_bool(enable_hotkey_sketch);
 DSN_DECLARE_uint32(hotkey_buckets_num);
 
 namespace dsn {
@@ -251,6 +255,11 @@ public:
         return &c->_result;
     }
 
+    int64_t get_hotkey_max_qps(std::shared_ptr<pegasus::server::hotkey_collector> c)
+    {
+        return METRIC_VALUE(*c, hotkey_max_qps);
+    }
+
     void on_detect_hotkey(const dsn::replication::detect_hotkey_request &req,
                           dsn::replication::detect_hotkey_response &resp)
     {
@@ -365,6 +374,49 @@ TEST_P(hotkey_collector_test, state_transform)
     _tracker.wait_outstanding_tasks();
 }
 
+TEST_P(hotkey_collector_test, sketch)
+{
+    PRESERVE_FLAG(enable_hotkey_sketch);
+    FLAGS_enable_hotkey_sketch = true;
+
+    // The hot keys are found continuously without any detection started.
+    auto collector = get_read_collector();
+    ASSERT_EQ(get_collector_stat(collector), hotkey_collector_state::STOPPED);
+    collector->analyse_data();
+    for (int i = 0; i < 1000; i++) {
+        dsn::tasking::enqueue(LPC_WRITE, &_tracker, [&] {
+            _server->on_get(generate_get_rpc(generate_hash_key_by_random(true, 50)));
+        });
+    }
+    _tracker.wait_outstanding_tasks();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    collector->analyse_data();
+    ASSERT_EQ(get_collector_stat(collector), hotkey_collector_state::STOPPED);
+
+    std::vector<dsn::replication::hotkey_info> hotkeys;
+    _server->query_hotkeys(dsn::replication::hotkey_type::READ, hotkeys);
+    ASSERT_FALSE(hotkeys.empty());
+    ASSERT_EQ("ThisisahotkeyThisisahotkey", hotkeys.front().hash_key);
+    ASSERT_GT(hotkeys.front().qps, 0);
+    ASSERT_GT(get_hotkey_max_qps(collector), 0);
+    for (size_t i = 1; i < hotkeys.size(); ++i) {
+        ASSERT_GE(hotkeys[i - 1].qps, hotkeys[i].qps);
+    }
+
+    // Nothing is found once no more keys are captured.
+    collector->analyse_data();
+    _server->query_hotkeys(dsn::replication::hotkey_type::READ, hotkeys);
+    ASSERT_TRUE(hotkeys.empty());
+    ASSERT_EQ(0, get_hotkey_max_qps(collector));
+
+    // Nothing is captured once disabled.
+    FLAGS_enable_hotkey_sketch = false;
+    _server->on_get(generate_get_rpc("ThisisahotkeyThisisahotkey"));
+    collector->analyse_data();
+    _server->query_hotkeys(dsn::replication::hotkey_type::READ, hotkeys);
+    ASSERT_TRUE(hotkeys.empty());
+}
+
 TEST_P(hotkey_collector_test, data_completeness)
 {
     dsn::replication::detect_hotkey_response resp;
@@ -0,0 +1,96 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "server/hotkey_sketch.h"
+
+#include <fmt/core.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace pegasus {
+namespace server {
+
+TEST(hotkey_sketch_test, exact_counts)
+{
+    hotkey_sketch sketch(4, 1);
+    sketch.add("a", 1);
+    sketch.add("b", 3);
+    sketch.add("a", 1);
+    sketch.add("c", 1);
+
+    auto hotkeys = sketch.collect(2);
+    ASSERT_EQ(2, hotkeys.size());
+    ASSERT_EQ("b", hotkeys[0].hash_key);
+    ASSERT_EQ(3, hotkeys[0].count);
+    ASSERT_EQ("a", hotkeys[1].hash_key);
+    ASSERT_EQ(2, hotkeys[1].count);
+    ASSERT_EQ(0, hotkeys[1].error);
+
+    // The sketch is reset once collected.
+    ASSERT_TRUE(sketch.collect(2).empty());
+}
+
+TEST(hotkey_sketch_test, replace_least_frequent)
+{
+    hotkey_sketch sketch(2, 1);
+    sketch.add("a", 5);
+    sketch.add("b", 1);
+    sketch.add("c", 1);
+
+    // "c" takes the place of "b", inheriting its count as the error.
+    auto hotkeys = sketch.collect(10);
+    ASSERT_EQ(2, hotkeys.size());
+    ASSERT_EQ("a", hotkeys[0].hash_key);
+    ASSERT_EQ(5, hotkeys[0].count);
+    ASSERT_EQ("c", hotkeys[1].hash_key);
+    ASSERT_EQ(2, hotkeys[1].count);
+    ASSERT_EQ(1, hotkeys[1].error);
+}
+
+TEST(hotkey_sketch_test, skewed_keys)
+{
+    hotkey_sketch sketch(16, 4);
+
+    // Each thread adds the hot key 1000 times among 10000 distinct cold keys.
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&sketch, t]() {
+            for (int i = 0; i < 10000; ++i) {
+                sketch.add(fmt::format("cold_{}_{}", t, i), 1);
+                if (i % 10 == 0) {
+                    sketch.add("hot", 1);
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    auto hotkeys = sketch.collect(1);
+    ASSERT_EQ(1, hotkeys.size());
+    ASSERT_EQ("hot", hotkeys[0].hash_key);
+    // The count is never underestimated.
+    ASSERT_GE(hotkeys[0].count, 4000);
+    ASSERT_GE(4000, hotkeys[0].count - hotkeys[0].error);
+}
+
+} // namespace server
+} // namespace pegasus
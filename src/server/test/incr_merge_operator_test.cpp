@@ -0,0 +1,231 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <rocksdb/merge_operator.h>
+#include <rocksdb/slice.h>
+#include <stdint.h>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "base/pegasus_utils.h"
+#include "base/pegasus_value_schema.h"
+#include "gtest/gtest.h"
+#include "server/incr_merge_operator.h"
+
+namespace pegasus {
+namespace server {
+
+class incr_merge_operator_test : public testing::TestWithParam<uint32_t>
+{
+public:
+    void SetUp() override { _op.SetPegasusDataVersion(GetParam()); }
+
+    std::string generate_value(const std::string &user_data, uint32_t expire_ts)
+    {
+        pegasus_value_generator generator;
+        const auto parts = generator.generate_value(GetParam(), user_data, expire_ts, 0);
+        std::string value;
+        for (int i = 0; i < parts.num_parts; ++i) {
+            value.append(parts.parts[i].data(), parts.parts[i].size());
+        }
+        return value;
+    }
+
+    static incr_merge_operand
+    make_operand(int64_t increment, int32_t expire_ts_seconds = 0, uint32_t write_ts = 100)
+    {
+        incr_merge_operand operand;
+        operand.increment = increment;
+        operand.expire_ts_seconds = expire_ts_seconds;
+        operand.write_ts = write_ts;
+        operand.timetag = 12345;
+        return operand;
+    }
+
+    // Returns false if the merge fails, otherwise the merged value is parsed into `value` and
+    // `expire_ts`.
+    bool merge(const std::string *existing_value,
+               const std::vector<incr_merge_operand> &operands,
+               /*out*/ std::string &value,
+               /*out*/ uint32_t &expire_ts)
+    {
+        std::vector<std::string> encoded;
+        for (const auto &operand : operands) {
+            encoded.push_back(operand.encode());
+        }
+        std::vector<rocksdb::Slice> operand_list(encoded.begin(), encoded.end());
+
+        rocksdb::Slice existing_slice;
+        if (existing_value != nullptr) {
+            existing_slice = rocksdb::Slice(*existing_value);
+        }
+        rocksdb::MergeOperator::MergeOperationInput merge_in(
+            rocksdb::Slice("key"),
+            existing_value == nullptr ? nullptr : &existing_slice,
+            operand_list,
+            nullptr);
+        std::string new_value;
+        rocksdb::Slice existing_operand(nullptr, 0);
+        rocksdb::MergeOperator::MergeOperationOutput merge_out(new_value, existing_operand);
+        if (!_op.FullMergeV2(merge_in, &merge_out)) {
+            return false;
+        }
+
+        const std::string raw_value =
+            existing_operand.data() != nullptr ? existing_operand.ToString() : new_value;
+        expire_ts = pegasus_extract_expire_ts(GetParam(), raw_value);
+        value = std::string(pegasus_extract_user_data_view(GetParam(), raw_value));
+        return true;
+    }
+
+    IncrMergeOperator _op;
+};
+
+INSTANTIATE_TEST_SUITE_P(, incr_merge_operator_test, ::testing::Values(0, 1));
+
+TEST(incr_merge_operand_test, encode_and_decode)
+{
+    incr_merge_operand operand;
+    operand.increment = std::numeric_limits<int64_t>::min();
+    operand.expire_ts_seconds = -1;
+    operand.default_expire_ts = 1000;
+    operand.write_ts = 2000;
+    operand.timetag = std::numeric_limits<uint64_t>::max();
+
+    const auto data = operand.encode();
+    ASSERT_EQ(incr_merge_operand::kSize, data.size());
+
+    incr_merge_operand decoded;
+    ASSERT_TRUE(decoded.decode(data));
+    ASSERT_EQ(operand.increment, decoded.increment);
+    ASSERT_EQ(operand.expire_ts_seconds, decoded.expire_ts_seconds);
+    ASSERT_EQ(operand.default_expire_ts, decoded.default_expire_ts);
+    ASSERT_EQ(operand.write_ts, decoded.write_ts);
+    ASSERT_EQ(operand.timetag, decoded.timetag);
+
+    ASSERT_FALSE(decoded.decode(data.substr(1)));
+    auto invalid_type = data;
+    invalid_type[0] = 0;
+    ASSERT_FALSE(decoded.decode(invalid_type));
+}
+
+TEST_P(incr_merge_operator_test, merge_on_absent_record)
+{
+    std::string value;
+    uint32_t expire_ts = 0;
+    ASSERT_TRUE(merge(nullptr, {make_operand(100), make_operand(-1)}, value, expire_ts));
+    ASSERT_EQ("99", value);
+    ASSERT_EQ(0, expire_ts);
+
+    // A negative ttl on the absent record means no ttl.
+    ASSERT_TRUE(merge(nullptr, {make_operand(1, -1)}, value, expire_ts));
+    ASSERT_EQ("1", value);
+    ASSERT_EQ(0, expire_ts);
+
+    ASSERT_TRUE(merge(nullptr, {make_operand(1, 500)}, value, expire_ts));
+    ASSERT_EQ(500, expire_ts);
+}
+
+TEST_P(incr_merge_operator_test, merge_on_existing_record)
+{
+    std::string value;
+    uint32_t expire_ts = 0;
+    const auto empty = generate_value("", 0);
+    ASSERT_TRUE(merge(&empty, {make_operand(10)}, value, expire_ts));
+    ASSERT_EQ("10", value);
+
+    const auto existing = generate_value("100", 500);
+    ASSERT_TRUE(merge(&existing, {make_operand(10)}, value, expire_ts));
+    ASSERT_EQ("110", value);
+    ASSERT_EQ(500, expire_ts);
+
+    ASSERT_TRUE(merge(&existing, {make_operand(10, 600), make_operand(-20)}, value, expire_ts));
+    ASSERT_EQ("90", value);
+    ASSERT_EQ(600, expire_ts);
+
+    ASSERT_TRUE(merge(&existing, {make_operand(10, -1)}, value, expire_ts));
+    ASSERT_EQ("110", value);
+    ASSERT_EQ(0, expire_ts);
+}
+
+TEST_P(incr_merge_operator_test, merge_on_expired_record)
+{
+    std::string value;
+    uint32_t expire_ts = 0;
+    // The record has expired by the time the first incr is written.
+    const auto existing = generate_value("100", 50);
+    ASSERT_TRUE(merge(&existing, {make_operand(1, 0, 100)}, value, expire_ts));
+    ASSERT_EQ("1", value);
+    ASSERT_EQ(0, expire_ts);
+
+    // The record has not expired yet when the incr is written.
+    ASSERT_TRUE(merge(&existing, {make_operand(1, 0, 10)}, value, expire_ts));
+    ASSERT_EQ("101", value);
+    ASSERT_EQ(50, expire_ts);
+}
+
+TEST_P(incr_merge_operator_test, default_ttl)
+{
+    std::string value;
+    uint32_t expire_ts = 0;
+    auto operand = make_operand(1);
+    operand.default_expire_ts = 1000;
+    ASSERT_TRUE(merge(nullptr, {operand}, value, expire_ts));
+    ASSERT_EQ(1000, expire_ts);
+
+    // The ttl of the record is kept.
+    const auto existing = generate_value("100", 500);
+    ASSERT_TRUE(merge(&existing, {operand}, value, expire_ts));
+    ASSERT_EQ(500, expire_ts);
+}
+
+TEST_P(incr_merge_operator_test, skip_failed_incr)
+{
+    std::string value;
+    uint32_t expire_ts = 0;
+    // The record which is not an integer is left unchanged.
+    const auto invalid = generate_value("abc", 500);
+    ASSERT_TRUE(merge(&invalid, {make_operand(1, 600)}, value, expire_ts));
+    ASSERT_EQ("abc", value);
+    ASSERT_EQ(500, expire_ts);
+
+    // The overflowed incr is skipped while the others are still applied.
+    const auto existing = generate_value("100", 0);
+    ASSERT_TRUE(merge(&existing,
+                      {make_operand(std::numeric_limits<int64_t>::max()), make_operand(1)},
+                      value,
+                      expire_ts));
+    ASSERT_EQ("101", value);
+}
+
+TEST_P(incr_merge_operator_test, corrupted_operand)
+{
+    std::vector<std::string> encoded = {"corrupted"};
+    std::vector<rocksdb::Slice> operand_list(encoded.begin(), encoded.end());
+    rocksdb::MergeOperator::MergeOperationInput merge_in(
+        rocksdb::Slice("key"), nullptr, operand_list, nullptr);
+    std::string new_value;
+    rocksdb::Slice existing_operand(nullptr, 0);
+    rocksdb::MergeOperator::MergeOperationOutput merge_out(new_value, existing_operand);
+    ASSERT_FALSE(_op.FullMergeV2(merge_in, &merge_out));
+}
+
+} // namespace server
+} // namespace pegasus
@@ -24,6 +24,7 @@
 #include <pegasus/error.h>
 #include <sys/types.h>
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <tuple>
 #include <utility>
@@ -44,9 +45,24 @@
 #include "runtime/message_utils.h"
 #include "runtime/rpc/rpc_holder.h"
 #include "runtime/rpc/rpc_message.h"
+#include "test_util/test_util.h"
 #include "server/pegasus_write_service.h"
 #include "utils/blob.h"
 #include "utils/error_code.h"
+#include "utils/flags.h"
+
+DSN_DECLARE_uint32(dup_frame_window_size);
+DSN_DECLARE_uint64(dup_frame_min_bytes);
+DSN_DECLARE_uint64(dup_frame_max_bytes);
+DSN_DECLARE_uint64(dup_frame_target_latency_ms);
+DSN_DECLARE_bool(dup_compress_frames);
+DSN_DECLARE_uint64(dup_max_decompressed_frame_bytes);
+
+namespace dsn {
+namespace replication {
+DSN_DECLARE_uint64(dup_max_allowed_write_size);
+} // namespace replication
+} // namespace dsn
 
 namespace pegasus {
 namespace server {
@@ -269,6 +285,167 @@ public:
         }
     }
 
+    void test_duplicate_in_frames()
+    {
+        PRESERVE_FLAG(dup_frame_window_size);
+        PRESERVE_FLAG(dup_frame_min_bytes);
+        PRESERVE_FLAG(dup_compress_frames);
+        FLAGS_dup_frame_window_size = 4;
+        FLAGS_dup_frame_min_bytes = 4096;
+        FLAGS_dup_compress_frames = true;
+
+        replica_base replica(dsn::gpid(1, 1), "fake_replica", "temp");
+        auto duplicator = new_mutation_duplicator(&replica, "onebox2", "temp");
+        duplicator->set_task_environment(&_env);
+        auto duplicator_impl = dynamic_cast<pegasus_mutation_duplicator *>(duplicator.get());
+        ASSERT_EQ(4 * 4096, duplicator->preferred_batch_bytes());
+
+        mutation_tuple_set muts;
+        std::map<uint64_t, std::vector<uint64_t>> expected_ts_by_lane;
+        for (uint64_t i = 0; i < 1000; i++) {
+            uint64_t ts = 200 + i;
+            dsn::apps::update_request request;
+            pegasus::pegasus_generate_key(
+                request.key, fmt::format("hash{}", i % 10), std::string(100, 's'));
+            dsn::message_ptr msg =
+                dsn::from_thrift_request_to_received_message(request, dsn::apps::RPC_RRDB_RRDB_PUT);
+            auto data = dsn::move_message_to_blob(msg.get());
+            muts.insert(std::make_tuple(ts, dsn::apps::RPC_RRDB_RRDB_PUT, data));
+
+            auto hash = get_hash_from_request(dsn::apps::RPC_RRDB_RRDB_PUT, data);
+            expected_ts_by_lane[hash % 4].push_back(ts);
+        }
+
+        RPC_MOCKING(duplicate_rpc)
+        {
+            size_t shipped_size = 0;
+            duplicator->duplicate(muts, [&shipped_size](size_t size) { shipped_size = size; });
+
+            // Only a frame is in flight for each lane.
+            ASSERT_EQ(expected_ts_by_lane.size(), duplicator_impl->_inflights.size());
+            ASSERT_EQ(expected_ts_by_lane.size(), duplicate_rpc::mail_box().size());
+
+            std::map<uint64_t, std::vector<uint64_t>> actual_ts_by_lane;
+            while (!duplicate_rpc::mail_box().empty()) {
+                auto rpc_list = std::move(duplicate_rpc::mail_box());
+                for (const auto &rpc : rpc_list) {
+                    // The compressed frames are shipped by another rpc code.
+                    ASSERT_EQ(dsn::apps::RPC_RRDB_RRDB_DUPLICATE_COMPRESSED,
+                              rpc.dsn_request()->rpc_code());
+                    ASSERT_TRUE(rpc.request().entries.empty());
+                    dsn::apps::duplicate_request frame;
+                    ASSERT_TRUE(
+                        decompress_duplicate_entries(rpc.request().compressed_entries, frame));
+                    ASSERT_FALSE(frame.entries.empty());
+
+                    const auto &last = frame.entries.back();
+                    const auto lane =
+                        get_hash_from_request(last.task_code, last.raw_message) % 4;
+                    for (const auto &entry : frame.entries) {
+                        ASSERT_EQ(lane,
+                                  get_hash_from_request(entry.task_code, entry.raw_message) % 4);
+                        actual_ts_by_lane[lane].push_back(entry.timestamp);
+                    }
+                    duplicator_impl->on_duplicate_reply(lane, [](size_t) {}, rpc, dsn::ERR_OK);
+                }
+                _tracker.wait_outstanding_tasks();
+            }
+
+            // The mutations of each lane are shipped in order.
+            ASSERT_EQ(expected_ts_by_lane, actual_ts_by_lane);
+            ASSERT_TRUE(duplicator_impl->_inflights.empty());
+        }
+    }
+
+    void test_duplicate_large_frames()
+    {
+        PRESERVE_FLAG(dup_frame_window_size);
+        PRESERVE_FLAG(dup_frame_min_bytes);
+        PRESERVE_FLAG(dup_frame_max_bytes);
+        PRESERVE_FLAG(dup_compress_frames);
+        PRESERVE_FLAG(dup_max_allowed_write_size);
+        FLAGS_dup_frame_window_size = 1;
+        // The frames would be 4MB if not limited by the max size of a write.
+        FLAGS_dup_frame_min_bytes = 4 << 20;
+        FLAGS_dup_frame_max_bytes = 4 << 20;
+        FLAGS_dup_compress_frames = false;
+        FLAGS_dup_max_allowed_write_size = 1 << 20;
+
+        replica_base replica(dsn::gpid(1, 1), "fake_replica", "temp");
+        auto duplicator = new_mutation_duplicator(&replica, "onebox2", "temp");
+        duplicator->set_task_environment(&_env);
+        auto duplicator_impl = dynamic_cast<pegasus_mutation_duplicator *>(duplicator.get());
+
+        // 3MB mutations in total.
+        mutation_tuple_set muts;
+        for (uint64_t i = 0; i < 300; i++) {
+            dsn::apps::update_request request;
+            pegasus::pegasus_generate_key(
+                request.key, fmt::format("hash{}", i % 10), fmt::format("sort{}", i));
+            request.value = dsn::blob::create_from_bytes(std::string(10 * 1024, 'v'));
+            dsn::message_ptr msg =
+                dsn::from_thrift_request_to_received_message(request, dsn::apps::RPC_RRDB_RRDB_PUT);
+            auto data = dsn::move_message_to_blob(msg.get());
+            muts.insert(std::make_tuple(200 + i, dsn::apps::RPC_RRDB_RRDB_PUT, data));
+        }
+
+        RPC_MOCKING(duplicate_rpc)
+        {
+            duplicator->duplicate(muts, [](size_t) {});
+
+            size_t frame_count = 0;
+            size_t entry_count = 0;
+            while (!duplicate_rpc::mail_box().empty()) {
+                auto rpc_list = std::move(duplicate_rpc::mail_box());
+                for (const auto &rpc : rpc_list) {
+                    ASSERT_EQ(dsn::apps::RPC_RRDB_RRDB_DUPLICATE, rpc.dsn_request()->rpc_code());
+                    // Each frame would be accepted by the remote cluster.
+                    ASSERT_LE(rpc.dsn_request()->body_size(), FLAGS_dup_max_allowed_write_size);
+                    frame_count++;
+                    entry_count += rpc.request().entries.size();
+                    duplicator_impl->on_duplicate_reply(0, [](size_t) {}, rpc, dsn::ERR_OK);
+                }
+                _tracker.wait_outstanding_tasks();
+            }
+            ASSERT_LE(3, frame_count);
+            ASSERT_EQ(muts.size(), entry_count);
+            ASSERT_TRUE(duplicator_impl->_inflights.empty());
+        }
+    }
+
+    void test_adjust_frame_bytes()
+    {
+        PRESERVE_FLAG(dup_frame_min_bytes);
+        PRESERVE_FLAG(dup_frame_max_bytes);
+        PRESERVE_FLAG(dup_frame_target_latency_ms);
+        FLAGS_dup_frame_min_bytes = 1024;
+        FLAGS_dup_frame_max_bytes = 4096;
+        FLAGS_dup_frame_target_latency_ms = 100;
+
+        replica_base replica(dsn::gpid(1, 1), "fake_replica", "temp");
+        auto duplicator = new_mutation_duplicator(&replica, "onebox2", "temp");
+        duplicator->set_task_environment(&_env);
+        auto duplicator_impl = dynamic_cast<pegasus_mutation_duplicator *>(duplicator.get());
+        auto adjust = [duplicator_impl](size_t full_frames, uint64_t latency_ms, bool failed) {
+            duplicator_impl->_full_frames = full_frames;
+            duplicator_impl->_max_frame_latency_ms = latency_ms;
+            duplicator_impl->_frame_failed = failed;
+            duplicator_impl->adjust_frame_bytes();
+            return duplicator_impl->_frame_bytes.load();
+        };
+
+        // The frames which are not full are kept.
+        ASSERT_EQ(1024, adjust(0, 10, false));
+        // The frames are enlarged until the max bytes.
+        ASSERT_EQ(2048, adjust(1, 10, false));
+        ASSERT_EQ(4096, adjust(1, 10, false));
+        ASSERT_EQ(4096, adjust(1, 10, false));
+        // The frames are shrunk until the min bytes once slow or failed.
+        ASSERT_EQ(2048, adjust(1, 200, false));
+        ASSERT_EQ(1024, adjust(1, 10, true));
+        ASSERT_EQ(1024, adjust(1, 200, false));
+    }
+
     void test_create_duplicator()
     {
         replica_base replica(dsn::gpid(1, 1), "fake_replica", "temp");
@@ -372,6 +549,49 @@ TEST_P(pegasus_mutation_duplicator_test, duplicate_isolated_hashkeys)
 
 TEST_P(pegasus_mutation_duplicator_test, create_duplicator) { test_create_duplicator(); }
 
+TEST_P(pegasus_mutation_duplicator_test, duplicate_in_frames) { test_duplicate_in_frames(); }
+
+TEST_P(pegasus_mutation_duplicator_test, duplicate_large_frames) { test_duplicate_large_frames(); }
+
+TEST_P(pegasus_mutation_duplicator_test, adjust_frame_bytes) { test_adjust_frame_bytes(); }
+
+TEST_P(pegasus_mutation_duplicator_test, compress_duplicate_entries)
+{
+    dsn::apps::duplicate_request request;
+    for (int i = 0; i < 10; i++) {
+        dsn::apps::duplicate_entry entry;
+        entry.__set_raw_message(dsn::blob::create_from_bytes(std::string(100, 'a' + i)));
+        entry.__set_task_code(dsn::apps::RPC_RRDB_RRDB_PUT);
+        entry.__set_timestamp(200 + i);
+        entry.__set_cluster_id(1);
+        request.entries.emplace_back(std::move(entry));
+    }
+    const auto expected = request;
+
+    compress_duplicate_entries(request);
+    ASSERT_TRUE(request.entries.empty());
+    ASSERT_TRUE(request.__isset.compressed_entries);
+    ASSERT_LT(request.compressed_entries.length(), 10 * 100);
+
+    dsn::apps::duplicate_request actual;
+    ASSERT_TRUE(decompress_duplicate_entries(request.compressed_entries, actual));
+    ASSERT_EQ(expected.entries.size(), actual.entries.size());
+    for (size_t i = 0; i < expected.entries.size(); i++) {
+        ASSERT_EQ(expected.entries[i].raw_message.to_string(),
+                  actual.entries[i].raw_message.to_string());
+        ASSERT_EQ(expected.entries[i].task_code, actual.entries[i].task_code);
+        ASSERT_EQ(expected.entries[i].timestamp, actual.entries[i].timestamp);
+        ASSERT_EQ(expected.entries[i].cluster_id, actual.entries[i].cluster_id);
+    }
+
+    ASSERT_FALSE(decompress_duplicate_entries(dsn::blob::create_from_bytes("corrupted"), actual));
+
+    // The frames declared to be too large after decompressed are rejected before allocating.
+    PRESERVE_FLAG(dup_max_decompressed_frame_bytes);
+    FLAGS_dup_max_decompressed_frame_bytes = 100;
+    ASSERT_FALSE(decompress_duplicate_entries(request.compressed_entries, actual));
+}
+
 TEST_P(pegasus_mutation_duplicator_test, duplicate_duplicate)
 {
     replica_base replica(dsn::gpid(1, 1), "fake_replica", "temp");
@@ -0,0 +1,142 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <rrdb/rrdb_types.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "server/pegasus_scan_context.h"
+
+namespace pegasus {
+namespace server {
+
+static std::shared_ptr<pegasus_scan_context> make_scan_context()
+{
+    return std::make_shared<pegasus_scan_context>(std::unique_ptr<rocksdb::Iterator>(),
+                                                  std::string(),
+                                                  false,
+                                                  ::dsn::apps::filter_type::FT_NO_FILTER,
+                                                  std::string(),
+                                                  ::dsn::apps::filter_type::FT_NO_FILTER,
+                                                  std::string(),
+                                                  100,
+                                                  false,
+                                                  true,
+                                                  false,
+                                                  false);
+}
+
+TEST(pegasus_context_cache_test, put_and_fetch)
+{
+    pegasus_context_cache cache;
+    auto context = make_scan_context();
+    int64_t handle = cache.put(context, 0);
+    ASSERT_GE(handle, pegasus_scan_context::SCAN_CONTEXT_ID_VALID_MIN);
+    ASSERT_EQ(1, cache.size());
+
+    // the handle should be unique
+    int64_t another_handle = cache.put(make_scan_context(), 0);
+    ASSERT_NE(handle, another_handle);
+    ASSERT_EQ(2, cache.size());
+
+    ASSERT_EQ(context, cache.fetch(handle));
+    ASSERT_EQ(1, cache.size());
+    // the context is removed after fetched
+    ASSERT_EQ(nullptr, cache.fetch(handle));
+
+    cache.clear();
+    ASSERT_EQ(0, cache.size());
+    ASSERT_EQ(nullptr, cache.fetch(another_handle));
+}
+
+TEST(pegasus_context_cache_test, evict_idle)
+{
+    pegasus_context_cache cache;
+    int64_t old_handle = cache.put(make_scan_context(), 1000);
+    int64_t new_handle = cache.put(make_scan_context(), 5000);
+    ASSERT_EQ(2, cache.size());
+
+    // nothing is idle for 10s
+    ASSERT_EQ(0, cache.evict_idle(6000, 10000));
+    ASSERT_EQ(2, cache.size());
+
+    // only the old one is idle for 5s
+    ASSERT_EQ(1, cache.evict_idle(6000, 5000));
+    ASSERT_EQ(1, cache.size());
+    ASSERT_EQ(nullptr, cache.fetch(old_handle));
+    ASSERT_NE(nullptr, cache.fetch(new_handle));
+}
+
+TEST(pegasus_context_cache_test, evict_overflow)
+{
+    pegasus_context_cache cache;
+    std::vector<int64_t> handles;
+    for (int i = 0; i < 100; ++i) {
+        handles.push_back(cache.put(make_scan_context(), i));
+    }
+
+    ASSERT_EQ(0, cache.evict_overflow(100));
+    ASSERT_EQ(100, cache.size());
+
+    // the least recently accessed ones are evicted
+    ASSERT_EQ(10, cache.evict_overflow(90));
+    ASSERT_EQ(90, cache.size());
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(nullptr, cache.fetch(handles[i]));
+    }
+    for (int i = 10; i < 100; ++i) {
+        ASSERT_NE(nullptr, cache.fetch(handles[i]));
+    }
+    ASSERT_EQ(0, cache.size());
+}
+
+TEST(pegasus_context_cache_test, evict_overflow_after_access)
+{
+    pegasus_context_cache cache;
+    std::vector<int64_t> handles;
+    for (int i = 0; i < 40; ++i) {
+        handles.push_back(cache.put(make_scan_context(), i));
+    }
+
+    // the first 10 contexts are accessed again, thus the next 10 are the least recently
+    // accessed ones.
+    for (int i = 0; i < 10; ++i) {
+        handles[i] = cache.put(cache.fetch(handles[i]), 100 + i);
+    }
+    ASSERT_EQ(40, cache.size());
+
+    ASSERT_EQ(10, cache.evict_overflow(30));
+    for (int i = 10; i < 20; ++i) {
+        ASSERT_EQ(nullptr, cache.fetch(handles[i]));
+    }
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_NE(nullptr, cache.fetch(handles[i]));
+    }
+    ASSERT_EQ(20, cache.size());
+
+    // only the contexts accessed before 30ms are idle for 110ms at 139ms.
+    ASSERT_EQ(10, cache.evict_idle(139, 110));
+    ASSERT_EQ(10, cache.size());
+}
+
+} // namespace server
+} // namespace pegasus
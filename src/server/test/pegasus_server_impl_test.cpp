@@ -21,6 +21,7 @@
 #include <fmt/core.h>
 #include <rocksdb/db.h>
 #include <rocksdb/options.h>
+#include <rocksdb/write_batch.h>
 #include <stdint.h>
 #include <map>
 #include <memory>
@@ -29,19 +30,26 @@
 #include <utility>
 
 #include "base/meta_store.h"
+#include "base/pegasus_value_schema.h"
 #include "common/replica_envs.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "pegasus_server_test_base.h"
 #include "rrdb/rrdb.code.definition.h"
 #include "rrdb/rrdb_types.h"
+#include "runtime/api_layer1.h"
 #include "runtime/serverlet.h"
 #include "server/pegasus_read_service.h"
 #include "utils/autoref_ptr.h"
 #include "utils/blob.h"
 #include "utils/error_code.h"
 #include "utils/filesystem.h"
+#include "utils/flags.h"
 #include "utils/metrics.h"
+#include "utils/synchronize.h"
+
+DSN_DECLARE_bool(rocksdb_pin_read_values);
+DSN_DECLARE_uint64(rocksdb_row_cache_capacity);
 
 namespace pegasus {
 namespace server {
@@ -140,6 +148,77 @@ public:
             }
         }
     }
+
+    void put_data_for_scan(int count, int start = 0)
+    {
+        pegasus_value_generator value_generator;
+        rocksdb::WriteBatch batch;
+        for (int i = start; i < start + count; ++i) {
+            dsn::blob key;
+            pegasus_generate_key(key, std::string("scan_hash_key"), fmt::format("sort_{:05}", i));
+            rocksdb::Slice key_slice(key.data(), key.length());
+            batch.Put(_server->_data_cf,
+                      rocksdb::SliceParts(&key_slice, 1),
+                      value_generator.generate_value(
+                          _server->_pegasus_data_version, fmt::format("value_{}", i), 0, 0));
+        }
+        ASSERT_TRUE(_server->_db->Write(rocksdb::WriteOptions(), &batch).ok());
+    }
+
+    // Scan all the data in 'batch_size' and return the count of the scanned kvs.
+    int scan_all(int32_t batch_size, int32_t prefetch_credits, int32_t sub_scan_count = 0)
+    {
+        ::dsn::apps::get_scanner_request request;
+        pegasus_generate_key(request.start_key, std::string("scan_hash_key"), std::string());
+        pegasus_generate_next_blob(request.stop_key, std::string("scan_hash_key"));
+        request.start_inclusive = true;
+        request.stop_inclusive = false;
+        request.batch_size = batch_size;
+        request.__set_prefetch_credits(prefetch_credits);
+        if (sub_scan_count > 0) {
+            request.__set_full_scan(true);
+            request.__set_validate_partition_hash(false);
+            request.__set_sub_scan_count(sub_scan_count);
+        }
+        get_scanner_rpc get_rpc(std::make_unique<::dsn::apps::get_scanner_request>(request),
+                                dsn::apps::RPC_RRDB_RRDB_GET_SCANNER);
+        _server->on_get_scanner(get_rpc);
+        EXPECT_EQ(rocksdb::Status::kOk, get_rpc.response().error);
+
+        int count = 0;
+        std::string last_key;
+        std::set<std::string> keys;
+        auto check_kvs = [&](const std::vector<::dsn::apps::key_value> &kvs) {
+            for (const auto &kv : kvs) {
+                std::string key = kv.key.to_string();
+                // The records are not ordered across the sub-ranges.
+                if (sub_scan_count == 0) {
+                    EXPECT_LT(last_key, key);
+                }
+                EXPECT_TRUE(keys.insert(key).second);
+                last_key = std::move(key);
+                ++count;
+            }
+        };
+        check_kvs(get_rpc.response().kvs);
+
+        int64_t context_id = get_rpc.response().context_id;
+        while (context_id != pegasus_scan_context::SCAN_CONTEXT_ID_COMPLETED) {
+            ::dsn::apps::scan_request scan_req;
+            scan_req.context_id = context_id;
+            scan_req.__set_prefetch_credits(prefetch_credits);
+            scan_rpc rpc(std::make_unique<::dsn::apps::scan_request>(scan_req),
+                         dsn::apps::RPC_RRDB_RRDB_SCAN);
+            _server->on_scan(rpc);
+            EXPECT_EQ(rocksdb::Status::kOk, rpc.response().error);
+            if (rpc.response().error != rocksdb::Status::kOk) {
+                break;
+            }
+            check_kvs(rpc.response().kvs);
+            context_id = rpc.response().context_id;
+        }
+        return count;
+    }
 };
 
 INSTANTIATE_TEST_SUITE_P(, pegasus_server_impl_test, ::testing::Values(false, true));
@@ -213,6 +292,104 @@ TEST_P(pegasus_server_impl_test, test_stop_db_twice)
     ASSERT_TRUE(_server->_db == nullptr);
 }
 
+TEST_P(pegasus_server_impl_test, test_pinned_values_outlive_db)
+{
+    PRESERVE_FLAG(rocksdb_pin_read_values);
+    FLAGS_rocksdb_pin_read_values = true;
+
+    ASSERT_EQ(dsn::ERR_OK, start());
+    put_data_for_scan(10);
+
+    dsn::blob key;
+    pegasus_generate_key(key, std::string("scan_hash_key"), std::string("sort_00000"));
+    get_rpc get(std::make_unique<dsn::blob>(key), dsn::apps::RPC_RRDB_RRDB_GET);
+    _server->on_get(get);
+    ASSERT_EQ(rocksdb::Status::kOk, get.response().error);
+    // The value read for the response opts in to being attached to the message without copying.
+    ASSERT_TRUE(get.response().value.zero_copy_write());
+
+    ::dsn::apps::multi_get_request request;
+    request.hash_key = dsn::blob::create_from_bytes(std::string("scan_hash_key"));
+    request.max_kv_count = 100;
+    request.start_inclusive = true;
+    request.stop_inclusive = true;
+    multi_get_rpc multi_get(std::make_unique<::dsn::apps::multi_get_request>(request),
+                            dsn::apps::RPC_RRDB_RRDB_MULTI_GET);
+    _server->on_multi_get(multi_get);
+    ASSERT_EQ(rocksdb::Status::kOk, multi_get.response().error);
+    ASSERT_EQ(10, multi_get.response().kvs.size());
+
+    // The values pinned by the responses which are not sent yet keep the DB alive after the
+    // replica is stopped.
+    ASSERT_EQ(dsn::ERR_OK, _server->stop(false));
+    ASSERT_TRUE(_server->_db == nullptr);
+    ASSERT_TRUE(_server->_db_owner == nullptr);
+    ASSERT_EQ("value_0", get.response().value.to_string());
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(fmt::format("value_{}", i), multi_get.response().kvs[i].value.to_string());
+    }
+}
+
+TEST_P(pegasus_server_impl_test, test_row_cache)
+{
+    PRESERVE_FLAG(rocksdb_row_cache_capacity);
+    FLAGS_rocksdb_row_cache_capacity = 8 * 1024 * 1024;
+    // The row cache is set to the options of the DB once the server is created.
+    _server = std::make_unique<mock_pegasus_server_impl>(_replica);
+    ASSERT_EQ(dsn::ERR_OK, start());
+    ASSERT_NE(nullptr, _server->_db_opts.row_cache);
+
+    // The row cache only serves the point lookups on the SST files.
+    put_data_for_scan(1);
+    ASSERT_TRUE(_server->_db->Flush(rocksdb::FlushOptions(), _server->_data_cf).ok());
+
+    dsn::blob key;
+    pegasus_generate_key(key, std::string("scan_hash_key"), std::string("sort_00000"));
+    const auto get = [this, &key]() {
+        get_rpc rpc(std::make_unique<dsn::blob>(key), dsn::apps::RPC_RRDB_RRDB_GET);
+        _server->on_get(rpc);
+        return rpc.response();
+    };
+
+    auto resp = get();
+    ASSERT_EQ(rocksdb::Status::kOk, resp.error);
+    ASSERT_EQ("value_0", resp.value.to_string());
+    _server->update_replica_rocksdb_statistics();
+    const auto hit_count = _server->METRIC_VAR_VALUE(rdb_row_cache_hit_count);
+    const auto total_count = _server->METRIC_VAR_VALUE(rdb_row_cache_total_count);
+    ASSERT_LT(0, total_count);
+
+    // The same key is read from the row cache this time.
+    resp = get();
+    ASSERT_EQ(rocksdb::Status::kOk, resp.error);
+    ASSERT_EQ("value_0", resp.value.to_string());
+    _server->update_replica_rocksdb_statistics();
+    ASSERT_EQ(hit_count + 1, _server->METRIC_VAR_VALUE(rdb_row_cache_hit_count));
+    ASSERT_EQ(total_count + 1, _server->METRIC_VAR_VALUE(rdb_row_cache_total_count));
+
+    // The overwrite is visible on the next read, either in the memtable or in the SST files.
+    pegasus_value_generator value_generator;
+    rocksdb::Slice key_slice(key.data(), key.length());
+    rocksdb::WriteBatch batch;
+    batch.Put(_server->_data_cf,
+              rocksdb::SliceParts(&key_slice, 1),
+              value_generator.generate_value(_server->_pegasus_data_version, "new_value", 0, 0));
+    ASSERT_TRUE(_server->_db->Write(rocksdb::WriteOptions(), &batch).ok());
+    resp = get();
+    ASSERT_EQ(rocksdb::Status::kOk, resp.error);
+    ASSERT_EQ("new_value", resp.value.to_string());
+    ASSERT_TRUE(_server->_db->Flush(rocksdb::FlushOptions(), _server->_data_cf).ok());
+    resp = get();
+    ASSERT_EQ(rocksdb::Status::kOk, resp.error);
+    ASSERT_EQ("new_value", resp.value.to_string());
+
+    // So is the delete.
+    ASSERT_TRUE(_server->_db->Delete(rocksdb::WriteOptions(), _server->_data_cf, key_slice).ok());
+    ASSERT_EQ(rocksdb::Status::kNotFound, get().error);
+    ASSERT_TRUE(_server->_db->Flush(rocksdb::FlushOptions(), _server->_data_cf).ok());
+    ASSERT_EQ(rocksdb::Status::kNotFound, get().error);
+}
+
 TEST_P(pegasus_server_impl_test, test_update_user_specified_compaction)
 {
     _server->_user_specified_compaction = "";
@@ -227,6 +404,130 @@ TEST_P(pegasus_server_impl_test, test_update_user_specified_compaction)
     ASSERT_EQ(user_specified_compaction, _server->_user_specified_compaction);
 }
 
+TEST_P(pegasus_server_impl_test, test_streaming_scan)
+{
+    ASSERT_EQ(dsn::ERR_OK, start());
+    put_data_for_scan(1000);
+
+    // streaming scan disabled
+    ASSERT_EQ(1000, scan_all(7, 0));
+
+    // streaming scan enabled, the results should be the same
+    ASSERT_EQ(1000, scan_all(7, 3));
+    ASSERT_EQ(1000, scan_all(100, 1));
+    ASSERT_EQ(1000, scan_all(1000, 3));
+
+    // The batches are prefetched in background until the credits are used up, and served to the
+    // next scan request.
+    const auto prefetched_batches = _server->METRIC_VAR_VALUE(scan_prefetched_batches);
+    const auto prefetch_hit_batches = _server->METRIC_VAR_VALUE(scan_prefetch_hit_batches);
+    ::dsn::apps::get_scanner_request request;
+    pegasus_generate_key(request.start_key, std::string("scan_hash_key"), std::string());
+    pegasus_generate_next_blob(request.stop_key, std::string("scan_hash_key"));
+    request.start_inclusive = true;
+    request.stop_inclusive = false;
+    request.batch_size = 7;
+    request.__set_prefetch_credits(3);
+    get_scanner_rpc get_rpc(std::make_unique<::dsn::apps::get_scanner_request>(request),
+                            dsn::apps::RPC_RRDB_RRDB_GET_SCANNER);
+    _server->on_get_scanner(get_rpc);
+    ASSERT_EQ(rocksdb::Status::kOk, get_rpc.response().error);
+    ASSERT_IN_TIME(
+        [&]() {
+            ASSERT_EQ(prefetched_batches + 3, _server->METRIC_VAR_VALUE(scan_prefetched_batches));
+        },
+        10);
+
+    ::dsn::apps::scan_request scan_req;
+    scan_req.context_id = get_rpc.response().context_id;
+    scan_rpc rpc(std::make_unique<::dsn::apps::scan_request>(scan_req),
+                 dsn::apps::RPC_RRDB_RRDB_SCAN);
+    _server->on_scan(rpc);
+    ASSERT_EQ(rocksdb::Status::kOk, rpc.response().error);
+    ASSERT_EQ(7, rpc.response().kvs.size());
+    ASSERT_EQ(prefetch_hit_batches + 1, _server->METRIC_VAR_VALUE(scan_prefetch_hit_batches));
+
+    // The prefetched batch is served without waiting for the iteration in progress, such as
+    // the next batch being prefetched.
+    auto context = _server->_context_cache.fetch(rpc.response().context_id);
+    ASSERT_NE(nullptr, context);
+    ASSERT_IN_TIME(
+        [&]() {
+            ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr> l(context->lock);
+            ASSERT_EQ(3, context->prefetched_batches.size());
+        },
+        10);
+    int64_t next_context_id = 0;
+    {
+        ::dsn::utils::auto_lock<::dsn::utils::ex_lock_nr> il(context->iterate_lock);
+        scan_req.context_id = _server->_context_cache.put(context, dsn_now_ms());
+        scan_rpc next_rpc(std::make_unique<::dsn::apps::scan_request>(scan_req),
+                          dsn::apps::RPC_RRDB_RRDB_SCAN);
+        _server->on_scan(next_rpc);
+        ASSERT_EQ(rocksdb::Status::kOk, next_rpc.response().error);
+        ASSERT_EQ(7, next_rpc.response().kvs.size());
+        ASSERT_EQ(prefetch_hit_batches + 2, _server->METRIC_VAR_VALUE(scan_prefetch_hit_batches));
+        next_context_id = next_rpc.response().context_id;
+    }
+    _server->on_clear_scanner(next_context_id);
+}
+
+TEST_P(pegasus_server_impl_test, test_scan_prefetch_after_stop)
+{
+    ASSERT_EQ(dsn::ERR_OK, start());
+    put_data_for_scan(1000);
+
+    // The pending prefetch tasks never keep the contexts, thus the iterators, after the DB is
+    // released.
+    for (int i = 0; i < 10; ++i) {
+        ::dsn::apps::get_scanner_request request;
+        pegasus_generate_key(request.start_key, std::string("scan_hash_key"), std::string());
+        pegasus_generate_next_blob(request.stop_key, std::string("scan_hash_key"));
+        request.start_inclusive = true;
+        request.stop_inclusive = false;
+        request.batch_size = 10;
+        request.__set_prefetch_credits(3);
+        get_scanner_rpc get_rpc(std::make_unique<::dsn::apps::get_scanner_request>(request),
+                                dsn::apps::RPC_RRDB_RRDB_GET_SCANNER);
+        _server->on_get_scanner(get_rpc);
+        ASSERT_EQ(rocksdb::Status::kOk, get_rpc.response().error);
+    }
+    ASSERT_EQ(dsn::ERR_OK, _server->stop(false));
+    ASSERT_TRUE(_server->_db == nullptr);
+    ASSERT_EQ(0, _server->_context_cache.size());
+}
+
+TEST_P(pegasus_server_impl_test, test_parallel_sub_range_scan)
+{
+    ASSERT_EQ(dsn::ERR_OK, start());
+    // Flush the data into several SST files, thus the range could be split by their boundaries.
+    for (int i = 0; i < 4; ++i) {
+        put_data_for_scan(250, i * 250);
+        ASSERT_TRUE(_server->_db->Flush(rocksdb::FlushOptions(), _server->_data_cf).ok());
+    }
+    std::vector<std::string> split_keys;
+    {
+        dsn::blob start_key, stop_key;
+        pegasus_generate_key(start_key, std::string("scan_hash_key"), std::string());
+        pegasus_generate_next_blob(stop_key, std::string("scan_hash_key"));
+        split_keys =
+            _server->get_scan_split_keys(rocksdb::Slice(start_key.data(), start_key.length()),
+                                         rocksdb::Slice(stop_key.data(), stop_key.length()),
+                                         4);
+    }
+    ASSERT_EQ(3, split_keys.size());
+    ASSERT_LT(split_keys[0], split_keys[1]);
+    ASSERT_LT(split_keys[1], split_keys[2]);
+
+    ASSERT_EQ(1000, scan_all(7, 0, 4));
+    ASSERT_EQ(1000, scan_all(100, 2, 4));
+    ASSERT_EQ(1000, scan_all(1000, 0, 2));
+
+    // Some data in the memtable is still scanned.
+    put_data_for_scan(100, 1000);
+    ASSERT_EQ(1100, scan_all(9, 0, 3));
+}
+
 TEST_P(pegasus_server_impl_test, test_load_from_duplication_data)
 {
     auto origin_file = fmt::format("{}/{}", _server->duplication_dir(), "checkpoint");
@@ -20,7 +20,10 @@
 #include "base/pegasus_value_schema.h"
 
 #include <limits>
+#include <string>
+#include <utility>
 
+#include "absl/strings/string_view.h"
 #include "gtest/gtest.h"
 
 using namespace pegasus;
@@ -66,3 +69,29 @@ TEST(value_schema, generate_and_extract_v1_v0)
         ASSERT_EQ(t.user_data, user_data.to_string());
     }
 }
+
+TEST(value_schema, value_view)
+{
+    pegasus_value_generator gen;
+    rocksdb::SliceParts sparts = gen.generate_value(1, "pegasus", 1000, 10001);
+    std::string raw_value;
+    for (int i = 0; i < sparts.num_parts; i++) {
+        raw_value += sparts.parts[i].ToString();
+    }
+
+    pegasus_value_view<1> view_v1(raw_value);
+    ASSERT_EQ(1000, view_v1.expire_ts());
+    ASSERT_EQ(10001, view_v1.timetag());
+    ASSERT_EQ("pegasus", view_v1.user_data());
+    // The view refers to the memory of the raw value.
+    ASSERT_EQ(raw_value.data() + pegasus_value_view<1>::kHeaderSize, view_v1.user_data().data());
+
+    // The expire_ts is decoded in the same way by both versions.
+    pegasus_value_view<0> view_v0(raw_value);
+    ASSERT_EQ(1000, view_v0.expire_ts());
+
+    ASSERT_EQ(std::make_pair(1000u, absl::string_view("pegasus")),
+              visit_value_view(1, raw_value, [](auto view) {
+                  return std::make_pair(view.expire_ts(), view.user_data());
+              }));
+}
@@ -24,6 +24,7 @@
 #include <memory>
 #include <string>
 
+#include "base/pegasus_value_schema.h"
 #include "gtest/gtest.h"
 #include "pegasus_key_schema.h"
 #include "pegasus_server_test_base.h"
@@ -60,6 +61,11 @@ public:
         return _rocksdb_wrapper->get(raw_key, get_ctx);
     }
 
+    absl::string_view extract_user_data(const std::string &raw_value)
+    {
+        return pegasus_extract_user_data_view(_write_impl->_pegasus_data_version, raw_value);
+    }
+
     void single_set(dsn::blob raw_key, dsn::blob user_value)
     {
         dsn::apps::update_request put;
@@ -181,5 +187,32 @@ TEST_P(incr_test, incr_on_expire_record)
     db_get(req.key.to_string_view(), &get_ctx);
     ASSERT_TRUE(get_ctx.found);
 }
+
+TEST_P(incr_test, incr_by_merge)
+{
+    _write_impl->set_incr_by_merge(true);
+
+    req.increment = 100;
+    ASSERT_EQ(0, _write_impl->incr(0, req, resp));
+    req.increment = -1;
+    ASSERT_EQ(0, _write_impl->incr(0, req, resp));
+
+    db_get_context get_ctx;
+    db_get(req.key.to_string_view(), &get_ctx);
+    ASSERT_TRUE(get_ctx.found);
+    ASSERT_EQ("99", extract_user_data(get_ctx.raw_value));
+
+    // The incr on the record which is not an integer is skipped.
+    single_set(req.key, dsn::blob::create_from_bytes("abc"));
+    req.increment = 1;
+    ASSERT_EQ(0, _write_impl->incr(0, req, resp));
+    db_get(req.key.to_string_view(), &get_ctx);
+    ASSERT_EQ("abc", extract_user_data(get_ctx.raw_value));
+
+    _write_impl->set_incr_by_merge(false);
+    req.increment = 1;
+    _write_impl->incr(0, req, resp);
+    ASSERT_EQ(rocksdb::Status::kInvalidArgument, resp.error);
+}
 } // namespace server
 } // namespace pegasus
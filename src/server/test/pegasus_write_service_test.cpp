@@ -37,6 +37,7 @@
 #include "runtime/message_utils.h"
 #include "runtime/rpc/rpc_message.h"
 #include "runtime/task/task_code.h"
+#include "server/pegasus_mutation_duplicator.h"
 #include "server/pegasus_server_write.h"
 #include "server/pegasus_write_service.h"
 #include "server/pegasus_write_service_impl.h"
@@ -338,5 +339,33 @@ TEST_P(pegasus_write_service_test, illegal_duplicate_request)
     ASSERT_EQ(resp.error, rocksdb::Status::kInvalidArgument);
 }
 
+TEST_P(pegasus_write_service_test, duplicate_compressed)
+{
+    dsn::apps::duplicate_request duplicate;
+    for (int i = 0; i < 100; i++) {
+        dsn::apps::update_request request;
+        pegasus::pegasus_generate_key(request.key, std::string("hash_key"), fmt::format("{}", i));
+        request.value = dsn::blob::create_from_bytes(fmt::format("value_{}", i));
+
+        dsn::message_ptr msg_ptr = pegasus::create_put_request(request);
+        dsn::apps::duplicate_entry entry;
+        entry.timestamp = 1000;
+        entry.cluster_id = 2;
+        entry.raw_message = dsn::move_message_to_blob(msg_ptr.get());
+        entry.task_code = dsn::apps::RPC_RRDB_RRDB_PUT;
+        duplicate.entries.emplace_back(entry);
+    }
+    compress_duplicate_entries(duplicate);
+    ASSERT_TRUE(duplicate.entries.empty());
+
+    dsn::apps::duplicate_response resp;
+    _write_svc->duplicate(1, duplicate, resp);
+    ASSERT_EQ(resp.error, 0);
+
+    duplicate.compressed_entries = dsn::blob::create_from_bytes("corrupted");
+    _write_svc->duplicate(1, duplicate, resp);
+    ASSERT_EQ(resp.error, rocksdb::Status::kInvalidArgument);
+}
+
 } // namespace server
 } // namespace pegasus
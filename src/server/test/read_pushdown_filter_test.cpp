@@ -0,0 +1,216 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <rrdb/rrdb_types.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "server/read_pushdown_filter.h"
+#include "utils/blob.h"
+
+namespace pegasus {
+namespace server {
+
+static ::dsn::apps::pushdown_predicate
+make_predicate(::dsn::apps::pushdown_predicate_type::type type, const std::string &operand)
+{
+    ::dsn::apps::pushdown_predicate pred;
+    pred.type = type;
+    pred.operand = ::dsn::blob::create_from_bytes(std::string(operand));
+    return pred;
+}
+
+TEST(read_pushdown_filter_test, value_prefix)
+{
+    ::dsn::apps::read_pushdown pushdown;
+    pushdown.predicates.emplace_back(
+        make_predicate(::dsn::apps::pushdown_predicate_type::PPT_VALUE_PREFIX, "abc"));
+
+    read_pushdown_filter filter;
+    std::string err_msg;
+    ASSERT_TRUE(filter.init(pushdown, err_msg));
+    ASSERT_TRUE(filter.has_predicates());
+    ASSERT_FALSE(filter.has_projection());
+
+    ASSERT_TRUE(filter.match("sort", "abc", 0, 100));
+    ASSERT_TRUE(filter.match("sort", "abcd", 0, 100));
+    ASSERT_FALSE(filter.match("sort", "ab", 0, 100));
+    ASSERT_FALSE(filter.match("sort", "xabc", 0, 100));
+}
+
+TEST(read_pushdown_filter_test, value_range)
+{
+    struct test_case
+    {
+        bool has_operand_end;
+        std::string value;
+        bool expected;
+    } tests[] = {{true, "a", false},
+                 {true, "b", true},
+                 {true, "bz", true},
+                 {true, "d", false},
+                 {true, "da", false},
+                 {false, "d", true},
+                 {false, "zzz", true},
+                 {false, "", false}};
+
+    for (const auto &test : tests) {
+        ::dsn::apps::read_pushdown pushdown;
+        auto pred = make_predicate(::dsn::apps::pushdown_predicate_type::PPT_VALUE_RANGE, "b");
+        if (test.has_operand_end) {
+            pred.__set_operand_end(::dsn::blob::create_from_bytes(std::string("d")));
+        }
+        pushdown.predicates.emplace_back(std::move(pred));
+
+        read_pushdown_filter filter;
+        std::string err_msg;
+        ASSERT_TRUE(filter.init(pushdown, err_msg));
+        ASSERT_EQ(test.expected, filter.match("sort", test.value, 0, 100)) << test.value;
+    }
+}
+
+TEST(read_pushdown_filter_test, ttl_range)
+{
+    ::dsn::apps::read_pushdown pushdown;
+    auto pred = make_predicate(::dsn::apps::pushdown_predicate_type::PPT_TTL_RANGE, "");
+    pred.__set_min_ttl_seconds(10);
+    pred.__set_max_ttl_seconds(20);
+    pushdown.predicates.emplace_back(std::move(pred));
+
+    read_pushdown_filter filter;
+    std::string err_msg;
+    ASSERT_TRUE(filter.init(pushdown, err_msg));
+
+    const uint32_t epoch_now = 1000;
+    // no ttl
+    ASSERT_FALSE(filter.match("sort", "value", 0, epoch_now));
+    ASSERT_FALSE(filter.match("sort", "value", epoch_now + 9, epoch_now));
+    ASSERT_TRUE(filter.match("sort", "value", epoch_now + 10, epoch_now));
+    ASSERT_TRUE(filter.match("sort", "value", epoch_now + 20, epoch_now));
+    ASSERT_FALSE(filter.match("sort", "value", epoch_now + 21, epoch_now));
+
+    // only the lower bound, the record without ttl matches
+    pushdown.predicates[0].__isset.max_ttl_seconds = false;
+    ASSERT_TRUE(filter.init(pushdown, err_msg));
+    ASSERT_TRUE(filter.match("sort", "value", 0, epoch_now));
+    ASSERT_TRUE(filter.match("sort", "value", epoch_now + 100, epoch_now));
+
+    // invalid ttl
+    pushdown.predicates[0].__set_min_ttl_seconds(-1);
+    ASSERT_FALSE(filter.init(pushdown, err_msg));
+}
+
+TEST(read_pushdown_filter_test, sort_key_regex)
+{
+    ::dsn::apps::read_pushdown pushdown;
+    pushdown.predicates.emplace_back(
+        make_predicate(::dsn::apps::pushdown_predicate_type::PPT_SORT_KEY_REGEX, "user_[0-9]+"));
+
+    read_pushdown_filter filter;
+    std::string err_msg;
+    ASSERT_TRUE(filter.init(pushdown, err_msg));
+    ASSERT_TRUE(filter.match("user_123", "value", 0, 100));
+    ASSERT_FALSE(filter.match("user_", "value", 0, 100));
+    ASSERT_FALSE(filter.match("user_123x", "value", 0, 100));
+
+    // malformed regex
+    pushdown.predicates[0] =
+        make_predicate(::dsn::apps::pushdown_predicate_type::PPT_SORT_KEY_REGEX, "user_[0-9");
+    ASSERT_FALSE(filter.init(pushdown, err_msg));
+
+    // too long regex
+    pushdown.predicates[0] =
+        make_predicate(::dsn::apps::pushdown_predicate_type::PPT_SORT_KEY_REGEX,
+                       std::string(read_pushdown_filter::kMaxRegexLength + 1, 'a'));
+    ASSERT_FALSE(filter.init(pushdown, err_msg));
+
+    // back references are not supported, since they could not be matched in linear time
+    pushdown.predicates[0] =
+        make_predicate(::dsn::apps::pushdown_predicate_type::PPT_SORT_KEY_REGEX, "(a)\\1");
+    ASSERT_FALSE(filter.init(pushdown, err_msg));
+
+    // the pattern which backtracks exponentially is matched in linear time against a long key
+    pushdown.predicates[0] =
+        make_predicate(::dsn::apps::pushdown_predicate_type::PPT_SORT_KEY_REGEX, "(a*)*b");
+    ASSERT_TRUE(filter.init(pushdown, err_msg));
+    ASSERT_FALSE(filter.match(std::string(1 << 20, 'a'), "value", 0, 100));
+    ASSERT_TRUE(filter.match(std::string(1 << 20, 'a') + "b", "value", 0, 100));
+
+    // the sort keys are matched byte by byte
+    pushdown.predicates[0] =
+        make_predicate(::dsn::apps::pushdown_predicate_type::PPT_SORT_KEY_REGEX, "k.\\x00");
+    ASSERT_TRUE(filter.init(pushdown, err_msg));
+    ASSERT_TRUE(filter.match(std::string("k\xff\x00", 3), "value", 0, 100));
+}
+
+TEST(read_pushdown_filter_test, conjunction)
+{
+    ::dsn::apps::read_pushdown pushdown;
+    pushdown.predicates.emplace_back(
+        make_predicate(::dsn::apps::pushdown_predicate_type::PPT_VALUE_PREFIX, "v"));
+    pushdown.predicates.emplace_back(
+        make_predicate(::dsn::apps::pushdown_predicate_type::PPT_SORT_KEY_REGEX, "s.*"));
+
+    read_pushdown_filter filter;
+    std::string err_msg;
+    ASSERT_TRUE(filter.init(pushdown, err_msg));
+    ASSERT_TRUE(filter.match("sort", "value", 0, 100));
+    ASSERT_FALSE(filter.match("sort", "alue", 0, 100));
+    ASSERT_FALSE(filter.match("xsort", "value", 0, 100));
+}
+
+TEST(read_pushdown_filter_test, projection)
+{
+    struct test_case
+    {
+        bool set_offset;
+        int32_t offset;
+        bool set_length;
+        int32_t length;
+        std::string expected;
+    } tests[] = {{false, 0, false, 0, "0123456789"},
+                 {true, 2, false, 0, "23456789"},
+                 {true, 2, true, 3, "234"},
+                 {true, 8, true, 5, "89"},
+                 {true, 10, true, 5, ""},
+                 {false, 0, true, 4, "0123"},
+                 {true, 3, true, -1, "3456789"}};
+
+    for (const auto &test : tests) {
+        ::dsn::apps::read_pushdown pushdown;
+        if (test.set_offset) {
+            pushdown.__set_value_offset(test.offset);
+        }
+        if (test.set_length) {
+            pushdown.__set_value_length(test.length);
+        }
+
+        read_pushdown_filter filter;
+        std::string err_msg;
+        ASSERT_TRUE(filter.init(pushdown, err_msg));
+        ASSERT_FALSE(filter.has_predicates());
+        ASSERT_EQ(test.set_offset || test.set_length, filter.has_projection());
+        ASSERT_EQ(test.expected, std::string(filter.project("0123456789")));
+    }
+}
+
+} // namespace server
+} // namespace pegasus
@@ -1275,6 +1275,8 @@ struct row_data
         storage_count += row.storage_count;
         rdb_block_cache_hit_count += row.rdb_block_cache_hit_count;
         rdb_block_cache_total_count += row.rdb_block_cache_total_count;
+        rdb_row_cache_hit_count += row.rdb_row_cache_hit_count;
+        rdb_row_cache_total_count += row.rdb_row_cache_total_count;
         rdb_index_and_filter_blocks_mem_usage += row.rdb_index_and_filter_blocks_mem_usage;
         rdb_memtable_mem_usage += row.rdb_memtable_mem_usage;
         rdb_estimate_num_keys += row.rdb_estimate_num_keys;
@@ -1339,6 +1341,8 @@ struct row_data
     double storage_count = 0;
     double rdb_block_cache_hit_count = 0;
     double rdb_block_cache_total_count = 0;
+    double rdb_row_cache_hit_count = 0;
+    double rdb_row_cache_total_count = 0;
     double rdb_index_and_filter_blocks_mem_usage = 0;
     double rdb_memtable_mem_usage = 0;
     double rdb_estimate_num_keys = 0;
@@ -1407,6 +1411,8 @@ inline dsn::metric_filters row_data_filters()
         "rdb_total_sst_files",
         "rdb_block_cache_hit_count",
         "rdb_block_cache_total_count",
+        "rdb_row_cache_hit_count",
+        "rdb_row_cache_total_count",
         "rdb_index_and_filter_blocks_mem_usage_bytes",
         "rdb_memtable_mem_usage_bytes",
         "rdb_estimated_keys",
@@ -1457,6 +1463,8 @@ inline stat_var_map create_sums(row_data &row)
         BIND_ROW(rdb_total_sst_files, storage_count),
         BIND_ROW(rdb_block_cache_hit_count, rdb_block_cache_hit_count),
         BIND_ROW(rdb_block_cache_total_count, rdb_block_cache_total_count),
+        BIND_ROW(rdb_row_cache_hit_count, rdb_row_cache_hit_count),
+        BIND_ROW(rdb_row_cache_total_count, rdb_row_cache_total_count),
         BIND_ROW(rdb_index_and_filter_blocks_mem_usage_bytes,
                  rdb_index_and_filter_blocks_mem_usage),
         BIND_ROW(rdb_memtable_mem_usage_bytes, rdb_memtable_mem_usage),
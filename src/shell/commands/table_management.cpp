@@ -575,6 +575,8 @@ bool app_stat(command_executor *e, shell_context *sc, arguments args)
         sum.storage_count += row.storage_count;
         sum.rdb_block_cache_hit_count += row.rdb_block_cache_hit_count;
         sum.rdb_block_cache_total_count += row.rdb_block_cache_total_count;
+        sum.rdb_row_cache_hit_count += row.rdb_row_cache_hit_count;
+        sum.rdb_row_cache_total_count += row.rdb_row_cache_total_count;
         sum.rdb_index_and_filter_blocks_mem_usage += row.rdb_index_and_filter_blocks_mem_usage;
         sum.rdb_memtable_mem_usage += row.rdb_memtable_mem_usage;
         sum.rdb_bf_seek_negatives += row.rdb_bf_seek_negatives;
@@ -628,6 +630,7 @@ bool app_stat(command_executor *e, shell_context *sc, arguments args)
         tp.add_column("mem_idx_mb", tp_alignment::kRight);
     }
     tp.add_column("hit_rate", tp_alignment::kRight);
+    tp.add_column("row_hit_rate", tp_alignment::kRight);
     tp.add_column("seek_n_rate", tp_alignment::kRight);
     tp.add_column("point_n_rate", tp_alignment::kRight);
     tp.add_column("point_fp_rate", tp_alignment::kRight);
@@ -666,6 +669,8 @@ bool app_stat(command_executor *e, shell_context *sc, arguments args)
         }
         tp.append_data(
             convert_to_ratio(row.rdb_block_cache_hit_count, row.rdb_block_cache_total_count));
+        tp.append_data(
+            convert_to_ratio(row.rdb_row_cache_hit_count, row.rdb_row_cache_total_count));
         tp.append_data(convert_to_ratio(row.rdb_bf_seek_negatives, row.rdb_bf_seek_total));
         tp.append_data(
             convert_to_ratio(row.rdb_bf_point_negatives,
@@ -370,6 +370,55 @@ TEST_F(scan_test, OVERALL)
     ASSERT_NO_FATAL_FAILURE(compare(expect_kvs_, data));
 }
 
+TEST_F(scan_test, READ_PUSHDOWN)
+{
+    // Only the first byte of the values whose sort keys start with [a-m] is returned.
+    pegasus_client::pushdown_predicate regex;
+    regex.type = pegasus_client::PPT_SORT_KEY_REGEX;
+    regex.operand = "[a-m].*";
+    std::map<std::string, std::string> expected_data;
+    for (const auto &kv : expect_kvs_[expected_hash_key_]) {
+        if (kv.first[0] >= 'a' && kv.first[0] <= 'm') {
+            expected_data[kv.first] = kv.second.substr(0, 1);
+        }
+    }
+
+    pegasus_client::scan_options options;
+    options.pushdown.predicates.push_back(regex);
+    options.pushdown.value_length = 1;
+    pegasus_client::pegasus_scanner *scanner = nullptr;
+    ASSERT_EQ(PERR_OK, client_->get_scanner(expected_hash_key_, "", "", options, scanner));
+    ASSERT_NE(nullptr, scanner);
+
+    std::map<std::string, std::string> data;
+    std::string hash_key;
+    std::string sort_key;
+    std::string value;
+    int ret;
+    while (PERR_OK == (ret = (scanner->next(hash_key, sort_key, value)))) {
+        ASSERT_EQ(expected_hash_key_, hash_key);
+        check_and_put(data, expected_hash_key_, sort_key, value);
+    }
+    delete scanner;
+    ASSERT_EQ(PERR_SCAN_COMPLETE, ret) << "Error occurred when scan. error="
+                                       << client_->get_error_string(ret);
+    ASSERT_NO_FATAL_FAILURE(compare(expected_data, data, expected_hash_key_));
+
+    // The same records are returned by multi_get.
+    pegasus_client::multi_get_options multi_get_options;
+    multi_get_options.pushdown = options.pushdown;
+    data.clear();
+    ASSERT_EQ(PERR_OK,
+              client_->multi_get(expected_hash_key_, "", "", multi_get_options, data, -1, -1));
+    ASSERT_NO_FATAL_FAILURE(compare(expected_data, data, expected_hash_key_));
+
+    // An invalid regex is rejected.
+    regex.operand = "(";
+    multi_get_options.pushdown.predicates = {regex};
+    ASSERT_EQ(PERR_INVALID_ARGUMENT,
+              client_->multi_get(expected_hash_key_, "", "", multi_get_options, data, -1, -1));
+}
+
 TEST_F(scan_test, REQUEST_EXPIRE_TS)
 {
     pegasus_client::scan_options options;
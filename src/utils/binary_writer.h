@@ -69,6 +69,10 @@ public:
     void write(const blob &val);
     void write_empty(int sz);
 
+    // Refer to the buffer of `val` rather than copying it, return false if it's not supported by
+    // the writer and the data should be copied, see rpc_write_stream.
+    virtual bool write_zero_copy(const blob &val) { return false; }
+
     bool next(void **data, int *size);
     bool backup(int count);
 
@@ -85,6 +89,9 @@ protected:
     void create_buffer(size_t size);
     void commit();
     virtual void create_new_buffer(size_t size, /*out*/ blob &bb);
+    // Account for the `size` bytes that the derived class has put into the underlying storage
+    // directly. Preconditions: the writer has been flushed.
+    void add_external_size(int size) { _total_size += size; }
 
 private:
     std::vector<blob> _buffers;
@@ -90,6 +90,7 @@ public:
         _buffer = _holder.get();
         _data = _holder.get() + offset;
         _length = length;
+        _zero_copy_write = false;
     }
 
     void assign(std::shared_ptr<char> &&buffer, int offset, unsigned int length)
@@ -98,6 +99,7 @@ public:
         _buffer = (_holder.get());
         _data = (_holder.get() + offset);
         _length = length;
+        _zero_copy_write = false;
     }
 
     /// Deprecated. Use absl::string_view whenever possible.
@@ -107,6 +109,7 @@ public:
         _buffer = buffer;
         _data = buffer + offset;
         _length = length;
+        _zero_copy_write = false;
     }
 
     const char *data() const noexcept { return _data; }
@@ -170,12 +173,35 @@ public:
     uint32_t read(::apache::thrift::protocol::TProtocol *iprot);
     uint32_t write(::apache::thrift::protocol::TProtocol *oprot) const;
 
+    /// Opt in to being referred to rather than copied by the transport while serialized, which
+    /// holds the buffer until the data is sent. Only use it for the blobs whose buffers are never
+    /// modified afterwards, e.g. the values read for a response.
+    void enable_zero_copy_write() { _zero_copy_write = true; }
+    bool zero_copy_write() const { return _zero_copy_write; }
+
+    /// The blobs shorter than it are always copied while serialized, since it's cheaper than
+    /// splitting the buffers of the message.
+    static constexpr unsigned int kMinZeroCopyWriteLength = 4096;
+
 private:
     friend class binary_writer;
     std::shared_ptr<char> _holder;
     const char *_buffer{nullptr};
     const char *_data{nullptr};
     unsigned int _length{0}; // data length
+    bool _zero_copy_write{false};
+};
+
+/// Implemented by the thrift transports that are able to refer to the buffer of a blob instead of
+/// copying it, e.g. the transport writing a rpc message.
+class zero_copy_transport
+{
+public:
+    virtual ~zero_copy_transport() = default;
+
+    /// Write the data of `bb` by referring to its buffer, return false if the data should be
+    /// copied instead.
+    virtual bool write_zero_copy(const blob &bb) = 0;
 };
 
 class blob_string
@@ -217,6 +243,20 @@ inline uint32_t blob::write(apache::thrift::protocol::TProtocol *oprot) const
 {
     apache::thrift::protocol::TBinaryProtocol *binary_proto =
         static_cast<apache::thrift::protocol::TBinaryProtocol *>(oprot);
+
+    // Large blobs owning a ref-counted buffer are not copied but referred to by the transport if
+    // they opt in and it's possible, see enable_zero_copy_write().
+    if (_zero_copy_write && _holder != nullptr && _length >= kMinZeroCopyWriteLength) {
+        auto transport = oprot->getTransport();
+        auto *zero_copy = dynamic_cast<zero_copy_transport *>(transport.get());
+        if (zero_copy != nullptr) {
+            uint32_t xfer = binary_proto->writeI32(static_cast<int32_t>(_length));
+            if (!zero_copy->write_zero_copy(*this)) {
+                transport->write(reinterpret_cast<const uint8_t *>(_data), _length);
+            }
+            return xfer + _length;
+        }
+    }
     return binary_proto->writeString<blob_string>(blob_string(const_cast<blob &>(*this)));
 }
 
@@ -25,8 +25,14 @@
  */
 
 #include <cstdio>
+#include <cstring>
 #include "utils/crc.h"
 
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#include <wmmintrin.h>
+#endif
+
 namespace dsn {
 namespace utils {
 
@@ -131,6 +137,24 @@ struct crc_generator
         return (r);
     };
 
+    //
+    // Returns (x ** uBits) mod POLY
+    //
+    static uintxx_t ComputeX_Bits(uint64_t uBits)
+    {
+        uintxx_t r;
+
+        r = MSB; // r = 1
+        for (; uBits != 0; --uBits) {
+            if (r & 1)
+                r = (r >> 1) ^ POLY;
+            else
+                r >>= 1;
+        }
+
+        return (r);
+    };
+
     //
     // Allows to change initial CRC value
     //
@@ -439,12 +463,182 @@ uint64_t crc64::_crc_table[sizeof(crc64::_crc_table) / sizeof(crc64::_crc_table[
 #undef crc64_POLY
 #undef BIT64
 #undef BIT32
+
+namespace {
+
+#if defined(__x86_64__)
+
+//
+// The polynomial of crc32 is the one of CRC-32C (Castagnoli), thus could be computed by the
+// crc32 instruction of SSE4.2, which processes 8 bytes at a time.
+//
+__attribute__((target("sse4.2"))) uint32_t
+crc32_compute_sse42(const void *pSrc, size_t uSize, uint32_t uCrc)
+{
+    const uint8_t *pData = (const uint8_t *)pSrc;
+    uint64_t uCrc64 = (uint32_t)~uCrc;
+
+    for (; uSize > 7; uSize -= 8, pData += 8) {
+        uint64_t uWord;
+        memcpy(&uWord, pData, sizeof(uWord));
+        uCrc64 = _mm_crc32_u64(uCrc64, uWord);
+    }
+
+    uint32_t uCrc32 = (uint32_t)uCrc64;
+    for (; uSize > 0; uSize -= 1, pData += 1)
+        uCrc32 = _mm_crc32_u8(uCrc32, pData[0]);
+
+    return ~uCrc32;
+}
+
+//
+// Computes CRC by folding the data with carry-less multiplications (PCLMULQDQ), see "Fast CRC
+// Computation for Generic Polynomials Using PCLMULQDQ Instruction" by Intel.
+//
+// Since CRC(A) == CRC(B) as long as A == B mod POLY (with the initial CRC xor-ed into the
+// first bytes and the double NOTs stripped), the data are folded 64 bytes at a time into 4
+// lanes of 128 bits, then into a single 128-bit block congruent to all the data before it.
+// The last block and the remaining bytes are left to `tail`, instead of Barrett reduction.
+//
+// "a" and "b" of 64 bits are represented in "reversed" order, thus the 128-bit result of
+// clmul(a, b) is actually (a * b * x); and for a 128-bit block X = (lo, hi) followed by
+// uBits bits of data,
+//      X * x**uBits = lo * x**(64 + uBits) + hi * x**uBits
+//                  == clmul(lo, x**(63 + uBits) mod POLY) + clmul(hi, x**(uBits - 1) mod POLY)
+//
+template <typename crc_gen>
+class crc_folder
+{
+public:
+    typedef typename crc_gen::uint uintxx_t;
+    typedef uintxx_t (*tail_func)(const void *, size_t, uintxx_t);
+
+    crc_folder()
+        : _k128(make_key(128)), _k256(make_key(256)), _k384(make_key(384)), _k512(make_key(512))
+    {
+    }
+
+    __attribute__((target("pclmul,sse4.1"))) uintxx_t compute(const void *pSrc,
+                                                               size_t uSize,
+                                                               uintxx_t uCrc,
+                                                               tail_func tail) const
+    {
+        if (uSize < 64) {
+            return tail(pSrc, uSize, uCrc);
+        }
+
+        const uint8_t *pData = (const uint8_t *)pSrc;
+
+        __m128i x0 = _mm_loadu_si128((const __m128i *)(pData + 0));
+        __m128i x1 = _mm_loadu_si128((const __m128i *)(pData + 16));
+        __m128i x2 = _mm_loadu_si128((const __m128i *)(pData + 32));
+        __m128i x3 = _mm_loadu_si128((const __m128i *)(pData + 48));
+        x0 = _mm_xor_si128(x0, _mm_cvtsi64_si128((int64_t)(uint64_t)(uintxx_t)~uCrc));
+        pData += 64;
+        uSize -= 64;
+
+        for (; uSize > 63; uSize -= 64, pData += 64) {
+            x0 = fold(x0, _k512, _mm_loadu_si128((const __m128i *)(pData + 0)));
+            x1 = fold(x1, _k512, _mm_loadu_si128((const __m128i *)(pData + 16)));
+            x2 = fold(x2, _k512, _mm_loadu_si128((const __m128i *)(pData + 32)));
+            x3 = fold(x3, _k512, _mm_loadu_si128((const __m128i *)(pData + 48)));
+        }
+
+        x3 = fold(x2, _k128, x3);
+        x3 = fold(x1, _k256, x3);
+        x3 = fold(x0, _k384, x3);
+
+        for (; uSize > 15; uSize -= 16, pData += 16) {
+            x3 = fold(x3, _k128, _mm_loadu_si128((const __m128i *)pData));
+        }
+
+        uint8_t uBlock[16];
+        _mm_storeu_si128((__m128i *)uBlock, x3);
+        uCrc = tail(uBlock, sizeof(uBlock), ~(uintxx_t)0);
+        return tail(pData, uSize, uCrc);
+    }
+
+private:
+    static __m128i make_key(uint64_t uBits)
+    {
+        // Align the remainders of crc32 to the "reversed" 64 bits.
+        const int shift = 64 - 8 * sizeof(uintxx_t);
+        const uint64_t lo = (uint64_t)crc_gen::ComputeX_Bits(63 + uBits) << shift;
+        const uint64_t hi = (uint64_t)crc_gen::ComputeX_Bits(uBits - 1) << shift;
+        return _mm_set_epi64x((int64_t)hi, (int64_t)lo);
+    }
+
+    // Returns X * x**uBits + Y, where uBits is the distance that `key` is made for.
+    __attribute__((target("pclmul,sse4.1"))) static __m128i fold(__m128i x, __m128i key, __m128i y)
+    {
+        const __m128i lo = _mm_clmulepi64_si128(x, key, 0x00);
+        const __m128i hi = _mm_clmulepi64_si128(x, key, 0x11);
+        return _mm_xor_si128(_mm_xor_si128(lo, hi), y);
+    }
+
+    const __m128i _k128;
+    const __m128i _k256;
+    const __m128i _k384;
+    const __m128i _k512;
+};
+
+uint32_t crc32_compute_clmul(const void *pSrc, size_t uSize, uint32_t uCrc)
+{
+    static const crc_folder<crc32> folder;
+    return folder.compute(pSrc, uSize, uCrc, crc32_compute_sse42);
+}
+
+uint64_t crc64_compute_clmul(const void *pSrc, size_t uSize, uint64_t uCrc)
+{
+    static const crc_folder<crc64> folder;
+    return folder.compute(pSrc, uSize, uCrc, crc64::compute);
+}
+
+#endif // defined(__x86_64__)
+
+typedef uint32_t (*crc32_func)(const void *, size_t, uint32_t);
+typedef uint64_t (*crc64_func)(const void *, size_t, uint64_t);
+
+// Choose the fastest implementation supported by the current CPU at runtime, all of which give
+// the same results as the portable ones by table lookups.
+crc32_func select_crc32_compute()
+{
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) {
+        if (__builtin_cpu_supports("pclmul")) {
+            return crc32_compute_clmul;
+        }
+        return crc32_compute_sse42;
+    }
+#endif
+    return crc32::compute;
+}
+
+crc64_func select_crc64_compute()
+{
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("pclmul")) {
+        return crc64_compute_clmul;
+    }
+#endif
+    return crc64::compute;
+}
+
+} // anonymous namespace
 }
 }
 
 namespace dsn {
 namespace utils {
 uint32_t crc32_calc(const void *ptr, size_t size, uint32_t init_crc)
+{
+    static const crc32_func compute = select_crc32_compute();
+    return compute(ptr, size, init_crc);
+}
+
+uint32_t crc32_calc_portable(const void *ptr, size_t size, uint32_t init_crc)
 {
     return dsn::utils::crc32::compute(ptr, size, init_crc);
 }
@@ -462,6 +656,12 @@ uint32_t crc32_concat(uint32_t xy_init,
 }
 
 uint64_t crc64_calc(const void *ptr, size_t size, uint64_t init_crc)
+{
+    static const crc64_func compute = select_crc64_compute();
+    return compute(ptr, size, init_crc);
+}
+
+uint64_t crc64_calc_portable(const void *ptr, size_t size, uint64_t init_crc)
 {
     return dsn::utils::crc64::compute(ptr, size, init_crc);
 }
@@ -34,8 +34,14 @@
 namespace dsn {
 namespace utils {
 
+// Computes CRC with the fastest implementation supported by the current CPU (e.g. SSE4.2 and
+// PCLMULQDQ on x86-64), which is chosen at runtime.
 uint32_t crc32_calc(const void *ptr, size_t size, uint32_t init_crc);
 
+// The portable implementation by table lookups, which always gives the same result as
+// crc32_calc().
+uint32_t crc32_calc_portable(const void *ptr, size_t size, uint32_t init_crc);
+
 //
 // Given
 //      x_final = crc32_calc(x_ptr, x_size, x_init);
@@ -55,6 +61,8 @@ uint32_t crc32_concat(uint32_t xy_init,
 
 uint64_t crc64_calc(const void *ptr, size_t size, uint64_t init_crc);
 
+uint64_t crc64_calc_portable(const void *ptr, size_t size, uint64_t init_crc);
+
 //
 // Given
 //      x_final = crc64_calc(x_ptr, x_size, x_init);
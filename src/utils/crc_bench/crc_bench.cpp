@@ -0,0 +1,131 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <fmt/core.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "utils/crc.h"
+#include "utils/rand.h"
+#include "utils/string_conv.h"
+#include "utils/strings.h"
+#include "utils/time_utils.h"
+
+namespace {
+
+void print_usage(const char *cmd)
+{
+    fmt::print(stderr, "USAGE: {} <num_operations> <buffer_size> <crc_type> <impl_type>\n", cmd);
+    fmt::print(stderr, "Run a simple benchmark that computes CRC of a buffer repeatedly.\n\n");
+
+    fmt::print(stderr, "    <num_operations>       the number of computations\n");
+    fmt::print(stderr, "    <buffer_size>          the size of the buffer in bytes\n");
+    fmt::print(stderr, "    <crc_type>             the type of CRC: crc32, crc64\n");
+    fmt::print(stderr,
+               "    <impl_type>            the type of implementation: portable, auto (the "
+               "fastest one supported by the CPU)\n");
+}
+
+template <typename uintxx_t>
+void run_bench(int64_t num_operations,
+               const std::vector<uint8_t> &buffer,
+               uintxx_t (*calc)(const void *, size_t, uintxx_t),
+               const char *name)
+{
+    uintxx_t crc = 0;
+
+    dsn::utils::chronograph timer;
+    for (int64_t i = 0; i < num_operations; ++i) {
+        crc = calc(buffer.data(), buffer.size(), crc);
+    }
+    const auto elapsed_ns = std::max<uint64_t>(timer.duration_ns(), 1);
+
+    fmt::print(stdout,
+               "Running {} computations of {} over {} bytes, crc = {:#x}, cost {} ms, "
+               "throughput = {:.2f} MB/s\n",
+               num_operations,
+               name,
+               buffer.size(),
+               crc,
+               elapsed_ns / 1000000.0,
+               1000.0 * num_operations * buffer.size() / elapsed_ns);
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 5) {
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    int64_t num_operations;
+    if (!dsn::buf2int64(argv[1], num_operations)) {
+        fmt::print(stderr, "Invalid num_operations: {}\n\n", argv[1]);
+
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    int64_t buffer_size;
+    if (!dsn::buf2int64(argv[2], buffer_size) || buffer_size < 0) {
+        fmt::print(stderr, "Invalid buffer_size: {}\n\n", argv[2]);
+
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    std::vector<uint8_t> buffer(buffer_size);
+    for (auto &b : buffer) {
+        b = static_cast<uint8_t>(dsn::rand::next_u32(0, 255));
+    }
+
+    const char *crc_type = argv[3];
+    const char *impl_type = argv[4];
+    const bool portable = dsn::utils::equals(impl_type, "portable");
+    if (!portable && !dsn::utils::equals(impl_type, "auto")) {
+        fmt::print(stderr, "Invalid impl_type: {}\n\n", impl_type);
+
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    const std::string name = fmt::format("{}({})", crc_type, impl_type);
+    if (dsn::utils::equals(crc_type, "crc32")) {
+        run_bench<uint32_t>(num_operations,
+                            buffer,
+                            portable ? dsn::utils::crc32_calc_portable : dsn::utils::crc32_calc,
+                            name.c_str());
+    } else if (dsn::utils::equals(crc_type, "crc64")) {
+        run_bench<uint64_t>(num_operations,
+                            buffer,
+                            portable ? dsn::utils::crc64_calc_portable : dsn::utils::crc64_calc,
+                            name.c_str());
+    } else {
+        fmt::print(stderr, "Invalid crc_type: {}\n\n", crc_type);
+
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    return 0;
+}
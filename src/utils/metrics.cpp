@@ -56,6 +56,17 @@ dsn::metric_entity_ptr server_metric_entity()
 
 namespace dsn {
 
+namespace {
+
+// The metrics that own timers, which should be closed before destructed.
+inline bool is_closeable_metric(const metric *m)
+{
+    const auto type = m->prototype()->type();
+    return type == metric_type::kPercentile || type == metric_type::kHistogram;
+}
+
+} // anonymous namespace
+
 metric_entity::metric_entity(const metric_entity_prototype *prototype,
                              const std::string &id,
                              const attr_map &attrs)
@@ -81,7 +92,7 @@ void metric_entity::close(close_option option)
     // It's inefficient to wait for each metric to be closed one by one. Therefore, the metric is
     // not closed in its destructor.
     for (auto &m : _metrics) {
-        if (m.second->prototype()->type() == metric_type::kPercentile) {
+        if (is_closeable_metric(m.second.get())) {
             auto p = down_cast<closeable_metric *>(m.second.get());
             p->close();
         }
@@ -93,7 +104,7 @@ void metric_entity::close(close_option option)
 
     // Wait for all of the close operations to be finished.
     for (auto &m : _metrics) {
-        if (m.second->prototype()->type() == metric_type::kPercentile) {
+        if (is_closeable_metric(m.second.get())) {
             auto p = down_cast<closeable_metric *>(m.second.get());
             p->wait();
         }
@@ -315,7 +326,8 @@ inline std::string encode_error_as_json(const char *error_message)
 
 dsn::metric_filters::metric_fields_type get_brief_metric_fields()
 {
-    dsn::metric_filters::metric_fields_type fields = {kMetricNameField, kMetricSingleValueField};
+    dsn::metric_filters::metric_fields_type fields = {
+        kMetricNameField, kMetricSingleValueField, kMetricHistogramCountField};
     for (const auto &kth : kAllKthPercentiles) {
         fields.insert(kth.name);
     }
@@ -676,6 +688,213 @@ metric::metric(const metric_prototype *prototype) : _prototype(prototype) {}
 
 closeable_metric::closeable_metric(const metric_prototype *prototype) : metric(prototype) {}
 
+int64_t histogram_bucket_highest_value(size_t index)
+{
+    CHECK_LT(index, kHistogramBucketCount);
+    if (index < kHistogramSubBucketCount) {
+        return static_cast<int64_t>(index);
+    }
+
+    const size_t half_count = kHistogramSubBucketCount / 2;
+    const size_t shift = index / half_count - 1;
+    const uint64_t offset = index - shift * half_count;
+    return static_cast<int64_t>(((offset + 1) << shift) - 1);
+}
+
+void histogram_snapshot::add(size_t index, uint64_t count)
+{
+    CHECK_LT(index, kHistogramBucketCount);
+    _buckets[index] += count;
+    _count += count;
+}
+
+void histogram_snapshot::merge(const histogram_snapshot &other)
+{
+    for (const auto &bucket : other._buckets) {
+        add(bucket.first, bucket.second);
+    }
+}
+
+int64_t histogram_snapshot::value(kth_percentile_type type) const
+{
+    if (_count == 0) {
+        return 0;
+    }
+
+    // Find the bucket of the nth value in the same way as the percentile.
+    const auto nth = kth_percentile_to_nth_index(_count, type);
+    uint64_t accumulated = 0;
+    for (const auto &bucket : _buckets) {
+        accumulated += bucket.second;
+        if (accumulated > nth) {
+            return histogram_bucket_highest_value(bucket.first);
+        }
+    }
+    return histogram_bucket_highest_value(_buckets.rbegin()->first);
+}
+
+histogram::histogram(const metric_prototype *prototype,
+                     uint64_t interval_ms,
+                     size_t window_count,
+                     const std::set<kth_percentile_type> &kth_percentiles)
+    : closeable_metric(prototype), _window_count(window_count)
+{
+    CHECK_GT(_window_count, 0);
+
+    for (const auto &kth : kth_percentiles) {
+        _kth_percentile_bitset.set(static_cast<size_t>(kth));
+    }
+
+    for (auto &stripe : _stripes) {
+        stripe.store(nullptr, std::memory_order_relaxed);
+    }
+
+#ifdef MOCK_TEST
+    if (interval_ms == 0) {
+        // Timer is disabled.
+        return;
+    }
+#else
+    CHECK_GT(interval_ms, 0);
+#endif
+
+    // The ref count is decremented by on_close() once the timer is closed, the same as the
+    // percentile.
+    add_ref();
+    _timer.reset(new metric_timer(interval_ms,
+                                  std::bind(&histogram::rotate, this),
+                                  std::bind(&histogram::on_close, this)));
+}
+
+histogram::~histogram()
+{
+    for (auto &stripe : _stripes) {
+        delete[] stripe.load(std::memory_order_acquire);
+    }
+}
+
+std::atomic<uint32_t> *histogram::allocate_stripe(size_t index)
+{
+    // Each stripe is allocated separately, so that the threads recording into different stripes
+    // do not share any cache line.
+    auto *stripe = new std::atomic<uint32_t>[kHistogramBucketCount]();
+    std::atomic<uint32_t> *expected = nullptr;
+    if (_stripes[index].compare_exchange_strong(expected, stripe, std::memory_order_acq_rel)) {
+        return stripe;
+    }
+
+    // Another thread sharing the stripe has allocated it first.
+    delete[] stripe;
+    return expected;
+}
+
+bool histogram::get(kth_percentile_type type, value_type &val) const
+{
+    const auto index = static_cast<size_t>(type);
+    CHECK_LT(index, static_cast<size_t>(kth_percentile_type::COUNT));
+
+    utils::auto_lock<utils::ex_lock_nr> l(_windows_lock);
+    val = _sliding_window.value(type);
+    return _kth_percentile_bitset.test(index);
+}
+
+histogram_snapshot histogram::snapshot() const
+{
+    utils::auto_lock<utils::ex_lock_nr> l(_windows_lock);
+    return _sliding_window;
+}
+
+void histogram::take_snapshot(metric_json_writer &writer, const metric_filters &filters)
+{
+    const auto window = snapshot();
+
+    writer.StartObject();
+
+    encode_prototype(writer, filters);
+    encode(writer, kMetricHistogramCountField, window.count(), filters);
+
+    for (size_t i = 0; i < static_cast<size_t>(kth_percentile_type::COUNT); ++i) {
+        if (!_kth_percentile_bitset.test(i)) {
+            continue;
+        }
+
+        encode(writer,
+               kAllKthPercentiles[i].name,
+               window.value(static_cast<kth_percentile_type>(i)),
+               filters);
+    }
+
+    if (filters.match_with_metric_field(kMetricHistogramBucketsField)) {
+        writer.Key(kMetricHistogramBucketsField.c_str());
+        writer.StartArray();
+        for (const auto &bucket : window.buckets()) {
+            writer.StartArray();
+            json::json_encode(writer, histogram_bucket_highest_value(bucket.first));
+            json::json_encode(writer, bucket.second);
+            writer.EndArray();
+        }
+        writer.EndArray();
+    }
+
+    writer.EndObject();
+}
+
+void histogram::close()
+{
+    if (_timer) {
+        _timer->close();
+    }
+}
+
+void histogram::wait()
+{
+    if (_timer) {
+        _timer->wait();
+    }
+}
+
+void histogram::on_close() { release_ref(); }
+
+void histogram::rotate()
+{
+    histogram_snapshot window;
+    for (auto &s : _stripes) {
+        auto *stripe = s.load(std::memory_order_acquire);
+        if (stripe == nullptr) {
+            // No observation has ever been recorded into this stripe.
+            continue;
+        }
+
+        for (size_t i = 0; i < kHistogramBucketCount; ++i) {
+            // Load before exchanging to avoid writing the cache lines of the empty buckets.
+            if (stripe[i].load(std::memory_order_relaxed) != 0) {
+                window.add(i, stripe[i].exchange(0, std::memory_order_relaxed));
+            }
+        }
+    }
+
+    utils::auto_lock<utils::ex_lock_nr> l(_windows_lock);
+    _windows.push_back(std::move(window));
+    while (_windows.size() > _window_count) {
+        _windows.pop_front();
+    }
+
+    histogram_snapshot sliding_window;
+    for (const auto &w : _windows) {
+        sliding_window.merge(w);
+    }
+    _sliding_window = std::move(sliding_window);
+}
+
+size_t histogram::current_stripe()
+{
+    // Spread the threads over the stripes in the round-robin way.
+    static std::atomic<size_t> next_stripe(0);
+    static thread_local size_t stripe =
+        next_stripe.fetch_add(1, std::memory_order_relaxed) % kStripeCount;
+    return stripe;
+}
+
 uint64_t metric_timer::generate_initial_delay_ms(uint64_t interval_ms)
 {
     CHECK_GT(interval_ms, 0);
@@ -23,11 +23,14 @@
 #include <rapidjson/ostreamwrapper.h>
 #include <stddef.h>
 #include <algorithm>
+#include <array>
 #include <atomic>
 #include <bitset>
 #include <chrono>
+#include <deque>
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <new>
 #include <ratio>
@@ -133,6 +136,11 @@ class error_code;
     dsn::floating_percentile_prototype<double> METRIC_##name(                                      \
         {#entity_type, dsn::metric_type::kPercentile, #name, unit, desc, ##__VA_ARGS__})
 
+// The histogram supports only non-negative int64 values, such as latencies.
+#define METRIC_DEFINE_histogram(entity_type, name, unit, desc, ...)                                \
+    dsn::histogram_prototype METRIC_##name(                                                        \
+        {#entity_type, dsn::metric_type::kHistogram, #name, unit, desc, ##__VA_ARGS__})
+
 // The following macros act as forward declarations for entity types and metric prototypes.
 #define METRIC_DECLARE_entity(name) extern ::dsn::metric_entity_prototype METRIC_ENTITY_##name
 #define METRIC_DECLARE_gauge_int64(name) extern ::dsn::gauge_prototype<int64_t> METRIC_##name
@@ -149,6 +157,7 @@ class error_code;
     extern dsn::percentile_prototype<int64_t> METRIC_##name
 #define METRIC_DECLARE_percentile_double(name)                                                     \
     extern dsn::floating_percentile_prototype<double> METRIC_##name
+#define METRIC_DECLARE_histogram(name) extern dsn::histogram_prototype METRIC_##name
 
 // Following METRIC_VAR* macros are introduced so that:
 // * only need to use prototype name to operate each metric variable;
@@ -169,6 +178,8 @@ class error_code;
     METRIC_VAR_DECLARE(name, __VA_ARGS__ dsn::counter_ptr<dsn::striped_long_adder, false>)
 #define METRIC_VAR_DECLARE_percentile_int64(name, ...)                                             \
     METRIC_VAR_DECLARE(name, __VA_ARGS__ dsn::percentile_ptr<int64_t>)
+#define METRIC_VAR_DECLARE_histogram(name, ...)                                                    \
+    METRIC_VAR_DECLARE(name, __VA_ARGS__ dsn::histogram_ptr)
 
 // Macro METRIC_VAR_DEFINE* are used for the metric that is a static member of a class:
 // * `clazz` is the name of the class;
@@ -237,7 +248,8 @@ class error_code;
 // Read the current measurement of gauges and counters.
 #define METRIC_VAR_VALUE(name) METRIC_VAR_NAME(name)->value()
 
-// Convenient macro that is used to compute latency automatically, which is dedicated to percentile.
+// Convenient macro that is used to compute latency automatically, which is dedicated to percentile
+// and histogram.
 #define METRIC_VAR_AUTO_LATENCY(name, ...)                                                         \
     dsn::auto_latency __##name##_auto_latency(METRIC_VAR_NAME(name), ##__VA_ARGS__)
 
@@ -755,7 +767,8 @@ private:
     DEF(Gauge)                                                                                     \
     DEF(Counter)                                                                                   \
     DEF(VolatileCounter)                                                                           \
-    DEF(Percentile)
+    DEF(Percentile)                                                                                \
+    DEF(Histogram)
 
 enum class metric_type
 {
@@ -808,7 +821,10 @@ ENUM_END(metric_type)
     DEF(FileLoads)                                                                                 \
     DEF(FileUploads)                                                                               \
     DEF(BulkLoads)                                                                                 \
-    DEF(Beacons)
+    DEF(Beacons)                                                                                   \
+    DEF(Batches)                                                                                   \
+    DEF(Contexts)                                                                                  \
+    DEF(Messages)
 
 enum class metric_unit : size_t
 {
@@ -1584,35 +1600,201 @@ template <typename T,
 using floating_percentile_prototype =
     metric_prototype_with<floating_percentile<T, NthElementFinder>>;
 
-// Compute latency automatically at the end of the scope, which is set to percentile which it has
-// bound to.
+const std::string kMetricHistogramCountField = "count";
+const std::string kMetricHistogramBucketsField = "buckets";
+
+// The buckets of histograms are log-linear, in the same way as HdrHistogram: the values less than
+// kHistogramSubBucketCount are counted exactly, while each following range of [2^n, 2^(n+1)) is
+// split into kHistogramSubBucketCount / 2 buckets of the same width. Thus any value is counted
+// with a relative error less than 2 / kHistogramSubBucketCount (about 3%).
+//
+// The values are clamped into [0, kHistogramMaxValue], which is about 18 minutes in nanoseconds.
+const int kHistogramSubBucketBits = 6;
+const size_t kHistogramSubBucketCount = 1 << kHistogramSubBucketBits;
+const int kHistogramMaxValueBits = 40;
+const int64_t kHistogramMaxValue = (int64_t(1) << kHistogramMaxValueBits) - 1;
+const size_t kHistogramBucketCount =
+    (kHistogramMaxValueBits - kHistogramSubBucketBits + 2) * (kHistogramSubBucketCount / 2);
+
+// Get the index of the bucket which counts `value`.
+inline size_t histogram_bucket_index(int64_t value)
+{
+    if (dsn_unlikely(value < 0)) {
+        value = 0;
+    } else if (dsn_unlikely(value > kHistogramMaxValue)) {
+        value = kHistogramMaxValue;
+    }
+
+    const auto val = static_cast<uint64_t>(value);
+    if (val < kHistogramSubBucketCount) {
+        return static_cast<size_t>(val);
+    }
+
+    // Shift the value into [kHistogramSubBucketCount / 2, kHistogramSubBucketCount), which is
+    // the offset of the bucket in its range.
+    const int shift = 64 - __builtin_clzll(val) - kHistogramSubBucketBits;
+    return static_cast<size_t>(shift) * (kHistogramSubBucketCount / 2) +
+           static_cast<size_t>(val >> shift);
+}
+
+// Get the highest value counted by the bucket of `index`, which is reported for all the values
+// in the bucket.
+int64_t histogram_bucket_highest_value(size_t index);
+
+// The counts of the histogram buckets, which could be merged with the ones of other histograms
+// (e.g. the same metric from other servers), since all histograms share the same buckets.
+class histogram_snapshot
+{
+public:
+    // Bucket index => count, only non-empty buckets are included.
+    using bucket_map = std::map<size_t, uint64_t>;
+
+    void add(size_t index, uint64_t count);
+    void merge(const histogram_snapshot &other);
+
+    // Get the kth percentile of all the values counted by the snapshot, or 0 if it is empty.
+    int64_t value(kth_percentile_type type) const;
+
+    uint64_t count() const { return _count; }
+    const bucket_map &buckets() const { return _buckets; }
+
+private:
+    bucket_map _buckets;
+    uint64_t _count{0};
+};
+
+// The histogram is a metric type that counts all observations into log-linear buckets (see
+// kHistogramSubBucketBits), rather than sampling some of them like the percentile.
+//
+// The observations are recorded lock-free into one of several stripes chosen by the thread, and
+// drained periodically into a new window, while the oldest window is dropped. The kth percentiles
+// are computed over the sliding time window of the latest `window_count` windows.
+//
+// Besides the configured kth percentiles, the non-empty buckets of the sliding window are also
+// taken in the snapshot. Since all histograms share the same buckets, the snapshots of the same
+// metric from different servers could be merged to compute the kth percentiles of the whole
+// cluster, which is impossible for the percentiles of the servers.
+class histogram : public closeable_metric
+{
+public:
+    using value_type = int64_t;
+
+    void set(const value_type &val) { set(1, val); }
+
+    void set(size_t n, const value_type &val)
+    {
+        get_stripe(current_stripe())[histogram_bucket_index(val)].fetch_add(
+            static_cast<uint32_t>(n), std::memory_order_relaxed);
+    }
+
+    // If `type` is not configured, it will return false with the value still stored in `val`.
+    bool get(kth_percentile_type type, value_type &val) const;
+
+    // Get the buckets of the sliding window.
+    histogram_snapshot snapshot() const;
+
+    // The snapshot collected has following json format:
+    // {
+    //     "name": "<metric_name>",
+    //     "count": ...,
+    //     "p50": ...,
+    //     "p90": ...,
+    //     ...
+    //     "buckets": [[<highest_value>, <count>], ...]
+    // }
+    // where "count" is the number of the observations in the sliding window, with each configured
+    // kth percentile followed, and "buckets" are the non-empty buckets in ascending order, each of
+    // which is identified by the highest value it counts.
+    void take_snapshot(metric_json_writer &writer, const metric_filters &filters) override;
+
+    bool timer_enabled() const { return !!_timer; }
+
+    static const size_t kDefaultWindowCount = 6;
+    static const size_t kStripeCount = 4;
+
+protected:
+    // interval_ms is the interval between drains of the stripes, namely the length of each
+    // window. The sliding time window is `interval_ms * window_count` long.
+    histogram(const metric_prototype *prototype,
+              uint64_t interval_ms = 10000,
+              size_t window_count = kDefaultWindowCount,
+              const std::set<kth_percentile_type> &kth_percentiles = kAllKthPercentileTypes);
+
+    virtual ~histogram();
+
+private:
+    friend class metric_entity;
+    friend class ref_ptr<histogram>;
+    friend class MetricVarTest;
+
+    void close() override;
+    void wait() override;
+    void on_close();
+
+    // Drain the stripes into a new window, and drop the oldest window out of the sliding window.
+    void rotate();
+
+    static size_t current_stripe();
+
+    std::atomic<uint32_t> *get_stripe(size_t index)
+    {
+        auto *stripe = _stripes[index].load(std::memory_order_acquire);
+        if (dsn_likely(stripe != nullptr)) {
+            return stripe;
+        }
+        return allocate_stripe(index);
+    }
+
+    std::atomic<uint32_t> *allocate_stripe(size_t index);
+
+    const size_t _window_count;
+    std::bitset<static_cast<size_t>(kth_percentile_type::COUNT)> _kth_percentile_bitset;
+
+    // Each stripe is allocated on its first observation, so that a histogram only recorded by few
+    // threads (e.g. the per-replica ones) does not pay for all the stripes. The counts of a
+    // stripe are 32-bit since they are drained into the window on each interval.
+    std::array<std::atomic<std::atomic<uint32_t> *>, kStripeCount> _stripes;
+
+    // Protect the windows, which are only updated by the timer.
+    mutable utils::ex_lock_nr _windows_lock;
+    std::deque<histogram_snapshot> _windows;
+    histogram_snapshot _sliding_window;
+
+    std::unique_ptr<metric_timer> _timer;
+
+    DISALLOW_COPY_AND_ASSIGN(histogram);
+};
+
+using histogram_ptr = ref_ptr<histogram>;
+using histogram_prototype = metric_prototype_with<histogram>;
+
+// Compute latency automatically at the end of the scope, which is set to the percentile or the
+// histogram which it has bound to.
+template <typename MetricPtr>
 class auto_latency
 {
 public:
-    auto_latency(const percentile_ptr<int64_t> &p) : _percentile(p) {}
+    auto_latency(const MetricPtr &m) : _metric(m) {}
 
-    auto_latency(const percentile_ptr<int64_t> &p, std::function<void(uint64_t)> callback)
-        : _percentile(p), _callback(std::move(callback))
+    auto_latency(const MetricPtr &m, std::function<void(uint64_t)> callback)
+        : _metric(m), _callback(std::move(callback))
     {
     }
 
-    auto_latency(const percentile_ptr<int64_t> &p, uint64_t start_time_ns)
-        : _percentile(p), _chrono(start_time_ns)
+    auto_latency(const MetricPtr &m, uint64_t start_time_ns) : _metric(m), _chrono(start_time_ns)
     {
     }
 
-    auto_latency(const percentile_ptr<int64_t> &p,
-                 uint64_t start_time_ns,
-                 std::function<void(uint64_t)> callback)
-        : _percentile(p), _chrono(start_time_ns), _callback(std::move(callback))
+    auto_latency(const MetricPtr &m, uint64_t start_time_ns, std::function<void(uint64_t)> callback)
+        : _metric(m), _chrono(start_time_ns), _callback(std::move(callback))
     {
     }
 
     ~auto_latency()
     {
         auto latency =
-            convert_metric_latency_from_ns(_chrono.duration_ns(), _percentile->prototype()->unit());
-        _percentile->set(static_cast<int64_t>(latency));
+            convert_metric_latency_from_ns(_chrono.duration_ns(), _metric->prototype()->unit());
+        _metric->set(static_cast<int64_t>(latency));
 
         if (_callback) {
             _callback(latency);
@@ -1622,7 +1804,7 @@ public:
     inline uint64_t duration_ns() const { return _chrono.duration_ns(); }
 
 private:
-    percentile_ptr<int64_t> _percentile;
+    MetricPtr _metric;
     utils::chronograph _chrono;
     std::function<void(uint64_t)> _callback;
 
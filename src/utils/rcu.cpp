@@ -0,0 +1,153 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include "utils/rcu.h"
+
+#include <stdint.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "utils/fmt_logging.h"
+
+namespace dsn {
+namespace utils {
+
+namespace {
+
+// The epoch at which the owner thread entered its read-side critical section, or 0 if the thread
+// is not in any. Each slot takes a whole cache line to avoid false sharing among readers.
+struct alignas(64) reader_slot
+{
+    std::atomic<uint64_t> epoch{0};
+};
+
+class reader_registry
+{
+public:
+    // The registry is never destroyed, since the threads may still exit after the static
+    // objects have been destroyed.
+    static reader_registry &instance()
+    {
+        static reader_registry *registry = new reader_registry();
+        return *registry;
+    }
+
+    reader_slot *acquire_slot()
+    {
+        std::lock_guard<std::mutex> l(_mtx);
+        if (!_free_slots.empty()) {
+            reader_slot *slot = _free_slots.back();
+            _free_slots.pop_back();
+            return slot;
+        }
+
+        _slots.emplace_back(new reader_slot());
+        return _slots.back().get();
+    }
+
+    // The slots are reused rather than freed, so that the writers could always access them.
+    void release_slot(reader_slot *slot)
+    {
+        std::lock_guard<std::mutex> l(_mtx);
+        _free_slots.push_back(slot);
+    }
+
+    uint64_t current_epoch() const { return _epoch.load(std::memory_order_acquire); }
+
+    void synchronize()
+    {
+        // Order the publish of the new data before the reads of the slots below, which pairs
+        // with the fence in rcu_read_lock(): either the writer sees the epoch of a reader, or
+        // the reader sees the new data.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const uint64_t target = _epoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+
+        std::lock_guard<std::mutex> l(_mtx);
+        for (const auto &slot : _slots) {
+            while (true) {
+                const uint64_t epoch = slot->epoch.load(std::memory_order_acquire);
+                if (epoch == 0 || epoch >= target) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    reader_registry() = default;
+
+    // Epoch 0 is reserved for the slots out of critical sections.
+    std::atomic<uint64_t> _epoch{1};
+
+    std::mutex _mtx;
+    std::vector<std::unique_ptr<reader_slot>> _slots;
+    std::vector<reader_slot *> _free_slots;
+};
+
+struct thread_reader
+{
+    ~thread_reader()
+    {
+        if (slot != nullptr) {
+            reader_registry::instance().release_slot(slot);
+        }
+    }
+
+    reader_slot *slot{nullptr};
+    uint32_t nesting{0};
+};
+
+thread_local thread_reader t_reader;
+
+} // anonymous namespace
+
+void rcu_read_lock()
+{
+    thread_reader &reader = t_reader;
+    if (reader.nesting++ > 0) {
+        return;
+    }
+
+    if (dsn_unlikely(reader.slot == nullptr)) {
+        reader.slot = reader_registry::instance().acquire_slot();
+    }
+
+    reader.slot->epoch.store(reader_registry::instance().current_epoch(),
+                             std::memory_order_relaxed);
+    // Order the store of the epoch before the reads of the data in the critical section.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void rcu_read_unlock()
+{
+    thread_reader &reader = t_reader;
+    DCHECK_GT(reader.nesting, 0);
+    if (--reader.nesting == 0) {
+        reader.slot->epoch.store(0, std::memory_order_release);
+    }
+}
+
+void rcu_synchronize()
+{
+    CHECK_EQ_MSG(t_reader.nesting, 0, "rcu_synchronize() is called in a read-side section");
+    reader_registry::instance().synchronize();
+}
+
+} // namespace utils
+} // namespace dsn
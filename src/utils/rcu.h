@@ -0,0 +1,84 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "utils/ports.h"
+
+namespace dsn {
+namespace utils {
+
+// A minimal epoch-based RCU (read-copy-update) for the data that are read on hot paths but
+// rarely updated.
+//
+// Readers access the data in read-side critical sections, which only write to a cache line owned
+// by the current thread, thus never block or contend with each other or with the writers.
+// Writers never update the data in place: they publish a new copy, and free the old one once all
+// the readers that might still see it have left their critical sections.
+
+// Enter and leave a read-side critical section of the current thread, which could be nested.
+void rcu_read_lock();
+void rcu_read_unlock();
+
+// Wait until all the read-side critical sections that began before the call have ended. It must
+// not be called in a read-side critical section, otherwise it would wait for itself forever.
+void rcu_synchronize();
+
+class rcu_read_guard
+{
+public:
+    rcu_read_guard() { rcu_read_lock(); }
+    ~rcu_read_guard() { rcu_read_unlock(); }
+
+private:
+    DISALLOW_COPY_AND_ASSIGN(rcu_read_guard);
+};
+
+// A pointer to an immutable object, which could be read wait-free and replaced by writers.
+template <typename T>
+class rcu_ptr
+{
+public:
+    rcu_ptr() = default;
+    ~rcu_ptr() { delete _ptr.load(std::memory_order_relaxed); }
+
+    // Must be called in a read-side critical section, and the object returned is only valid
+    // until the section ends.
+    const T *get() const { return _ptr.load(std::memory_order_acquire); }
+
+    // Publish `ptr` as the new object, and free the old one once no reader could access it.
+    // Concurrent writers should be serialized by the caller.
+    void reset(std::unique_ptr<const T> ptr)
+    {
+        const T *old = _ptr.exchange(ptr.release(), std::memory_order_seq_cst);
+        if (old != nullptr) {
+            rcu_synchronize();
+            delete old;
+        }
+    }
+
+private:
+    std::atomic<const T *> _ptr{nullptr};
+
+    DISALLOW_COPY_AND_ASSIGN(rcu_ptr);
+};
+
+} // namespace utils
+} // namespace dsn
@@ -0,0 +1,230 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <fmt/core.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "common/gpid.h"
+#include "test_util/test_util.h"
+#include "utils/autoref_ptr.h"
+#include "utils/ports.h"
+#include "utils/rcu.h"
+#include "utils/string_conv.h"
+#include "utils/strings.h"
+#include "utils/synchronize.h"
+
+// Compare the lookups of the replicas by gpid, as replica_stub::get_replica() does, between the
+// map protected by a rwlock and the map published by RCU.
+
+namespace {
+
+class mock_replica : public dsn::ref_counter
+{
+};
+
+using mock_replica_ptr = dsn::ref_ptr<mock_replica>;
+using mock_replicas = std::unordered_map<dsn::gpid, mock_replica_ptr>;
+
+const int32_t kAppId = 1;
+
+// The same lock as the one underlying zrwlock_nr by default.
+class rwlock_replicas
+{
+public:
+    explicit rwlock_replicas(const mock_replicas &rs) : _replicas(rs) {}
+
+    mock_replica_ptr get(const dsn::gpid &pid) const
+    {
+        dsn::utils::auto_read_lock l(_lock);
+        auto it = _replicas.find(pid);
+        return it == _replicas.end() ? nullptr : it->second;
+    }
+
+    void update(const mock_replicas &rs)
+    {
+        dsn::utils::auto_write_lock l(_lock);
+        _replicas = rs;
+    }
+
+private:
+    mutable dsn::utils::rw_lock_nr _lock;
+    mock_replicas _replicas;
+
+    DISALLOW_COPY_AND_ASSIGN(rwlock_replicas);
+};
+
+class rcu_replicas
+{
+public:
+    explicit rcu_replicas(const mock_replicas &rs) { update(rs); }
+
+    mock_replica_ptr get(const dsn::gpid &pid) const
+    {
+        dsn::utils::rcu_read_guard guard;
+        const auto *rs = _replicas.get();
+        auto it = rs->find(pid);
+        return it == rs->end() ? nullptr : it->second;
+    }
+
+    void update(const mock_replicas &rs)
+    {
+        _replicas.reset(std::make_unique<const mock_replicas>(rs));
+    }
+
+private:
+    dsn::utils::rcu_ptr<mock_replicas> _replicas;
+
+    DISALLOW_COPY_AND_ASSIGN(rcu_replicas);
+};
+
+void print_usage(const char *cmd)
+{
+    fmt::print(stderr,
+               "USAGE: {} <num_operations> <num_threads> <lookup_type> [num_replicas] "
+               "[update_interval_ms]\n",
+               cmd);
+    fmt::print(stderr, "Run a simple benchmark that looks up the replicas by gpid.\n\n");
+
+    fmt::print(stderr,
+               "    <num_operations>       the number of lookups executed by each thread\n");
+    fmt::print(stderr, "    <num_threads>          the number of threads\n");
+    fmt::print(stderr, "    <lookup_type>          the type of lookup: rwlock, rcu\n");
+    fmt::print(stderr, "    [num_replicas]         the number of replicas, 1000 by default\n");
+    fmt::print(stderr,
+               "    [update_interval_ms]   the interval to update the replicas, 0 means never "
+               "updating, 100 by default\n");
+}
+
+template <typename Replicas>
+void run_bench(int64_t num_operations,
+               int64_t num_threads,
+               int32_t num_replicas,
+               int64_t update_interval_ms,
+               const char *name)
+{
+    mock_replicas rs;
+    for (int32_t i = 0; i < num_replicas; ++i) {
+        rs.emplace(dsn::gpid(kAppId, i), mock_replica_ptr(new mock_replica()));
+    }
+    Replicas replicas(rs);
+
+    // Update the replicas periodically as the replicas are opened and closed.
+    std::atomic<bool> stopped(false);
+    std::thread updater([&]() {
+        if (update_interval_ms <= 0) {
+            return;
+        }
+        while (!stopped.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(update_interval_ms));
+            replicas.update(rs);
+        }
+    });
+
+    std::atomic<int64_t> found(0);
+    std::vector<std::thread> threads;
+
+    pegasus::stop_watch sw;
+    for (int64_t i = 0; i < num_threads; i++) {
+        threads.emplace_back([num_operations, num_replicas, i, &replicas, &found]() {
+            int64_t local_found = 0;
+            for (int64_t j = 0; j < num_operations; ++j) {
+                auto pidx = static_cast<int32_t>((i + j) % num_replicas);
+                if (replicas.get(dsn::gpid(kAppId, pidx)) != nullptr) {
+                    ++local_found;
+                }
+            }
+            found.fetch_add(local_found);
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    sw.stop_and_output(fmt::format("Running {} lookups of {} with {} threads, found = {}",
+                                   num_operations,
+                                   name,
+                                   num_threads,
+                                   found.load()));
+
+    stopped.store(true);
+    updater.join();
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 4) {
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    int64_t num_operations;
+    if (!dsn::buf2int64(argv[1], num_operations)) {
+        fmt::print(stderr, "Invalid num_operations: {}\n\n", argv[1]);
+
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    int64_t num_threads;
+    if (!dsn::buf2int64(argv[2], num_threads)) {
+        fmt::print(stderr, "Invalid num_threads: {}\n\n", argv[2]);
+
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    int32_t num_replicas = 1000;
+    if (argc > 4 && (!dsn::buf2int32(argv[4], num_replicas) || num_replicas <= 0)) {
+        fmt::print(stderr, "Invalid num_replicas: {}\n\n", argv[4]);
+
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    int64_t update_interval_ms = 100;
+    if (argc > 5 && !dsn::buf2int64(argv[5], update_interval_ms)) {
+        fmt::print(stderr, "Invalid update_interval_ms: {}\n\n", argv[5]);
+
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    const char *lookup_type = argv[3];
+    if (dsn::utils::equals(lookup_type, "rwlock")) {
+        run_bench<rwlock_replicas>(
+            num_operations, num_threads, num_replicas, update_interval_ms, lookup_type);
+    } else if (dsn::utils::equals(lookup_type, "rcu")) {
+        run_bench<rcu_replicas>(
+            num_operations, num_threads, num_replicas, update_interval_ms, lookup_type);
+    } else {
+        fmt::print(stderr, "Invalid lookup_type: {}\n\n", lookup_type);
+
+        print_usage(argv[0]);
+        ::exit(-1);
+    }
+
+    return 0;
+}
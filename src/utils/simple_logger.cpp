@@ -29,9 +29,12 @@
 // IWYU pragma: no_include <ext/alloc_traits.h>
 #include <fmt/core.h>
 #include <stdint.h>
+#include <algorithm>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <sstream>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/string_view.h"
@@ -70,11 +73,33 @@ DSN_DEFINE_validator(stderr_start_level, [](const char *level) -> bool {
     return !dsn::utils::equals(level, "LOG_LEVEL_INVALID");
 });
 
+DSN_DEFINE_uint32(tools.async_logger,
+                  buffer_capacity_per_thread,
+                  1024,
+                  "The max number of logs buffered for each logging thread before being written "
+                  "by the background thread");
+DSN_DEFINE_validator(buffer_capacity_per_thread, [](uint32_t value) -> bool { return value > 0; });
+
+DSN_DEFINE_uint32(tools.async_logger,
+                  flush_interval_ms,
+                  100,
+                  "The max interval in milliseconds for the background thread to write the "
+                  "buffered logs to file");
+DSN_DEFINE_validator(flush_interval_ms, [](uint32_t value) -> bool { return value > 0; });
+
+DSN_DEFINE_bool(tools.async_logger,
+                block_on_full_buffer,
+                false,
+                "Whether to block the logging thread until its buffer has room when it is full, "
+                "otherwise the log is dropped and counted");
+DSN_TAG_VARIABLE(block_on_full_buffer, FT_MUTABLE);
+
 DSN_DECLARE_string(logging_start_level);
 
 namespace dsn {
 namespace tools {
-static void print_header(FILE *fp, log_level_t log_level)
+static void
+print_header(FILE *fp, log_level_t log_level, uint64_t ts, int tid, const std::string &prefix)
 {
     // The leading character of each log lines, corresponding to the log level
     // D: Debug
@@ -84,18 +109,16 @@ static void print_header(FILE *fp, log_level_t log_level)
     // F: Fatal
     static char s_level_char[] = "DIWEF";
 
-    uint64_t ts = dsn_now_ns();
     std::string time_str;
     dsn::utils::time_ms_to_string(ts / 1000000, time_str);
 
-    int tid = dsn::utils::get_current_tid();
-    fmt::print(fp,
-               "{}{} ({} {}) {}",
-               s_level_char[log_level],
-               time_str,
-               ts,
-               tid,
-               log_prefixed_message_func().c_str());
+    fmt::print(fp, "{}{} ({} {}) {}", s_level_char[log_level], time_str, ts, tid, prefix);
+}
+
+static void print_header(FILE *fp, log_level_t log_level)
+{
+    print_header(
+        fp, log_level, dsn_now_ns(), dsn::utils::get_current_tid(), log_prefixed_message_func());
 }
 
 namespace {
@@ -264,7 +287,28 @@ void simple_logger::log(
 {
     utils::auto_lock<::dsn::utils::ex_lock> l(_lock);
 
-    print_header(_log, log_level);
+    write_log(dsn_now_ns(),
+              dsn::utils::get_current_tid(),
+              log_prefixed_message_func(),
+              file,
+              function,
+              line,
+              log_level,
+              str);
+
+    process_fatal_log(log_level);
+}
+
+void simple_logger::write_log(uint64_t ts_ns,
+                              int tid,
+                              const std::string &prefix,
+                              const char *file,
+                              const char *function,
+                              const int line,
+                              log_level_t log_level,
+                              const char *str)
+{
+    print_header(_log, log_level, ts_ns, tid, prefix);
     if (!FLAGS_short_header) {
         fprintf(_log, "%s:%d:%s(): ", file, line, function);
     }
@@ -274,19 +318,261 @@ void simple_logger::log(
     }
 
     if (log_level >= _stderr_start_level) {
-        print_header(stdout, log_level);
+        print_header(stdout, log_level, ts_ns, tid, prefix);
         if (!FLAGS_short_header) {
             printf("%s:%d:%s(): ", file, line, function);
         }
         printf("%s\n", str);
     }
 
-    process_fatal_log(log_level);
-
     if (++_lines >= 200000) {
         create_log_file();
     }
 }
 
+// A single-producer single-consumer ring buffer of logs: the producer is the owner thread, and
+// the consumer is whoever holds async_logger::_lock.
+class async_log_ring
+{
+public:
+    explicit async_log_ring(size_t capacity) : _entries(capacity) {}
+
+    size_t capacity() const { return _entries.size(); }
+
+    size_t size() const
+    {
+        return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+    }
+
+    // Move `entry` into the ring if it is not full.
+    bool push(async_log_entry &entry)
+    {
+        const uint64_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) >= _entries.size()) {
+            return false;
+        }
+
+        _entries[tail % _entries.size()] = std::move(entry);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Move all the entries in the ring to the back of `entries`.
+    void pop_all(std::vector<async_log_entry> &entries)
+    {
+        uint64_t head = _head.load(std::memory_order_relaxed);
+        const uint64_t tail = _tail.load(std::memory_order_acquire);
+        for (; head < tail; ++head) {
+            entries.push_back(std::move(_entries[head % _entries.size()]));
+        }
+        _head.store(head, std::memory_order_release);
+    }
+
+    // Mark the ring as no longer being written after the owner thread exits.
+    void abandon() { _abandoned.store(true, std::memory_order_release); }
+    bool is_abandoned() const { return _abandoned.load(std::memory_order_acquire); }
+
+private:
+    std::vector<async_log_entry> _entries;
+    CACHELINE_ALIGNED std::atomic<uint64_t> _head{0};
+    CACHELINE_ALIGNED std::atomic<uint64_t> _tail{0};
+    std::atomic<bool> _abandoned{false};
+
+    DISALLOW_COPY_AND_ASSIGN(async_log_ring);
+};
+
+namespace {
+
+std::atomic<uint64_t> s_next_async_logger_id{1};
+
+// The ring buffer of the current thread for the async_logger it logged to last time.
+struct thread_log_ring
+{
+    ~thread_log_ring()
+    {
+        if (ring != nullptr) {
+            ring->abandon();
+        }
+    }
+
+    uint64_t logger_id{0};
+    std::shared_ptr<async_log_ring> ring;
+};
+
+thread_local thread_log_ring t_log_ring;
+
+} // anonymous namespace
+
+async_logger::async_logger(const char *log_dir)
+    : simple_logger(log_dir),
+      _id(s_next_async_logger_id.fetch_add(1, std::memory_order_relaxed)),
+      _flusher([this]() { flusher_loop(); })
+{
+}
+
+async_logger::~async_logger()
+{
+    {
+        std::lock_guard<std::mutex> l(_flusher_lock);
+        _stopped.store(true);
+    }
+    _flusher_cv.notify_one();
+    _flusher.join();
+
+    flush();
+}
+
+async_log_ring *async_logger::get_thread_ring()
+{
+    if (dsn_likely(t_log_ring.logger_id == _id)) {
+        return t_log_ring.ring.get();
+    }
+
+    // The ring for another logger would never be written again.
+    if (t_log_ring.ring != nullptr) {
+        t_log_ring.ring->abandon();
+    }
+
+    auto ring = std::make_shared<async_log_ring>(FLAGS_buffer_capacity_per_thread);
+    {
+        std::lock_guard<std::mutex> l(_rings_lock);
+        _rings.push_back(ring);
+    }
+    t_log_ring.logger_id = _id;
+    t_log_ring.ring = std::move(ring);
+    return t_log_ring.ring.get();
+}
+
+void async_logger::notify_flusher()
+{
+    {
+        std::lock_guard<std::mutex> l(_flusher_lock);
+        _flush_requested = true;
+    }
+    _flusher_cv.notify_one();
+}
+
+void async_logger::log(
+    const char *file, const char *function, const int line, log_level_t log_level, const char *str)
+{
+    if (dsn_unlikely(log_level >= LOG_LEVEL_FATAL)) {
+        // Write the buffered logs before the fatal one, which may cause coredump.
+        utils::auto_lock<::dsn::utils::ex_lock> l(_lock);
+        write_buffered_logs();
+        write_log(dsn_now_ns(),
+                  dsn::utils::get_current_tid(),
+                  log_prefixed_message_func(),
+                  file,
+                  function,
+                  line,
+                  log_level,
+                  str);
+
+        process_fatal_log(log_level);
+        return;
+    }
+
+    async_log_entry entry{dsn_now_ns(),
+                          dsn::utils::get_current_tid(),
+                          log_prefixed_message_func(),
+                          file,
+                          function,
+                          line,
+                          log_level,
+                          str};
+    async_log_ring *ring = get_thread_ring();
+    while (!ring->push(entry)) {
+        notify_flusher();
+        if (!FLAGS_block_on_full_buffer || _stopped.load(std::memory_order_relaxed)) {
+            _dropped_count.fetch_add(1, std::memory_order_relaxed);
+            _total_dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    // Wake up the flusher earlier rather than waiting for the interval, if the log is important
+    // or the ring is going to be full.
+    if (log_level >= LOG_LEVEL_ERROR || ring->size() * 2 >= ring->capacity()) {
+        notify_flusher();
+    }
+}
+
+void async_logger::flush()
+{
+    {
+        utils::auto_lock<::dsn::utils::ex_lock> l(_lock);
+        write_buffered_logs();
+    }
+    simple_logger::flush();
+}
+
+void async_logger::flusher_loop()
+{
+    while (true) {
+        {
+            std::unique_lock<std::mutex> l(_flusher_lock);
+            _flusher_cv.wait_for(l, std::chrono::milliseconds(FLAGS_flush_interval_ms), [this]() {
+                return _flush_requested || _stopped.load();
+            });
+            _flush_requested = false;
+        }
+
+        if (_stopped.load()) {
+            return;
+        }
+        flush();
+    }
+}
+
+void async_logger::write_buffered_logs()
+{
+    {
+        std::lock_guard<std::mutex> l(_rings_lock);
+        for (auto it = _rings.begin(); it != _rings.end();) {
+            // Check before popping, since the ring is abandoned after its last push.
+            const bool abandoned = (*it)->is_abandoned();
+            (*it)->pop_all(_batch);
+            if (abandoned) {
+                it = _rings.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Merge the logs of all threads in the order of time.
+    std::stable_sort(_batch.begin(),
+                     _batch.end(),
+                     [](const async_log_entry &lhs, const async_log_entry &rhs) {
+                         return lhs.ts_ns < rhs.ts_ns;
+                     });
+
+    const uint64_t dropped_count = _dropped_count.exchange(0, std::memory_order_relaxed);
+    if (dropped_count > 0) {
+        write_log(dsn_now_ns(),
+                  dsn::utils::get_current_tid(),
+                  log_prefixed_message_func(),
+                  __FILE__,
+                  __FUNCTION__,
+                  __LINE__,
+                  LOG_LEVEL_WARNING,
+                  fmt::format("{} logs were dropped since the buffers were full", dropped_count)
+                      .c_str());
+    }
+
+    for (const auto &entry : _batch) {
+        write_log(entry.ts_ns,
+                  entry.tid,
+                  entry.prefix,
+                  entry.file,
+                  entry.function,
+                  entry.line,
+                  entry.log_level,
+                  entry.str.c_str());
+    }
+    _batch.clear();
+}
+
 } // namespace tools
 } // namespace dsn
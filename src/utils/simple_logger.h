@@ -26,8 +26,15 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
 #include <cstdio>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "utils/api_utilities.h"
 #include "utils/logging_provider.h"
@@ -76,12 +83,25 @@ public:
 
     void flush() override;
 
+protected:
+    // Write a line to the log file (and stdout if the level is high enough) with the header
+    // fields captured when it was logged, which must be called with `_lock` held.
+    void write_log(uint64_t ts_ns,
+                   int tid,
+                   const std::string &prefix,
+                   const char *file,
+                   const char *function,
+                   const int line,
+                   log_level_t log_level,
+                   const char *str);
+
+    ::dsn::utils::ex_lock _lock; // use recursive lock to avoid dead lock when flush() is called
+                                 // in signal handler if cored for bad logging format reason.
+
 private:
     void create_log_file();
 
 private:
-    ::dsn::utils::ex_lock _lock; // use recursive lock to avoid dead lock when flush() is called
-                                 // in signal handler if cored for bad logging format reason.
     const std::string _log_dir;
     FILE *_log;
     int _start_index;
@@ -89,5 +109,71 @@ private:
     int _lines;
     log_level_t _stderr_start_level;
 };
+
+// A log buffered by async_logger, whose header fields are captured when it is logged but
+// formatted by the background thread.
+struct async_log_entry
+{
+    uint64_t ts_ns;
+    int tid;
+    std::string prefix;
+    // Both `file` and `function` point to string literals.
+    const char *file;
+    const char *function;
+    int line;
+    log_level_t log_level;
+    std::string str;
+};
+
+class async_log_ring;
+
+/*
+ * async_logger provides a logger which writes to file like simple_logger. However, a logging
+ * thread only appends the logs to its own lock-free ring buffer, while a background thread
+ * formats and writes the logs of all threads in batches, thus the logging threads never block
+ * on file I/O or on each other. The fatal logs are still written synchronously.
+ */
+class async_logger : public simple_logger
+{
+public:
+    explicit async_logger(const char *log_dir);
+    ~async_logger() override;
+
+    void log(const char *file,
+             const char *function,
+             const int line,
+             log_level_t log_level,
+             const char *str) override;
+
+    void flush() override;
+
+    // The total number of logs dropped since the ring buffers were full.
+    uint64_t dropped_count() const { return _total_dropped_count.load(std::memory_order_relaxed); }
+
+private:
+    async_log_ring *get_thread_ring();
+    void notify_flusher();
+    void flusher_loop();
+
+    // Write all the logs buffered by now to the file, which must be called with `_lock` held.
+    void write_buffered_logs();
+
+    const uint64_t _id;
+
+    std::mutex _rings_lock;
+    std::vector<std::shared_ptr<async_log_ring>> _rings;
+    // Only accessed with `_lock` held.
+    std::vector<async_log_entry> _batch;
+
+    // The number of logs dropped since they were reported last time.
+    std::atomic<uint64_t> _dropped_count{0};
+    std::atomic<uint64_t> _total_dropped_count{0};
+
+    std::atomic<bool> _stopped{false};
+    std::mutex _flusher_lock;
+    std::condition_variable _flusher_cv;
+    bool _flush_requested{false};
+    std::thread _flusher;
+};
 } // namespace tools
 } // namespace dsn
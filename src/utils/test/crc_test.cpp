@@ -0,0 +1,89 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "utils/crc.h"
+#include "utils/rand.h"
+
+namespace dsn {
+namespace utils {
+
+TEST(crc_test, check_values)
+{
+    const char *data = "123456789";
+    ASSERT_EQ(0xe3069283, crc32_calc(data, 9, 0));
+    ASSERT_EQ(0xe3069283, crc32_calc_portable(data, 9, 0));
+    ASSERT_EQ(0xae8b14860a799888, crc64_calc(data, 9, 0));
+    ASSERT_EQ(0xae8b14860a799888, crc64_calc_portable(data, 9, 0));
+}
+
+// The implementations chosen at runtime should always give the same results as the portable
+// ones, whatever the sizes, the alignments and the initial values are.
+TEST(crc_test, same_as_portable)
+{
+    std::vector<uint8_t> buffer(4096 + 16);
+    for (auto &b : buffer) {
+        b = static_cast<uint8_t>(rand::next_u32(0, 255));
+    }
+
+    const std::vector<uint64_t> inits = {0, 0x1234567890abcdef, ~0ULL, rand::next_u64()};
+    for (size_t size = 0; size <= 4096; size = size < 300 ? size + 1 : size * 2 - 1) {
+        for (size_t offset = 0; offset < 16; ++offset) {
+            const uint8_t *data = buffer.data() + offset;
+            for (const auto init : inits) {
+                ASSERT_EQ(crc32_calc_portable(data, size, static_cast<uint32_t>(init)),
+                          crc32_calc(data, size, static_cast<uint32_t>(init)))
+                    << "size = " << size << ", offset = " << offset << ", init = " << init;
+                ASSERT_EQ(crc64_calc_portable(data, size, init), crc64_calc(data, size, init))
+                    << "size = " << size << ", offset = " << offset << ", init = " << init;
+            }
+        }
+    }
+}
+
+TEST(crc_test, concat)
+{
+    std::vector<uint8_t> buffer(1000);
+    for (auto &b : buffer) {
+        b = static_cast<uint8_t>(rand::next_u32(0, 255));
+    }
+
+    for (const size_t x_size : {0, 7, 64, 333, 1000}) {
+        const size_t y_size = buffer.size() - x_size;
+
+        const uint32_t x_crc32 = crc32_calc(buffer.data(), x_size, 0);
+        const uint32_t y_crc32 = crc32_calc(buffer.data() + x_size, y_size, 0);
+        ASSERT_EQ(crc32_calc(buffer.data(), buffer.size(), 0),
+                  crc32_concat(0, 0, x_crc32, x_size, 0, y_crc32, y_size));
+        ASSERT_EQ(crc32_calc(buffer.data(), buffer.size(), 0),
+                  crc32_calc(buffer.data() + x_size, y_size, x_crc32));
+
+        const uint64_t x_crc64 = crc64_calc(buffer.data(), x_size, 0);
+        const uint64_t y_crc64 = crc64_calc(buffer.data() + x_size, y_size, 0);
+        ASSERT_EQ(crc64_calc(buffer.data(), buffer.size(), 0),
+                  crc64_concat(0, 0, x_crc64, x_size, 0, y_crc64, y_size));
+        ASSERT_EQ(crc64_calc(buffer.data(), buffer.size(), 0),
+                  crc64_calc(buffer.data() + x_size, y_size, x_crc64));
+    }
+}
+
+} // namespace utils
+} // namespace dsn
@@ -27,15 +27,18 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <errno.h>
 #include <fmt/core.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <algorithm>
+#include <fstream>
 #include <memory>
 #include <string>
 #include <thread>
 #include <vector>
 
 #include "gtest/gtest.h"
+#include "test_util/test_util.h"
 #include "utils/api_utilities.h"
 #include "utils/filesystem.h"
 #include "utils/flags.h"
@@ -43,6 +46,8 @@
 #include "utils/safe_strerror_posix.h"
 #include "utils/simple_logger.h"
 
+DSN_DECLARE_bool(block_on_full_buffer);
+DSN_DECLARE_uint32(buffer_capacity_per_thread);
 DSN_DECLARE_uint64(max_number_of_log_files_on_disk);
 
 namespace dsn {
@@ -81,6 +86,30 @@ void prepare_test_dir()
     ASSERT_EQ(0, ::chdir(kTestDir.c_str()));
 }
 
+// Count the lines containing `str` in all the log files.
+uint64_t count_log_lines(const std::string &str)
+{
+    std::vector<std::string> sub_list;
+    EXPECT_TRUE(dsn::utils::filesystem::get_subfiles("./", sub_list, false));
+
+    uint64_t count = 0;
+    for (const auto &path : sub_list) {
+        const auto &name = dsn::utils::filesystem::get_file_name(path);
+        if (!boost::algorithm::starts_with(name, "log.")) {
+            continue;
+        }
+
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.find(str) != std::string::npos) {
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
 void remove_test_dir()
 {
     ASSERT_EQ(0, ::chdir("..")) << "chdir failed, err = " << dsn::utils::safe_strerror(errno);
@@ -127,5 +156,49 @@ TEST(LoggerTest, SimpleLogger)
     remove_test_dir();
 }
 
+TEST(LoggerTest, AsyncLogger)
+{
+    PRESERVE_FLAG(block_on_full_buffer);
+    PRESERVE_FLAG(buffer_capacity_per_thread);
+    // Use small buffers to make them full frequently.
+    FLAGS_buffer_capacity_per_thread = 16;
+
+    const int kThreadCount = 4;
+    const uint64_t kLogCountPerThread = 10000;
+    for (const bool block : {false, true}) {
+        FLAGS_block_on_full_buffer = block;
+        prepare_test_dir();
+
+        uint64_t dropped_count = 0;
+        {
+            auto logger = std::make_unique<async_logger>("./");
+            std::vector<std::thread> threads;
+            for (int i = 0; i < kThreadCount; ++i) {
+                threads.emplace_back([&logger]() {
+                    for (uint64_t j = 0; j < kLogCountPerThread; ++j) {
+                        LOG_PRINT(logger.get(), "{}", "test_print");
+                    }
+                });
+            }
+            for (auto &t : threads) {
+                t.join();
+            }
+            logger->flush();
+            dropped_count = logger->dropped_count();
+        }
+
+        // Each log is either written or dropped and counted, and none is dropped if blocking.
+        if (block) {
+            ASSERT_EQ(0, dropped_count);
+        }
+        ASSERT_EQ(kThreadCount * kLogCountPerThread, count_log_lines("test_print") + dropped_count);
+        if (dropped_count > 0) {
+            ASSERT_LT(0, count_log_lines("logs were dropped since the buffers were full"));
+        }
+
+        remove_test_dir();
+    }
+}
+
 } // namespace tools
 } // namespace dsn
@@ -24,6 +24,7 @@
 #include <gtest/gtest.h>
 #include <rapidjson/document.h>
 #include <rapidjson/error/error.h>
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <cstring>
@@ -196,6 +197,11 @@ METRIC_DEFINE_percentile_int64(my_replica,
                                dsn::metric_unit::kSeconds,
                                "a replica-level percentile of int64 type in seconds for test");
 
+METRIC_DEFINE_histogram(my_replica,
+                        test_replica_histogram,
+                        dsn::metric_unit::kNanoSeconds,
+                        "a replica-level histogram for test");
+
 namespace dsn {
 
 TEST(metrics_test, create_entity)
@@ -3197,6 +3203,63 @@ INSTANTIATE_TEST_SUITE_P(MetricsTest,
                          MetricsRetirementTest,
                          testing::ValuesIn(metrics_retirement_tests));
 
+TEST(metrics_test, histogram_buckets)
+{
+    // The small values are counted exactly.
+    for (int64_t val = 0; val < static_cast<int64_t>(kHistogramSubBucketCount); ++val) {
+        ASSERT_EQ(val, histogram_bucket_index(val));
+        ASSERT_EQ(val, histogram_bucket_highest_value(histogram_bucket_index(val)));
+    }
+
+    // The buckets are continuous.
+    for (size_t i = 0; i < kHistogramBucketCount; ++i) {
+        const auto highest_value = histogram_bucket_highest_value(i);
+        ASSERT_EQ(i, histogram_bucket_index(highest_value));
+        if (i + 1 < kHistogramBucketCount) {
+            ASSERT_EQ(i + 1, histogram_bucket_index(highest_value + 1));
+        }
+    }
+
+    // The relative error is bounded.
+    for (int i = 0; i < 100000; ++i) {
+        const auto val = static_cast<int64_t>(rand::next_u64(0, kHistogramMaxValue));
+        const auto highest_value = histogram_bucket_highest_value(histogram_bucket_index(val));
+        ASSERT_GE(highest_value, val);
+        ASSERT_LE(highest_value - val, val * 2 / static_cast<int64_t>(kHistogramSubBucketCount));
+    }
+
+    // The values out of range are clamped.
+    ASSERT_EQ(0, histogram_bucket_index(-1));
+    ASSERT_EQ(kHistogramBucketCount - 1, histogram_bucket_index(kHistogramMaxValue));
+    ASSERT_EQ(kHistogramBucketCount - 1, histogram_bucket_index(INT64_MAX));
+}
+
+TEST(metrics_test, histogram_snapshot)
+{
+    histogram_snapshot empty;
+    ASSERT_EQ(0, empty.count());
+    ASSERT_EQ(0, empty.value(kth_percentile_type::P99));
+
+    histogram_snapshot first_half;
+    histogram_snapshot second_half;
+    for (size_t i = 0; i < 32; ++i) {
+        first_half.add(i, 1);
+        second_half.add(i + 32, 1);
+    }
+    ASSERT_EQ(31, first_half.value(kth_percentile_type::P99));
+
+    // The percentiles of the merged snapshot are the same as if all the values had been counted
+    // by a single histogram.
+    first_half.merge(second_half);
+    ASSERT_EQ(64, first_half.count());
+    ASSERT_EQ(64, first_half.buckets().size());
+    ASSERT_EQ(32, first_half.value(kth_percentile_type::P50));
+    ASSERT_EQ(57, first_half.value(kth_percentile_type::P90));
+    ASSERT_EQ(60, first_half.value(kth_percentile_type::P95));
+    ASSERT_EQ(63, first_half.value(kth_percentile_type::P99));
+    ASSERT_EQ(63, first_half.value(kth_percentile_type::P999));
+}
+
 class MetricVarTest : public testing::Test
 {
 protected:
@@ -3219,6 +3282,8 @@ protected:
 
     void test_auto_count();
 
+    void test_set_histogram();
+
     const metric_entity_ptr _my_replica_metric_entity;
     METRIC_VAR_DECLARE_gauge_int64(test_replica_gauge_int64);
     METRIC_VAR_DECLARE_counter(test_replica_counter);
@@ -3226,6 +3291,7 @@ protected:
     METRIC_VAR_DECLARE_percentile_int64(test_replica_percentile_int64_us);
     METRIC_VAR_DECLARE_percentile_int64(test_replica_percentile_int64_ms);
     METRIC_VAR_DECLARE_percentile_int64(test_replica_percentile_int64_s);
+    METRIC_VAR_DECLARE_histogram(test_replica_histogram);
 
     DISALLOW_COPY_AND_ASSIGN(MetricVarTest);
 };
@@ -3237,7 +3303,10 @@ MetricVarTest::MetricVarTest()
       METRIC_VAR_INIT_my_replica(test_replica_percentile_int64_ns),
       METRIC_VAR_INIT_my_replica(test_replica_percentile_int64_us),
       METRIC_VAR_INIT_my_replica(test_replica_percentile_int64_ms),
-      METRIC_VAR_INIT_my_replica(test_replica_percentile_int64_s)
+      METRIC_VAR_INIT_my_replica(test_replica_percentile_int64_s),
+      // Disable the timer of the histogram to rotate the windows manually, and keep the latest
+      // 2 windows.
+      METRIC_VAR_INIT_my_replica(test_replica_histogram, 0, 2)
 {
 }
 
@@ -3270,6 +3339,72 @@ void MetricVarTest::test_auto_count()
     ASSERT_EQ(0, METRIC_VAR_VALUE(test_replica_gauge_int64));
 }
 
+void MetricVarTest::test_set_histogram()
+{
+    auto &h = METRIC_VAR_NAME(test_replica_histogram);
+    ASSERT_FALSE(h->timer_enabled());
+
+    const auto allocated_stripes = [&h]() {
+        return std::count_if(h->_stripes.begin(), h->_stripes.end(), [](const auto &stripe) {
+            return stripe.load() != nullptr;
+        });
+    };
+
+    // No stripe is allocated before the first observation.
+    ASSERT_EQ(0, allocated_stripes());
+
+    // Nothing is visible before the observations are drained into a window.
+    for (int64_t val = 1; val <= 60; ++val) {
+        METRIC_VAR_SET(test_replica_histogram, val);
+    }
+    METRIC_VAR_SET(test_replica_histogram, 40, 1000);
+    ASSERT_EQ(0, h->snapshot().count());
+
+    // All the observations are recorded by this thread, into only one stripe.
+    ASSERT_EQ(1, allocated_stripes());
+
+    h->rotate();
+    ASSERT_EQ(100, h->snapshot().count());
+    int64_t val = 0;
+    ASSERT_TRUE(h->get(kth_percentile_type::P50, val));
+    ASSERT_EQ(51, val);
+    ASSERT_TRUE(h->get(kth_percentile_type::P90, val));
+    ASSERT_EQ(histogram_bucket_highest_value(histogram_bucket_index(1000)), val);
+    ASSERT_GE(val, 1000);
+    ASSERT_LE(val, 1000 + 1000 * 2 / static_cast<int64_t>(kHistogramSubBucketCount));
+
+    // The buckets are taken in the snapshot.
+    metric_filters filters;
+    const auto json_string = take_snapshot_as_json(h.get(), filters);
+    rapidjson::Document doc;
+    ASSERT_FALSE(doc.Parse(json_string.c_str()).HasParseError());
+    ASSERT_EQ(100, doc[kMetricHistogramCountField.c_str()].GetUint64());
+    ASSERT_EQ(val, doc["p90"].GetInt64());
+    const auto &buckets = doc[kMetricHistogramBucketsField.c_str()];
+    ASSERT_EQ(61, buckets.Size());
+    ASSERT_EQ(1, buckets[0][0].GetInt64());
+    ASSERT_EQ(1, buckets[0][1].GetUint64());
+    ASSERT_EQ(val, buckets[60][0].GetInt64());
+    ASSERT_EQ(40, buckets[60][1].GetUint64());
+
+    // The sliding window consists of the latest 2 windows.
+    METRIC_VAR_SET(test_replica_histogram, 20, 1000);
+    h->rotate();
+    ASSERT_EQ(120, h->snapshot().count());
+    h->rotate();
+    ASSERT_EQ(20, h->snapshot().count());
+    h->rotate();
+    ASSERT_EQ(0, h->snapshot().count());
+
+    // The latency could also be recorded automatically into the histogram.
+    {
+        METRIC_VAR_AUTO_LATENCY(test_replica_histogram);
+    }
+    h->rotate();
+    ASSERT_EQ(1, h->snapshot().count());
+    ASSERT_EQ(1, allocated_stripes());
+}
+
 #define TEST_METRIC_VAR_INCREMENT(name)                                                            \
     do {                                                                                           \
         ASSERT_EQ(0, METRIC_VAR_VALUE(name));                                                      \
@@ -3355,4 +3490,6 @@ TEST_F(MetricVarTest, AutoLatencySeconds) { TEST_METRIC_VAR_AUTO_LATENCY(s, 1000
 
 TEST_F(MetricVarTest, AutoCount) { ASSERT_NO_FATAL_FAILURE(test_auto_count()); }
 
+TEST_F(MetricVarTest, SetHistogram) { ASSERT_NO_FATAL_FAILURE(test_set_histogram()); }
+
 } // namespace dsn
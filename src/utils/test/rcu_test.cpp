@@ -0,0 +1,132 @@
+// Licensed to the Apache Software Foundation (ASF) under one
+// or more contributor license agreements.  See the NOTICE file
+// distributed with this work for additional information
+// regarding copyright ownership.  The ASF licenses this file
+// to you under the Apache License, Version 2.0 (the
+// "License"); you may not use this file except in compliance
+// with the License.  You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing,
+// software distributed under the License is distributed on an
+// "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied.  See the License for the
+// specific language governing permissions and limitations
+// under the License.
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "utils/rcu.h"
+
+namespace dsn {
+namespace utils {
+
+namespace {
+
+struct rcu_object
+{
+    explicit rcu_object(int64_t v) : value(v), alive(true) {}
+    ~rcu_object() { alive.store(false); }
+
+    int64_t value;
+    std::atomic<bool> alive;
+};
+
+} // anonymous namespace
+
+TEST(rcu_test, read_and_reset)
+{
+    rcu_ptr<rcu_object> ptr;
+    {
+        rcu_read_guard guard;
+        ASSERT_EQ(nullptr, ptr.get());
+    }
+
+    ptr.reset(std::make_unique<rcu_object>(1));
+    {
+        rcu_read_guard guard;
+        ASSERT_EQ(1, ptr.get()->value);
+
+        // The read-side critical sections could be nested.
+        rcu_read_guard nested_guard;
+        ASSERT_EQ(1, ptr.get()->value);
+    }
+
+    ptr.reset(std::make_unique<rcu_object>(2));
+    {
+        rcu_read_guard guard;
+        ASSERT_EQ(2, ptr.get()->value);
+    }
+}
+
+TEST(rcu_test, synchronize_waits_for_readers)
+{
+    std::atomic<bool> reader_entered(false);
+    std::atomic<bool> reader_exiting(false);
+    std::thread reader([&]() {
+        rcu_read_guard guard;
+        reader_entered.store(true);
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        reader_exiting.store(true);
+    });
+
+    while (!reader_entered.load()) {
+        std::this_thread::yield();
+    }
+    rcu_synchronize();
+    ASSERT_TRUE(reader_exiting.load());
+    reader.join();
+
+    // No reader is in a critical section, thus it should return immediately.
+    rcu_synchronize();
+}
+
+TEST(rcu_test, concurrent_read_and_reset)
+{
+    rcu_ptr<rcu_object> ptr;
+    ptr.reset(std::make_unique<rcu_object>(0));
+
+    const int kReaderCount = 8;
+    const int64_t kResetCount = 1000;
+    std::atomic<bool> stopped(false);
+    std::atomic<int64_t> dead_reads(0);
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < kReaderCount; ++i) {
+        readers.emplace_back([&]() {
+            int64_t last_value = 0;
+            while (!stopped.load(std::memory_order_relaxed)) {
+                rcu_read_guard guard;
+                const rcu_object *obj = ptr.get();
+                // The object read should never be freed in the critical section, and the values
+                // should never go backwards.
+                if (!obj->alive.load() || obj->value < last_value) {
+                    dead_reads.fetch_add(1);
+                }
+                last_value = obj->value;
+            }
+        });
+    }
+
+    for (int64_t i = 1; i <= kResetCount; ++i) {
+        ptr.reset(std::make_unique<rcu_object>(i));
+    }
+    stopped.store(true);
+    for (auto &reader : readers) {
+        reader.join();
+    }
+
+    ASSERT_EQ(0, dead_reads.load());
+    rcu_read_guard guard;
+    ASSERT_EQ(kResetCount, ptr.get()->value);
+}
+
+} // namespace utils
+} // namespace dsn